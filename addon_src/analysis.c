@@ -0,0 +1,2857 @@
+/**
+ * @file analysis.c
+ * @brief Media analysis passes - Whole-file scans (black/silence, crop, fingerprints, packets), cover art and per-frame statistics
+ * @description Every call opens its own demuxer and decoders and runs as one work item on the
+ *              libuv thread pool, so several files are analysed concurrently; results are
+ *              delivered through a Promise
+ */
+
+#include <node_api.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavformat/avformat.h"
+#include "libavcodec/avcodec.h"
+#include "libavutil/channel_layout.h"
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/motion_vector.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/samplefmt.h"
+#include "libavutil/thread.h"
+#include "libswresample/swresample.h"
+#include "libswscale/swscale.h"
+
+#include "atomic_api.h"
+#include "memory_budget.h"
+
+// ============================================================================
+// Analysis Jobs - One async work item per call; each pass embeds AnalysisJob
+// as its first member
+// ============================================================================
+
+typedef struct AnalysisJob {
+    char file_path[1024];
+    napi_deferred deferred;
+    napi_async_work work;
+    const char *name;      // Async resource name
+    int error;
+    MemoryBudget *budget;  // memoryBudget option; charged for decoded frames
+
+    int (*run)(struct AnalysisJob *job);                              // Worker thread
+    napi_value (*build_result)(napi_env env, struct AnalysisJob *job); // Main thread
+    void (*uninit)(struct AnalysisJob *job);
+} AnalysisJob;
+
+static void free_analysis_job(AnalysisJob *job) {
+    if (job->uninit) {
+        job->uninit(job);
+    }
+    memory_budget_unref(&job->budget);
+    av_free(job);
+}
+
+static void analysis_execute(napi_env env, void *data) {
+    AnalysisJob *job = (AnalysisJob *)data;
+    (void)env;
+
+    job->error = job->run(job);
+}
+
+static void analysis_complete(napi_env env, napi_status status, void *data) {
+    AnalysisJob *job = (AnalysisJob *)data;
+    napi_value result = NULL;
+
+    if (status == napi_ok && job->error >= 0) {
+        result = job->build_result(env, job);
+    }
+
+    if (result) {
+        napi_resolve_deferred(env, job->deferred, result);
+    } else {
+        char errbuf[128];
+        if (status != napi_ok) {
+            snprintf(errbuf, sizeof(errbuf), "Analysis was cancelled");
+        } else if (job->error < 0) {
+            av_strerror(job->error, errbuf, sizeof(errbuf));
+        } else {
+            snprintf(errbuf, sizeof(errbuf), "Failed to build analysis result");
+        }
+        napi_value msg, error;
+        napi_create_string_utf8(env, errbuf, NAPI_AUTO_LENGTH, &msg);
+        napi_create_error(env, NULL, msg, &error);
+        napi_reject_deferred(env, job->deferred, error);
+    }
+
+    napi_delete_async_work(env, job->work);
+    free_analysis_job(job);
+}
+
+static void reject_analysis_job(napi_env env, AnalysisJob *job, const char *message) {
+    napi_value msg, error;
+    napi_create_string_utf8(env, message, NAPI_AUTO_LENGTH, &msg);
+    napi_create_error(env, NULL, msg, &error);
+    napi_reject_deferred(env, job->deferred, error);
+    free_analysis_job(job);
+}
+
+static void start_analysis_job(napi_env env, AnalysisJob *job) {
+    napi_value resource_name;
+    napi_create_string_utf8(env, job->name, NAPI_AUTO_LENGTH, &resource_name);
+    napi_status status = napi_create_async_work(env, NULL, resource_name,
+                                                analysis_execute, analysis_complete,
+                                                job, &job->work);
+    if (status == napi_ok) {
+        status = napi_queue_async_work(env, job->work);
+    }
+    if (status != napi_ok) {
+        if (job->work) {
+            napi_delete_async_work(env, job->work);
+        }
+        reject_analysis_job(env, job, "Failed to queue analysis");
+    }
+}
+
+// The memory budget dropped below its limit (or the wait timed out); admit the job
+static void analysis_budget_ready(napi_env env, void *opaque, int status) {
+    AnalysisJob *job = opaque;
+
+    if (status < 0) {
+        char errbuf[128];
+        av_strerror(status, errbuf, sizeof(errbuf));
+        reject_analysis_job(env, job, errbuf);
+        return;
+    }
+    start_analysis_job(env, job);
+}
+
+// Queue a job; ownership passes to the completion callback (or is released here on failure).
+// With a memory budget the job is only admitted to the thread pool while the budget has room,
+// since its decoder charges frames without waiting
+static napi_value queue_analysis_job(napi_env env, AnalysisJob *job, napi_value options,
+                                     const char *name) {
+    napi_value promise;
+
+    job->name = name;
+    if (memory_budget_from_option(env, options, &job->budget) < 0) {
+        free_analysis_job(job);
+        return NULL;
+    }
+    if (napi_create_promise(env, &job->deferred, &promise) != napi_ok) {
+        free_analysis_job(job);
+        napi_throw_error(env, NULL, "Failed to create promise");
+        return NULL;
+    }
+
+    int ret = job->budget ? memory_budget_wait_async(env, job->budget, 1, analysis_budget_ready, job) : 1;
+    if (ret > 0) {
+        start_analysis_job(env, job);
+    } else if (ret < 0) {
+        analysis_budget_ready(env, job, ret);
+    }
+    return promise;
+}
+
+// ============================================================================
+// Option Helpers
+// ============================================================================
+
+static int get_double_option(napi_env env, napi_value obj, const char *name, double *out) {
+    bool has = false;
+    napi_value val;
+    napi_valuetype type;
+
+    if (napi_has_named_property(env, obj, name, &has) != napi_ok || !has) {
+        return 0;
+    }
+    napi_get_named_property(env, obj, name, &val);
+    napi_typeof(env, val, &type);
+    if (type != napi_number) {
+        return 0;
+    }
+    napi_get_value_double(env, val, out);
+    return 1;
+}
+
+// Returns 1 when set, 0 when absent, -1 after throwing a RangeError for NaN, +-Infinity or a
+// value outside int32 (fractions are truncated)
+static int get_int_option(napi_env env, napi_value obj, const char *name, int32_t *out) {
+    double val;
+    if (!get_double_option(env, obj, name, &val)) {
+        return 0;
+    }
+    if (!(val > INT32_MIN - 1.0 && val < INT32_MAX + 1.0)) {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "%s must be a finite 32-bit integer", name);
+        napi_throw_range_error(env, NULL, msg);
+        return -1;
+    }
+    *out = (int32_t)val;
+    return 1;
+}
+
+static int get_bool_option(napi_env env, napi_value obj, const char *name, int *out) {
+    bool has = false, flag = false;
+    napi_value val;
+    napi_valuetype type;
+
+    if (napi_has_named_property(env, obj, name, &has) != napi_ok || !has) {
+        return 0;
+    }
+    napi_get_named_property(env, obj, name, &val);
+    napi_typeof(env, val, &type);
+    if (type != napi_boolean) {
+        return 0;
+    }
+    napi_get_value_bool(env, val, &flag);
+    *out = flag;
+    return 1;
+}
+
+// Parse the (filePath, options?) arguments shared by every pass
+static int get_analysis_args(napi_env env, napi_callback_info info, char *file_path, size_t size,
+                             napi_value *options) {
+    size_t argc = 2;
+    napi_value argv[2];
+    size_t str_len;
+
+    napi_status status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected file path argument");
+        return -1;
+    }
+    if (napi_get_value_string_utf8(env, argv[0], file_path, size, &str_len) != napi_ok) {
+        napi_throw_error(env, NULL, "Failed to get file path");
+        return -1;
+    }
+
+    *options = NULL;
+    if (argc >= 2) {
+        napi_valuetype type;
+        napi_typeof(env, argv[1], &type);
+        if (type == napi_object) {
+            *options = argv[1];
+        }
+    }
+    return 0;
+}
+
+// ============================================================================
+// Decoding Helpers (worker thread)
+// ============================================================================
+
+static int open_analysis_input(const char *file_path, AVFormatContext **fmt_ctx) {
+    int ret = avformat_open_input(fmt_ctx, file_path, NULL, NULL);
+    if (ret < 0) {
+        return ret;
+    }
+    ret = avformat_find_stream_info(*fmt_ctx, NULL);
+    if (ret < 0) {
+        avformat_close_input(fmt_ctx);
+    }
+    return ret;
+}
+
+/**
+ * Open a decoder for the best stream of a type
+ * @param budget - Memory budget charged for decoded frames, or NULL
+ * @param target_width - Video only: lowres decoding is used while the picture stays at least this wide
+ * @param keyframes_only - Video only: non-key frames are skipped by the decoder
+ * @returns stream index, or negative AVERROR (AVERROR_STREAM_NOT_FOUND if there is none)
+ */
+static int open_analysis_decoder(AVFormatContext *fmt_ctx, enum AVMediaType type, MemoryBudget *budget,
+                                 int target_width, int keyframes_only, AVCodecContext **dec_ctx) {
+    const AVCodec *codec = NULL;
+    int idx = av_find_best_stream(fmt_ctx, type, -1, -1, &codec, 0);
+    if (idx < 0) {
+        return idx;
+    }
+
+    AVCodecContext *dec = avcodec_alloc_context3(codec);
+    if (!dec) {
+        return AVERROR(ENOMEM);
+    }
+    int ret = avcodec_parameters_to_context(dec, fmt_ctx->streams[idx]->codecpar);
+    if (ret < 0) {
+        avcodec_free_context(&dec);
+        return ret;
+    }
+    dec->pkt_timebase = fmt_ctx->streams[idx]->time_base;
+    dec->thread_count = 0;
+    memory_budget_attach_decoder(dec, budget);
+
+    if (type == AVMEDIA_TYPE_VIDEO) {
+        // Analysis never needs full fidelity: drop deblocking and decode at reduced size where possible
+        dec->skip_loop_filter = AVDISCARD_ALL;
+        while (target_width > 0 && dec->lowres < codec->max_lowres &&
+               (dec->width >> (dec->lowres + 1)) >= target_width) {
+            dec->lowres++;
+        }
+        if (keyframes_only) {
+            // Frame threading only adds output delay when sparse keyframes are decoded
+            dec->skip_frame = AVDISCARD_NONKEY;
+            dec->thread_type = FF_THREAD_SLICE;
+        }
+    }
+
+    ret = avcodec_open2(dec, codec, NULL);
+    if (ret < 0) {
+        avcodec_free_context(&dec);
+        return ret;
+    }
+    *dec_ctx = dec;
+    return idx;
+}
+
+typedef int (*analysis_frame_fn)(void *opaque, AVFrame *frame);
+
+// Send a packet (NULL to flush) and hand every decoded frame to process
+static int decode_and_process(AVCodecContext *dec, const AVPacket *pkt, AVFrame *frame,
+                              analysis_frame_fn process, void *opaque) {
+    int ret = avcodec_send_packet(dec, pkt);
+    // Corrupt packets are skipped rather than failing the whole scan
+    if (ret < 0 && ret != AVERROR_INVALIDDATA) {
+        return ret;
+    }
+
+    while ((ret = avcodec_receive_frame(dec, frame)) >= 0) {
+        ret = process(opaque, frame);
+        av_frame_unref(frame);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    return (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) ? 0 : ret;
+}
+
+// Plane 0 can be scanned directly as 8-bit luma
+static int is_8bit_luma_format(enum AVPixelFormat fmt) {
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+    return desc && desc->comp[0].plane == 0 && desc->comp[0].step == 1 && desc->comp[0].depth == 8 &&
+           !(desc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_PAL |
+                            AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_BITSTREAM));
+}
+
+/**
+ * Get an 8-bit luma plane of a frame at the requested size
+ * @description Frames that already are 8-bit YUV/gray at that size are used in place; anything
+ *              else goes through swscale into *gray (GRAY8, allocated on demand)
+ */
+static int get_luma_plane(struct SwsContext **sws, AVFrame **gray, const AVFrame *frame,
+                          int width, int height, const uint8_t **data, int *linesize) {
+    if (width == frame->width && height == frame->height && is_8bit_luma_format(frame->format)) {
+        *data = frame->data[0];
+        *linesize = frame->linesize[0];
+        return 0;
+    }
+
+    if (!*gray) {
+        *gray = av_frame_alloc();
+        if (!*gray) {
+            return AVERROR(ENOMEM);
+        }
+    }
+    if ((*gray)->width != width || (*gray)->height != height) {
+        av_frame_unref(*gray);
+        (*gray)->format = AV_PIX_FMT_GRAY8;
+        (*gray)->width = width;
+        (*gray)->height = height;
+        int ret = av_frame_get_buffer(*gray, 0);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    *sws = sws_getCachedContext(*sws, frame->width, frame->height, frame->format,
+                                width, height, AV_PIX_FMT_GRAY8, SWS_AREA, NULL, NULL, NULL);
+    if (!*sws) {
+        return AVERROR(EINVAL);
+    }
+    int ret = sws_scale(*sws, (const uint8_t * const *)frame->data, frame->linesize, 0, frame->height,
+                        (*gray)->data, (*gray)->linesize);
+    if (ret < 0) {
+        return ret;
+    }
+    *data = (*gray)->data[0];
+    *linesize = (*gray)->linesize[0];
+    return 0;
+}
+
+static double frame_time(const AVFrame *frame, AVRational time_base, double fallback) {
+    int64_t ts = frame->best_effort_timestamp;
+    if (ts == AV_NOPTS_VALUE) {
+        ts = frame->pts;
+    }
+    return ts == AV_NOPTS_VALUE ? fallback : ts * av_q2d(time_base);
+}
+
+// ============================================================================
+// Interval Lists
+// ============================================================================
+
+typedef struct {
+    double start;
+    double end;
+} Interval;
+
+typedef struct {
+    Interval *items;
+    int nb;
+    int capacity;
+} IntervalList;
+
+static int interval_list_add(IntervalList *list, double start, double end) {
+    if (list->nb == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 16;
+        Interval *items = av_realloc_array(list->items, capacity, sizeof(*items));
+        if (!items) {
+            return AVERROR(ENOMEM);
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->nb].start = start;
+    list->items[list->nb].end = end;
+    list->nb++;
+    return 0;
+}
+
+static napi_value interval_list_to_js(napi_env env, const IntervalList *list) {
+    napi_value array, item, val;
+    napi_create_array_with_length(env, list->nb, &array);
+    for (int i = 0; i < list->nb; i++) {
+        napi_create_object(env, &item);
+        napi_create_double(env, list->items[i].start, &val);
+        napi_set_named_property(env, item, "start", val);
+        napi_create_double(env, list->items[i].end, &val);
+        napi_set_named_property(env, item, "end", val);
+        napi_create_double(env, list->items[i].end - list->items[i].start, &val);
+        napi_set_named_property(env, item, "duration", val);
+        napi_set_element(env, array, i, item);
+    }
+    return array;
+}
+
+// ============================================================================
+// Black-Frame / Silence Detection (blackdetect / silencedetect semantics)
+// ============================================================================
+
+typedef struct {
+    AnalysisJob job;
+
+    // Options
+    double black_min_duration;
+    double picture_black_ratio;
+    double pixel_black_threshold;
+    double silence_noise;          // Linear amplitude
+    double silence_min_duration;
+    int keyframes_only;
+    int analysis_width;
+
+    // Video state
+    AVRational video_tb;
+    struct SwsContext *sws;
+    AVFrame *gray;
+    int in_black;
+    double black_start;
+    double video_end;
+
+    // Audio state
+    AVRational audio_tb;
+    struct SwrContext *swr;
+    int swr_in_rate;
+    enum AVSampleFormat swr_in_fmt;
+    AVChannelLayout swr_in_layout;
+    float *samples;
+    int samples_capacity;
+    int in_silence;
+    double silence_start;
+    double audio_end;
+
+    IntervalList black;
+    IntervalList silence;
+} BlackSilenceJob;
+
+// Pixels at or below threshold; the inner loop is branch-free so it vectorizes
+static int64_t count_dark_pixels(const uint8_t *data, int linesize, int width, int height, int threshold) {
+    int64_t total = 0;
+    for (int y = 0; y < height; y++) {
+        const uint8_t * restrict row = data + (ptrdiff_t)y * linesize;
+        int n = 0;
+        for (int x = 0; x < width; x++) {
+            n += row[x] <= threshold;
+        }
+        total += n;
+    }
+    return total;
+}
+
+static int black_process_frame(void *opaque, AVFrame *frame) {
+    BlackSilenceJob *j = (BlackSilenceJob *)opaque;
+
+    int width = frame->width, height = frame->height;
+    const uint8_t *data;
+    int linesize;
+
+    // 8-bit luma is scanned in place; other formats are converted at analysis size
+    int converted = !is_8bit_luma_format(frame->format);
+    if (converted) {
+        width = FFMIN(j->analysis_width, frame->width);
+        height = FFMAX(1, (int)av_rescale(frame->height, width, frame->width));
+    }
+    int ret = get_luma_plane(&j->sws, &j->gray, frame, width, height, &data, &linesize);
+    if (ret < 0) {
+        return ret;
+    }
+
+    // Limited-range luma starts at 16; swscale output and JPEG-range frames are full range
+    int full_range = converted || frame->color_range == AVCOL_RANGE_JPEG;
+    int threshold = full_range ? (int)(j->pixel_black_threshold * 255)
+                               : (int)(16 + j->pixel_black_threshold * (235 - 16));
+
+    int64_t dark = count_dark_pixels(data, linesize, width, height, threshold);
+    int is_black = dark >= j->picture_black_ratio * width * height;
+
+    double t = frame_time(frame, j->video_tb, j->video_end);
+    if (is_black && !j->in_black) {
+        j->in_black = 1;
+        j->black_start = t;
+    } else if (!is_black && j->in_black) {
+        j->in_black = 0;
+        if (t - j->black_start >= j->black_min_duration) {
+            ret = interval_list_add(&j->black, j->black_start, t);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+    }
+
+    double duration = frame->duration > 0 ? frame->duration * av_q2d(j->video_tb) : 0;
+    j->video_end = FFMAX(j->video_end, t + duration);
+    return 0;
+}
+
+// Convert any input to interleaved float with the same layout and rate
+static int silence_convert(BlackSilenceJob *j, const AVFrame *frame) {
+    if (!j->swr ||
+        j->swr_in_rate != frame->sample_rate ||
+        j->swr_in_fmt != (enum AVSampleFormat)frame->format ||
+        av_channel_layout_compare(&j->swr_in_layout, &frame->ch_layout)) {
+        swr_free(&j->swr);
+        av_channel_layout_uninit(&j->swr_in_layout);
+
+        int ret = swr_alloc_set_opts2(&j->swr,
+            &frame->ch_layout, AV_SAMPLE_FMT_FLT, frame->sample_rate,
+            &frame->ch_layout, (enum AVSampleFormat)frame->format, frame->sample_rate,
+            0, NULL);
+        if (ret < 0) {
+            return ret;
+        }
+        ret = swr_init(j->swr);
+        if (ret < 0) {
+            swr_free(&j->swr);
+            return ret;
+        }
+        j->swr_in_rate = frame->sample_rate;
+        j->swr_in_fmt = (enum AVSampleFormat)frame->format;
+        ret = av_channel_layout_copy(&j->swr_in_layout, &frame->ch_layout);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    int needed = frame->nb_samples * frame->ch_layout.nb_channels;
+    if (needed > j->samples_capacity) {
+        av_freep(&j->samples);
+        j->samples = av_malloc_array(needed, sizeof(float));
+        if (!j->samples) {
+            j->samples_capacity = 0;
+            return AVERROR(ENOMEM);
+        }
+        j->samples_capacity = needed;
+    }
+
+    uint8_t *out = (uint8_t *)j->samples;
+    return swr_convert(j->swr, &out, frame->nb_samples,
+                       (const uint8_t * const *)frame->extended_data, frame->nb_samples);
+}
+
+static int silence_process_frame(void *opaque, AVFrame *frame) {
+    BlackSilenceJob *j = (BlackSilenceJob *)opaque;
+
+    int nb_samples = silence_convert(j, frame);
+    if (nb_samples < 0) {
+        return nb_samples;
+    }
+
+    int channels = frame->ch_layout.nb_channels;
+    double t0 = frame_time(frame, j->audio_tb, j->audio_end);
+    double sample_dur = 1.0 / frame->sample_rate;
+    const float noise = (float)j->silence_noise;
+    const float * restrict s = j->samples;
+
+    for (int i = 0; i < nb_samples; i++) {
+        // A sample is silent when every channel is below the noise floor
+        float peak = 0.0f;
+        for (int c = 0; c < channels; c++) {
+            peak = fmaxf(peak, fabsf(s[i * channels + c]));
+        }
+        int silent = peak < noise;
+        if (silent == j->in_silence) {
+            continue;
+        }
+
+        double t = t0 + i * sample_dur;
+        if (silent) {
+            j->silence_start = t;
+        } else if (t - j->silence_start >= j->silence_min_duration) {
+            int ret = interval_list_add(&j->silence, j->silence_start, t);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+        j->in_silence = silent;
+    }
+
+    j->audio_end = FFMAX(j->audio_end, t0 + nb_samples * sample_dur);
+    return 0;
+}
+
+static int black_silence_run(AnalysisJob *job) {
+    BlackSilenceJob *j = (BlackSilenceJob *)job;
+    AVFormatContext *fmt_ctx = NULL;
+    AVCodecContext *vdec = NULL, *adec = NULL;
+    AVPacket *pkt = NULL;
+    AVFrame *frame = NULL;
+
+    int ret = open_analysis_input(job->file_path, &fmt_ctx);
+    if (ret < 0) {
+        return ret;
+    }
+
+    int vidx = open_analysis_decoder(fmt_ctx, AVMEDIA_TYPE_VIDEO, j->job.budget, j->analysis_width, j->keyframes_only, &vdec);
+    int aidx = open_analysis_decoder(fmt_ctx, AVMEDIA_TYPE_AUDIO, j->job.budget, 0, 0, &adec);
+    // A missing (or undecodable) stream only leaves its interval list empty
+    if (vidx < 0 && vidx != AVERROR_STREAM_NOT_FOUND && vidx != AVERROR_DECODER_NOT_FOUND) {
+        ret = vidx;
+        goto end;
+    }
+    if (aidx < 0 && aidx != AVERROR_STREAM_NOT_FOUND && aidx != AVERROR_DECODER_NOT_FOUND) {
+        ret = aidx;
+        goto end;
+    }
+    if (vidx < 0 && aidx < 0) {
+        ret = AVERROR_STREAM_NOT_FOUND;
+        goto end;
+    }
+
+    for (unsigned int i = 0; i < fmt_ctx->nb_streams; i++) {
+        if ((int)i != vidx && (int)i != aidx) {
+            fmt_ctx->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+    if (vidx >= 0) {
+        j->video_tb = fmt_ctx->streams[vidx]->time_base;
+    }
+    if (aidx >= 0) {
+        j->audio_tb = fmt_ctx->streams[aidx]->time_base;
+    }
+
+    pkt = av_packet_alloc();
+    frame = av_frame_alloc();
+    if (!pkt || !frame) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    while ((ret = av_read_frame(fmt_ctx, pkt)) >= 0) {
+        if (pkt->stream_index == vidx) {
+            ret = decode_and_process(vdec, pkt, frame, black_process_frame, j);
+        } else if (pkt->stream_index == aidx) {
+            ret = decode_and_process(adec, pkt, frame, silence_process_frame, j);
+        }
+        av_packet_unref(pkt);
+        if (ret < 0) {
+            goto end;
+        }
+    }
+    if (ret != AVERROR_EOF) {
+        goto end;
+    }
+
+    ret = 0;
+    if (vdec) {
+        ret = decode_and_process(vdec, NULL, frame, black_process_frame, j);
+    }
+    if (ret >= 0 && adec) {
+        ret = decode_and_process(adec, NULL, frame, silence_process_frame, j);
+    }
+    if (ret < 0) {
+        goto end;
+    }
+
+    // Runs still open at the end of the file are reported up to the last decoded frame
+    if (j->in_black && j->video_end - j->black_start >= j->black_min_duration) {
+        ret = interval_list_add(&j->black, j->black_start, j->video_end);
+    }
+    if (ret >= 0 && j->in_silence && j->audio_end - j->silence_start >= j->silence_min_duration) {
+        ret = interval_list_add(&j->silence, j->silence_start, j->audio_end);
+    }
+
+end:
+    av_frame_free(&frame);
+    av_packet_free(&pkt);
+    avcodec_free_context(&vdec);
+    avcodec_free_context(&adec);
+    avformat_close_input(&fmt_ctx);
+    return ret;
+}
+
+static napi_value black_silence_build_result(napi_env env, AnalysisJob *job) {
+    BlackSilenceJob *j = (BlackSilenceJob *)job;
+    napi_value result, val;
+
+    napi_create_object(env, &result);
+    napi_set_named_property(env, result, "black", interval_list_to_js(env, &j->black));
+    napi_set_named_property(env, result, "silence", interval_list_to_js(env, &j->silence));
+    napi_create_double(env, FFMAX(j->video_end, j->audio_end), &val);
+    napi_set_named_property(env, result, "duration", val);
+    return result;
+}
+
+static void black_silence_uninit(AnalysisJob *job) {
+    BlackSilenceJob *j = (BlackSilenceJob *)job;
+
+    sws_freeContext(j->sws);
+    av_frame_free(&j->gray);
+    swr_free(&j->swr);
+    av_channel_layout_uninit(&j->swr_in_layout);
+    av_freep(&j->samples);
+    av_freep(&j->black.items);
+    av_freep(&j->silence.items);
+}
+
+/**
+ * Detect black video intervals and audio silence in one pass
+ * @param filePath - Input file path
+ * @param options - { blackMinDuration (2), pictureBlackRatio (0.98), pixelBlackThreshold (0.10),
+ *                  noise (-60 dB), silenceMinDuration (2), keyframesOnly (false), analysisWidth (256) }
+ * @returns Promise resolving to { black: Interval[], silence: Interval[], duration }
+ */
+napi_value detect_black_and_silence(napi_env env, napi_callback_info info) {
+    char file_path[1024];
+    napi_value options;
+
+    if (get_analysis_args(env, info, file_path, sizeof(file_path), &options) < 0) {
+        return NULL;
+    }
+
+    double black_min_duration = 2.0, picture_black_ratio = 0.98, pixel_black_threshold = 0.10;
+    double noise_db = -60.0, silence_min_duration = 2.0;
+    int32_t analysis_width = 256;
+    int keyframes_only = 0;
+
+    if (options) {
+        get_double_option(env, options, "blackMinDuration", &black_min_duration);
+        get_double_option(env, options, "pictureBlackRatio", &picture_black_ratio);
+        get_double_option(env, options, "pixelBlackThreshold", &pixel_black_threshold);
+        get_double_option(env, options, "noise", &noise_db);
+        get_double_option(env, options, "silenceMinDuration", &silence_min_duration);
+        if (get_int_option(env, options, "analysisWidth", &analysis_width) < 0) {
+            return NULL;
+        }
+        get_bool_option(env, options, "keyframesOnly", &keyframes_only);
+    }
+
+    if (picture_black_ratio < 0 || picture_black_ratio > 1 ||
+        pixel_black_threshold < 0 || pixel_black_threshold > 1) {
+        napi_throw_error(env, NULL, "pictureBlackRatio and pixelBlackThreshold must be between 0 and 1");
+        return NULL;
+    }
+    if (black_min_duration < 0 || silence_min_duration < 0 || analysis_width <= 0) {
+        napi_throw_error(env, NULL, "Durations must not be negative and analysisWidth must be positive");
+        return NULL;
+    }
+
+    BlackSilenceJob *j = av_mallocz(sizeof(*j));
+    if (!j) {
+        napi_throw_error(env, NULL, "Failed to allocate analysis job");
+        return NULL;
+    }
+    snprintf(j->job.file_path, sizeof(j->job.file_path), "%s", file_path);
+    j->job.run = black_silence_run;
+    j->job.build_result = black_silence_build_result;
+    j->job.uninit = black_silence_uninit;
+
+    j->black_min_duration = black_min_duration;
+    j->picture_black_ratio = picture_black_ratio;
+    j->pixel_black_threshold = pixel_black_threshold;
+    j->silence_noise = pow(10.0, noise_db / 20.0);
+    j->silence_min_duration = silence_min_duration;
+    j->keyframes_only = keyframes_only;
+    j->analysis_width = analysis_width;
+
+    return queue_analysis_job(env, &j->job, options, "ffmpeg7:detectBlackAndSilence");
+}
+
+// ============================================================================
+// Crop (Letterbox) Detection over sampled keyframes (cropdetect semantics)
+// ============================================================================
+
+#define MAX_CROP_SAMPLES 1000
+#define MAX_CROP_THREADS 16
+
+typedef struct {
+    double time;
+    int x1, y1, x2, y2;   // Inclusive content box
+    int valid;            // 0 if the frame was entirely black or could not be decoded
+} CropSample;
+
+typedef struct {
+    AnalysisJob job;
+
+    // Options
+    int nb_samples;
+    int limit;
+    int round;
+    int threads;
+
+    CropSample *samples;
+    int width, height;
+
+    // Result
+    int x, y, w, h;
+    int nb_valid;
+} CropJob;
+
+typedef struct {
+    CropJob *job;
+    AVFormatContext *fmt_ctx;   // Opened by the worker unless handed over
+    int first;                  // Samples first, first + step, ... belong to this worker
+    int step;
+    int64_t start;
+    int64_t duration;
+    int error;
+} CropWorker;
+
+/**
+ * Find the content box of one luma plane
+ * @description Rows and columns whose mean luma exceeds limit are content. Row sums and column sums
+ *              are accumulated in the same pass; the inner loop has no branches so it vectorizes
+ */
+static void find_content_box(const uint8_t *data, int linesize, int width, int height, int limit,
+                             uint32_t * restrict col_sum, CropSample *s) {
+    int y1 = height, y2 = -1, x1 = width, x2 = -1;
+
+    memset(col_sum, 0, width * sizeof(*col_sum));
+    for (int y = 0; y < height; y++) {
+        const uint8_t * restrict row = data + (ptrdiff_t)y * linesize;
+        uint32_t row_sum = 0;
+        for (int x = 0; x < width; x++) {
+            row_sum += row[x];
+            col_sum[x] += row[x];
+        }
+        if (row_sum > (uint32_t)limit * width) {
+            y1 = FFMIN(y1, y);
+            y2 = y;
+        }
+    }
+    for (int x = 0; x < width; x++) {
+        if (col_sum[x] > (uint32_t)limit * height) {
+            x1 = FFMIN(x1, x);
+            x2 = x;
+        }
+    }
+
+    s->x1 = x1;
+    s->y1 = y1;
+    s->x2 = x2;
+    s->y2 = y2;
+    s->valid = x2 >= x1 && y2 >= y1;
+}
+
+// Seek to one sample position and decode the keyframe at or before it
+static int crop_decode_sample(AVFormatContext *fmt_ctx, AVCodecContext *dec, int vidx, int64_t ts,
+                              AVPacket *pkt, AVFrame *frame) {
+    // Unseekable inputs simply continue from the current position
+    if (av_seek_frame(fmt_ctx, -1, ts, AVSEEK_FLAG_BACKWARD) >= 0) {
+        avcodec_flush_buffers(dec);
+    }
+
+    for (;;) {
+        int ret = avcodec_receive_frame(dec, frame);
+        if (ret != AVERROR(EAGAIN)) {
+            return ret;
+        }
+
+        ret = av_read_frame(fmt_ctx, pkt);
+        if (ret == AVERROR_EOF) {
+            avcodec_send_packet(dec, NULL);
+            continue;
+        }
+        if (ret < 0) {
+            return ret;
+        }
+        if (pkt->stream_index == vidx) {
+            ret = avcodec_send_packet(dec, pkt);
+            if (ret < 0 && ret != AVERROR_INVALIDDATA) {
+                av_packet_unref(pkt);
+                return ret;
+            }
+        }
+        av_packet_unref(pkt);
+    }
+}
+
+static int crop_worker_run(CropWorker *w) {
+    CropJob *j = w->job;
+    AVCodecContext *dec = NULL;
+    AVPacket *pkt = NULL;
+    AVFrame *frame = NULL, *gray = NULL;
+    struct SwsContext *sws = NULL;
+    uint32_t *col_sum = NULL;
+    int ret = 0;
+
+    if (!w->fmt_ctx) {
+        ret = open_analysis_input(j->job.file_path, &w->fmt_ctx);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    int vidx = open_analysis_decoder(w->fmt_ctx, AVMEDIA_TYPE_VIDEO, j->job.budget, 0, 1, &dec);
+    if (vidx < 0) {
+        ret = vidx;
+        goto end;
+    }
+    for (unsigned int i = 0; i < w->fmt_ctx->nb_streams; i++) {
+        if ((int)i != vidx) {
+            w->fmt_ctx->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+    AVRational tb = w->fmt_ctx->streams[vidx]->time_base;
+
+    pkt = av_packet_alloc();
+    frame = av_frame_alloc();
+    col_sum = av_malloc_array(j->width, sizeof(*col_sum));
+    if (!pkt || !frame || !col_sum) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    for (int i = w->first; i < j->nb_samples; i += w->step) {
+        CropSample *s = &j->samples[i];
+        int64_t ts = w->start + av_rescale(w->duration, 2 * i + 1, 2 * j->nb_samples);
+
+        ret = crop_decode_sample(w->fmt_ctx, dec, vidx, ts, pkt, frame);
+        if (ret == AVERROR_EOF || ret == AVERROR_INVALIDDATA) {
+            ret = 0;
+            continue; // Leaves the sample invalid
+        }
+        if (ret < 0) {
+            goto end;
+        }
+
+        // Samples are measured against the stream size; frames after a size change are skipped
+        if (frame->width == j->width && frame->height == j->height) {
+            const uint8_t *data;
+            int linesize;
+            ret = get_luma_plane(&sws, &gray, frame, frame->width, frame->height, &data, &linesize);
+            if (ret < 0) {
+                goto end;
+            }
+            s->time = frame_time(frame, tb, ts / (double)AV_TIME_BASE);
+            find_content_box(data, linesize, frame->width, frame->height, j->limit, col_sum, s);
+        }
+        av_frame_unref(frame);
+    }
+
+end:
+    av_freep(&col_sum);
+    sws_freeContext(sws);
+    av_frame_free(&gray);
+    av_frame_free(&frame);
+    av_packet_free(&pkt);
+    avcodec_free_context(&dec);
+    avformat_close_input(&w->fmt_ctx);
+    return ret;
+}
+
+static void *crop_worker_thread(void *arg) {
+    CropWorker *w = (CropWorker *)arg;
+    w->error = crop_worker_run(w);
+    return NULL;
+}
+
+// Shrink a span to a multiple of round, keeping it centred on the content (cropdetect rounding)
+static void round_crop_span(int lo, int hi, int round, int *pos, int *size) {
+    int len = hi - lo + 1;
+    int shrink = len % round;
+    *size = len - shrink;
+    *pos = (lo + (shrink + 1) / 2) & ~1;
+}
+
+static int crop_run(AnalysisJob *job) {
+    CropJob *j = (CropJob *)job;
+    CropWorker workers[MAX_CROP_THREADS] = {0};
+    pthread_t threads[MAX_CROP_THREADS];
+    int started[MAX_CROP_THREADS] = {0};
+    AVFormatContext *fmt_ctx = NULL;
+
+    int ret = open_analysis_input(job->file_path, &fmt_ctx);
+    if (ret < 0) {
+        return ret;
+    }
+
+    int vidx = av_find_best_stream(fmt_ctx, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
+    if (vidx < 0) {
+        avformat_close_input(&fmt_ctx);
+        return vidx;
+    }
+    j->width = fmt_ctx->streams[vidx]->codecpar->width;
+    j->height = fmt_ctx->streams[vidx]->codecpar->height;
+    if (j->width <= 0 || j->height <= 0) {
+        avformat_close_input(&fmt_ctx);
+        return AVERROR_INVALIDDATA;
+    }
+
+    int64_t start = fmt_ctx->start_time != AV_NOPTS_VALUE ? fmt_ctx->start_time : 0;
+    int64_t duration = fmt_ctx->duration > 0 ? fmt_ctx->duration : 0;
+    if (!duration) {
+        j->nb_samples = 1; // Unseekable or unknown length: only the first keyframe
+    }
+
+    int nb_workers = FFMAX(1, FFMIN(j->threads, j->nb_samples));
+    for (int i = 0; i < nb_workers; i++) {
+        workers[i].job = j;
+        workers[i].first = i;
+        workers[i].step = nb_workers;
+        workers[i].start = start;
+        workers[i].duration = duration;
+    }
+
+    // Worker 0 reuses the probed input and runs on this thread; the others open their own
+    workers[0].fmt_ctx = fmt_ctx;
+    for (int i = 1; i < nb_workers; i++) {
+        started[i] = !pthread_create(&threads[i], NULL, crop_worker_thread, &workers[i]);
+        if (!started[i]) {
+            workers[i].error = AVERROR(EAGAIN);
+        }
+    }
+    workers[0].error = crop_worker_run(&workers[0]);
+    for (int i = 1; i < nb_workers; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+    for (int i = 0; i < nb_workers; i++) {
+        if (workers[i].error < 0) {
+            return workers[i].error;
+        }
+    }
+
+    // The union of all content boxes never cuts into picture that appears in any sample
+    int x1 = j->width, y1 = j->height, x2 = -1, y2 = -1;
+    for (int i = 0; i < j->nb_samples; i++) {
+        const CropSample *s = &j->samples[i];
+        if (!s->valid) {
+            continue;
+        }
+        x1 = FFMIN(x1, s->x1);
+        y1 = FFMIN(y1, s->y1);
+        x2 = FFMAX(x2, s->x2);
+        y2 = FFMAX(y2, s->y2);
+        j->nb_valid++;
+    }
+    if (!j->nb_valid) {
+        x1 = y1 = 0;
+        x2 = j->width - 1;
+        y2 = j->height - 1;
+    }
+
+    round_crop_span(x1, x2, j->round, &j->x, &j->w);
+    round_crop_span(y1, y2, j->round, &j->y, &j->h);
+    return 0;
+}
+
+static napi_value crop_build_result(napi_env env, AnalysisJob *job) {
+    CropJob *j = (CropJob *)job;
+    napi_value result, samples, item, val;
+    char filter[64];
+
+    napi_create_object(env, &result);
+    napi_create_int32(env, j->x, &val);
+    napi_set_named_property(env, result, "x", val);
+    napi_create_int32(env, j->y, &val);
+    napi_set_named_property(env, result, "y", val);
+    napi_create_int32(env, j->w, &val);
+    napi_set_named_property(env, result, "width", val);
+    napi_create_int32(env, j->h, &val);
+    napi_set_named_property(env, result, "height", val);
+    napi_create_int32(env, j->width, &val);
+    napi_set_named_property(env, result, "sourceWidth", val);
+    napi_create_int32(env, j->height, &val);
+    napi_set_named_property(env, result, "sourceHeight", val);
+    snprintf(filter, sizeof(filter), "crop=%d:%d:%d:%d", j->w, j->h, j->x, j->y);
+    napi_create_string_utf8(env, filter, NAPI_AUTO_LENGTH, &val);
+    napi_set_named_property(env, result, "filter", val);
+
+    napi_create_array(env, &samples);
+    uint32_t n = 0;
+    for (int i = 0; i < j->nb_samples; i++) {
+        const CropSample *s = &j->samples[i];
+        if (!s->valid) {
+            continue;
+        }
+        napi_create_object(env, &item);
+        napi_create_double(env, s->time, &val);
+        napi_set_named_property(env, item, "time", val);
+        napi_create_int32(env, s->x1, &val);
+        napi_set_named_property(env, item, "x", val);
+        napi_create_int32(env, s->y1, &val);
+        napi_set_named_property(env, item, "y", val);
+        napi_create_int32(env, s->x2 - s->x1 + 1, &val);
+        napi_set_named_property(env, item, "width", val);
+        napi_create_int32(env, s->y2 - s->y1 + 1, &val);
+        napi_set_named_property(env, item, "height", val);
+        napi_set_element(env, samples, n++, item);
+    }
+    napi_set_named_property(env, result, "samples", samples);
+    return result;
+}
+
+static void crop_uninit(AnalysisJob *job) {
+    CropJob *j = (CropJob *)job;
+    av_freep(&j->samples);
+}
+
+/**
+ * Detect black bars from evenly spaced keyframes
+ * @param filePath - Input file path
+ * @param options - { samples (12), limit (24), round (2), threads (4) }
+ * @returns Promise resolving to { x, y, width, height, sourceWidth, sourceHeight, filter, samples }
+ */
+napi_value detect_crop(napi_env env, napi_callback_info info) {
+    char file_path[1024];
+    napi_value options;
+
+    if (get_analysis_args(env, info, file_path, sizeof(file_path), &options) < 0) {
+        return NULL;
+    }
+
+    int32_t nb_samples = 12, limit = 24, round = 2, threads = 4;
+    if (options) {
+        if (get_int_option(env, options, "samples", &nb_samples) < 0 ||
+            get_int_option(env, options, "limit", &limit) < 0 ||
+            get_int_option(env, options, "round", &round) < 0 ||
+            get_int_option(env, options, "threads", &threads) < 0) {
+            return NULL;
+        }
+    }
+
+    if (nb_samples <= 0 || nb_samples > MAX_CROP_SAMPLES) {
+        napi_throw_error(env, NULL, "samples must be between 1 and 1000");
+        return NULL;
+    }
+    if (limit < 0 || limit > 255 || round <= 0 || threads <= 0) {
+        napi_throw_error(env, NULL, "limit must be between 0 and 255, round and threads must be positive");
+        return NULL;
+    }
+
+    CropJob *j = av_mallocz(sizeof(*j));
+    if (!j) {
+        napi_throw_error(env, NULL, "Failed to allocate analysis job");
+        return NULL;
+    }
+    snprintf(j->job.file_path, sizeof(j->job.file_path), "%s", file_path);
+    j->job.run = crop_run;
+    j->job.build_result = crop_build_result;
+    j->job.uninit = crop_uninit;
+
+    j->nb_samples = nb_samples;
+    j->limit = limit;
+    j->round = round % 2 ? round * 2 : round; // Even sizes keep chroma planes aligned
+    j->threads = FFMIN(threads, MAX_CROP_THREADS);
+    j->samples = av_calloc(nb_samples, sizeof(*j->samples));
+    if (!j->samples) {
+        crop_uninit(&j->job);
+        av_free(j);
+        napi_throw_error(env, NULL, "Failed to allocate analysis job");
+        return NULL;
+    }
+
+    return queue_analysis_job(env, &j->job, options, "ffmpeg7:detectCrop");
+}
+
+// ============================================================================
+// Perceptual Fingerprints (DCT pHash of the luma plane)
+// ============================================================================
+
+#define PHASH_SIZE 32                 // Frames are area-scaled to 32x32 luma before the DCT
+#define FINGERPRINT_HEADER_SIZE 8     // "PH", version, hash bytes, fps * 1000 (uint32 LE)
+#define FINGERPRINT_VERSION 1
+
+typedef struct {
+    AnalysisJob job;
+
+    // Options
+    double fps;
+    int hash_size;                    // DCT coefficients per side (8 → 64 bits, 16 → 256 bits)
+    int keyframes_only;
+
+    float cos_table[16][PHASH_SIZE];  // DCT-II basis, first hash_size rows
+    struct SwsContext *sws;
+    AVFrame *gray;
+    AVRational tb;
+
+    // Hash of the most recent frame, repeated for every tick until the next one arrives
+    uint8_t last_hash[32];
+    int have_last;
+    double next_tick;
+
+    uint8_t *signature;
+    int nb_hashes;
+    int capacity;
+} FingerprintJob;
+
+static int compare_floats(const void *a, const void *b) {
+    float fa = *(const float *)a, fb = *(const float *)b;
+    return (fa > fb) - (fa < fb);
+}
+
+/**
+ * Hash one 32x32 luma block
+ * @description Only the hash_size x hash_size low-frequency corner of the 2D DCT is computed, as two
+ *              separable passes with contiguous float loops; each bit is set when its coefficient is
+ *              above the median (DC excluded from the median)
+ */
+static void phash_block(const FingerprintJob *j, const uint8_t *data, int linesize, uint8_t *hash) {
+    const int n = j->hash_size;
+    float pixels[PHASH_SIZE][PHASH_SIZE];
+    float rows[16][PHASH_SIZE];   // Row pass: rows[u][y] = sum_x cos[u][x] * p[y][x]
+    float coeffs[16 * 16], sorted[16 * 16];
+
+    for (int y = 0; y < PHASH_SIZE; y++) {
+        for (int x = 0; x < PHASH_SIZE; x++) {
+            pixels[y][x] = data[y * linesize + x];
+        }
+    }
+
+    for (int u = 0; u < n; u++) {
+        const float * restrict c = j->cos_table[u];
+        for (int y = 0; y < PHASH_SIZE; y++) {
+            const float * restrict p = pixels[y];
+            float sum = 0.0f;
+            for (int x = 0; x < PHASH_SIZE; x++) {
+                sum += c[x] * p[x];
+            }
+            rows[u][y] = sum;
+        }
+    }
+    for (int v = 0; v < n; v++) {
+        const float * restrict c = j->cos_table[v];
+        for (int u = 0; u < n; u++) {
+            const float * restrict r = rows[u];
+            float sum = 0.0f;
+            for (int y = 0; y < PHASH_SIZE; y++) {
+                sum += c[y] * r[y];
+            }
+            coeffs[v * n + u] = sum;
+        }
+    }
+
+    memcpy(sorted, coeffs + 1, (n * n - 1) * sizeof(float));
+    qsort(sorted, n * n - 1, sizeof(float), compare_floats);
+    float median = sorted[(n * n - 1) / 2];
+
+    memset(hash, 0, n * n / 8);
+    for (int i = 0; i < n * n; i++) {
+        if (coeffs[i] > median) {
+            hash[i >> 3] |= 1 << (i & 7);
+        }
+    }
+}
+
+static int fingerprint_append(FingerprintJob *j, const uint8_t *hash) {
+    int hash_bytes = j->hash_size * j->hash_size / 8;
+    if (j->nb_hashes == j->capacity) {
+        int capacity = j->capacity ? j->capacity * 2 : 256;
+        uint8_t *signature = av_realloc(j->signature, FINGERPRINT_HEADER_SIZE + (size_t)capacity * hash_bytes);
+        if (!signature) {
+            return AVERROR(ENOMEM);
+        }
+        j->signature = signature;
+        j->capacity = capacity;
+    }
+    memcpy(j->signature + FINGERPRINT_HEADER_SIZE + (size_t)j->nb_hashes * hash_bytes, hash, hash_bytes);
+    j->nb_hashes++;
+    return 0;
+}
+
+// Emit one hash per 1/fps tick; each tick takes the last frame at or before it
+static int fingerprint_process_frame(void *opaque, AVFrame *frame) {
+    FingerprintJob *j = (FingerprintJob *)opaque;
+    double t = frame_time(frame, j->tb, j->next_tick);
+
+    if (j->have_last) {
+        while (j->next_tick < t) {
+            int ret = fingerprint_append(j, j->last_hash);
+            if (ret < 0) {
+                return ret;
+            }
+            j->next_tick += 1.0 / j->fps;
+        }
+    } else {
+        j->next_tick = t;
+    }
+
+    const uint8_t *data;
+    int linesize;
+    int ret = get_luma_plane(&j->sws, &j->gray, frame, PHASH_SIZE, PHASH_SIZE, &data, &linesize);
+    if (ret < 0) {
+        return ret;
+    }
+    phash_block(j, data, linesize, j->last_hash);
+    j->have_last = 1;
+    return 0;
+}
+
+static int fingerprint_run(AnalysisJob *job) {
+    FingerprintJob *j = (FingerprintJob *)job;
+    AVFormatContext *fmt_ctx = NULL;
+    AVCodecContext *dec = NULL;
+    AVPacket *pkt = NULL;
+    AVFrame *frame = NULL;
+
+    int ret = open_analysis_input(job->file_path, &fmt_ctx);
+    if (ret < 0) {
+        return ret;
+    }
+
+    int vidx = open_analysis_decoder(fmt_ctx, AVMEDIA_TYPE_VIDEO, j->job.budget, 4 * PHASH_SIZE, j->keyframes_only, &dec);
+    if (vidx < 0) {
+        ret = vidx;
+        goto end;
+    }
+    for (unsigned int i = 0; i < fmt_ctx->nb_streams; i++) {
+        if ((int)i != vidx) {
+            fmt_ctx->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+    j->tb = fmt_ctx->streams[vidx]->time_base;
+
+    pkt = av_packet_alloc();
+    frame = av_frame_alloc();
+    if (!pkt || !frame) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    while ((ret = av_read_frame(fmt_ctx, pkt)) >= 0) {
+        if (pkt->stream_index == vidx) {
+            ret = decode_and_process(dec, pkt, frame, fingerprint_process_frame, j);
+        }
+        av_packet_unref(pkt);
+        if (ret < 0) {
+            goto end;
+        }
+    }
+    if (ret != AVERROR_EOF) {
+        goto end;
+    }
+    ret = decode_and_process(dec, NULL, frame, fingerprint_process_frame, j);
+    if (ret >= 0 && j->have_last) {
+        ret = fingerprint_append(j, j->last_hash);
+    }
+
+end:
+    av_frame_free(&frame);
+    av_packet_free(&pkt);
+    avcodec_free_context(&dec);
+    avformat_close_input(&fmt_ctx);
+    return ret;
+}
+
+static napi_value fingerprint_build_result(napi_env env, AnalysisJob *job) {
+    FingerprintJob *j = (FingerprintJob *)job;
+    size_t size = FINGERPRINT_HEADER_SIZE + (size_t)j->nb_hashes * (j->hash_size * j->hash_size / 8);
+    napi_value arraybuffer, result;
+    void *data;
+
+    if (napi_create_arraybuffer(env, size, &data, &arraybuffer) != napi_ok) {
+        return NULL;
+    }
+    uint8_t *out = data;
+    out[0] = 'P';
+    out[1] = 'H';
+    out[2] = FINGERPRINT_VERSION;
+    out[3] = j->hash_size * j->hash_size / 8;
+    AV_WL32(out + 4, (uint32_t)lrint(j->fps * 1000));
+    if (j->nb_hashes) {
+        memcpy(out + FINGERPRINT_HEADER_SIZE, j->signature + FINGERPRINT_HEADER_SIZE,
+               size - FINGERPRINT_HEADER_SIZE);
+    }
+
+    napi_create_typedarray(env, napi_uint8_array, size, arraybuffer, 0, &result);
+    return result;
+}
+
+static void fingerprint_uninit(AnalysisJob *job) {
+    FingerprintJob *j = (FingerprintJob *)job;
+
+    sws_freeContext(j->sws);
+    av_frame_free(&j->gray);
+    av_freep(&j->signature);
+}
+
+/**
+ * Compute a perceptual video fingerprint
+ * @param filePath - Input file path
+ * @param options - { fps (1), hashBits (64 | 256, default 64), keyframesOnly (true) }
+ * @returns Promise resolving to a Uint8Array signature (8-byte header followed by one hash per tick)
+ */
+napi_value fingerprint(napi_env env, napi_callback_info info) {
+    char file_path[1024];
+    napi_value options;
+
+    if (get_analysis_args(env, info, file_path, sizeof(file_path), &options) < 0) {
+        return NULL;
+    }
+
+    double fps = 1.0;
+    int32_t hash_bits = 64;
+    int keyframes_only = 1;
+    if (options) {
+        get_double_option(env, options, "fps", &fps);
+        if (get_int_option(env, options, "hashBits", &hash_bits) < 0) {
+            return NULL;
+        }
+        get_bool_option(env, options, "keyframesOnly", &keyframes_only);
+    }
+
+    if (!(fps > 0 && fps <= 1000)) {
+        napi_throw_error(env, NULL, "fps must be greater than 0 and at most 1000");
+        return NULL;
+    }
+    if (hash_bits != 64 && hash_bits != 256) {
+        napi_throw_error(env, NULL, "hashBits must be 64 or 256");
+        return NULL;
+    }
+
+    FingerprintJob *j = av_mallocz(sizeof(*j));
+    if (!j) {
+        napi_throw_error(env, NULL, "Failed to allocate analysis job");
+        return NULL;
+    }
+    snprintf(j->job.file_path, sizeof(j->job.file_path), "%s", file_path);
+    j->job.run = fingerprint_run;
+    j->job.build_result = fingerprint_build_result;
+    j->job.uninit = fingerprint_uninit;
+
+    j->fps = fps;
+    j->hash_size = hash_bits == 256 ? 16 : 8;
+    j->keyframes_only = keyframes_only;
+    for (int u = 0; u < j->hash_size; u++) {
+        for (int x = 0; x < PHASH_SIZE; x++) {
+            j->cos_table[u][x] = (float)cos(M_PI * u * (2 * x + 1) / (2.0 * PHASH_SIZE));
+        }
+    }
+
+    return queue_analysis_job(env, &j->job, options, "ffmpeg7:fingerprint");
+}
+
+// Validate a signature and return its hash count
+static int parse_fingerprint(napi_env env, napi_value value, const uint8_t **hashes, int *hash_bytes,
+                             uint32_t *milli_fps) {
+    napi_typedarray_type type;
+    size_t length, byte_offset;
+    void *data;
+    napi_value arraybuffer;
+    bool is_typedarray = false;
+
+    napi_is_typedarray(env, value, &is_typedarray);
+    if (!is_typedarray) {
+        return -1;
+    }
+    napi_get_typedarray_info(env, value, &type, &length, &data, &arraybuffer, &byte_offset);
+    if (type != napi_uint8_array || length < FINGERPRINT_HEADER_SIZE) {
+        return -1;
+    }
+
+    const uint8_t *p = data;
+    if (p[0] != 'P' || p[1] != 'H' || p[2] != FINGERPRINT_VERSION || (p[3] != 8 && p[3] != 32) ||
+        (length - FINGERPRINT_HEADER_SIZE) % p[3]) {
+        return -1;
+    }
+    *hash_bytes = p[3];
+    *milli_fps = AV_RL32(p + 4);
+    *hashes = p + FINGERPRINT_HEADER_SIZE;
+    return (int)((length - FINGERPRINT_HEADER_SIZE) / p[3]);
+}
+
+// Mean Hamming distance over the overlap of a shifted against b
+static double mean_hamming(const uint8_t *a, int nb_a, const uint8_t *b, int nb_b, int hash_bytes,
+                           int offset, int *overlap) {
+    int start = FFMAX(0, -offset);
+    int end = FFMIN(nb_a, nb_b - offset);
+    uint64_t bits = 0;
+
+    *overlap = FFMAX(0, end - start);
+    for (int i = start; i < end; i++) {
+        const uint8_t *ha = a + (size_t)i * hash_bytes;
+        const uint8_t *hb = b + (size_t)(i + offset) * hash_bytes;
+        for (int k = 0; k < hash_bytes; k += 8) {
+            bits += av_popcount64(AV_RN64(ha + k) ^ AV_RN64(hb + k));
+        }
+    }
+    return *overlap ? (double)bits / *overlap : 0.0;
+}
+
+/**
+ * Compare two fingerprints with sliding alignment
+ * @param a - Signature from fingerprint()
+ * @param b - Signature from fingerprint() with the same fps and hashBits
+ * @param options - { maxOffset (seconds, default 10), minOverlap (seconds, default 5) }
+ * @returns { similarity (0..1), offset (seconds b lags a), distance (mean bits), overlap (seconds) }
+ */
+napi_value fingerprint_compare(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 3;
+    napi_value argv[3];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 2) {
+        napi_throw_error(env, NULL, "Expected two fingerprints");
+        return NULL;
+    }
+
+    const uint8_t *a, *b;
+    int bytes_a, bytes_b;
+    uint32_t fps_a, fps_b;
+    int nb_a = parse_fingerprint(env, argv[0], &a, &bytes_a, &fps_a);
+    int nb_b = parse_fingerprint(env, argv[1], &b, &bytes_b, &fps_b);
+    if (nb_a < 0 || nb_b < 0) {
+        napi_throw_error(env, NULL, "Invalid fingerprint");
+        return NULL;
+    }
+    if (bytes_a != bytes_b || fps_a != fps_b) {
+        napi_throw_error(env, NULL, "Fingerprints differ in fps or hashBits");
+        return NULL;
+    }
+
+    double max_offset = 10.0, min_overlap = 5.0;
+    if (argc >= 3) {
+        napi_valuetype type;
+        napi_typeof(env, argv[2], &type);
+        if (type == napi_object) {
+            get_double_option(env, argv[2], "maxOffset", &max_offset);
+            get_double_option(env, argv[2], "minOverlap", &min_overlap);
+        }
+    }
+
+    double fps = fps_a / 1000.0;
+    int max_shift = (int)(FFMAX(0.0, max_offset) * fps);
+    int min_ticks = FFMAX(1, FFMIN((int)(min_overlap * fps), FFMIN(nb_a, nb_b)));
+    int hash_bits = bytes_a * 8;
+
+    double best = hash_bits;
+    int best_offset = 0, best_overlap = 0;
+    for (int offset = -max_shift; offset <= max_shift; offset++) {
+        int overlap;
+        double dist = mean_hamming(a, nb_a, b, nb_b, bytes_a, offset, &overlap);
+        if (overlap >= min_ticks && dist < best) {
+            best = dist;
+            best_offset = offset;
+            best_overlap = overlap;
+        }
+    }
+
+    napi_value result, val;
+    napi_create_object(env, &result);
+    napi_create_double(env, best_overlap ? 1.0 - best / hash_bits : 0.0, &val);
+    napi_set_named_property(env, result, "similarity", val);
+    napi_create_double(env, best_offset / fps, &val);
+    napi_set_named_property(env, result, "offset", val);
+    napi_create_double(env, best, &val);
+    napi_set_named_property(env, result, "distance", val);
+    napi_create_double(env, best_overlap / fps, &val);
+    napi_set_named_property(env, result, "overlap", val);
+    return result;
+}
+
+// ============================================================================
+// Frame Statistics (per-component histograms and moments)
+// ============================================================================
+
+typedef struct {
+    uint64_t sum;
+    uint64_t sum_sq;
+    uint64_t count;
+    int min;
+    int max;
+} ComponentMoments;
+
+typedef struct {
+    int nb;
+    int comps[4];
+    int all;          // No explicit selection: every component of the frame
+} ComponentSelection;
+
+static int stats_format_supported(const AVPixFmtDescriptor *desc) {
+    return desc && !(desc->flags & (AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_HWACCEL |
+                                    AV_PIX_FMT_FLAG_BITSTREAM | AV_PIX_FMT_FLAG_FLOAT));
+}
+
+// Resolve the selection against a pixel format; every selected component must exist
+static int resolve_components(const ComponentSelection *sel, const AVPixFmtDescriptor *desc,
+                              ComponentSelection *out) {
+    *out = *sel;
+    if (sel->all) {
+        out->nb = desc->nb_components;
+        for (int i = 0; i < out->nb; i++) {
+            out->comps[i] = i;
+        }
+    }
+    for (int i = 0; i < out->nb; i++) {
+        if (out->comps[i] < 0 || out->comps[i] >= desc->nb_components) {
+            return AVERROR(EINVAL);
+        }
+    }
+    return 0;
+}
+
+/**
+ * Count every value of one component into full (1 << depth entries, accumulated)
+ * @description 8-bit components are read in place with four interleaved sub-histograms, which breaks the
+ *              store-to-load dependency between neighbouring equal pixels; other layouts are unpacked
+ *              a row at a time through av_read_image_line2
+ */
+static void count_component(const AVFrame *frame, const AVPixFmtDescriptor *desc, int c,
+                            uint32_t *full, uint16_t *line) {
+    const AVComponentDescriptor *comp = &desc->comp[c];
+    int w = frame->width, h = frame->height;
+    if ((c == 1 || c == 2) && !(desc->flags & AV_PIX_FMT_FLAG_RGB)) {
+        w = AV_CEIL_RSHIFT(w, desc->log2_chroma_w);
+        h = AV_CEIL_RSHIFT(h, desc->log2_chroma_h);
+    }
+
+    if (comp->depth == 8 && comp->step == 1 && comp->shift == 0) {
+        uint32_t part[4][256] = {{0}};
+        for (int y = 0; y < h; y++) {
+            const uint8_t * restrict row = frame->data[comp->plane] + (ptrdiff_t)y * frame->linesize[comp->plane] + comp->offset;
+            int x = 0;
+            for (; x + 4 <= w; x += 4) {
+                part[0][row[x]]++;
+                part[1][row[x + 1]]++;
+                part[2][row[x + 2]]++;
+                part[3][row[x + 3]]++;
+            }
+            for (; x < w; x++) {
+                part[0][row[x]]++;
+            }
+        }
+        for (int v = 0; v < 256; v++) {
+            full[v] += part[0][v] + part[1][v] + part[2][v] + part[3][v];
+        }
+        return;
+    }
+
+    for (int y = 0; y < h; y++) {
+        av_read_image_line2(line, (const uint8_t **)frame->data, frame->linesize, desc, 0, y, c, w, 0, 2);
+        for (int x = 0; x < w; x++) {
+            full[line[x]]++;
+        }
+    }
+}
+
+// Derive exact moments from the full histogram and fold it into 1 << bins_log2 bins
+static void finish_component(const uint32_t *full, int depth, int bins_log2, uint32_t *hist,
+                             ComponentMoments *m) {
+    memset(m, 0, sizeof(*m));
+    for (int v = 0; v < (1 << depth); v++) {
+        uint64_t n = full[v];
+        if (!n) {
+            continue;
+        }
+        if (!m->count) {
+            m->min = v;
+        }
+        m->max = v;
+        m->count += n;
+        m->sum += n * v;
+        m->sum_sq += n * v * (uint64_t)v;
+        hist[depth >= bins_log2 ? v >> (depth - bins_log2) : v << (bins_log2 - depth)] += n;
+    }
+}
+
+static void moments_mean_variance(const ComponentMoments *m, double *mean, double *variance) {
+    if (!m->count) {
+        *mean = *variance = 0.0;
+        return;
+    }
+    *mean = (double)m->sum / m->count;
+    *variance = FFMAX(0.0, (double)m->sum_sq / m->count - *mean * *mean);
+}
+
+// Parse { planes, bins } shared by frameStats and analyzeVideoStats
+static int get_stats_options(napi_env env, napi_value options, ComponentSelection *sel, int *bins_log2) {
+    int32_t bins = 256;
+
+    memset(sel, 0, sizeof(*sel));
+    sel->all = 1;
+    if (!options) {
+        *bins_log2 = 8;
+        return 0;
+    }
+
+    if (get_int_option(env, options, "bins", &bins) < 0) {
+        return -1;
+    }
+    if (bins < 2 || bins > 65536 || (bins & (bins - 1))) {
+        napi_throw_error(env, NULL, "bins must be a power of two between 2 and 65536");
+        return -1;
+    }
+    *bins_log2 = av_log2(bins);
+
+    bool has = false, is_array = false;
+    napi_has_named_property(env, options, "planes", &has);
+    if (has) {
+        napi_value planes;
+        uint32_t length = 0;
+        napi_get_named_property(env, options, "planes", &planes);
+        napi_is_array(env, planes, &is_array);
+        if (is_array) {
+            napi_get_array_length(env, planes, &length);
+        }
+        if (!is_array || length < 1 || length > 4) {
+            napi_throw_error(env, NULL, "planes must be an array of 1 to 4 component indices");
+            return -1;
+        }
+        sel->all = 0;
+        sel->nb = length;
+        for (uint32_t i = 0; i < length; i++) {
+            napi_value val;
+            napi_get_element(env, planes, i, &val);
+            napi_get_value_int32(env, val, &sel->comps[i]);
+        }
+    }
+    return 0;
+}
+
+// Histogram bins actually used: never finer than the shallowest selected component
+static int stats_bins_log2(const AVPixFmtDescriptor *desc, const ComponentSelection *sel, int bins_log2) {
+    for (int i = 0; i < sel->nb; i++) {
+        bins_log2 = FFMIN(bins_log2, desc->comp[sel->comps[i]].depth);
+    }
+    return bins_log2;
+}
+
+/**
+ * Compute histograms and moments of a frame's components
+ * @param frameId - Frame ID
+ * @param options - { planes (component indices, default all), bins (default 256) }
+ * @returns Array of { component, mean, variance, min, max, histogram: Uint32Array }
+ */
+napi_value frame_stats(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 2;
+    napi_value argv[2];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected frame ID");
+        return NULL;
+    }
+
+    int frame_id;
+    napi_get_value_int32(env, argv[0], &frame_id);
+    AVFrame *frame = get_context_ptr(frame_id, CTX_TYPE_FRAME);
+    if (!frame) {
+        napi_throw_error(env, NULL, "Invalid frame ID");
+        return NULL;
+    }
+    if (handle_is_busy(env, frame_id)) {
+        return NULL;
+    }
+
+    napi_value options = NULL;
+    if (argc >= 2) {
+        napi_valuetype type;
+        napi_typeof(env, argv[1], &type);
+        if (type == napi_object) {
+            options = argv[1];
+        }
+    }
+
+    ComponentSelection requested, sel;
+    int bins_log2;
+    if (get_stats_options(env, options, &requested, &bins_log2) < 0) {
+        return NULL;
+    }
+
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
+    if (!frame->data[0] || !stats_format_supported(desc)) {
+        napi_throw_error(env, NULL, "Frame has no data or an unsupported pixel format");
+        return NULL;
+    }
+    if (resolve_components(&requested, desc, &sel) < 0) {
+        napi_throw_error(env, NULL, "Component index out of range for the frame's pixel format");
+        return NULL;
+    }
+    bins_log2 = stats_bins_log2(desc, &sel, bins_log2);
+
+    uint32_t *full = av_malloc(sizeof(*full) << 16);
+    uint16_t *line = av_malloc_array(frame->width, sizeof(*line));
+    if (!full || !line) {
+        av_free(full);
+        av_free(line);
+        napi_throw_error(env, NULL, "Failed to allocate histogram");
+        return NULL;
+    }
+
+    napi_value result;
+    napi_create_array_with_length(env, sel.nb, &result);
+    for (int i = 0; i < sel.nb; i++) {
+        int c = sel.comps[i];
+        int depth = desc->comp[c].depth;
+        ComponentMoments m;
+        double mean, variance;
+        napi_value item, val, arraybuffer;
+        void *hist;
+
+        memset(full, 0, sizeof(*full) << depth);
+        count_component(frame, desc, c, full, line);
+
+        napi_create_arraybuffer(env, sizeof(uint32_t) << bins_log2, &hist, &arraybuffer);
+        memset(hist, 0, sizeof(uint32_t) << bins_log2);
+        finish_component(full, depth, bins_log2, hist, &m);
+        moments_mean_variance(&m, &mean, &variance);
+
+        napi_create_object(env, &item);
+        napi_create_int32(env, c, &val);
+        napi_set_named_property(env, item, "component", val);
+        napi_create_double(env, mean, &val);
+        napi_set_named_property(env, item, "mean", val);
+        napi_create_double(env, variance, &val);
+        napi_set_named_property(env, item, "variance", val);
+        napi_create_int32(env, m.min, &val);
+        napi_set_named_property(env, item, "min", val);
+        napi_create_int32(env, m.max, &val);
+        napi_set_named_property(env, item, "max", val);
+        napi_create_typedarray(env, napi_uint32_array, 1 << bins_log2, arraybuffer, 0, &val);
+        napi_set_named_property(env, item, "histogram", val);
+        napi_set_element(env, result, i, item);
+    }
+
+    av_free(full);
+    av_free(line);
+    return result;
+}
+
+// ----------------------------------------------------------------------------
+// Streaming statistics over a whole file
+// ----------------------------------------------------------------------------
+
+typedef struct {
+    AnalysisJob job;
+
+    // Options
+    ComponentSelection requested;
+    int requested_bins_log2;
+    int keyframes_only;
+    int per_frame_histograms;
+
+    // Fixed by the first frame
+    ComponentSelection sel;
+    int bins_log2;
+    AVRational tb;
+
+    uint32_t *full;
+    uint16_t *line;
+    int line_size;
+
+    int nb_frames;
+    double *time;             unsigned int time_size;
+    double *mean;             unsigned int mean_size;
+    double *variance;         unsigned int variance_size;
+    uint16_t *min;            unsigned int min_size;
+    uint16_t *max;            unsigned int max_size;
+    uint32_t *histogram;      unsigned int histogram_size;
+} VideoStatsJob;
+
+static int grow_buffer(void *buf, unsigned int *size, size_t needed) {
+    void *p = av_fast_realloc(*(void **)buf, size, needed);
+    if (!p) {
+        return AVERROR(ENOMEM);
+    }
+    *(void **)buf = p;
+    return 0;
+}
+
+static int video_stats_process_frame(void *opaque, AVFrame *frame) {
+    VideoStatsJob *j = (VideoStatsJob *)opaque;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
+    int ret;
+
+    if (!stats_format_supported(desc)) {
+        return AVERROR_PATCHWELCOME;
+    }
+    if (!j->nb_frames) {
+        ret = resolve_components(&j->requested, desc, &j->sel);
+        if (ret < 0) {
+            return ret;
+        }
+        j->bins_log2 = stats_bins_log2(desc, &j->sel, j->requested_bins_log2);
+    } else {
+        // Later frames must still carry every selected component
+        ComponentSelection check = j->sel;
+        check.all = 0;
+        ret = resolve_components(&check, desc, &check);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    if (frame->width > j->line_size) {
+        av_freep(&j->line);
+        j->line = av_malloc_array(frame->width, sizeof(*j->line));
+        if (!j->line) {
+            j->line_size = 0;
+            return AVERROR(ENOMEM);
+        }
+        j->line_size = frame->width;
+    }
+
+    int nc = j->sel.nb, n = j->nb_frames, bins = 1 << j->bins_log2;
+    size_t hist_count = j->per_frame_histograms ? (size_t)(n + 1) * nc * bins : (size_t)nc * bins;
+    if ((ret = grow_buffer(&j->time, &j->time_size, (n + 1) * sizeof(double))) < 0 ||
+        (ret = grow_buffer(&j->mean, &j->mean_size, (size_t)(n + 1) * nc * sizeof(double))) < 0 ||
+        (ret = grow_buffer(&j->variance, &j->variance_size, (size_t)(n + 1) * nc * sizeof(double))) < 0 ||
+        (ret = grow_buffer(&j->min, &j->min_size, (size_t)(n + 1) * nc * sizeof(uint16_t))) < 0 ||
+        (ret = grow_buffer(&j->max, &j->max_size, (size_t)(n + 1) * nc * sizeof(uint16_t))) < 0 ||
+        (ret = grow_buffer(&j->histogram, &j->histogram_size, hist_count * sizeof(uint32_t))) < 0) {
+        return ret;
+    }
+
+    uint32_t *hist_base = j->histogram;
+    if (j->per_frame_histograms) {
+        hist_base += (size_t)n * nc * bins;
+        memset(hist_base, 0, (size_t)nc * bins * sizeof(uint32_t));
+    } else if (!n) {
+        memset(hist_base, 0, (size_t)nc * bins * sizeof(uint32_t));
+    }
+
+    j->time[n] = frame_time(frame, j->tb, n ? j->time[n - 1] : 0.0);
+    for (int i = 0; i < nc; i++) {
+        int c = j->sel.comps[i];
+        int depth = desc->comp[c].depth;
+        ComponentMoments m;
+
+        memset(j->full, 0, sizeof(*j->full) << depth);
+        count_component(frame, desc, c, j->full, j->line);
+        finish_component(j->full, depth, j->bins_log2, hist_base + (size_t)i * bins, &m);
+        moments_mean_variance(&m, &j->mean[n * nc + i], &j->variance[n * nc + i]);
+        j->min[n * nc + i] = m.min;
+        j->max[n * nc + i] = m.max;
+    }
+    j->nb_frames++;
+    return 0;
+}
+
+static int video_stats_run(AnalysisJob *job) {
+    VideoStatsJob *j = (VideoStatsJob *)job;
+    AVFormatContext *fmt_ctx = NULL;
+    AVCodecContext *dec = NULL;
+    AVPacket *pkt = NULL;
+    AVFrame *frame = NULL;
+
+    j->full = av_malloc(sizeof(*j->full) << 16);
+    if (!j->full) {
+        return AVERROR(ENOMEM);
+    }
+
+    int ret = open_analysis_input(job->file_path, &fmt_ctx);
+    if (ret < 0) {
+        return ret;
+    }
+
+    int vidx = open_analysis_decoder(fmt_ctx, AVMEDIA_TYPE_VIDEO, j->job.budget, 0, j->keyframes_only, &dec);
+    if (vidx < 0) {
+        ret = vidx;
+        goto end;
+    }
+    for (unsigned int i = 0; i < fmt_ctx->nb_streams; i++) {
+        if ((int)i != vidx) {
+            fmt_ctx->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+    j->tb = fmt_ctx->streams[vidx]->time_base;
+
+    pkt = av_packet_alloc();
+    frame = av_frame_alloc();
+    if (!pkt || !frame) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    while ((ret = av_read_frame(fmt_ctx, pkt)) >= 0) {
+        if (pkt->stream_index == vidx) {
+            ret = decode_and_process(dec, pkt, frame, video_stats_process_frame, j);
+        }
+        av_packet_unref(pkt);
+        if (ret < 0) {
+            goto end;
+        }
+    }
+    if (ret == AVERROR_EOF) {
+        ret = decode_and_process(dec, NULL, frame, video_stats_process_frame, j);
+    }
+
+end:
+    av_frame_free(&frame);
+    av_packet_free(&pkt);
+    avcodec_free_context(&dec);
+    avformat_close_input(&fmt_ctx);
+    return ret;
+}
+
+// Copy a native array into a new typed array
+static napi_value create_typed_copy(napi_env env, napi_typedarray_type type, const void *src,
+                                    size_t length, size_t element_size) {
+    napi_value arraybuffer, result;
+    void *data;
+
+    if (napi_create_arraybuffer(env, length * element_size, &data, &arraybuffer) != napi_ok) {
+        return NULL;
+    }
+    if (length) {
+        memcpy(data, src, length * element_size);
+    }
+    napi_create_typedarray(env, type, length, arraybuffer, 0, &result);
+    return result;
+}
+
+static napi_value video_stats_build_result(napi_env env, AnalysisJob *job) {
+    VideoStatsJob *j = (VideoStatsJob *)job;
+    int n = j->nb_frames, nc = n ? j->sel.nb : 0, bins = 1 << j->bins_log2;
+    size_t hist_count = !n ? 0 : j->per_frame_histograms ? (size_t)n * nc * bins : (size_t)nc * bins;
+    napi_value result, val;
+
+    napi_create_object(env, &result);
+    napi_create_int32(env, n, &val);
+    napi_set_named_property(env, result, "frames", val);
+    napi_create_int32(env, n ? bins : 0, &val);
+    napi_set_named_property(env, result, "bins", val);
+
+    napi_value comps;
+    napi_create_array_with_length(env, nc, &comps);
+    for (int i = 0; i < nc; i++) {
+        napi_create_int32(env, j->sel.comps[i], &val);
+        napi_set_element(env, comps, i, val);
+    }
+    napi_set_named_property(env, result, "components", comps);
+
+    napi_set_named_property(env, result, "time",
+        create_typed_copy(env, napi_float64_array, j->time, n, sizeof(double)));
+    napi_set_named_property(env, result, "mean",
+        create_typed_copy(env, napi_float64_array, j->mean, (size_t)n * nc, sizeof(double)));
+    napi_set_named_property(env, result, "variance",
+        create_typed_copy(env, napi_float64_array, j->variance, (size_t)n * nc, sizeof(double)));
+    napi_set_named_property(env, result, "min",
+        create_typed_copy(env, napi_uint16_array, j->min, (size_t)n * nc, sizeof(uint16_t)));
+    napi_set_named_property(env, result, "max",
+        create_typed_copy(env, napi_uint16_array, j->max, (size_t)n * nc, sizeof(uint16_t)));
+    napi_set_named_property(env, result, "histogram",
+        create_typed_copy(env, napi_uint32_array, j->histogram, hist_count, sizeof(uint32_t)));
+    return result;
+}
+
+static void video_stats_uninit(AnalysisJob *job) {
+    VideoStatsJob *j = (VideoStatsJob *)job;
+
+    av_freep(&j->full);
+    av_freep(&j->line);
+    av_freep(&j->time);
+    av_freep(&j->mean);
+    av_freep(&j->variance);
+    av_freep(&j->min);
+    av_freep(&j->max);
+    av_freep(&j->histogram);
+}
+
+/**
+ * Compute per-frame statistics over a whole video stream
+ * @param filePath - Input file path
+ * @param options - { planes, bins (256), keyframesOnly (false), perFrameHistograms (false) }
+ * @returns Promise resolving to { frames, bins, components, time, mean, variance, min, max, histogram }
+ *          (per-frame arrays are frame-major with one entry per component)
+ */
+napi_value analyze_video_stats(napi_env env, napi_callback_info info) {
+    char file_path[1024];
+    napi_value options;
+
+    if (get_analysis_args(env, info, file_path, sizeof(file_path), &options) < 0) {
+        return NULL;
+    }
+
+    ComponentSelection requested;
+    int bins_log2;
+    int keyframes_only = 0, per_frame_histograms = 0;
+    if (get_stats_options(env, options, &requested, &bins_log2) < 0) {
+        return NULL;
+    }
+    if (options) {
+        get_bool_option(env, options, "keyframesOnly", &keyframes_only);
+        get_bool_option(env, options, "perFrameHistograms", &per_frame_histograms);
+    }
+
+    VideoStatsJob *j = av_mallocz(sizeof(*j));
+    if (!j) {
+        napi_throw_error(env, NULL, "Failed to allocate analysis job");
+        return NULL;
+    }
+    snprintf(j->job.file_path, sizeof(j->job.file_path), "%s", file_path);
+    j->job.run = video_stats_run;
+    j->job.build_result = video_stats_build_result;
+    j->job.uninit = video_stats_uninit;
+
+    j->requested = requested;
+    j->requested_bins_log2 = bins_log2;
+    j->keyframes_only = keyframes_only;
+    j->per_frame_histograms = per_frame_histograms;
+
+    return queue_analysis_job(env, &j->job, options, "ffmpeg7:analyzeVideoStats");
+}
+
+// ============================================================================
+// Motion Vector Statistics (decoder flags2=+export_mvs)
+// ============================================================================
+
+/**
+ * Reduce a frame's exported motion vectors to motion magnitude and direction histograms
+ * @param frameId - Frame ID decoded with flags2=+export_mvs
+ * @param options - { magnitudeBins (16), maxMagnitude (64 px), directionBins (8) }
+ * @returns { vectors, meanMagnitude, coverage, magnitude: Float64Array, direction: Float64Array }
+ * @description Histograms are weighted by block area in pixels. Vectors that reference a future frame
+ *              are negated so every direction describes forward motion
+ */
+napi_value frame_motion_stats(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 2;
+    napi_value argv[2];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected frame ID");
+        return NULL;
+    }
+
+    int frame_id;
+    napi_get_value_int32(env, argv[0], &frame_id);
+    AVFrame *frame = get_context_ptr(frame_id, CTX_TYPE_FRAME);
+    if (!frame) {
+        napi_throw_error(env, NULL, "Invalid frame ID");
+        return NULL;
+    }
+    if (handle_is_busy(env, frame_id)) {
+        return NULL;
+    }
+
+    int32_t magnitude_bins = 16, direction_bins = 8;
+    double max_magnitude = 64.0;
+    if (argc >= 2) {
+        napi_valuetype type;
+        napi_typeof(env, argv[1], &type);
+        if (type == napi_object) {
+            if (get_int_option(env, argv[1], "magnitudeBins", &magnitude_bins) < 0 ||
+                get_int_option(env, argv[1], "directionBins", &direction_bins) < 0) {
+                return NULL;
+            }
+            get_double_option(env, argv[1], "maxMagnitude", &max_magnitude);
+        }
+    }
+    if (magnitude_bins < 1 || magnitude_bins > 1024 || direction_bins < 1 || direction_bins > 360 ||
+        !(max_magnitude > 0)) {
+        napi_throw_error(env, NULL, "Invalid histogram options");
+        return NULL;
+    }
+
+    napi_value mag_buffer, dir_buffer;
+    void *mag_data, *dir_data;
+    napi_create_arraybuffer(env, magnitude_bins * sizeof(double), &mag_data, &mag_buffer);
+    napi_create_arraybuffer(env, direction_bins * sizeof(double), &dir_data, &dir_buffer);
+    double *mag_hist = mag_data, *dir_hist = dir_data;
+    memset(mag_hist, 0, magnitude_bins * sizeof(double));
+    memset(dir_hist, 0, direction_bins * sizeof(double));
+
+    const AVFrameSideData *sd = av_frame_get_side_data(frame, AV_FRAME_DATA_MOTION_VECTORS);
+    const AVMotionVector *mvs = sd ? (const AVMotionVector *)sd->data : NULL;
+    int nb_mvs = sd ? (int)(sd->size / sizeof(*mvs)) : 0;
+
+    double total_area = 0, moving_area = 0, weighted_magnitude = 0;
+    const double mag_scale = magnitude_bins / max_magnitude;
+    const double dir_scale = direction_bins / (2 * M_PI);
+
+    for (int i = 0; i < nb_mvs; i++) {
+        const AVMotionVector *mv = &mvs[i];
+        double scale = mv->motion_scale ? 1.0 / mv->motion_scale : 1.0;
+        double dx = mv->motion_x * scale, dy = mv->motion_y * scale;
+        double area = (double)mv->w * mv->h;
+        // motion = src - dst; against a past reference the block moved from src to dst, so
+        // forward motion is the negated vector (future references already point forwards)
+        if (mv->source < 0) {
+            dx = -dx;
+            dy = -dy;
+        }
+
+        double magnitude = sqrt(dx * dx + dy * dy);
+        total_area += area;
+        weighted_magnitude += magnitude * area;
+        mag_hist[FFMIN((int)(magnitude * mag_scale), magnitude_bins - 1)] += area;
+        if (magnitude > 0) {
+            // 0 = rightwards, counter-clockwise on screen (y grows downwards)
+            double angle = atan2(-dy, dx);
+            if (angle < 0) {
+                angle += 2 * M_PI;
+            }
+            dir_hist[FFMIN((int)(angle * dir_scale), direction_bins - 1)] += area;
+            moving_area += area;
+        }
+    }
+
+    napi_value result, val;
+    napi_create_object(env, &result);
+    napi_create_int32(env, nb_mvs, &val);
+    napi_set_named_property(env, result, "vectors", val);
+    napi_create_double(env, total_area > 0 ? weighted_magnitude / total_area : 0.0, &val);
+    napi_set_named_property(env, result, "meanMagnitude", val);
+    double frame_area = (double)frame->width * frame->height;
+    napi_create_double(env, frame_area > 0 ? FFMIN(1.0, moving_area / frame_area) : 0.0, &val);
+    napi_set_named_property(env, result, "coverage", val);
+    napi_create_typedarray(env, napi_float64_array, magnitude_bins, mag_buffer, 0, &val);
+    napi_set_named_property(env, result, "magnitude", val);
+    napi_create_typedarray(env, napi_float64_array, direction_bins, dir_buffer, 0, &val);
+    napi_set_named_property(env, result, "direction", val);
+    return result;
+}
+
+// ============================================================================
+// Packet Scan - Frame counts, GOP structure and bitrate timeline without decoding
+// ============================================================================
+
+// Timestamps past this many buckets are counted but left out of the timeline
+#define MAX_BITRATE_BUCKETS (1 << 22)
+
+typedef struct {
+    int selected;
+    AVRational tb;
+    int64_t packets;
+    int64_t bytes;
+    int64_t first_ts;
+    int64_t end_ts;           // Largest ts + duration seen
+    int64_t gop_start;        // Packet number of the current keyframe, -1 before the first one
+
+    int nb_keyframes;
+    double *key_time;         unsigned int key_time_size;
+    uint32_t *key_index;      unsigned int key_index_size;
+    int nb_gops;
+    uint32_t *gop;            unsigned int gop_size;
+    int nb_buckets;
+    uint64_t *bucket;         unsigned int bucket_size;
+} PacketStreamStats;
+
+typedef struct {
+    AnalysisJob job;
+    double interval;
+    int *requested;           // Stream indices, NULL for all
+    int nb_requested;
+
+    double start;             // Timeline origin in seconds
+    double duration;
+    unsigned int nb_streams;
+    PacketStreamStats *streams;
+    char (*codec)[32];
+    enum AVMediaType *type;
+} PacketScanJob;
+
+static int packet_scan_add(PacketScanJob *j, PacketStreamStats *s, const AVPacket *pkt) {
+    int64_t ts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+    int ret;
+
+    if (ts != AV_NOPTS_VALUE) {
+        if (s->first_ts == AV_NOPTS_VALUE) {
+            s->first_ts = ts;
+        }
+        s->end_ts = s->end_ts == AV_NOPTS_VALUE ? ts + pkt->duration : FFMAX(s->end_ts, ts + pkt->duration);
+    }
+
+    if (pkt->flags & AV_PKT_FLAG_KEY) {
+        if (s->gop_start >= 0) {
+            if ((ret = grow_buffer(&s->gop, &s->gop_size, (s->nb_gops + 1) * sizeof(*s->gop))) < 0) {
+                return ret;
+            }
+            s->gop[s->nb_gops++] = (uint32_t)(s->packets - s->gop_start);
+        }
+        s->gop_start = s->packets;
+
+        if ((ret = grow_buffer(&s->key_time, &s->key_time_size, (s->nb_keyframes + 1) * sizeof(double))) < 0 ||
+            (ret = grow_buffer(&s->key_index, &s->key_index_size, (s->nb_keyframes + 1) * sizeof(uint32_t))) < 0) {
+            return ret;
+        }
+        s->key_time[s->nb_keyframes] = ts != AV_NOPTS_VALUE ? ts * av_q2d(s->tb) : NAN;
+        s->key_index[s->nb_keyframes] = (uint32_t)s->packets;
+        s->nb_keyframes++;
+    }
+
+    if (ts != AV_NOPTS_VALUE) {
+        double b = floor((ts * av_q2d(s->tb) - j->start) / j->interval);
+        if (b >= 0 && b < MAX_BITRATE_BUCKETS) {
+            int bucket = (int)b;
+            if (bucket >= s->nb_buckets) {
+                if ((ret = grow_buffer(&s->bucket, &s->bucket_size, (bucket + 1) * sizeof(uint64_t))) < 0) {
+                    return ret;
+                }
+                memset(s->bucket + s->nb_buckets, 0, (bucket + 1 - s->nb_buckets) * sizeof(uint64_t));
+                s->nb_buckets = bucket + 1;
+            }
+            s->bucket[bucket] += pkt->size;
+        }
+    }
+
+    s->packets++;
+    s->bytes += pkt->size;
+    return 0;
+}
+
+static int packet_scan_run(AnalysisJob *job) {
+    PacketScanJob *j = (PacketScanJob *)job;
+    AVFormatContext *fmt_ctx = NULL;
+    AVPacket *pkt = NULL;
+
+    int ret = open_analysis_input(job->file_path, &fmt_ctx);
+    if (ret < 0) {
+        return ret;
+    }
+
+    j->nb_streams = fmt_ctx->nb_streams;
+    j->streams = av_calloc(j->nb_streams, sizeof(*j->streams));
+    j->codec = av_calloc(j->nb_streams, sizeof(*j->codec));
+    j->type = av_calloc(j->nb_streams, sizeof(*j->type));
+    pkt = av_packet_alloc();
+    if (!j->streams || !j->codec || !j->type || !pkt) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    for (int i = 0; i < j->nb_requested; i++) {
+        if (j->requested[i] < 0 || j->requested[i] >= (int)j->nb_streams) {
+            ret = AVERROR_STREAM_NOT_FOUND;
+            goto end;
+        }
+        j->streams[j->requested[i]].selected = 1;
+    }
+
+    for (unsigned int i = 0; i < j->nb_streams; i++) {
+        AVStream *st = fmt_ctx->streams[i];
+        PacketStreamStats *s = &j->streams[i];
+        if (!j->requested) {
+            s->selected = 1;
+        }
+        // Unused streams are dropped by the demuxer instead of being read and ignored
+        st->discard = s->selected ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+        s->tb = st->time_base;
+        s->first_ts = s->end_ts = AV_NOPTS_VALUE;
+        s->gop_start = -1;
+        j->type[i] = st->codecpar->codec_type;
+        snprintf(j->codec[i], sizeof(j->codec[i]), "%s", avcodec_get_name(st->codecpar->codec_id));
+    }
+
+    j->start = fmt_ctx->start_time != AV_NOPTS_VALUE ? fmt_ctx->start_time / (double)AV_TIME_BASE : 0.0;
+    j->duration = fmt_ctx->duration > 0 ? fmt_ctx->duration / (double)AV_TIME_BASE : 0.0;
+
+    while ((ret = av_read_frame(fmt_ctx, pkt)) >= 0) {
+        // Streams that appear mid-file are outside the scanned set
+        if (pkt->stream_index < (int)j->nb_streams && j->streams[pkt->stream_index].selected) {
+            ret = packet_scan_add(j, &j->streams[pkt->stream_index], pkt);
+        }
+        av_packet_unref(pkt);
+        if (ret < 0) {
+            goto end;
+        }
+    }
+    if (ret == AVERROR_EOF) {
+        ret = 0;
+    }
+
+    for (unsigned int i = 0; i < j->nb_streams; i++) {
+        PacketStreamStats *s = &j->streams[i];
+        // The last GOP runs to the end of the stream
+        if (s->gop_start >= 0) {
+            if ((ret = grow_buffer(&s->gop, &s->gop_size, (s->nb_gops + 1) * sizeof(*s->gop))) < 0) {
+                goto end;
+            }
+            s->gop[s->nb_gops++] = (uint32_t)(s->packets - s->gop_start);
+        }
+        if (s->first_ts != AV_NOPTS_VALUE) {
+            j->duration = FFMAX(j->duration, (s->end_ts - s->first_ts) * av_q2d(s->tb));
+        }
+    }
+
+end:
+    av_packet_free(&pkt);
+    avformat_close_input(&fmt_ctx);
+    return ret;
+}
+
+static napi_value packet_scan_build_result(napi_env env, AnalysisJob *job) {
+    PacketScanJob *j = (PacketScanJob *)job;
+    napi_value result, streams, val;
+    uint32_t count = 0;
+
+    napi_create_object(env, &result);
+    napi_create_double(env, j->duration, &val);
+    napi_set_named_property(env, result, "duration", val);
+    napi_create_double(env, j->interval, &val);
+    napi_set_named_property(env, result, "interval", val);
+    napi_create_array(env, &streams);
+
+    for (unsigned int i = 0; i < j->nb_streams; i++) {
+        PacketStreamStats *s = &j->streams[i];
+        if (!s->selected) {
+            continue;
+        }
+
+        napi_value stream;
+        napi_create_object(env, &stream);
+        napi_create_uint32(env, i, &val);
+        napi_set_named_property(env, stream, "index", val);
+        const char *type = av_get_media_type_string(j->type[i]);
+        napi_create_string_utf8(env, type ? type : "unknown", NAPI_AUTO_LENGTH, &val);
+        napi_set_named_property(env, stream, "type", val);
+        napi_create_string_utf8(env, j->codec[i], NAPI_AUTO_LENGTH, &val);
+        napi_set_named_property(env, stream, "codec", val);
+        napi_create_int64(env, s->packets, &val);
+        napi_set_named_property(env, stream, "frames", val);
+        napi_create_int64(env, s->bytes, &val);
+        napi_set_named_property(env, stream, "bytes", val);
+
+        double duration = s->first_ts != AV_NOPTS_VALUE ? (s->end_ts - s->first_ts) * av_q2d(s->tb) : 0.0;
+        napi_create_double(env, duration, &val);
+        napi_set_named_property(env, stream, "duration", val);
+        napi_create_double(env, duration > 0 ? s->bytes * 8 / duration : 0.0, &val);
+        napi_set_named_property(env, stream, "bitrate", val);
+
+        napi_set_named_property(env, stream, "keyframeTimes",
+            create_typed_copy(env, napi_float64_array, s->key_time, s->nb_keyframes, sizeof(double)));
+        napi_set_named_property(env, stream, "keyframeIndices",
+            create_typed_copy(env, napi_uint32_array, s->key_index, s->nb_keyframes, sizeof(uint32_t)));
+        napi_set_named_property(env, stream, "gopSizes",
+            create_typed_copy(env, napi_uint32_array, s->gop, s->nb_gops, sizeof(uint32_t)));
+
+        napi_value timeline;
+        void *data;
+        napi_create_arraybuffer(env, s->nb_buckets * sizeof(double), &data, &timeline);
+        double *bps = data;
+        for (int b = 0; b < s->nb_buckets; b++) {
+            bps[b] = s->bucket[b] * 8 / j->interval;
+        }
+        napi_create_typedarray(env, napi_float64_array, s->nb_buckets, timeline, 0, &val);
+        napi_set_named_property(env, stream, "bitrateTimeline", val);
+
+        napi_set_element(env, streams, count++, stream);
+    }
+
+    napi_set_named_property(env, result, "streams", streams);
+    return result;
+}
+
+static void packet_scan_uninit(AnalysisJob *job) {
+    PacketScanJob *j = (PacketScanJob *)job;
+
+    for (unsigned int i = 0; j->streams && i < j->nb_streams; i++) {
+        av_freep(&j->streams[i].key_time);
+        av_freep(&j->streams[i].key_index);
+        av_freep(&j->streams[i].gop);
+        av_freep(&j->streams[i].bucket);
+    }
+    av_freep(&j->streams);
+    av_freep(&j->codec);
+    av_freep(&j->type);
+    av_freep(&j->requested);
+}
+
+/**
+ * Scan all packets of a file without decoding
+ * @param filePath - Input file path
+ * @param options - { streams (all), interval (1 s bitrate timeline bucket) }
+ * @returns Promise resolving to { duration, interval, streams: [{ index, type, codec, frames, bytes,
+ *          duration, bitrate, keyframeTimes, keyframeIndices, gopSizes, bitrateTimeline }] }
+ * @description Unselected streams are discarded in the demuxer. GOP sizes count packets from one
+ *              keyframe to the next; timeline buckets start at the container start time
+ */
+napi_value analyze_packets(napi_env env, napi_callback_info info) {
+    char file_path[1024];
+    napi_value options;
+
+    if (get_analysis_args(env, info, file_path, sizeof(file_path), &options) < 0) {
+        return NULL;
+    }
+
+    PacketScanJob *j = av_mallocz(sizeof(*j));
+    if (!j) {
+        napi_throw_error(env, NULL, "Failed to allocate analysis job");
+        return NULL;
+    }
+    snprintf(j->job.file_path, sizeof(j->job.file_path), "%s", file_path);
+    j->job.run = packet_scan_run;
+    j->job.build_result = packet_scan_build_result;
+    j->job.uninit = packet_scan_uninit;
+    j->interval = 1.0;
+
+    if (options) {
+        get_double_option(env, options, "interval", &j->interval);
+
+        bool has = false, is_array = false;
+        napi_value streams;
+        napi_has_named_property(env, options, "streams", &has);
+        if (has) {
+            napi_get_named_property(env, options, "streams", &streams);
+            napi_is_array(env, streams, &is_array);
+        }
+        if (is_array) {
+            uint32_t length;
+            napi_get_array_length(env, streams, &length);
+            j->requested = av_malloc_array(FFMAX(length, 1), sizeof(*j->requested));
+            if (!j->requested) {
+                av_free(j);
+                napi_throw_error(env, NULL, "Failed to allocate analysis job");
+                return NULL;
+            }
+            for (uint32_t i = 0; i < length; i++) {
+                napi_value item;
+                napi_get_element(env, streams, i, &item);
+                if (napi_get_value_int32(env, item, &j->requested[i]) != napi_ok) {
+                    j->requested[i] = -1;
+                }
+            }
+            j->nb_requested = (int)length;
+        }
+    }
+    if (!(j->interval > 0)) {
+        packet_scan_uninit(&j->job);
+        av_free(j);
+        napi_throw_error(env, NULL, "interval must be positive");
+        return NULL;
+    }
+
+    return queue_analysis_job(env, &j->job, options, "ffmpeg7:analyzePackets");
+}
+
+// ============================================================================
+// Attached Pictures - Cover art straight from the demuxer, optionally thumbnailed
+// ============================================================================
+
+typedef struct {
+    AnalysisJob job;
+    int transcode;            // Decode, scale and re-encode instead of returning the stored bytes
+    int width, height;        // Requested size; 0 keeps the aspect ratio of the other dimension
+    enum AVCodecID out_codec;
+    int quality;              // JPEG qscale, 2 (best) - 31
+
+    AVPacket *picture;        // Result; NULL when the file has no attached picture
+    int stream_index;
+    char codec[32];
+    int out_width, out_height;
+} AttachedPictureJob;
+
+static int decode_attached_picture(const AVStream *st, const AVPacket *pkt, MemoryBudget *budget,
+                                   AVFrame *frame) {
+    const AVCodec *codec = avcodec_find_decoder(st->codecpar->codec_id);
+    if (!codec) {
+        return AVERROR_DECODER_NOT_FOUND;
+    }
+    AVCodecContext *dec = avcodec_alloc_context3(codec);
+    if (!dec) {
+        return AVERROR(ENOMEM);
+    }
+
+    memory_budget_attach_decoder(dec, budget);
+
+    int ret = avcodec_parameters_to_context(dec, st->codecpar);
+    if (ret >= 0) {
+        ret = avcodec_open2(dec, codec, NULL);
+    }
+    if (ret >= 0) {
+        ret = avcodec_send_packet(dec, pkt);
+    }
+    if (ret >= 0) {
+        avcodec_send_packet(dec, NULL);
+        ret = avcodec_receive_frame(dec, frame);
+    }
+    avcodec_free_context(&dec);
+    return ret;
+}
+
+// Scale the decoded picture and encode it as a single JPEG or PNG image into out
+static int encode_thumbnail(AttachedPictureJob *j, const AVFrame *src, AVPacket *out) {
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(src->format);
+    int has_alpha = desc && (desc->flags & AV_PIX_FMT_FLAG_ALPHA);
+    enum AVPixelFormat pix_fmt = j->out_codec == AV_CODEC_ID_PNG ?
+                                 (has_alpha ? AV_PIX_FMT_RGBA : AV_PIX_FMT_RGB24) : AV_PIX_FMT_YUVJ420P;
+    int w = j->width, h = j->height;
+
+    if (!w && !h) {
+        w = src->width;
+        h = src->height;
+    } else if (!w) {
+        w = (int)av_rescale(h, src->width, src->height);
+    } else if (!h) {
+        h = (int)av_rescale(w, src->height, src->width);
+    }
+    if (pix_fmt == AV_PIX_FMT_YUVJ420P) {
+        w = FFMAX(2, w & ~1);
+        h = FFMAX(2, h & ~1);
+    }
+    w = FFMAX(1, w);
+    h = FFMAX(1, h);
+
+    const AVCodec *codec = avcodec_find_encoder(j->out_codec);
+    if (!codec) {
+        return AVERROR_ENCODER_NOT_FOUND;
+    }
+
+    AVCodecContext *enc = avcodec_alloc_context3(codec);
+    AVFrame *dst = av_frame_alloc();
+    struct SwsContext *sws = NULL;
+    int ret = 0;
+    if (!enc || !dst) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    if (src->width == w && src->height == h && src->format == pix_fmt) {
+        // Already what the encoder takes: encode the decoded picture itself
+        if ((ret = av_frame_ref(dst, src)) < 0) {
+            goto end;
+        }
+    } else {
+        dst->format = pix_fmt;
+        dst->width = w;
+        dst->height = h;
+        if ((ret = av_frame_get_buffer(dst, 0)) < 0) {
+            goto end;
+        }
+        sws = sws_getContext(src->width, src->height, src->format, w, h, pix_fmt, SWS_BICUBIC, NULL, NULL, NULL);
+        if (!sws) {
+            ret = AVERROR(EINVAL);
+            goto end;
+        }
+        if ((ret = sws_scale(sws, (const uint8_t * const *)src->data, src->linesize, 0, src->height,
+                             dst->data, dst->linesize)) < 0) {
+            goto end;
+        }
+    }
+
+    enc->width = w;
+    enc->height = h;
+    enc->pix_fmt = pix_fmt;
+    enc->time_base = (AVRational){ 1, 1 };
+    if (j->out_codec == AV_CODEC_ID_MJPEG) {
+        enc->color_range = AVCOL_RANGE_JPEG;
+        enc->flags |= AV_CODEC_FLAG_QSCALE;
+        enc->global_quality = FF_QP2LAMBDA * j->quality;
+        dst->quality = enc->global_quality;
+    }
+    if ((ret = avcodec_open2(enc, codec, NULL)) < 0) {
+        goto end;
+    }
+
+    dst->pts = 0;
+    if ((ret = avcodec_send_frame(enc, dst)) >= 0 &&
+        (ret = avcodec_send_frame(enc, NULL)) >= 0) {
+        ret = avcodec_receive_packet(enc, out);
+    }
+    j->out_width = w;
+    j->out_height = h;
+
+end:
+    sws_freeContext(sws);
+    av_frame_free(&dst);
+    avcodec_free_context(&enc);
+    return ret;
+}
+
+static int attached_picture_run(AnalysisJob *job) {
+    AttachedPictureJob *j = (AttachedPictureJob *)job;
+    AVFormatContext *fmt_ctx = NULL;
+    AVFrame *frame = NULL;
+
+    // Demuxers load attached pictures while reading the header; no stream probing is needed
+    int ret = avformat_open_input(&fmt_ctx, job->file_path, NULL, NULL);
+    if (ret < 0) {
+        return ret;
+    }
+
+    const AVStream *st = NULL;
+    for (unsigned int i = 0; i < fmt_ctx->nb_streams; i++) {
+        if ((fmt_ctx->streams[i]->disposition & AV_DISPOSITION_ATTACHED_PIC) &&
+            fmt_ctx->streams[i]->attached_pic.size > 0) {
+            st = fmt_ctx->streams[i];
+            break;
+        }
+    }
+    if (!st) {
+        goto end;
+    }
+
+    j->stream_index = st->index;
+    j->out_width = st->codecpar->width;
+    j->out_height = st->codecpar->height;
+    j->picture = av_packet_alloc();
+    if (!j->picture) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    if (!j->transcode) {
+        // A new reference, not a copy: the bytes outlive the demuxer
+        snprintf(j->codec, sizeof(j->codec), "%s", avcodec_get_name(st->codecpar->codec_id));
+        ret = av_packet_ref(j->picture, &st->attached_pic);
+        goto end;
+    }
+
+    frame = av_frame_alloc();
+    if (!frame) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    if ((ret = decode_attached_picture(st, &st->attached_pic, j->job.budget, frame)) < 0 ||
+        (ret = encode_thumbnail(j, frame, j->picture)) < 0) {
+        goto end;
+    }
+    snprintf(j->codec, sizeof(j->codec), "%s", avcodec_get_name(j->out_codec));
+
+end:
+    if (ret < 0) {
+        av_packet_free(&j->picture);
+    }
+    av_frame_free(&frame);
+    avformat_close_input(&fmt_ctx);
+    return ret;
+}
+
+static void attached_picture_buffer_finalize(napi_env env, void *data, void *hint) {
+    AVBufferRef *ref = hint;
+    (void)env;
+    (void)data;
+    av_buffer_unref(&ref);
+}
+
+static napi_value attached_picture_build_result(napi_env env, AnalysisJob *job) {
+    AttachedPictureJob *j = (AttachedPictureJob *)job;
+    napi_value result, data, val;
+
+    if (!j->picture) {
+        napi_get_null(env, &result);
+        return result;
+    }
+
+    AVPacket *pkt = j->picture;
+    AVBufferRef *ref = pkt->buf ? av_buffer_ref(pkt->buf) : NULL;
+    if (!ref || napi_create_external_buffer(env, pkt->size, pkt->data, attached_picture_buffer_finalize,
+                                            ref, &data) != napi_ok) {
+        // Runtimes that forbid external buffers get a copy
+        av_buffer_unref(&ref);
+        void *copy;
+        if (napi_create_buffer_copy(env, pkt->size, pkt->data, &copy, &data) != napi_ok) {
+            return NULL;
+        }
+    }
+
+    napi_create_object(env, &result);
+    napi_set_named_property(env, result, "data", data);
+    napi_create_string_utf8(env, j->codec, NAPI_AUTO_LENGTH, &val);
+    napi_set_named_property(env, result, "codec", val);
+    napi_create_int32(env, j->out_width, &val);
+    napi_set_named_property(env, result, "width", val);
+    napi_create_int32(env, j->out_height, &val);
+    napi_set_named_property(env, result, "height", val);
+    napi_create_int32(env, j->stream_index, &val);
+    napi_set_named_property(env, result, "streamIndex", val);
+    return result;
+}
+
+static void attached_picture_uninit(AnalysisJob *job) {
+    AttachedPictureJob *j = (AttachedPictureJob *)job;
+    av_packet_free(&j->picture);
+}
+
+/**
+ * Get the embedded cover art of a file
+ * @param filePath - Input file path
+ * @param options - { width, height, format ('jpeg' | 'png'), quality (JPEG qscale 2-31, default 3) };
+ *                  any of them decodes, scales and re-encodes the picture
+ * @returns Promise resolving to { data: Buffer, codec, width, height, streamIndex } or null
+ * @description Without options no decoder is opened and data references the demuxed packet
+ *              directly; width and height are 0 when the container does not store them
+ */
+napi_value get_attached_picture(napi_env env, napi_callback_info info) {
+    char file_path[1024];
+    napi_value options;
+
+    if (get_analysis_args(env, info, file_path, sizeof(file_path), &options) < 0) {
+        return NULL;
+    }
+
+    int32_t width = 0, height = 0, quality = 3;
+    enum AVCodecID out_codec = AV_CODEC_ID_MJPEG;
+    int transcode = 0;
+    if (options) {
+        int has_width = get_int_option(env, options, "width", &width);
+        int has_height = has_width < 0 ? -1 : get_int_option(env, options, "height", &height);
+        int has_quality = has_height < 0 ? -1 : get_int_option(env, options, "quality", &quality);
+        if (has_quality < 0) {
+            return NULL;
+        }
+        transcode = has_width || has_height || has_quality;
+
+        bool has = false;
+        napi_has_named_property(env, options, "format", &has);
+        if (has) {
+            char format[16];
+            size_t len;
+            napi_value val;
+            napi_get_named_property(env, options, "format", &val);
+            if (napi_get_value_string_utf8(env, val, format, sizeof(format), &len) != napi_ok ||
+                (strcmp(format, "jpeg") && strcmp(format, "png"))) {
+                napi_throw_error(env, NULL, "format must be 'jpeg' or 'png'");
+                return NULL;
+            }
+            out_codec = strcmp(format, "png") ? AV_CODEC_ID_MJPEG : AV_CODEC_ID_PNG;
+            transcode = 1;
+        }
+    }
+    if (width < 0 || height < 0 || width > 16384 || height > 16384 || quality < 2 || quality > 31) {
+        napi_throw_error(env, NULL, "Invalid thumbnail options");
+        return NULL;
+    }
+
+    AttachedPictureJob *j = av_mallocz(sizeof(*j));
+    if (!j) {
+        napi_throw_error(env, NULL, "Failed to allocate analysis job");
+        return NULL;
+    }
+    snprintf(j->job.file_path, sizeof(j->job.file_path), "%s", file_path);
+    j->job.run = attached_picture_run;
+    j->job.build_result = attached_picture_build_result;
+    j->job.uninit = attached_picture_uninit;
+    j->transcode = transcode;
+    j->width = width;
+    j->height = height;
+    j->out_codec = out_codec;
+    j->quality = quality;
+
+    return queue_analysis_job(env, &j->job, options, "ffmpeg7:getAttachedPicture");
+}
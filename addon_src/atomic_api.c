@@ -5,33 +5,108 @@
  */
 
 #include <node_api.h>
+#include <math.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "libavformat/avformat.h"
 #include "libavcodec/avcodec.h"
+#include "libavutil/bprint.h"
 #include "libavutil/opt.h"
 #include "libavutil/dict.h"
+#include "libavutil/intreadwrite.h"
 #include "libavutil/pixdesc.h"
+#include "libavutil/thread.h"
+#include "libavutil/time.h"
 #include "libswscale/swscale.h"
 #include "libswresample/swresample.h"
 
+#include "atomic_api.h"
+#include "decoder_arena.h"
+#include "frame_pool.h"
+#include "latency.h"
+
 // ============================================================================
 // Context Management - Manages FFmpeg context objects using handle mapping table
 // ============================================================================
 
 #define MAX_CONTEXTS 8192
 
+// Per-packet encoder statistics, kept as parallel arrays so they can be copied out in bulk
+typedef struct {
+    int capacity;
+    int head;              // Next slot to write
+    int count;             // Records not yet read
+    int64_t dropped;       // Records overwritten before they were read
+    double *pts;
+    double *dts;
+    int32_t *size;
+    uint8_t *flags;
+    uint8_t *pict_type;
+    float *qp;
+    double *error;         // 4 per record (AV_PKT_DATA_QUALITY_STATS error sums, 0 if absent)
+} PacketStatsRing;
+
+// Managed scaler: the destination is fixed at creation, and one context per source geometry is
+// kept so streams that switch between renditions reuse them instead of rebuilding
+#define SCALER_CACHE_SIZE 4
+
+typedef struct {
+    struct SwsContext *ctx;
+    int width;
+    int height;
+    enum AVPixelFormat format;
+    int64_t last_used;
+} ScalerCacheEntry;
+
+typedef struct {
+    int dst_width;
+    int dst_height;
+    enum AVPixelFormat dst_format;
+    int flags;
+    int64_t frames;
+    ScalerCacheEntry cache[SCALER_CACHE_SIZE];
+} ScalerState;
+
+// Latency histograms kept per handle
 typedef enum {
-    CTX_TYPE_INPUT_FORMAT,
-    CTX_TYPE_OUTPUT_FORMAT,
-    CTX_TYPE_ENCODER,
-    CTX_TYPE_DECODER,
-    CTX_TYPE_FRAME,
-    CTX_TYPE_PACKET,
-    CTX_TYPE_SWS,
-    CTX_TYPE_SWR
-} ContextType;
+    LATENCY_ENCODE,        // Encoder: sendFrame -> receivePacket of the same frame
+    LATENCY_END_TO_END,    // Output: sendFrame -> writePacket of the same frame
+    // Per-call durations, recorded while setLatencyTracking(true) is on
+    LATENCY_SEND_PACKET,   // Decoder: avcodec_send_packet
+    LATENCY_RECEIVE_FRAME, // Decoder: avcodec_receive_frame (successful calls)
+    LATENCY_SEND_FRAME,    // Encoder: avcodec_send_frame
+    LATENCY_RECEIVE_PACKET,// Encoder: avcodec_receive_packet (successful calls)
+    LATENCY_SCALE,         // Sws: sws_scale
+    LATENCY_CONVERT,       // Swr: swr_convert_frame / swr_convert
+    LATENCY_WRITE,         // Output: av_interleaved_write_frame / av_write_frame
+    LATENCY_NB
+} LatencyMetric;
+
+static const char *const latency_metric_names[LATENCY_NB] = {
+    "encode", "endToEnd", "sendPacket", "receiveFrame", "sendFrame", "receivePacket",
+    "scale", "convert", "write"
+};
+
+// Global switch for per-call timing. Timed calls also run on the thread pool (codecTransfer)
+// while JS reads the histograms, so histograms are shared (lock-free) ones allocated on the JS
+// thread and published with a release store; they are only freed once no transfer holds the handle
+static atomic_int call_latency_enabled = 0;
+
+// Metrics timed per call on each handle kind, allocated up front while tracking is on
+static const struct {
+    ContextType type;
+    LatencyMetric metric;
+} call_latency_metrics[] = {
+    { CTX_TYPE_DECODER,       LATENCY_SEND_PACKET },
+    { CTX_TYPE_DECODER,       LATENCY_RECEIVE_FRAME },
+    { CTX_TYPE_ENCODER,       LATENCY_SEND_FRAME },
+    { CTX_TYPE_ENCODER,       LATENCY_RECEIVE_PACKET },
+    { CTX_TYPE_SWS,           LATENCY_SCALE },
+    { CTX_TYPE_SWR,           LATENCY_CONVERT },
+    { CTX_TYPE_OUTPUT_FORMAT, LATENCY_WRITE },
+};
 
 typedef struct {
     int id;
@@ -40,6 +115,26 @@ typedef struct {
     int in_use;
     AVDictionary *options; // For encoder/decoder options
     int64_t frame_counter; // Frame counter for encoders
+    int preserve_pts;      // Encoder keeps caller-provided frame pts instead of frame_counter
+    PacketStatsRing *packet_stats; // Encoder only, enabled by the "packet_stats" option
+    int low_latency;       // Encoder/output "low_latency" profile
+    int saved_fmt_flags;   // Output: AVFMT_FLAG_FLUSH_PACKETS before low_latency, restored by "0"
+    int saved_flush_packets; // Output: flush_packets before low_latency
+    int saved_max_delay;   // Output: max_delay before low_latency
+    SharedLatencyHistogram *_Atomic latency[LATENCY_NB];
+    AVCodecContext *standby; // Encoder: opened replacement from reconfigureEncoder, swapped in at the next frame
+    int draining;          // Encoder: flushing the current codec before switching to standby
+    AVFrame *pending_frame; // Encoder: frame that started the switch, sent to standby once it takes over
+    int flush_after_switch; // Encoder: sendFrame(null) arrived while draining; flush standby after the switch
+    int switched;          // Encoder: 1 right after a switch (next packet carries new extradata), 2 after; dts kept monotonic
+    int64_t last_dts;      // Encoder: dts of the last packet returned
+    int64_t reorder_delay; // Encoder: largest pts - dts of a first packet so far (AV_NOPTS_VALUE before the first)
+    int64_t dts_bias;      // Encoder: added to the current codec's dts after a switch (never positive)
+    int64_t pts_shift;     // Encoder: added to pts and dts; grows only when a replacement reorders deeper
+    ScalerState *scaler;   // Sws: owns every cached context, ptr is the one used last
+    struct SwsContext *convert_sws; // Encoder: prepareFrameForEncoder conversion
+    int convert_frame_id;  // Encoder: frame handle holding converted frames (0 until needed)
+    int transfer_busy;     // Encoder/decoder, frame, packet: in use by a codecTransfer on the thread pool
 } ContextEntry;
 
 static ContextEntry context_table[MAX_CONTEXTS] = {0};
@@ -67,6 +162,32 @@ static void cleanup_encoder_mappings(int encoder_ctx_id) {
     }
 }
 
+// Allocate a handle's histogram for a metric (JS thread only)
+static int enable_latency_metric(ContextEntry *entry, LatencyMetric metric) {
+    if (atomic_load_explicit(&entry->latency[metric], memory_order_relaxed)) {
+        return 0;
+    }
+    SharedLatencyHistogram *hist = shared_latency_histogram_alloc();
+    if (!hist) {
+        return AVERROR(ENOMEM);
+    }
+    atomic_store_explicit(&entry->latency[metric], hist, memory_order_release);
+    return 0;
+}
+
+// Allocate the per-call histograms of a handle's kind (JS thread only)
+static int enable_call_latency(ContextEntry *entry) {
+    for (size_t i = 0; i < FF_ARRAY_ELEMS(call_latency_metrics); i++) {
+        if (call_latency_metrics[i].type == entry->type) {
+            int ret = enable_latency_metric(entry, call_latency_metrics[i].metric);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+    }
+    return 0;
+}
+
 // Allocate context ID
 static int alloc_context_id(ContextType type, void *ptr) {
     for (int i = 0; i < MAX_CONTEXTS; i++) {
@@ -76,13 +197,116 @@ static int alloc_context_id(ContextType type, void *ptr) {
             context_table[i].ptr = ptr;
             context_table[i].in_use = 1;
             context_table[i].options = NULL;
+            context_table[i].frame_counter = 0;
+            context_table[i].preserve_pts = 0;
+            context_table[i].packet_stats = NULL;
+            context_table[i].low_latency = 0;
+            context_table[i].saved_fmt_flags = 0;
+            context_table[i].saved_flush_packets = 0;
+            context_table[i].saved_max_delay = 0;
+            for (int m = 0; m < LATENCY_NB; m++) {
+                atomic_init(&context_table[i].latency[m], NULL);
+            }
+            context_table[i].standby = NULL;
+            context_table[i].draining = 0;
+            context_table[i].pending_frame = NULL;
+            context_table[i].flush_after_switch = 0;
+            context_table[i].switched = 0;
+            context_table[i].last_dts = AV_NOPTS_VALUE;
+            context_table[i].reorder_delay = AV_NOPTS_VALUE;
+            context_table[i].dts_bias = 0;
+            context_table[i].pts_shift = 0;
+            context_table[i].scaler = NULL;
+            context_table[i].convert_sws = NULL;
+            context_table[i].convert_frame_id = 0;
+            context_table[i].transfer_busy = 0;
+            // Histograms are never allocated on the thread pool; without them calls go untimed
+            if (atomic_load(&call_latency_enabled)) {
+                enable_call_latency(&context_table[i]);
+            }
             return context_table[i].id;
         }
     }
     return -1;
 }
 
-// Get context pointer (exported for audio_fifo.c)
+static void scaler_state_free(ScalerState **scaler) {
+    if (*scaler) {
+        for (int i = 0; i < SCALER_CACHE_SIZE; i++) {
+            sws_freeContext((*scaler)->cache[i].ctx);
+        }
+        av_freep(scaler);
+    }
+}
+
+static void packet_stats_free(PacketStatsRing **ring) {
+    if (*ring) {
+        av_freep(&(*ring)->pts);
+        av_freep(&(*ring)->dts);
+        av_freep(&(*ring)->size);
+        av_freep(&(*ring)->flags);
+        av_freep(&(*ring)->pict_type);
+        av_freep(&(*ring)->qp);
+        av_freep(&(*ring)->error);
+        av_freep(ring);
+    }
+}
+
+static PacketStatsRing *packet_stats_alloc(int capacity) {
+    PacketStatsRing *ring = av_mallocz(sizeof(*ring));
+    if (!ring) {
+        return NULL;
+    }
+    ring->capacity = capacity;
+    ring->pts = av_malloc_array(capacity, sizeof(*ring->pts));
+    ring->dts = av_malloc_array(capacity, sizeof(*ring->dts));
+    ring->size = av_malloc_array(capacity, sizeof(*ring->size));
+    ring->flags = av_malloc_array(capacity, sizeof(*ring->flags));
+    ring->pict_type = av_malloc_array(capacity, sizeof(*ring->pict_type));
+    ring->qp = av_malloc_array(capacity, sizeof(*ring->qp));
+    ring->error = av_malloc_array(capacity, 4 * sizeof(*ring->error));
+    if (!ring->pts || !ring->dts || !ring->size || !ring->flags || !ring->pict_type || !ring->qp || !ring->error) {
+        packet_stats_free(&ring);
+    }
+    return ring;
+}
+
+// Append one encoded packet; the oldest record is overwritten when the ring is full
+static void packet_stats_record(PacketStatsRing *ring, const AVPacket *pkt) {
+    int i = ring->head;
+    size_t sd_size = 0;
+    const uint8_t *sd = av_packet_get_side_data(pkt, AV_PKT_DATA_QUALITY_STATS, &sd_size);
+
+    ring->pts[i] = pkt->pts == AV_NOPTS_VALUE ? NAN : (double)pkt->pts;
+    ring->dts[i] = pkt->dts == AV_NOPTS_VALUE ? NAN : (double)pkt->dts;
+    ring->size[i] = pkt->size;
+    ring->flags[i] = (uint8_t)pkt->flags;
+    ring->pict_type[i] = (pkt->flags & AV_PKT_FLAG_KEY) ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
+    ring->qp[i] = NAN;
+    memset(&ring->error[i * 4], 0, 4 * sizeof(*ring->error));
+
+    // Layout: u32le quality (lambda), u8 pict_type, u8 error count, u16 reserved, u64le error[count]
+    if (sd && sd_size >= 6) {
+        ring->qp[i] = (float)AV_RL32(sd) / FF_QP2LAMBDA;
+        ring->pict_type[i] = sd[4];
+        // Error values start after the reserved field, so a 6-7 byte payload carries none
+        if (sd_size >= 8) {
+            int nb_errors = FFMIN(FFMIN(sd[5], 4), (int)((sd_size - 8) / 8));
+            for (int k = 0; k < nb_errors; k++) {
+                ring->error[i * 4 + k] = (double)AV_RL64(sd + 8 + 8 * k);
+            }
+        }
+    }
+
+    ring->head = (ring->head + 1) % ring->capacity;
+    if (ring->count == ring->capacity) {
+        ring->dropped++;
+    } else {
+        ring->count++;
+    }
+}
+
+// Get context pointer (exported via atomic_api.h)
 void* get_context_ptr(int id, ContextType expected_type) {
     for (int i = 0; i < MAX_CONTEXTS; i++) {
         if (context_table[i].in_use && 
@@ -104,12 +328,103 @@ static ContextEntry* get_context_entry(int id) {
     return NULL;
 }
 
+
+// Frames sent to a latency-tracked encoder carry their send time in opaque (offset by one so 0 means unset)
+static void stamp_frame_time(AVFrame *frame) {
+    frame->opaque = (void *)(intptr_t)(av_gettime_relative() + 1);
+}
+
+static SharedLatencyHistogram *get_latency_metric(ContextEntry *entry, LatencyMetric metric) {
+    return atomic_load_explicit(&entry->latency[metric], memory_order_acquire);
+}
+
+static int has_latency_metric(ContextEntry *entry, LatencyMetric metric) {
+    return get_latency_metric(entry, metric) != NULL;
+}
+
+// Add a sample if the handle tracks the metric (any thread, lock-free)
+static void record_latency(ContextEntry *entry, LatencyMetric metric, int64_t us) {
+    SharedLatencyHistogram *hist = get_latency_metric(entry, metric);
+    if (hist) {
+        shared_latency_histogram_record(hist, us);
+    }
+}
+
+static void record_packet_latency(ContextEntry *entry, LatencyMetric metric, const AVPacket *pkt) {
+    if (pkt->opaque) {
+        record_latency(entry, metric, av_gettime_relative() + 1 - (intptr_t)pkt->opaque);
+    }
+}
+
+// Start time of a timed call, or 0 when per-call tracking is off
+static int64_t call_latency_start(void) {
+    return atomic_load(&call_latency_enabled) ? av_gettime_relative() : 0;
+}
+
+static void call_latency_end(ContextEntry *entry, LatencyMetric metric, int64_t start) {
+    if (start && entry) {
+        record_latency(entry, metric, av_gettime_relative() - start);
+    }
+}
+
+// Encoder private options of the low-latency profile; the first match by codec name wins
+static const struct {
+    const char *codec;
+    const char *key;
+    const char *value;
+} low_latency_encoder_options[] = {
+    { "libx264",    "tune",          "zerolatency" },
+    { "libx265",    "tune",          "zerolatency" },
+    { "libvpx",     "deadline",      "realtime" },
+    { "libvpx",     "lag-in-frames", "0" },
+    { "libvpx-vp9", "deadline",      "realtime" },
+    { "libvpx-vp9", "lag-in-frames", "0" },
+    { "libaom-av1", "usage",         "realtime" },
+    { "libaom-av1", "lag-in-frames", "0" },
+    { "h264_nvenc", "zerolatency",   "1" },
+    { "h264_nvenc", "delay",         "0" },
+    { "hevc_nvenc", "zerolatency",   "1" },
+    { "hevc_nvenc", "delay",         "0" },
+};
+
+/**
+ * Apply the low-latency encoder profile: no B-frames, slice threading instead of frame threading
+ * (which delays output by one frame per thread) and the codec's zero-latency tuning. Options the
+ * caller already set are kept.
+ */
+static int apply_low_latency_encoder(ContextEntry *entry, AVCodecContext *codec_ctx) {
+    codec_ctx->max_b_frames = 0;
+    codec_ctx->thread_type = FF_THREAD_SLICE;
+    codec_ctx->flags |= AV_CODEC_FLAG_LOW_DELAY;
+
+    for (size_t i = 0; i < FF_ARRAY_ELEMS(low_latency_encoder_options); i++) {
+        if (!strcmp(codec_ctx->codec->name, low_latency_encoder_options[i].codec)) {
+            int ret = av_dict_set(&entry->options, low_latency_encoder_options[i].key,
+                                  low_latency_encoder_options[i].value, AV_DICT_DONT_OVERWRITE);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+    }
+
+    entry->low_latency = 1;
+    return enable_latency_metric(entry, LATENCY_ENCODE);
+}
+
 // Free context ID
 static void free_context_id(int id) {
     for (int i = 0; i < MAX_CONTEXTS; i++) {
         if (context_table[i].in_use && context_table[i].id == id) {
             context_table[i].in_use = 0;
             context_table[i].ptr = NULL;
+            packet_stats_free(&context_table[i].packet_stats);
+            // Closing is refused while a transfer runs, so nothing can be recording here
+            for (int m = 0; m < LATENCY_NB; m++) {
+                SharedLatencyHistogram *hist = atomic_exchange(&context_table[i].latency[m], NULL);
+                shared_latency_histogram_free(&hist);
+            }
+            avcodec_free_context(&context_table[i].standby);
+            av_frame_free(&context_table[i].pending_frame);
             if (context_table[i].options) {
                 av_dict_free(&context_table[i].options);
                 context_table[i].options = NULL;
@@ -119,6 +434,8 @@ static void free_context_id(int id) {
     }
 }
 
+static int parse_channel_layout(napi_env env, napi_value value, AVChannelLayout *layout);
+
 // ============================================================================
 // 1. Input/Output Management
 // ============================================================================
@@ -301,6 +618,15 @@ napi_value atomic_get_input_streams(napi_env env, napi_callback_info info) {
             napi_set_named_property(env, stream_obj, "codec", codec_val);
         }
         
+        // Stream time base (units of packet/frame timestamps)
+        napi_value tb_obj, tb_num_val, tb_den_val;
+        napi_create_object(env, &tb_obj);
+        napi_create_int32(env, stream->time_base.num, &tb_num_val);
+        napi_create_int32(env, stream->time_base.den, &tb_den_val);
+        napi_set_named_property(env, tb_obj, "num", tb_num_val);
+        napi_set_named_property(env, tb_obj, "den", tb_den_val);
+        napi_set_named_property(env, stream_obj, "timeBase", tb_obj);
+        
         // Video stream specific properties
         if (codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
             napi_value width_val, height_val, fps_val;
@@ -360,6 +686,13 @@ napi_value atomic_get_input_streams(napi_env env, napi_callback_info info) {
             napi_create_int32(env, codecpar->ch_layout.nb_channels, &channels_val);
             napi_set_named_property(env, stream_obj, "sampleRate", sample_rate_val);
             napi_set_named_property(env, stream_obj, "channels", channels_val);
+            
+            char layout_str[128];
+            if (av_channel_layout_describe(&codecpar->ch_layout, layout_str, sizeof(layout_str)) > 0) {
+                napi_value layout_val;
+                napi_create_string_utf8(env, layout_str, NAPI_AUTO_LENGTH, &layout_val);
+                napi_set_named_property(env, stream_obj, "channelLayout", layout_val);
+            }
         }
         
         // Bit rate
@@ -462,6 +795,10 @@ napi_value atomic_close_context(napi_env env, napi_callback_info info) {
     for (int i = 0; i < MAX_CONTEXTS; i++) {
         if (context_table[i].in_use && context_table[i].id == ctx_id) {
             void *ptr = context_table[i].ptr;
+            if (context_table[i].transfer_busy) {
+                napi_throw_error(env, NULL, "Codec context is busy with an async transfer");
+                return NULL;
+            }
             ContextType type = context_table[i].type;
             
             // Release resources based on type
@@ -476,14 +813,21 @@ napi_value atomic_close_context(napi_env env, napi_callback_info info) {
                 avformat_free_context(fmt_ctx);
             } else if (type == CTX_TYPE_ENCODER || type == CTX_TYPE_DECODER) {
                 AVCodecContext *codec_ctx = (AVCodecContext *)ptr;
+                DecoderArena *arena = decoder_arena_from_codec(codec_ctx);
                 avcodec_free_context(&codec_ctx);
+                decoder_arena_close(env, arena);
                 // Clean up encoder stream mappings
                 if (type == CTX_TYPE_ENCODER) {
                     cleanup_encoder_mappings(ctx_id);
+                    sws_freeContext(context_table[i].convert_sws);
+                    AVFrame *convert_frame = get_context_ptr(context_table[i].convert_frame_id, CTX_TYPE_FRAME);
+                    if (convert_frame) {
+                        av_frame_free(&convert_frame);
+                        free_context_id(context_table[i].convert_frame_id);
+                    }
                 }
             } else if (type == CTX_TYPE_SWS) {
-                struct SwsContext *sws_ctx = (struct SwsContext *)ptr;
-                sws_freeContext(sws_ctx);
+                scaler_state_free(&context_table[i].scaler);
             } else if (type == CTX_TYPE_SWR) {
                 struct SwrContext *swr_ctx = (struct SwrContext *)ptr;
                 swr_free(&swr_ctx);
@@ -584,6 +928,9 @@ napi_value atomic_set_encoder_option(napi_env env, napi_callback_info info) {
         return NULL;
     }
     
+    if (handle_is_busy(env, ctx_id)) {
+        return NULL;
+    }
     AVCodecContext *codec_ctx = get_context_ptr(ctx_id, CTX_TYPE_ENCODER);
     ContextEntry *entry = get_context_entry(ctx_id);
     if (!codec_ctx || !entry) {
@@ -625,6 +972,23 @@ napi_value atomic_set_encoder_option(napi_env env, napi_callback_info info) {
             codec_ctx->gop_size = int_val;
         } else if (strcmp(key, "max_b_frames") == 0) {
             codec_ctx->max_b_frames = int_val;
+        } else if (strcmp(key, "preserve_pts") == 0) {
+            // Keep frame pts as produced upstream (e.g. by a frame-rate converter, VFR output)
+            entry->preserve_pts = int_val != 0;
+        } else if (strcmp(key, "packet_stats") == 0) {
+            // Ring capacity for getEncoderPacketStats; 0 disables collection
+            packet_stats_free(&entry->packet_stats);
+            if (int_val > 0) {
+                entry->packet_stats = packet_stats_alloc(int_val);
+                if (!entry->packet_stats) {
+                    ret = AVERROR(ENOMEM);
+                }
+            }
+        } else if (strcmp(key, "low_latency") == 0) {
+            // Realtime profile plus send -> receive latency tracking (getLatencyStats)
+            if (int_val) {
+                ret = apply_low_latency_encoder(entry, codec_ctx);
+            }
         } else {
             // Store in options dictionary for later use in avcodec_open2
             char val_str[32];
@@ -695,6 +1059,9 @@ napi_value atomic_open_encoder(napi_env env, napi_callback_info info) {
         return NULL;
     }
     
+    if (handle_is_busy(env, ctx_id)) {
+        return NULL;
+    }
     AVCodecContext *codec_ctx = get_context_ptr(ctx_id, CTX_TYPE_ENCODER);
     ContextEntry *entry = get_context_entry(ctx_id);
     if (!codec_ctx || !entry) {
@@ -708,6 +1075,14 @@ napi_value atomic_open_encoder(napi_env env, napi_callback_info info) {
         av_dict_copy(&options, entry->options, 0);
     }
     
+    // Latency tracking needs the frame send time on the packet; encoders with delay only pass opaque
+    // through if they support reordering it
+    int caps = codec_ctx->codec->capabilities;
+    if (has_latency_metric(entry, LATENCY_ENCODE) &&
+        (!(caps & AV_CODEC_CAP_DELAY) || (caps & AV_CODEC_CAP_ENCODER_REORDERED_OPAQUE))) {
+        codec_ctx->flags |= AV_CODEC_FLAG_COPY_OPAQUE;
+    }
+    
     int ret = avcodec_open2(codec_ctx, codec_ctx->codec, &options);
     
     // Check for unrecognized options
@@ -731,6 +1106,268 @@ napi_value atomic_open_encoder(napi_env env, napi_callback_info info) {
     return NULL;
 }
 
+// Parameters encoders pick up between frames without being reopened (libx264 reconfig_encoder,
+// nvenc dynamic bitrate); each only applies in the rate-control mode the encoder was opened with
+typedef enum {
+    RECONFIG_ANY,
+    RECONFIG_BITRATE,      // Opened with a target bitrate (ABR/CBR)
+    RECONFIG_QUALITY,      // Opened without a target bitrate (CRF)
+    RECONFIG_VBV,          // Opened with maxrate and bufsize (VBV cannot be turned on later)
+} ReconfigMode;
+
+static const struct {
+    const char *codec;
+    const char *key;
+    ReconfigMode mode;
+} encoder_runtime_options[] = {
+    { "libx264",    "bitrate", RECONFIG_BITRATE },
+    { "libx264",    "maxrate", RECONFIG_VBV },
+    { "libx264",    "bufsize", RECONFIG_VBV },
+    { "libx264",    "crf",     RECONFIG_QUALITY },
+    { "libx264",    "crf_max", RECONFIG_QUALITY },
+    { "h264_nvenc", "bitrate", RECONFIG_BITRATE },
+    { "h264_nvenc", "maxrate", RECONFIG_BITRATE },
+    { "h264_nvenc", "bufsize", RECONFIG_BITRATE },
+    { "hevc_nvenc", "bitrate", RECONFIG_BITRATE },
+    { "hevc_nvenc", "maxrate", RECONFIG_BITRATE },
+    { "hevc_nvenc", "bufsize", RECONFIG_BITRATE },
+    { "av1_nvenc",  "bitrate", RECONFIG_BITRATE },
+    { "av1_nvenc",  "maxrate", RECONFIG_BITRATE },
+    { "av1_nvenc",  "bufsize", RECONFIG_BITRATE },
+};
+
+static int is_runtime_option(const AVCodecContext *codec_ctx, const char *key) {
+    for (size_t i = 0; i < FF_ARRAY_ELEMS(encoder_runtime_options); i++) {
+        if (strcmp(codec_ctx->codec->name, encoder_runtime_options[i].codec) ||
+            strcmp(key, encoder_runtime_options[i].key)) {
+            continue;
+        }
+        switch (encoder_runtime_options[i].mode) {
+            case RECONFIG_BITRATE: return codec_ctx->bit_rate > 0;
+            case RECONFIG_QUALITY: return codec_ctx->bit_rate <= 0;
+            case RECONFIG_VBV:     return codec_ctx->rc_max_rate > 0 && codec_ctx->rc_buffer_size > 0;
+            default:               return 1;
+        }
+    }
+    return 0;
+}
+
+// Set a codec context field reconfigureEncoder handles directly; returns 0 if key is not one
+static int set_encoder_field(AVCodecContext *codec_ctx, const char *key, const char *value) {
+    if (strcmp(key, "bitrate") == 0) {
+        codec_ctx->bit_rate = strtoll(value, NULL, 10);
+    } else if (strcmp(key, "maxrate") == 0) {
+        codec_ctx->rc_max_rate = strtoll(value, NULL, 10);
+    } else if (strcmp(key, "bufsize") == 0) {
+        codec_ctx->rc_buffer_size = atoi(value);
+    } else if (strcmp(key, "width") == 0) {
+        codec_ctx->width = atoi(value);
+    } else if (strcmp(key, "height") == 0) {
+        codec_ctx->height = atoi(value);
+    } else if (strcmp(key, "gop_size") == 0) {
+        codec_ctx->gop_size = atoi(value);
+    } else if (strcmp(key, "max_b_frames") == 0) {
+        codec_ctx->max_b_frames = atoi(value);
+    } else if (strcmp(key, "pix_fmt") == 0) {
+        enum AVPixelFormat pix_fmt = av_get_pix_fmt(value);
+        if (pix_fmt == AV_PIX_FMT_NONE) {
+            return AVERROR(EINVAL);
+        }
+        codec_ctx->pix_fmt = pix_fmt;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+// Unopened copy of an encoder's configuration; time_base is kept so timestamps continue, color
+// metadata so the stream does not change appearance at the handover
+static AVCodecContext *clone_encoder_config(const AVCodecContext *src) {
+    AVCodecContext *dst = avcodec_alloc_context3(src->codec);
+    if (!dst) {
+        return NULL;
+    }
+    dst->width = src->width;
+    dst->height = src->height;
+    dst->pix_fmt = src->pix_fmt;
+    dst->sample_aspect_ratio = src->sample_aspect_ratio;
+    dst->color_range = src->color_range;
+    dst->color_primaries = src->color_primaries;
+    dst->color_trc = src->color_trc;
+    dst->colorspace = src->colorspace;
+    dst->chroma_sample_location = src->chroma_sample_location;
+    dst->time_base = src->time_base;
+    dst->framerate = src->framerate;
+    dst->bit_rate = src->bit_rate;
+    dst->rc_max_rate = src->rc_max_rate;
+    dst->rc_min_rate = src->rc_min_rate;
+    dst->rc_buffer_size = src->rc_buffer_size;
+    dst->gop_size = src->gop_size;
+    dst->max_b_frames = src->max_b_frames;
+    dst->global_quality = src->global_quality;
+    dst->qmin = src->qmin;
+    dst->qmax = src->qmax;
+    dst->profile = src->profile;
+    dst->level = src->level;
+    dst->thread_count = src->thread_count;
+    dst->thread_type = src->thread_type;
+    dst->flags = src->flags;
+    dst->flags2 = src->flags2;
+    dst->strict_std_compliance = src->strict_std_compliance;
+    dst->field_order = src->field_order;
+    dst->bits_per_raw_sample = src->bits_per_raw_sample;
+    dst->sample_rate = src->sample_rate;
+    dst->sample_fmt = src->sample_fmt;
+    // Hardware encoders keep drawing from the same device and frame pool
+    if ((src->hw_device_ctx && !(dst->hw_device_ctx = av_buffer_ref(src->hw_device_ctx))) ||
+        (src->hw_frames_ctx && !(dst->hw_frames_ctx = av_buffer_ref(src->hw_frames_ctx))) ||
+        av_channel_layout_copy(&dst->ch_layout, &src->ch_layout) < 0) {
+        avcodec_free_context(&dst);
+    }
+    return dst;
+}
+
+/**
+ * Reconfigure an open encoder mid-stream
+ * 
+ * Bitrate / VBV / CRF changes the encoder supports at runtime (libx264, nvenc) are applied in
+ * place and take effect with the next frame. Anything else (resolution, pixel format, GOP,
+ * private options) opens a replacement encoder right away; the next sendFrame accepts the frame,
+ * holds it and flushes the current encoder. receivePacket drains it, switches at its EOF and
+ * hands the held frame to the replacement, which continues from the same frame counter and
+ * time_base, starting with a keyframe.
+ * 
+ * @param encoderContextId - Encoder context ID
+ * @param options - { key: value } using setEncoderOption keys plus "maxrate" / "bufsize"
+ * @returns "inPlace" or "switch"
+ */
+napi_value atomic_reconfigure_encoder(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 2;
+    napi_value argv[2];
+    
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 2) {
+        napi_throw_error(env, NULL, "Expected encoder context ID and options");
+        return NULL;
+    }
+    
+    int ctx_id;
+    napi_get_value_int32(env, argv[0], &ctx_id);
+    
+    // The context must not be dereferenced while a codecTransfer may be swapping it
+    if (handle_is_busy(env, ctx_id)) {
+        return NULL;
+    }
+    AVCodecContext *codec_ctx = get_context_ptr(ctx_id, CTX_TYPE_ENCODER);
+    ContextEntry *entry = get_context_entry(ctx_id);
+    if (!codec_ctx || !entry || !avcodec_is_open(codec_ctx)) {
+        napi_throw_error(env, NULL, "Invalid or unopened encoder context");
+        return NULL;
+    }
+    if (entry->draining) {
+        napi_throw_error(env, NULL, "Encoder switch already in progress");
+        return NULL;
+    }
+    
+    // Collect the changes as strings
+    AVDictionary *changes = NULL;
+    napi_value keys;
+    uint32_t nb_keys = 0;
+    if (napi_get_property_names(env, argv[1], &keys) != napi_ok) {
+        napi_throw_type_error(env, NULL, "Options must be an object");
+        return NULL;
+    }
+    napi_get_array_length(env, keys, &nb_keys);
+    
+    int in_place = 1;
+    int ret = 0;
+    for (uint32_t i = 0; i < nb_keys && ret >= 0; i++) {
+        napi_value key_val, value;
+        char key[64], str_val[256];
+        size_t len;
+        napi_get_element(env, keys, i, &key_val);
+        napi_get_value_string_utf8(env, key_val, key, sizeof(key), &len);
+        napi_get_property(env, argv[1], key_val, &value);
+        
+        napi_valuetype valuetype;
+        napi_typeof(env, value, &valuetype);
+        if (valuetype == napi_number) {
+            double num;
+            napi_get_value_double(env, value, &num);
+            snprintf(str_val, sizeof(str_val), "%.17g", num);
+        } else if (valuetype == napi_string) {
+            napi_get_value_string_utf8(env, value, str_val, sizeof(str_val), &len);
+        } else {
+            av_dict_free(&changes);
+            char errbuf[128];
+            snprintf(errbuf, sizeof(errbuf), "Option %s must be a number or string", key);
+            napi_throw_type_error(env, NULL, errbuf);
+            return NULL;
+        }
+        
+        in_place &= is_runtime_option(codec_ctx, key);
+        ret = av_dict_set(&changes, key, str_val, 0);
+    }
+    
+    AVDictionaryEntry *e = NULL;
+    if (ret >= 0 && in_place) {
+        // The encoder compares its configuration against these before each frame
+        while (ret >= 0 && (e = av_dict_get(changes, "", e, AV_DICT_IGNORE_SUFFIX))) {
+            ret = set_encoder_field(codec_ctx, e->key, e->value);
+            if (ret == 0) {
+                ret = av_opt_set(codec_ctx->priv_data, e->key, e->value, 0);
+                // Keep later replacements in sync
+                if (ret >= 0) {
+                    ret = av_dict_set(&entry->options, e->key, e->value, 0);
+                }
+            } else if (ret > 0) {
+                ret = av_dict_set(&entry->options, e->key, NULL, 0);
+            }
+        }
+    } else if (ret >= 0) {
+        AVCodecContext *standby = clone_encoder_config(codec_ctx);
+        AVDictionary *options = NULL;
+        ret = standby ? av_dict_copy(&options, entry->options, 0) : AVERROR(ENOMEM);
+        while (ret >= 0 && (e = av_dict_get(changes, "", e, AV_DICT_IGNORE_SUFFIX))) {
+            ret = set_encoder_field(standby, e->key, e->value);
+            // Fields override any stale copy in the dictionary
+            ret = ret < 0 ? ret : av_dict_set(&options, e->key, ret ? NULL : e->value, 0);
+        }
+        
+        AVDictionary *open_options = NULL;
+        if (ret >= 0) {
+            ret = av_dict_copy(&open_options, options, 0);
+        }
+        if (ret >= 0) {
+            ret = avcodec_open2(standby, standby->codec, &open_options);
+        }
+        av_dict_free(&open_options);
+        
+        if (ret >= 0) {
+            avcodec_free_context(&entry->standby);
+            entry->standby = standby;
+            av_dict_free(&entry->options);
+            entry->options = options;
+        } else {
+            avcodec_free_context(&standby);
+            av_dict_free(&options);
+        }
+    }
+    av_dict_free(&changes);
+    
+    if (ret < 0) {
+        char errbuf[128];
+        av_strerror(ret, errbuf, sizeof(errbuf));
+        napi_throw_error(env, NULL, errbuf);
+        return NULL;
+    }
+    
+    napi_value result;
+    napi_create_string_utf8(env, in_place ? "inPlace" : "switch", NAPI_AUTO_LENGTH, &result);
+    return result;
+}
+
 // ============================================================================
 // 3. Transcoding Operations - Core transcoding functions
 // ============================================================================
@@ -782,6 +1419,35 @@ napi_value atomic_set_output_option(napi_env env, napi_callback_info info) {
         return NULL;
     }
     
+    if (strcmp(key, "low_latency") == 0) {
+        // Write packets as they come instead of through the interleaving queue, flush the IO
+        // buffer after every packet and track send -> write latency (getLatencyStats)
+        int enable = strcmp(value, "1") == 0;
+        if (!enable && strcmp(value, "0") != 0) {
+            napi_throw_error(env, NULL, "low_latency must be \"0\" or \"1\"");
+            return NULL;
+        }
+        if (enable && !entry->low_latency) {
+            if (enable_latency_metric(entry, LATENCY_END_TO_END) < 0) {
+                napi_throw_error(env, NULL, "Failed to allocate latency histogram");
+                return NULL;
+            }
+            entry->saved_fmt_flags = fmt_ctx->flags & AVFMT_FLAG_FLUSH_PACKETS;
+            entry->saved_flush_packets = fmt_ctx->flush_packets;
+            entry->saved_max_delay = fmt_ctx->max_delay;
+            fmt_ctx->flags |= AVFMT_FLAG_FLUSH_PACKETS;
+            fmt_ctx->flush_packets = 1;
+            fmt_ctx->max_delay = 0;
+        } else if (!enable && entry->low_latency) {
+            // Back to the interleaved write path with the muxer settings from before
+            fmt_ctx->flags = (fmt_ctx->flags & ~AVFMT_FLAG_FLUSH_PACKETS) | entry->saved_fmt_flags;
+            fmt_ctx->flush_packets = entry->saved_flush_packets;
+            fmt_ctx->max_delay = entry->saved_max_delay;
+        }
+        entry->low_latency = enable;
+        return NULL;
+    }
+    
     // Store option in context entry's options dictionary
     // These options will be passed to avformat_write_header
     int ret = av_dict_set(&entry->options, key, value, 0);
@@ -977,6 +1643,9 @@ napi_value atomic_copy_encoder_to_stream(napi_env env, napi_callback_info info)
     napi_get_value_int32(env, argv[1], &output_ctx_id);
     napi_get_value_int32(env, argv[2], &output_stream_idx);
     
+    if (handle_is_busy(env, encoder_ctx_id)) {
+        return NULL;
+    }
     AVCodecContext *codec_ctx = get_context_ptr(encoder_ctx_id, CTX_TYPE_ENCODER);
     AVFormatContext *output_fmt_ctx = get_context_ptr(output_ctx_id, CTX_TYPE_OUTPUT_FORMAT);
     
@@ -1132,6 +1801,9 @@ napi_value atomic_write_packet(napi_env env, napi_callback_info info) {
         napi_throw_error(env, NULL, "Invalid context or packet");
         return NULL;
     }
+    if (handle_is_busy(env, pkt_id)) {
+        return NULL;
+    }
     
     if (output_stream_idx >= (int)fmt_ctx->nb_streams) {
         napi_throw_error(env, NULL, "Invalid stream index");
@@ -1187,7 +1859,19 @@ napi_value atomic_write_packet(napi_env env, napi_callback_info info) {
         av_packet_rescale_ts(out_pkt, src_tb, out_stream->time_base);
     }
     
-    int ret = av_interleaved_write_frame(fmt_ctx, out_pkt);
+    // Low-latency outputs bypass interleaving: the caller already writes packets in order
+    ContextEntry *out_entry = get_context_entry(output_ctx_id);
+    int64_t start = call_latency_start();
+    int ret;
+    if (out_entry->low_latency) {
+        ret = av_write_frame(fmt_ctx, out_pkt);
+    } else {
+        ret = av_interleaved_write_frame(fmt_ctx, out_pkt);
+    }
+    if (ret >= 0) {
+        call_latency_end(out_entry, LATENCY_WRITE, start);
+        record_packet_latency(out_entry, LATENCY_END_TO_END, out_pkt);
+    }
     
     av_packet_free(&out_pkt);
     
@@ -1223,6 +1907,9 @@ napi_value atomic_free_packet(napi_env env, napi_callback_info info) {
         return NULL;
     }
     
+    if (handle_is_busy(env, pkt_id)) {
+        return NULL;
+    }
     AVPacket *pkt = get_context_ptr(pkt_id, CTX_TYPE_PACKET);
     if (pkt) {
         av_packet_free(&pkt);
@@ -1310,6 +1997,9 @@ napi_value atomic_copy_decoder_params(napi_env env, napi_callback_info info) {
     napi_get_value_int32(env, argv[2], &stream_idx);
     
     AVFormatContext *fmt_ctx = get_context_ptr(input_ctx_id, CTX_TYPE_INPUT_FORMAT);
+    if (handle_is_busy(env, decoder_ctx_id)) {
+        return NULL;
+    }
     AVCodecContext *codec_ctx = get_context_ptr(decoder_ctx_id, CTX_TYPE_DECODER);
     
     if (!fmt_ctx || !codec_ctx) {
@@ -1335,17 +2025,19 @@ napi_value atomic_copy_decoder_params(napi_env env, napi_callback_info info) {
 }
 
 /**
- * Open decoder
+ * Set decoder option
  * @param codecContextId - Decoder context ID
+ * @param key - Option name (e.g. "threads", "flags2", "skip_frame")
+ * @param value - Option value, applied when the decoder is opened
  */
-napi_value atomic_open_decoder(napi_env env, napi_callback_info info) {
+napi_value atomic_set_decoder_option(napi_env env, napi_callback_info info) {
     napi_status status;
-    size_t argc = 1;
-    napi_value argv[1];
+    size_t argc = 3;
+    napi_value argv[3];
     
     status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
-    if (status != napi_ok || argc < 1) {
-        napi_throw_error(env, NULL, "Expected context ID");
+    if (status != napi_ok || argc < 3) {
+        napi_throw_error(env, NULL, "Expected context ID, key, and value");
         return NULL;
     }
     
@@ -1356,13 +2048,50 @@ napi_value atomic_open_decoder(napi_env env, napi_callback_info info) {
         return NULL;
     }
     
+    char key[64];
+    size_t key_len;
+    status = napi_get_value_string_utf8(env, argv[1], key, sizeof(key), &key_len);
+    if (status != napi_ok) {
+        napi_throw_error(env, NULL, "Invalid key");
+        return NULL;
+    }
+    
+    if (handle_is_busy(env, ctx_id)) {
+        return NULL;
+    }
     AVCodecContext *codec_ctx = get_context_ptr(ctx_id, CTX_TYPE_DECODER);
-    if (!codec_ctx) {
+    ContextEntry *entry = get_context_entry(ctx_id);
+    if (!codec_ctx || !entry) {
         napi_throw_error(env, NULL, "Invalid decoder context");
         return NULL;
     }
     
-    int ret = avcodec_open2(codec_ctx, codec_ctx->codec, NULL);
+    napi_valuetype valuetype;
+    napi_typeof(env, argv[2], &valuetype);
+    
+    int ret = 0;
+    if (valuetype == napi_number) {
+        int32_t int_val;
+        napi_get_value_int32(env, argv[2], &int_val);
+        
+        if (strcmp(key, "threads") == 0) {
+            codec_ctx->thread_count = int_val;
+        } else {
+            char val_str[32];
+            snprintf(val_str, sizeof(val_str), "%d", int_val);
+            ret = av_dict_set(&entry->options, key, val_str, 0);
+        }
+    } else if (valuetype == napi_string) {
+        char str_val[256];
+        size_t str_len;
+        napi_get_value_string_utf8(env, argv[2], str_val, sizeof(str_val), &str_len);
+        // e.g. flags2=+export_mvs for motion vector side data
+        ret = av_dict_set(&entry->options, key, str_val, 0);
+    } else {
+        napi_throw_error(env, NULL, "Option value must be a number or string");
+        return NULL;
+    }
+    
     if (ret < 0) {
         char errbuf[128];
         av_strerror(ret, errbuf, sizeof(errbuf));
@@ -1373,32 +2102,298 @@ napi_value atomic_open_decoder(napi_env env, napi_callback_info info) {
     return NULL;
 }
 
-// ============================================================================
-// 5. Frame and Packet Processing
-// ============================================================================
-
 /**
- * Allocate a new frame
- * @returns frameId - Frame ID
+ * Open decoder
+ * @param codecContextId - Decoder context ID
  */
-napi_value atomic_alloc_frame(napi_env env, napi_callback_info info) {
-    AVFrame *frame = av_frame_alloc();
-    if (!frame) {
-        napi_throw_error(env, NULL, "Failed to allocate frame");
+napi_value atomic_open_decoder(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 1;
+    napi_value argv[1];
+    
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected context ID");
         return NULL;
     }
     
-    int frame_id = alloc_context_id(CTX_TYPE_FRAME, frame);
-    if (frame_id < 0) {
-        av_frame_free(&frame);
-        napi_throw_error(env, NULL, "Too many open contexts");
+    int ctx_id;
+    status = napi_get_value_int32(env, argv[0], &ctx_id);
+    if (status != napi_ok) {
+        napi_throw_error(env, NULL, "Invalid context ID");
         return NULL;
     }
     
-    napi_value result;
-    napi_create_int32(env, frame_id, &result);
-    return result;
-}
+    if (handle_is_busy(env, ctx_id)) {
+        return NULL;
+    }
+    AVCodecContext *codec_ctx = get_context_ptr(ctx_id, CTX_TYPE_DECODER);
+    ContextEntry *entry = get_context_entry(ctx_id);
+    if (!codec_ctx || !entry) {
+        napi_throw_error(env, NULL, "Invalid decoder context");
+        return NULL;
+    }
+    
+    // Open decoder with options set through setDecoderOption
+    AVDictionary *options = NULL;
+    if (entry->options) {
+        av_dict_copy(&options, entry->options, 0);
+    }
+    
+    int ret = avcodec_open2(codec_ctx, codec_ctx->codec, &options);
+    av_dict_free(&options);
+    if (ret < 0) {
+        char errbuf[128];
+        av_strerror(ret, errbuf, sizeof(errbuf));
+        napi_throw_error(env, NULL, errbuf);
+        return NULL;
+    }
+    
+    return NULL;
+}
+
+// ============================================================================
+// 5. Frame and Packet Processing
+// ============================================================================
+
+/**
+ * Allocate a new frame
+ * @returns frameId - Frame ID
+ */
+napi_value atomic_alloc_frame(napi_env env, napi_callback_info info) {
+    AVFrame *frame = av_frame_alloc();
+    if (!frame) {
+        napi_throw_error(env, NULL, "Failed to allocate frame");
+        return NULL;
+    }
+    
+    int frame_id = alloc_context_id(CTX_TYPE_FRAME, frame);
+    if (frame_id < 0) {
+        av_frame_free(&frame);
+        napi_throw_error(env, NULL, "Too many open contexts");
+        return NULL;
+    }
+    
+    napi_value result;
+    napi_create_int32(env, frame_id, &result);
+    return result;
+}
+
+// ============================================================================
+// Codec Steps - Shared by the synchronous calls below and codecTransfer, which
+// runs them on the thread pool; each returns 0 or a negative AVERROR
+// ============================================================================
+
+static int decoder_send_packet(ContextEntry *entry, AVPacket *pkt) {
+    int64_t start = call_latency_start();
+    int ret = avcodec_send_packet(entry->ptr, pkt);
+    if (ret == 0) {
+        call_latency_end(entry, LATENCY_SEND_PACKET, start);
+    }
+    return ret;
+}
+
+static int decoder_receive_frame(ContextEntry *entry, AVFrame *frame) {
+    int64_t start = call_latency_start();
+    int ret = avcodec_receive_frame(entry->ptr, frame);
+    if (ret == 0) {
+        call_latency_end(entry, LATENCY_RECEIVE_FRAME, start);
+    }
+    return ret;
+}
+
+static int encoder_send_frame(ContextEntry *entry, AVFrame *frame) {
+    AVCodecContext *codec_ctx = entry->ptr;
+
+    // Switch in progress: the replacement already holds a frame, so more frames must wait until
+    // receivePacket has drained the current encoder. A final flush is queued behind the frame
+    if (entry->draining) {
+        if (frame) {
+            return AVERROR(EAGAIN);
+        }
+        if (entry->flush_after_switch) {
+            return AVERROR_EOF;
+        }
+        entry->flush_after_switch = 1;
+        return 0;
+    }
+
+    if (frame) {
+        // 清除解码帧的类型信息，让编码器自己决定帧类型
+        frame->pict_type = AV_PICTURE_TYPE_NONE;
+
+        // 为帧设置正确的pts
+        // 使用帧计数器来生成递增的pts，确保编码器输出正确的时间戳
+        // preserve_pts: 保留上游（如帧率转换器）已按编码器时间基计算好的pts
+        if (!entry->preserve_pts || frame->pts == AV_NOPTS_VALUE) {
+            frame->pts = entry->frame_counter;
+        }
+        entry->frame_counter++;
+
+        if (has_latency_metric(entry, LATENCY_ENCODE)) {
+            stamp_frame_time(frame);
+        }
+
+        // A replacement encoder is waiting: keep this frame for it and flush the current one.
+        // receivePacket drains it and switches encoders at its EOF
+        if (entry->standby) {
+            entry->pending_frame = av_frame_clone(frame);
+            if (!entry->pending_frame) {
+                return AVERROR(ENOMEM);
+            }
+            avcodec_send_frame(codec_ctx, NULL);
+            entry->draining = 1;
+            return 0;
+        }
+    }
+    // Note: When flushing (null frame), don't reset the counter
+    // The counter represents total frames sent, not current batch
+
+    // Flushing for good: the pending replacement is never used
+    if (!frame && entry->standby) {
+        avcodec_free_context(&entry->standby);
+    }
+
+    int64_t start = call_latency_start();
+    int ret = avcodec_send_frame(codec_ctx, frame);
+    if (ret == 0) {
+        call_latency_end(entry, LATENCY_SEND_FRAME, start);
+    }
+    return ret;
+}
+
+// Packets of a replacement encoder: announce its global header and keep dts increasing past the
+// last packet of the previous encoder (its first packets may have dts < pts). pts moves by the same
+// offset so B-frame reordering is preserved
+static int64_t packet_reorder_delay(const AVPacket *pkt) {
+    if (pkt->pts == AV_NOPTS_VALUE || pkt->dts == AV_NOPTS_VALUE) {
+        return 0;
+    }
+    return FFMAX(pkt->pts - pkt->dts, 0);
+}
+
+/**
+ * Keep timestamps continuous across encoder switches
+ * @description Every codec's dts run is normalized by its own reorder delay (pts - dts of its first
+ *              packet) and then placed reorder_delay ticks behind pts, the deepest delay seen on
+ *              the handle. A dts sequence normalized this way never goes backwards across a switch
+ *              and stays <= pts, so offsets are fixed once per switch instead of per packet. Only a
+ *              replacement that reorders deeper than every codec before it needs room that was
+ *              not reserved: pts then moves by the difference, once, and the total shift is
+ *              bounded by the deepest delay rather than growing with each switch
+ */
+static int finish_encoder_switch(ContextEntry *entry, AVPacket *pkt) {
+    AVCodecContext *codec_ctx = entry->ptr;
+    if (entry->switched == 1) {
+        entry->switched = 2;
+        int64_t delay = packet_reorder_delay(pkt);
+        if (entry->reorder_delay == AV_NOPTS_VALUE) {
+            entry->reorder_delay = 0;
+        }
+        if (delay > entry->reorder_delay) {
+            entry->pts_shift += delay - entry->reorder_delay;
+            entry->reorder_delay = delay;
+        }
+        entry->dts_bias = delay - entry->reorder_delay;
+        if (codec_ctx->extradata_size > 0) {
+            uint8_t *data = av_packet_new_side_data(pkt, AV_PKT_DATA_NEW_EXTRADATA, codec_ctx->extradata_size);
+            if (!data) {
+                return AVERROR(ENOMEM);
+            }
+            memcpy(data, codec_ctx->extradata, codec_ctx->extradata_size);
+        }
+    }
+    if (pkt->pts != AV_NOPTS_VALUE) {
+        pkt->pts += entry->pts_shift;
+    }
+    if (pkt->dts != AV_NOPTS_VALUE) {
+        pkt->dts += entry->dts_bias + entry->pts_shift;
+        // Encoders whose first packet understates their delay: keep dts monotonic without touching pts
+        if (entry->last_dts != AV_NOPTS_VALUE && pkt->dts <= entry->last_dts) {
+            pkt->dts = entry->last_dts + 1;
+        }
+    }
+    return 0;
+}
+
+static int encoder_receive_packet(ContextEntry *entry, AVPacket *pkt) {
+    AVCodecContext *codec_ctx = entry->ptr;
+
+    int64_t start = call_latency_start();
+    int ret = avcodec_receive_packet(codec_ctx, pkt);
+
+    if (ret == AVERROR_EOF && entry->draining) {
+        // Old encoder fully drained: switch to the replacement and give it the held frame
+        avcodec_free_context(&codec_ctx);
+        codec_ctx = entry->ptr = entry->standby;
+        entry->standby = NULL;
+        entry->draining = 0;
+        entry->switched = 1;
+        ret = avcodec_send_frame(codec_ctx, entry->pending_frame);
+        av_frame_free(&entry->pending_frame);
+        if (ret >= 0 && entry->flush_after_switch) {
+            ret = avcodec_send_frame(codec_ctx, NULL);
+        }
+        entry->flush_after_switch = 0;
+        if (ret >= 0) {
+            ret = avcodec_receive_packet(codec_ctx, pkt);
+        }
+    }
+    if (ret == 0) {
+        call_latency_end(entry, LATENCY_RECEIVE_PACKET, start);
+        if (entry->switched) {
+            ret = finish_encoder_switch(entry, pkt);
+        } else if (entry->reorder_delay == AV_NOPTS_VALUE) {
+            entry->reorder_delay = packet_reorder_delay(pkt);
+        }
+        entry->last_dts = pkt->dts;
+    }
+    if (ret == 0 && entry->packet_stats) {
+        packet_stats_record(entry->packet_stats, pkt);
+    }
+    if (ret == 0) {
+        record_packet_latency(entry, LATENCY_ENCODE, pkt);
+    }
+    return ret;
+}
+
+// Map a codec step result to the status codes of the synchronous API
+static napi_value codec_status(napi_env env, int ret) {
+    napi_value result;
+    if (ret == 0) {
+        napi_create_int32(env, 0, &result);
+    } else if (ret == AVERROR(EAGAIN)) {
+        napi_create_int32(env, -1, &result);
+    } else if (ret == AVERROR_EOF) {
+        napi_create_int32(env, -2, &result);
+    } else {
+        napi_create_int32(env, -3, &result);
+    }
+    return result;
+}
+
+// Codec handles lent to a pending codecTransfer belong to the thread pool until it completes
+static int codec_is_busy(napi_env env, const ContextEntry *entry) {
+    if (entry && entry->transfer_busy) {
+        napi_throw_error(env, NULL, "Codec context is busy with an async transfer");
+        return 1;
+    }
+    return 0;
+}
+
+int handle_is_busy(napi_env env, int id) {
+    ContextEntry *entry = get_context_entry(id);
+    if (entry && entry->transfer_busy) {
+        if (!env) {
+            return 1;
+        }
+        napi_throw_error(env, NULL, entry->type == CTX_TYPE_FRAME ? "Frame is busy with an async transfer" :
+                                    entry->type == CTX_TYPE_PACKET ? "Packet is busy with an async transfer" :
+                                    "Codec context is busy with an async transfer");
+        return 1;
+    }
+    return 0;
+}
 
 /**
  * Send packet to decoder
@@ -1421,10 +2416,14 @@ napi_value atomic_send_packet(napi_env env, napi_callback_info info) {
     napi_get_value_int32(env, argv[0], &decoder_ctx_id);
     
     AVCodecContext *codec_ctx = get_context_ptr(decoder_ctx_id, CTX_TYPE_DECODER);
+    ContextEntry *entry = get_context_entry(decoder_ctx_id);
     if (!codec_ctx) {
         napi_throw_error(env, NULL, "Invalid decoder context");
         return NULL;
     }
+    if (codec_is_busy(env, entry)) {
+        return NULL;
+    }
     
     AVPacket *pkt = NULL;
     if (argc >= 2) {
@@ -1433,24 +2432,14 @@ napi_value atomic_send_packet(napi_env env, napi_callback_info info) {
         if (valuetype != napi_null && valuetype != napi_undefined) {
             int pkt_id;
             napi_get_value_int32(env, argv[1], &pkt_id);
+            if (handle_is_busy(env, pkt_id)) {
+                return NULL;
+            }
             pkt = get_context_ptr(pkt_id, CTX_TYPE_PACKET);
         }
     }
     
-    int ret = avcodec_send_packet(codec_ctx, pkt);
-    
-    napi_value result;
-    if (ret == 0) {
-        napi_create_int32(env, 0, &result);
-    } else if (ret == AVERROR(EAGAIN)) {
-        napi_create_int32(env, -1, &result);
-    } else if (ret == AVERROR_EOF) {
-        napi_create_int32(env, -2, &result);
-    } else {
-        napi_create_int32(env, -3, &result);
-    }
-    
-    return result;
+    return codec_status(env, decoder_send_packet(entry, pkt));
 }
 
 /**
@@ -1481,21 +2470,12 @@ napi_value atomic_receive_frame(napi_env env, napi_callback_info info) {
         napi_throw_error(env, NULL, "Invalid context or frame");
         return NULL;
     }
-    
-    int ret = avcodec_receive_frame(codec_ctx, frame);
-    
-    napi_value result;
-    if (ret == 0) {
-        napi_create_int32(env, 0, &result);
-    } else if (ret == AVERROR(EAGAIN)) {
-        napi_create_int32(env, -1, &result);
-    } else if (ret == AVERROR_EOF) {
-        napi_create_int32(env, -2, &result);
-    } else {
-        napi_create_int32(env, -3, &result);
+    ContextEntry *entry = get_context_entry(decoder_ctx_id);
+    if (codec_is_busy(env, entry) || handle_is_busy(env, frame_id)) {
+        return NULL;
     }
     
-    return result;
+    return codec_status(env, decoder_receive_frame(entry, frame));
 }
 
 /**
@@ -1524,6 +2504,9 @@ napi_value atomic_send_frame(napi_env env, napi_callback_info info) {
         napi_throw_error(env, NULL, "Invalid encoder context");
         return NULL;
     }
+    if (codec_is_busy(env, entry)) {
+        return NULL;
+    }
     
     AVFrame *frame = NULL;
     if (argc >= 2) {
@@ -1532,79 +2515,497 @@ napi_value atomic_send_frame(napi_env env, napi_callback_info info) {
         if (valuetype != napi_null && valuetype != napi_undefined) {
             int frame_id;
             napi_get_value_int32(env, argv[1], &frame_id);
-            frame = get_context_ptr(frame_id, CTX_TYPE_FRAME);
-            
-            if (frame) {
-                // 清除解码帧的类型信息，让编码器自己决定帧类型
-                frame->pict_type = AV_PICTURE_TYPE_NONE;
-                
-                // 为帧设置正确的pts
-                // 使用帧计数器来生成递增的pts，确保编码器输出正确的时间戳
-                frame->pts = entry->frame_counter++;
+            if (handle_is_busy(env, frame_id)) {
+                return NULL;
             }
+            frame = get_context_ptr(frame_id, CTX_TYPE_FRAME);
         }
-        // Note: When flushing (null frame), don't reset the counter
-        // The counter represents total frames sent, not current batch
     }
     
-    int ret = avcodec_send_frame(codec_ctx, frame);
+    return codec_status(env, encoder_send_frame(entry, frame));
+}
+
+/**
+ * Receive packet from encoder
+ * @param encoderContextId - Encoder context ID
+ * @param packetId - Packet ID to receive into
+ * @returns Status: 0 (success), -1 (EAGAIN), -2 (EOF), -3 (error)
+ */
+napi_value atomic_receive_packet(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 2;
+    napi_value argv[2];
     
-    napi_value result;
-    if (ret == 0) {
-        napi_create_int32(env, 0, &result);
-    } else if (ret == AVERROR(EAGAIN)) {
-        napi_create_int32(env, -1, &result);
-    } else if (ret == AVERROR_EOF) {
-        napi_create_int32(env, -2, &result);
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 2) {
+        napi_throw_error(env, NULL, "Expected encoder context ID and packet ID");
+        return NULL;
+    }
+    
+    int encoder_ctx_id, pkt_id;
+    napi_get_value_int32(env, argv[0], &encoder_ctx_id);
+    napi_get_value_int32(env, argv[1], &pkt_id);
+    
+    AVCodecContext *codec_ctx = get_context_ptr(encoder_ctx_id, CTX_TYPE_ENCODER);
+    AVPacket *pkt = get_context_ptr(pkt_id, CTX_TYPE_PACKET);
+    
+    if (!codec_ctx || !pkt) {
+        napi_throw_error(env, NULL, "Invalid context or packet");
+        return NULL;
+    }
+    ContextEntry *entry = get_context_entry(encoder_ctx_id);
+    if (codec_is_busy(env, entry) || handle_is_busy(env, pkt_id)) {
+        return NULL;
+    }
+    
+    return codec_status(env, encoder_receive_packet(entry, pkt));
+}
+
+// ============================================================================
+// Async Codec Transfer - One input in, available outputs out, on the thread pool
+// ============================================================================
+
+#define MAX_TRANSFER_OUTPUTS 64
+
+typedef struct {
+    ContextEntry *entry;
+    int encoder;
+    int send;               // 0: only drain outputs
+    void *input;            // AVFrame (encoder) or AVPacket (decoder); NULL flushes
+    void *outputs[MAX_TRANSFER_OUTPUTS];
+    int nb_outputs;
+    ContextEntry *lent[MAX_TRANSFER_OUTPUTS + 1]; // Frame/packet entries marked busy until completion
+    int nb_lent;
+
+    int consumed;
+    int received;
+    int eof;
+    int error;
+    napi_deferred deferred;
+    napi_async_work work;
+} CodecTransfer;
+
+static void codec_transfer_execute(napi_env env, void *data) {
+    CodecTransfer *t = data;
+    int idle = 0;
+    (void)env;
+
+    t->consumed = !t->send;
+    while (t->received < t->nb_outputs) {
+        int ret;
+        if (!t->consumed) {
+            ret = t->encoder ? encoder_send_frame(t->entry, t->input)
+                             : decoder_send_packet(t->entry, t->input);
+            // A repeated flush is a no-op; corrupt packets are skipped rather than failing the stream
+            if (ret == 0 || (ret == AVERROR_EOF && !t->input) ||
+                (!t->encoder && ret == AVERROR_INVALIDDATA)) {
+                t->consumed = 1;
+            } else if (ret != AVERROR(EAGAIN)) {
+                t->error = ret;
+                return;
+            }
+        }
+
+        ret = t->encoder ? encoder_receive_packet(t->entry, t->outputs[t->received])
+                         : decoder_receive_frame(t->entry, t->outputs[t->received]);
+        if (ret == 0) {
+            t->received++;
+            idle = 0;
+        } else if (ret == AVERROR_EOF) {
+            t->eof = 1;
+            return;
+        } else if (ret != AVERROR(EAGAIN)) {
+            t->error = ret;
+            return;
+        } else if (t->consumed || ++idle > 1) {
+            // Nothing more to drain. A rejected input gets one retry once outputs were read
+            return;
+        }
+    }
+}
+
+static void codec_transfer_unlend(CodecTransfer *t) {
+    for (int i = 0; i < t->nb_lent; i++) {
+        t->lent[i]->transfer_busy = 0;
+    }
+    t->nb_lent = 0;
+}
+
+// Resolve a frame/packet handle and lend it to the transfer; NULL when the handle is invalid or
+// already lent, including to this transfer
+static void *codec_transfer_lend(CodecTransfer *t, int id, ContextType type) {
+    ContextEntry *entry = get_context_entry(id);
+    if (!entry || entry->type != type || entry->transfer_busy) {
+        return NULL;
+    }
+    entry->transfer_busy = 1;
+    t->lent[t->nb_lent++] = entry;
+    return entry->ptr;
+}
+
+static void codec_transfer_complete(napi_env env, napi_status status, void *data) {
+    CodecTransfer *t = data;
+
+    t->entry->transfer_busy = 0;
+    codec_transfer_unlend(t);
+    if (status != napi_ok || t->error < 0) {
+        char errbuf[128];
+        if (status != napi_ok) {
+            snprintf(errbuf, sizeof(errbuf), "Codec transfer was cancelled");
+        } else {
+            av_strerror(t->error, errbuf, sizeof(errbuf));
+        }
+        napi_value msg, error;
+        napi_create_string_utf8(env, errbuf, NAPI_AUTO_LENGTH, &msg);
+        napi_create_error(env, NULL, msg, &error);
+        napi_reject_deferred(env, t->deferred, error);
     } else {
-        napi_create_int32(env, -3, &result);
+        napi_value result, val;
+        napi_create_object(env, &result);
+        napi_create_int32(env, t->received, &val);
+        napi_set_named_property(env, result, "received", val);
+        napi_get_boolean(env, t->send && t->consumed, &val);
+        napi_set_named_property(env, result, "consumed", val);
+        napi_get_boolean(env, t->eof, &val);
+        napi_set_named_property(env, result, "eof", val);
+        napi_resolve_deferred(env, t->deferred, result);
+    }
+
+    napi_delete_async_work(env, t->work);
+    av_free(t);
+}
+
+/**
+ * Send one input to an encoder or decoder and drain its outputs on the thread pool
+ * @param contextId - Encoder or decoder context ID
+ * @param inputId - Frame ID (encoder) or packet ID (decoder), null to flush, undefined to only drain
+ * @param outputIds - Packet IDs (encoder) or frame IDs (decoder) to receive into, in order
+ * @returns Promise resolving to { received, consumed, eof } - outputs filled, whether the input was
+ *          accepted (send it again otherwise), and whether the codec is fully drained
+ * @description The context and every handle passed stay owned by the thread pool until the
+ *              promise settles; synchronous calls on them (including freeing them) throw meanwhile
+ */
+napi_value atomic_codec_transfer(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 3;
+    napi_value argv[3];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 3) {
+        napi_throw_error(env, NULL, "Expected context ID, input ID and output IDs");
+        return NULL;
     }
+
+    int ctx_id;
+    napi_get_value_int32(env, argv[0], &ctx_id);
+    ContextEntry *entry = get_context_entry(ctx_id);
+    if (!entry || (entry->type != CTX_TYPE_ENCODER && entry->type != CTX_TYPE_DECODER)) {
+        napi_throw_error(env, NULL, "Invalid encoder or decoder context");
+        return NULL;
+    }
+    if (codec_is_busy(env, entry)) {
+        return NULL;
+    }
+
+    int encoder = entry->type == CTX_TYPE_ENCODER;
+    ContextType input_type = encoder ? CTX_TYPE_FRAME : CTX_TYPE_PACKET;
+    ContextType output_type = encoder ? CTX_TYPE_PACKET : CTX_TYPE_FRAME;
+
+    bool is_array = false;
+    uint32_t nb_outputs = 0;
+    napi_is_array(env, argv[2], &is_array);
+    if (!is_array || napi_get_array_length(env, argv[2], &nb_outputs) != napi_ok ||
+        nb_outputs == 0 || nb_outputs > MAX_TRANSFER_OUTPUTS) {
+        napi_throw_error(env, NULL, "Expected 1 to 64 output IDs");
+        return NULL;
+    }
+
+    CodecTransfer *t = av_mallocz(sizeof(*t));
+    if (!t) {
+        napi_throw_error(env, NULL, "Failed to allocate codec transfer");
+        return NULL;
+    }
+    t->entry = entry;
+    t->encoder = encoder;
+
+    napi_valuetype valuetype;
+    napi_typeof(env, argv[1], &valuetype);
+    t->send = valuetype != napi_undefined;
+    if (valuetype != napi_null && valuetype != napi_undefined) {
+        int input_id;
+        napi_get_value_int32(env, argv[1], &input_id);
+        t->input = codec_transfer_lend(t, input_id, input_type);
+        if (!t->input) {
+            if (!handle_is_busy(env, input_id)) {
+                napi_throw_error(env, NULL, encoder ? "Invalid input frame" : "Invalid input packet");
+            }
+            av_free(t);
+            return NULL;
+        }
+    }
+
+    for (uint32_t i = 0; i < nb_outputs; i++) {
+        napi_value val;
+        int output_id;
+        napi_get_element(env, argv[2], i, &val);
+        napi_get_value_int32(env, val, &output_id);
+        t->outputs[i] = codec_transfer_lend(t, output_id, output_type);
+        if (!t->outputs[i]) {
+            if (!handle_is_busy(env, output_id)) {
+                napi_throw_error(env, NULL, encoder ? "Invalid output packet" : "Invalid output frame");
+            }
+            codec_transfer_unlend(t);
+            av_free(t);
+            return NULL;
+        }
+    }
+    t->nb_outputs = nb_outputs;
+
+    napi_value promise, resource_name;
+    if (napi_create_promise(env, &t->deferred, &promise) != napi_ok) {
+        codec_transfer_unlend(t);
+        av_free(t);
+        napi_throw_error(env, NULL, "Failed to create promise");
+        return NULL;
+    }
+
+    napi_create_string_utf8(env, "ffmpeg7:codecTransfer", NAPI_AUTO_LENGTH, &resource_name);
+    status = napi_create_async_work(env, NULL, resource_name,
+                                    codec_transfer_execute, codec_transfer_complete,
+                                    t, &t->work);
+    if (status == napi_ok) {
+        status = napi_queue_async_work(env, t->work);
+    }
+    if (status != napi_ok) {
+        if (t->work) {
+            napi_delete_async_work(env, t->work);
+        }
+        napi_value msg, error;
+        napi_create_string_utf8(env, "Failed to queue codec transfer", NAPI_AUTO_LENGTH, &msg);
+        napi_create_error(env, NULL, msg, &error);
+        napi_reject_deferred(env, t->deferred, error);
+        codec_transfer_unlend(t);
+        av_free(t);
+        return promise;
+    }
+
+    entry->transfer_busy = 1;
+    return promise;
+}
+
+// Copy count ring records starting at tail into a new typed array
+static napi_value packet_stats_copy(napi_env env, napi_typedarray_type type, const void *src, size_t element_size,
+                                    int per_record, int capacity, int tail, int count) {
+    napi_value arraybuffer, result;
+    void *data;
+    size_t record_size = element_size * per_record;
+
+    napi_create_arraybuffer(env, record_size * count, &data, &arraybuffer);
+    int first = FFMIN(count, capacity - tail);
+    memcpy(data, (const uint8_t *)src + record_size * tail, record_size * first);
+    memcpy((uint8_t *)data + record_size * first, src, record_size * (count - first));
+    napi_create_typedarray(env, type, (size_t)count * per_record, arraybuffer, 0, &result);
+    return result;
+}
+
+/**
+ * Read and clear the encoder's per-packet statistics
+ * @param encoderContextId - Encoder context ID (with the "packet_stats" option set)
+ * @returns { count, dropped, pts, dts, size, flags, pictType, qp, error } - typed arrays, oldest packet first;
+ *          error holds 4 values per packet
+ */
+napi_value atomic_get_encoder_packet_stats(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 1;
+    napi_value argv[1];
     
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected encoder context ID");
+        return NULL;
+    }
+    
+    int encoder_ctx_id;
+    napi_get_value_int32(env, argv[0], &encoder_ctx_id);
+    
+    ContextEntry *entry = get_context_entry(encoder_ctx_id);
+    if (!entry || entry->type != CTX_TYPE_ENCODER) {
+        napi_throw_error(env, NULL, "Invalid encoder context");
+        return NULL;
+    }
+    // A codecTransfer records into the ring from the thread pool
+    if (codec_is_busy(env, entry)) {
+        return NULL;
+    }
+    PacketStatsRing *ring = entry->packet_stats;
+    if (!ring) {
+        napi_throw_error(env, NULL, "Packet statistics are not enabled, set the packet_stats encoder option");
+        return NULL;
+    }
+    
+    int count = ring->count;
+    int tail = (ring->head - count + ring->capacity) % ring->capacity;
+    
+    napi_value result, val;
+    napi_create_object(env, &result);
+    napi_create_int32(env, count, &val);
+    napi_set_named_property(env, result, "count", val);
+    napi_create_int64(env, ring->dropped, &val);
+    napi_set_named_property(env, result, "dropped", val);
+    napi_set_named_property(env, result, "pts",
+        packet_stats_copy(env, napi_float64_array, ring->pts, sizeof(double), 1, ring->capacity, tail, count));
+    napi_set_named_property(env, result, "dts",
+        packet_stats_copy(env, napi_float64_array, ring->dts, sizeof(double), 1, ring->capacity, tail, count));
+    napi_set_named_property(env, result, "size",
+        packet_stats_copy(env, napi_int32_array, ring->size, sizeof(int32_t), 1, ring->capacity, tail, count));
+    napi_set_named_property(env, result, "flags",
+        packet_stats_copy(env, napi_uint8_array, ring->flags, 1, 1, ring->capacity, tail, count));
+    napi_set_named_property(env, result, "pictType",
+        packet_stats_copy(env, napi_uint8_array, ring->pict_type, 1, 1, ring->capacity, tail, count));
+    napi_set_named_property(env, result, "qp",
+        packet_stats_copy(env, napi_float32_array, ring->qp, sizeof(float), 1, ring->capacity, tail, count));
+    napi_set_named_property(env, result, "error",
+        packet_stats_copy(env, napi_float64_array, ring->error, sizeof(double), 4, ring->capacity, tail, count));
+    
+    ring->count = 0;
+    ring->dropped = 0;
     return result;
 }
 
 /**
- * Receive packet from encoder
- * @param encoderContextId - Encoder context ID
- * @param packetId - Packet ID to receive into
- * @returns Status: 0 (success), -1 (EAGAIN), -2 (EOF), -3 (error)
+ * Read latency histograms of a handle
+ * @param contextId - Encoder/output context ID with the "low_latency" option set, or any
+ *                    encoder/decoder/output/sws/swr context while setLatencyTracking is on
+ * @param reset - (Optional) Clear the histograms after reading
+ * @returns { encode?, endToEnd?, sendPacket?, receiveFrame?, sendFrame?, receivePacket?, scale?,
+ *          convert?, write? } - { count, min, max, mean, p50, p90, p99, p999 } in milliseconds
+ *          plus bucketUpperBounds / bucketCounts for the non-empty buckets
+ */
+napi_value atomic_get_latency_stats(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 2;
+    napi_value argv[2];
+    
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected context ID");
+        return NULL;
+    }
+    
+    int ctx_id;
+    napi_get_value_int32(env, argv[0], &ctx_id);
+    
+    bool reset = false;
+    if (argc >= 2) {
+        napi_get_value_bool(env, argv[1], &reset);
+    }
+    
+    ContextEntry *entry = get_context_entry(ctx_id);
+    if (!entry) {
+        napi_throw_error(env, NULL, "Invalid context ID");
+        return NULL;
+    }
+    
+    napi_value result;
+    napi_create_object(env, &result);
+    for (int m = 0; m < LATENCY_NB; m++) {
+        // A codecTransfer may be recording into the same histogram, so read a snapshot
+        SharedLatencyHistogram *hist = get_latency_metric(entry, m);
+        if (hist) {
+            LatencyHistogram snapshot;
+            shared_latency_histogram_snapshot(hist, &snapshot, reset);
+            napi_set_named_property(env, result, latency_metric_names[m],
+                                    latency_histogram_to_js(env, &snapshot));
+        }
+    }
+    
+    return result;
+}
+
+/**
+ * Enable or disable per-call latency tracking for all handles
+ * @param enabled - Time avcodec_send_* / receive_*, sws_scale, swr_convert* and packet writes
  */
-napi_value atomic_receive_packet(napi_env env, napi_callback_info info) {
+napi_value atomic_set_latency_tracking(napi_env env, napi_callback_info info) {
     napi_status status;
-    size_t argc = 2;
-    napi_value argv[2];
+    size_t argc = 1;
+    napi_value argv[1];
     
     status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
-    if (status != napi_ok || argc < 2) {
-        napi_throw_error(env, NULL, "Expected encoder context ID and packet ID");
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected enabled flag");
         return NULL;
     }
     
-    int encoder_ctx_id, pkt_id;
-    napi_get_value_int32(env, argv[0], &encoder_ctx_id);
-    napi_get_value_int32(env, argv[1], &pkt_id);
-    
-    AVCodecContext *codec_ctx = get_context_ptr(encoder_ctx_id, CTX_TYPE_ENCODER);
-    AVPacket *pkt = get_context_ptr(pkt_id, CTX_TYPE_PACKET);
+    bool enabled = false;
+    napi_get_value_bool(env, argv[0], &enabled);
     
-    if (!codec_ctx || !pkt) {
-        napi_throw_error(env, NULL, "Invalid context or packet");
-        return NULL;
+    // Allocate every open handle's histograms here so timed calls never allocate
+    if (enabled) {
+        for (int i = 0; i < MAX_CONTEXTS; i++) {
+            if (context_table[i].in_use && enable_call_latency(&context_table[i]) < 0) {
+                napi_throw_error(env, NULL, "Failed to allocate latency histogram");
+                return NULL;
+            }
+        }
     }
+    atomic_store(&call_latency_enabled, enabled);
     
-    int ret = avcodec_receive_packet(codec_ctx, pkt);
+    return NULL;
+}
+
+static const char *context_kind_name(ContextType type) {
+    switch (type) {
+        case CTX_TYPE_INPUT_FORMAT:  return "input";
+        case CTX_TYPE_OUTPUT_FORMAT: return "output";
+        case CTX_TYPE_ENCODER:       return "encoder";
+        case CTX_TYPE_DECODER:       return "decoder";
+        case CTX_TYPE_SWS:           return "sws";
+        case CTX_TYPE_SWR:           return "swr";
+        default:                     return "other";
+    }
+}
+
+/**
+ * Export all latency histograms in Prometheus text exposition format
+ * @returns String with one ffmpeg7_latency_seconds histogram series per handle and metric,
+ *          labelled handle, kind and metric
+ */
+napi_value atomic_get_latency_metrics(napi_env env, napi_callback_info info) {
+    static const char *const name = "ffmpeg7_latency_seconds";
+    AVBPrint bp;
+    char labels[128];
+    
+    av_bprint_init(&bp, 0, AV_BPRINT_SIZE_UNLIMITED);
+    av_bprintf(&bp, "# HELP %s Latency of FFmpeg calls and frames per handle.\n", name);
+    av_bprintf(&bp, "# TYPE %s histogram\n", name);
+    for (int i = 0; i < MAX_CONTEXTS; i++) {
+        ContextEntry *entry = &context_table[i];
+        if (!entry->in_use) {
+            continue;
+        }
+        for (int m = 0; m < LATENCY_NB; m++) {
+            // Format from a snapshot so recording on the thread pool is never held up
+            SharedLatencyHistogram *hist = get_latency_metric(entry, m);
+            if (hist) {
+                LatencyHistogram snapshot;
+                shared_latency_histogram_snapshot(hist, &snapshot, 0);
+                snprintf(labels, sizeof(labels), "handle=\"%d\",kind=\"%s\",metric=\"%s\"",
+                         entry->id, context_kind_name(entry->type), latency_metric_names[m]);
+                latency_histogram_write_prometheus(&bp, name, labels, &snapshot);
+            }
+        }
+    }
     
-    napi_value result;
-    if (ret == 0) {
-        napi_create_int32(env, 0, &result);
-    } else if (ret == AVERROR(EAGAIN)) {
-        napi_create_int32(env, -1, &result);
-    } else if (ret == AVERROR_EOF) {
-        napi_create_int32(env, -2, &result);
-    } else {
-        napi_create_int32(env, -3, &result);
+    if (!av_bprint_is_complete(&bp)) {
+        av_bprint_finalize(&bp, NULL);
+        napi_throw_error(env, NULL, "Failed to allocate metrics text");
+        return NULL;
     }
     
+    napi_value result;
+    napi_create_string_utf8(env, bp.str, bp.len, &result);
+    av_bprint_finalize(&bp, NULL);
     return result;
 }
 
@@ -1630,6 +3031,9 @@ napi_value atomic_free_frame(napi_env env, napi_callback_info info) {
         return NULL;
     }
     
+    if (handle_is_busy(env, frame_id)) {
+        return NULL;
+    }
     AVFrame *frame = get_context_ptr(frame_id, CTX_TYPE_FRAME);
     if (frame) {
         av_frame_free(&frame);
@@ -1741,7 +3145,7 @@ napi_value atomic_get_muxer_list(napi_env env, napi_callback_info info) {
 // ============================================================================
 
 /**
- * Allocate frame buffer
+ * Allocate frame buffer from the per-geometry buffer pools (see frame_pool.c)
  * @param frameId - Frame ID
  * @param align - Buffer alignment (0 for default)
  */
@@ -1764,13 +3168,16 @@ napi_value atomic_frame_get_buffer(napi_env env, napi_callback_info info) {
         napi_throw_error(env, NULL, "Invalid frame");
         return NULL;
     }
+    if (handle_is_busy(env, frame_id)) {
+        return NULL;
+    }
     
     int align = 0;
     if (argc >= 2) {
         napi_get_value_int32(env, argv[1], &align);
     }
     
-    int ret = av_frame_get_buffer(frame, align);
+    int ret = frame_pool_get_buffer(frame, align);
     if (ret < 0) {
         char errbuf[128];
         av_strerror(ret, errbuf, sizeof(errbuf));
@@ -1810,6 +3217,9 @@ napi_value atomic_set_frame_property(napi_env env, napi_callback_info info) {
         napi_throw_error(env, NULL, "Invalid frame");
         return NULL;
     }
+    if (handle_is_busy(env, frame_id)) {
+        return NULL;
+    }
     
     napi_valuetype valuetype;
     napi_typeof(env, argv[2], &valuetype);
@@ -1851,6 +3261,14 @@ napi_value atomic_set_frame_property(napi_env env, napi_callback_info info) {
         napi_get_value_int32(env, argv[2], &channels);
         av_channel_layout_uninit(&frame->ch_layout);
         av_channel_layout_default(&frame->ch_layout, channels);
+    } else if (strcmp(property, "channel_layout") == 0) {
+        AVChannelLayout layout = {0};
+        if (parse_channel_layout(env, argv[2], &layout) < 0) {
+            napi_throw_error(env, NULL, "Invalid channel layout");
+            return NULL;
+        }
+        av_channel_layout_uninit(&frame->ch_layout);
+        frame->ch_layout = layout;
     } else {
         napi_throw_error(env, NULL, "Unknown or unsupported property");
         return NULL;
@@ -1888,6 +3306,9 @@ napi_value atomic_get_frame_property(napi_env env, napi_callback_info info) {
         napi_throw_error(env, NULL, "Invalid frame");
         return NULL;
     }
+    if (handle_is_busy(env, frame_id)) {
+        return NULL;
+    }
     
     napi_value result;
     
@@ -1909,6 +3330,10 @@ napi_value atomic_get_frame_property(napi_env env, napi_callback_info info) {
         napi_create_int32(env, frame->nb_samples, &result);
     } else if (strcmp(property, "channels") == 0) {
         napi_create_int32(env, frame->ch_layout.nb_channels, &result);
+    } else if (strcmp(property, "channel_layout") == 0) {
+        char layout_str[128] = {0};
+        av_channel_layout_describe(&frame->ch_layout, layout_str, sizeof(layout_str));
+        napi_create_string_utf8(env, layout_str, NAPI_AUTO_LENGTH, &result);
     } else if (strcmp(property, "linesize") == 0) {
         napi_create_array(env, &result);
         for (int i = 0; i < AV_NUM_DATA_POINTERS; i++) {
@@ -1916,6 +3341,13 @@ napi_value atomic_get_frame_property(napi_env env, napi_callback_info info) {
             napi_create_int32(env, frame->linesize[i], &val);
             napi_set_element(env, result, i, val);
         }
+    } else if (strcmp(property, "time_base") == 0) {
+        napi_value num, den;
+        napi_create_array_with_length(env, 2, &result);
+        napi_create_int32(env, frame->time_base.num, &num);
+        napi_create_int32(env, frame->time_base.den, &den);
+        napi_set_element(env, result, 0, num);
+        napi_set_element(env, result, 1, den);
     } else {
         napi_throw_error(env, NULL, "Unknown property");
         return NULL;
@@ -1950,6 +3382,9 @@ napi_value atomic_get_frame_data(napi_env env, napi_callback_info info) {
         napi_throw_error(env, NULL, "Invalid frame");
         return NULL;
     }
+    if (handle_is_busy(env, frame_id)) {
+        return NULL;
+    }
     
     if (plane_idx < 0 || plane_idx >= AV_NUM_DATA_POINTERS) {
         napi_throw_error(env, NULL, "Invalid plane index");
@@ -2014,6 +3449,9 @@ napi_value atomic_set_frame_data(napi_env env, napi_callback_info info) {
         napi_throw_error(env, NULL, "Invalid frame");
         return NULL;
     }
+    if (handle_is_busy(env, frame_id)) {
+        return NULL;
+    }
     
     if (plane_idx < 0 || plane_idx >= AV_NUM_DATA_POINTERS) {
         napi_throw_error(env, NULL, "Invalid plane index");
@@ -2092,6 +3530,9 @@ napi_value atomic_get_packet_data(napi_env env, napi_callback_info info) {
         napi_throw_error(env, NULL, "Invalid packet");
         return NULL;
     }
+    if (handle_is_busy(env, pkt_id)) {
+        return NULL;
+    }
     
     if (!pkt->data || pkt->size == 0) {
         return NULL; // Return null for empty packet
@@ -2132,6 +3573,9 @@ napi_value atomic_set_packet_data(napi_env env, napi_callback_info info) {
         napi_throw_error(env, NULL, "Invalid packet");
         return NULL;
     }
+    if (handle_is_busy(env, pkt_id)) {
+        return NULL;
+    }
     
     bool is_buffer;
     status = napi_is_buffer(env, argv[1], &is_buffer);
@@ -2194,6 +3638,9 @@ napi_value atomic_get_packet_property(napi_env env, napi_callback_info info) {
         napi_throw_error(env, NULL, "Invalid packet");
         return NULL;
     }
+    if (handle_is_busy(env, pkt_id)) {
+        return NULL;
+    }
     
     napi_value result;
     
@@ -2246,6 +3693,9 @@ napi_value atomic_set_packet_property(napi_env env, napi_callback_info info) {
         napi_throw_error(env, NULL, "Invalid packet");
         return NULL;
     }
+    if (handle_is_busy(env, pkt_id)) {
+        return NULL;
+    }
     
     napi_valuetype valuetype;
     napi_typeof(env, argv[2], &valuetype);
@@ -2371,24 +3821,69 @@ napi_value atomic_create_sws_context(napi_env env, napi_callback_info info) {
         return NULL;
     }
     
+    ScalerState *scaler = av_mallocz(sizeof(*scaler));
+    if (!scaler) {
+        sws_freeContext(sws_ctx);
+        napi_throw_error(env, NULL, "Failed to allocate scaler state");
+        return NULL;
+    }
+    scaler->dst_width = dst_width;
+    scaler->dst_height = dst_height;
+    scaler->dst_format = dst_fmt;
+    scaler->flags = flags;
+    scaler->cache[0] = (ScalerCacheEntry){ sws_ctx, src_width, src_height, src_fmt, 0 };
+    
     // Allocate context ID
     int ctx_id = alloc_context_id(CTX_TYPE_SWS, sws_ctx);
     if (ctx_id < 0) {
-        sws_freeContext(sws_ctx);
+        scaler_state_free(&scaler);
         napi_throw_error(env, NULL, "Too many open contexts");
         return NULL;
     }
+    get_context_entry(ctx_id)->scaler = scaler;
     
     napi_value result;
     napi_create_int32(env, ctx_id, &result);
     return result;
 }
 
+// Context for the source frame's geometry: reuse a cached one, or build it in the least recently
+// used slot. Mid-stream resolution or format changes never reach sws_scale with a stale context
+static struct SwsContext *scaler_for_frame(ContextEntry *entry, const AVFrame *src) {
+    ScalerState *scaler = entry->scaler;
+    int slot = 0;
+    
+    scaler->frames++;
+    for (int i = 0; i < SCALER_CACHE_SIZE; i++) {
+        ScalerCacheEntry *c = &scaler->cache[i];
+        if (c->ctx && c->width == src->width && c->height == src->height && c->format == src->format) {
+            c->last_used = scaler->frames;
+            entry->ptr = c->ctx;
+            return c->ctx;
+        }
+        if (scaler->cache[slot].ctx && (!c->ctx || c->last_used < scaler->cache[slot].last_used)) {
+            slot = i;
+        }
+    }
+    
+    struct SwsContext *sws_ctx = sws_getContext(src->width, src->height, src->format,
+                                                scaler->dst_width, scaler->dst_height, scaler->dst_format,
+                                                scaler->flags, NULL, NULL, NULL);
+    if (!sws_ctx) {
+        return NULL;
+    }
+    sws_freeContext(scaler->cache[slot].ctx);
+    scaler->cache[slot] = (ScalerCacheEntry){ sws_ctx, src->width, src->height, src->format, scaler->frames };
+    entry->ptr = sws_ctx;
+    return sws_ctx;
+}
+
 /**
  * Scale frame using sws context
  * @param swsContextId - Scaler context ID
- * @param srcFrameId - Source frame ID
- * @param dstFrameId - Destination frame ID
+ * @param srcFrameId - Source frame ID; its size and format may change between calls
+ * @param dstFrameId - Destination frame ID; allocated with the scaler's output size and format
+ *                   if it has no buffer yet
  */
 napi_value atomic_sws_scale(napi_env env, napi_callback_info info) {
     napi_status status;
@@ -2414,8 +3909,40 @@ napi_value atomic_sws_scale(napi_env env, napi_callback_info info) {
         napi_throw_error(env, NULL, "Invalid context or frame");
         return NULL;
     }
+    if (handle_is_busy(env, src_frame_id) || handle_is_busy(env, dst_frame_id)) {
+        return NULL;
+    }
+    
+    ContextEntry *entry = get_context_entry(sws_ctx_id);
+    ScalerState *scaler = entry->scaler;
+    sws_ctx = scaler_for_frame(entry, src_frame);
+    if (!sws_ctx) {
+        char errbuf[128];
+        snprintf(errbuf, sizeof(errbuf), "Failed to create scaler for %dx%d %s", src_frame->width,
+                 src_frame->height, av_get_pix_fmt_name(src_frame->format) ? av_get_pix_fmt_name(src_frame->format) : "none");
+        napi_throw_error(env, NULL, errbuf);
+        return NULL;
+    }
+    
+    if (!dst_frame->data[0]) {
+        dst_frame->width = scaler->dst_width;
+        dst_frame->height = scaler->dst_height;
+        dst_frame->format = scaler->dst_format;
+        int ret = frame_pool_get_buffer(dst_frame, 0);
+        if (ret < 0) {
+            char errbuf[128];
+            av_strerror(ret, errbuf, sizeof(errbuf));
+            napi_throw_error(env, NULL, errbuf);
+            return NULL;
+        }
+    } else if (dst_frame->width < scaler->dst_width || dst_frame->height < scaler->dst_height ||
+               dst_frame->format != scaler->dst_format) {
+        napi_throw_error(env, NULL, "Destination frame is smaller than the scaler output or has another format");
+        return NULL;
+    }
     
     // Perform scaling
+    int64_t start = call_latency_start();
     int ret = sws_scale(
         sws_ctx,
         (const uint8_t * const *)src_frame->data, src_frame->linesize,
@@ -2427,6 +3954,7 @@ napi_value atomic_sws_scale(napi_env env, napi_callback_info info) {
         napi_throw_error(env, NULL, "Scaling failed");
         return NULL;
     }
+    call_latency_end(entry, LATENCY_SCALE, start);
     
     // Copy frame properties
     dst_frame->pts = src_frame->pts;
@@ -2437,36 +3965,222 @@ napi_value atomic_sws_scale(napi_env env, napi_callback_info info) {
     return NULL;
 }
 
+/**
+ * Get a frame in the size and pixel format an encoder expects
+ * 
+ * Frames that already match are returned as-is, without copying. Others are converted into a
+ * frame owned by the encoder handle (freed with it), reusing its scaler while the source
+ * geometry stays the same.
+ * 
+ * @param frameId - Source video frame ID
+ * @param encoderContextId - Video encoder context ID (width, height and pix_fmt set)
+ * @returns Frame ID to send: frameId itself, or the encoder's conversion frame
+ */
+napi_value atomic_prepare_frame_for_encoder(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 2;
+    napi_value argv[2];
+    
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 2) {
+        napi_throw_error(env, NULL, "Expected frame ID and encoder context ID");
+        return NULL;
+    }
+    
+    int frame_id, encoder_ctx_id;
+    napi_get_value_int32(env, argv[0], &frame_id);
+    napi_get_value_int32(env, argv[1], &encoder_ctx_id);
+    
+    AVFrame *src = get_context_ptr(frame_id, CTX_TYPE_FRAME);
+    AVCodecContext *codec_ctx = get_context_ptr(encoder_ctx_id, CTX_TYPE_ENCODER);
+    ContextEntry *entry = get_context_entry(encoder_ctx_id);
+    if (!src || !codec_ctx || !entry) {
+        napi_throw_error(env, NULL, "Invalid frame or encoder context");
+        return NULL;
+    }
+    if (codec_is_busy(env, entry) || handle_is_busy(env, frame_id) || handle_is_busy(env, entry->convert_frame_id)) {
+        return NULL;
+    }
+    
+    napi_value result;
+    if (src->width == codec_ctx->width && src->height == codec_ctx->height &&
+        src->format == codec_ctx->pix_fmt) {
+        napi_create_int32(env, frame_id, &result);
+        return result;
+    }
+    
+    AVFrame *dst = get_context_ptr(entry->convert_frame_id, CTX_TYPE_FRAME);
+    if (!dst) {
+        dst = av_frame_alloc();
+        int id = dst ? alloc_context_id(CTX_TYPE_FRAME, dst) : -1;
+        if (id < 0) {
+            av_frame_free(&dst);
+            napi_throw_error(env, NULL, "Failed to allocate conversion frame");
+            return NULL;
+        }
+        entry->convert_frame_id = id;
+    }
+    
+    int ret;
+    if (dst->width != codec_ctx->width || dst->height != codec_ctx->height ||
+        dst->format != codec_ctx->pix_fmt || !dst->buf[0]) {
+        av_frame_unref(dst);
+        dst->width = codec_ctx->width;
+        dst->height = codec_ctx->height;
+        dst->format = codec_ctx->pix_fmt;
+        ret = frame_pool_get_buffer(dst, 0);
+    } else {
+        // The encoder may still reference the previous conversion (frame delay)
+        ret = av_frame_make_writable(dst);
+    }
+    
+    if (ret >= 0) {
+        entry->convert_sws = sws_getCachedContext(entry->convert_sws, src->width, src->height, src->format,
+                                                  dst->width, dst->height, dst->format,
+                                                  SWS_BICUBIC, NULL, NULL, NULL);
+        ret = entry->convert_sws ? 0 : AVERROR(EINVAL);
+    }
+    if (ret >= 0) {
+        ret = sws_scale(entry->convert_sws, (const uint8_t * const *)src->data, src->linesize,
+                        0, src->height, dst->data, dst->linesize);
+    }
+    if (ret >= 0) {
+        ret = av_frame_copy_props(dst, src);
+    }
+    
+    if (ret < 0) {
+        char errbuf[128];
+        av_strerror(ret, errbuf, sizeof(errbuf));
+        napi_throw_error(env, NULL, errbuf);
+        return NULL;
+    }
+    
+    napi_create_int32(env, entry->convert_frame_id, &result);
+    return result;
+}
+
 // ============================================================================
 // 10. Audio Resampling (SwrContext)
 // ============================================================================
 
+/**
+ * Parse a channel layout argument
+ * @param value - Channel count (number), layout description (string, e.g. "5.1", "FL+FR", "0x3f") or mask (BigInt)
+ * @returns 0 on success, negative AVERROR on failure
+ */
+static int parse_channel_layout(napi_env env, napi_value value, AVChannelLayout *layout) {
+    napi_valuetype type;
+    napi_typeof(env, value, &type);
+
+    if (type == napi_string) {
+        char layout_str[128];
+        size_t str_len;
+        napi_get_value_string_utf8(env, value, layout_str, sizeof(layout_str), &str_len);
+        return av_channel_layout_from_string(layout, layout_str);
+    }
+    if (type == napi_bigint) {
+        uint64_t mask;
+        bool lossless;
+        napi_get_value_bigint_uint64(env, value, &mask, &lossless);
+        if (!lossless) {
+            return AVERROR(EINVAL);
+        }
+        return av_channel_layout_from_mask(layout, mask);
+    }
+
+    int32_t channels;
+    if (napi_get_value_int32(env, value, &channels) != napi_ok || channels <= 0) {
+        return AVERROR(EINVAL);
+    }
+    av_channel_layout_default(layout, channels);
+    return 0;
+}
+
+/**
+ * Apply a JS options object to an AVOptions-enabled object
+ * @description Strings go through av_opt_set (named constants such as dither_method "triangular"),
+ *              numbers through av_opt_set_int/av_opt_set_double, booleans as 0/1; undefined values are skipped
+ * @returns 0 on success, negative AVERROR on failure (failed key copied to bad_key)
+ */
+static int apply_av_options(napi_env env, napi_value options, void *obj, char *bad_key, size_t bad_key_size) {
+    napi_value keys;
+    uint32_t key_count = 0;
+
+    if (napi_get_property_names(env, options, &keys) != napi_ok) {
+        return AVERROR(EINVAL);
+    }
+    napi_get_array_length(env, keys, &key_count);
+
+    for (uint32_t i = 0; i < key_count; i++) {
+        napi_value key_val, val;
+        napi_valuetype val_type;
+        char key[64];
+        size_t key_len;
+        int ret;
+
+        napi_get_element(env, keys, i, &key_val);
+        napi_get_value_string_utf8(env, key_val, key, sizeof(key), &key_len);
+        napi_get_property(env, options, key_val, &val);
+        napi_typeof(env, val, &val_type);
+
+        // Every option is optional; spread objects may carry keys explicitly set to undefined
+        if (val_type == napi_undefined) {
+            continue;
+        }
+        if (val_type == napi_string) {
+            char str[256];
+            size_t str_len;
+            napi_get_value_string_utf8(env, val, str, sizeof(str), &str_len);
+            ret = av_opt_set(obj, key, str, 0);
+        } else if (val_type == napi_number) {
+            double d;
+            napi_get_value_double(env, val, &d);
+            if (d == (double)(int64_t)d) {
+                ret = av_opt_set_int(obj, key, (int64_t)d, 0);
+            } else {
+                ret = av_opt_set_double(obj, key, d, 0);
+            }
+        } else if (val_type == napi_boolean) {
+            bool b;
+            napi_get_value_bool(env, val, &b);
+            ret = av_opt_set_int(obj, key, b ? 1 : 0, 0);
+        } else {
+            ret = AVERROR(EINVAL);
+        }
+
+        if (ret < 0) {
+            snprintf(bad_key, bad_key_size, "%s", key);
+            return ret;
+        }
+    }
+    return 0;
+}
+
 /**
  * Create software resample context
  * @param srcSampleRate - Source sample rate
- * @param srcChannels - Source channel count
+ * @param srcLayout - Source channel count, layout string ("5.1", "0x3f") or mask (BigInt)
  * @param srcFormat - Source sample format (string or enum value)
  * @param dstSampleRate - Destination sample rate
- * @param dstChannels - Destination channel count
+ * @param dstLayout - Destination channel count, layout string or mask
  * @param dstFormat - Destination sample format (string or enum value)
+ * @param options - Optional swr options (filter_size, phase_shift, dither_method, async, ...)
  * @returns swrContextId - Resample context ID
  */
 napi_value atomic_create_swr_context(napi_env env, napi_callback_info info) {
     napi_status status;
-    size_t argc = 6;
-    napi_value argv[6];
+    size_t argc = 7;
+    napi_value argv[7];
     
     status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
     if (status != napi_ok || argc < 6) {
-        napi_throw_error(env, NULL, "Expected srcSampleRate, srcChannels, srcFormat, dstSampleRate, dstChannels, dstFormat");
+        napi_throw_error(env, NULL, "Expected srcSampleRate, srcLayout, srcFormat, dstSampleRate, dstLayout, dstFormat");
         return NULL;
     }
     
-    int32_t src_sample_rate, src_channels, dst_sample_rate, dst_channels;
+    int32_t src_sample_rate, dst_sample_rate;
     napi_get_value_int32(env, argv[0], &src_sample_rate);
-    napi_get_value_int32(env, argv[1], &src_channels);
     napi_get_value_int32(env, argv[3], &dst_sample_rate);
-    napi_get_value_int32(env, argv[4], &dst_channels);
     
     // Parse source format
     enum AVSampleFormat src_fmt;
@@ -2506,10 +4220,17 @@ napi_value atomic_create_swr_context(napi_env env, napi_callback_info info) {
         dst_fmt = (enum AVSampleFormat)fmt_val;
     }
     
-    // Create channel layouts
-    AVChannelLayout src_ch_layout, dst_ch_layout;
-    av_channel_layout_default(&src_ch_layout, src_channels);
-    av_channel_layout_default(&dst_ch_layout, dst_channels);
+    // Parse channel layouts
+    AVChannelLayout src_ch_layout = {0}, dst_ch_layout = {0};
+    if (parse_channel_layout(env, argv[1], &src_ch_layout) < 0) {
+        napi_throw_error(env, NULL, "Invalid source channel layout");
+        return NULL;
+    }
+    if (parse_channel_layout(env, argv[4], &dst_ch_layout) < 0) {
+        av_channel_layout_uninit(&src_ch_layout);
+        napi_throw_error(env, NULL, "Invalid destination channel layout");
+        return NULL;
+    }
     
     // Create resample context
     struct SwrContext *swr_ctx = NULL;
@@ -2528,6 +4249,24 @@ napi_value atomic_create_swr_context(napi_env env, napi_callback_info info) {
         return NULL;
     }
     
+    // Apply resampler options (must happen before swr_init)
+    if (argc >= 7) {
+        napi_valuetype opts_type;
+        napi_typeof(env, argv[6], &opts_type);
+        if (opts_type == napi_object) {
+            char bad_key[64] = {0};
+            ret = apply_av_options(env, argv[6], swr_ctx, bad_key, sizeof(bad_key));
+            if (ret < 0) {
+                char errbuf[128], msg[256];
+                av_strerror(ret, errbuf, sizeof(errbuf));
+                snprintf(msg, sizeof(msg), "Invalid swr option '%s': %s", bad_key, errbuf);
+                swr_free(&swr_ctx);
+                napi_throw_error(env, NULL, msg);
+                return NULL;
+            }
+        }
+    }
+    
     // Initialize resample context
     ret = swr_init(swr_ctx);
     if (ret < 0) {
@@ -2580,6 +4319,9 @@ napi_value atomic_swr_convert_frame(napi_env env, napi_callback_info info) {
         napi_throw_error(env, NULL, "Invalid context or frame");
         return NULL;
     }
+    if (handle_is_busy(env, dst_frame_id)) {
+        return NULL;
+    }
     
     // Check if src frame is provided or if flushing
     AVFrame *src_frame = NULL;
@@ -2588,10 +4330,14 @@ napi_value atomic_swr_convert_frame(napi_env env, napi_callback_info info) {
     if (src_type != napi_null && src_type != napi_undefined) {
         int src_frame_id;
         napi_get_value_int32(env, argv[1], &src_frame_id);
+        if (handle_is_busy(env, src_frame_id)) {
+            return NULL;
+        }
         src_frame = get_context_ptr(src_frame_id, CTX_TYPE_FRAME);
     }
     
     // Perform resampling
+    int64_t start = call_latency_start();
     int ret = swr_convert_frame(swr_ctx, dst_frame, src_frame);
     if (ret < 0) {
         char errbuf[128];
@@ -2599,6 +4345,7 @@ napi_value atomic_swr_convert_frame(napi_env env, napi_callback_info info) {
         napi_throw_error(env, NULL, errbuf);
         return NULL;
     }
+    call_latency_end(get_context_entry(swr_ctx_id), LATENCY_CONVERT, start);
     
     // Copy frame properties if source is provided
     if (src_frame) {
@@ -2610,6 +4357,139 @@ napi_value atomic_swr_convert_frame(napi_env env, napi_callback_info info) {
     return result;
 }
 
+/**
+ * Collect plane pointers from a TypedArray (packed formats) or an array of TypedArrays (planar formats)
+ * @returns Samples per channel that fit in the buffers, or negative AVERROR
+ */
+static int get_sample_planes(napi_env env, napi_value value, enum AVSampleFormat fmt, int channels,
+                             uint8_t *planes[AV_NUM_DATA_POINTERS]) {
+    int bps = av_get_bytes_per_sample(fmt);
+    int planar = av_sample_fmt_is_planar(fmt);
+    int nb_planes = planar ? channels : 1;
+    int nb_samples = INT_MAX;
+    bool is_array = false;
+
+    if (bps <= 0 || nb_planes > AV_NUM_DATA_POINTERS) {
+        return AVERROR(EINVAL);
+    }
+
+    napi_is_array(env, value, &is_array);
+    if (planar != is_array) {
+        return AVERROR(EINVAL);
+    }
+
+    for (int p = 0; p < nb_planes; p++) {
+        napi_value plane = value;
+        bool is_typedarray = false;
+        void *data;
+        size_t length, byte_offset;
+        napi_typedarray_type type;
+        napi_value arraybuffer;
+
+        if (is_array) {
+            napi_get_element(env, value, p, &plane);
+        }
+        napi_is_typedarray(env, plane, &is_typedarray);
+        if (!is_typedarray) {
+            return AVERROR(EINVAL);
+        }
+        napi_get_typedarray_info(env, plane, &type, &length, &data, &arraybuffer, &byte_offset);
+
+        size_t byte_length = length;
+        switch (type) {
+        case napi_int16_array:
+        case napi_uint16_array:   byte_length *= 2; break;
+        case napi_int32_array:
+        case napi_uint32_array:
+        case napi_float32_array:  byte_length *= 4; break;
+        case napi_float64_array:
+        case napi_bigint64_array:
+        case napi_biguint64_array: byte_length *= 8; break;
+        default: break;
+        }
+
+        planes[p] = data;
+        nb_samples = FFMIN(nb_samples, (int)(byte_length / (bps * (planar ? 1 : channels))));
+    }
+    return nb_samples;
+}
+
+/**
+ * Resample raw samples between typed arrays
+ * @param swrContextId - Resample context ID
+ * @param src - Source TypedArray (packed) or array of TypedArrays (planar), or null to flush
+ * @param dst - Destination TypedArray (packed) or array of TypedArrays (planar)
+ * @returns Number of samples output per channel
+ * @description Sample counts are derived from the typed array lengths; pass subarray() views to convert less
+ */
+napi_value atomic_swr_convert(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 3;
+    napi_value argv[3];
+    
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 3) {
+        napi_throw_error(env, NULL, "Expected swr context ID, src data (or null), dst data");
+        return NULL;
+    }
+    
+    int swr_ctx_id;
+    napi_get_value_int32(env, argv[0], &swr_ctx_id);
+    
+    struct SwrContext *swr_ctx = get_context_ptr(swr_ctx_id, CTX_TYPE_SWR);
+    if (!swr_ctx) {
+        napi_throw_error(env, NULL, "Invalid swr context");
+        return NULL;
+    }
+    
+    enum AVSampleFormat in_fmt, out_fmt;
+    AVChannelLayout in_layout = {0}, out_layout = {0};
+    av_opt_get_sample_fmt(swr_ctx, "in_sample_fmt", 0, &in_fmt);
+    av_opt_get_sample_fmt(swr_ctx, "out_sample_fmt", 0, &out_fmt);
+    av_opt_get_chlayout(swr_ctx, "in_chlayout", 0, &in_layout);
+    av_opt_get_chlayout(swr_ctx, "out_chlayout", 0, &out_layout);
+    int in_channels = in_layout.nb_channels;
+    int out_channels = out_layout.nb_channels;
+    av_channel_layout_uninit(&in_layout);
+    av_channel_layout_uninit(&out_layout);
+    
+    uint8_t *in_planes[AV_NUM_DATA_POINTERS] = {0};
+    uint8_t *out_planes[AV_NUM_DATA_POINTERS] = {0};
+    int in_count = 0;
+    
+    napi_valuetype src_type;
+    napi_typeof(env, argv[1], &src_type);
+    if (src_type != napi_null && src_type != napi_undefined) {
+        in_count = get_sample_planes(env, argv[1], in_fmt, in_channels, in_planes);
+        if (in_count < 0) {
+            napi_throw_error(env, NULL, "Source must be a TypedArray for packed formats or an array of TypedArrays (one per channel) for planar formats");
+            return NULL;
+        }
+    }
+    
+    int out_count = get_sample_planes(env, argv[2], out_fmt, out_channels, out_planes);
+    if (out_count < 0) {
+        napi_throw_error(env, NULL, "Destination must be a TypedArray for packed formats or an array of TypedArrays (one per channel) for planar formats");
+        return NULL;
+    }
+    
+    int64_t start = call_latency_start();
+    int ret = swr_convert(swr_ctx, out_planes, out_count,
+                          src_type == napi_null || src_type == napi_undefined ? NULL : (const uint8_t **)in_planes,
+                          in_count);
+    if (ret < 0) {
+        char errbuf[128];
+        av_strerror(ret, errbuf, sizeof(errbuf));
+        napi_throw_error(env, NULL, errbuf);
+        return NULL;
+    }
+    call_latency_end(get_context_entry(swr_ctx_id), LATENCY_CONVERT, start);
+    
+    napi_value result;
+    napi_create_int32(env, ret, &result);
+    return result;
+}
+
 // ============================================================================
 // 11. Auxiliary Functions - Seek, Metadata, Format Query
 // ============================================================================
@@ -2820,6 +4700,9 @@ napi_value atomic_get_supported_pix_fmts(napi_env env, napi_callback_info info)
     int ctx_id;
     napi_get_value_int32(env, argv[0], &ctx_id);
     
+    if (handle_is_busy(env, ctx_id)) {
+        return NULL;
+    }
     AVCodecContext *codec_ctx = get_context_ptr(ctx_id, CTX_TYPE_ENCODER);
     if (!codec_ctx || !codec_ctx->codec) {
         napi_throw_error(env, NULL, "Invalid encoder context");
@@ -2865,6 +4748,9 @@ napi_value atomic_get_supported_sample_fmts(napi_env env, napi_callback_info inf
     int ctx_id;
     napi_get_value_int32(env, argv[0], &ctx_id);
     
+    if (handle_is_busy(env, ctx_id)) {
+        return NULL;
+    }
     AVCodecContext *codec_ctx = get_context_ptr(ctx_id, CTX_TYPE_ENCODER);
     if (!codec_ctx || !codec_ctx->codec) {
         napi_throw_error(env, NULL, "Invalid encoder context");
@@ -2910,6 +4796,9 @@ napi_value atomic_get_supported_sample_rates(napi_env env, napi_callback_info in
     int ctx_id;
     napi_get_value_int32(env, argv[0], &ctx_id);
     
+    if (handle_is_busy(env, ctx_id)) {
+        return NULL;
+    }
     AVCodecContext *codec_ctx = get_context_ptr(ctx_id, CTX_TYPE_ENCODER);
     if (!codec_ctx || !codec_ctx->codec) {
         napi_throw_error(env, NULL, "Invalid encoder context");
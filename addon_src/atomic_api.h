@@ -0,0 +1,30 @@
+/**
+ * @file atomic_api.h
+ * @brief Shared handle table access for modules built on top of atomic_api.c
+ */
+
+#ifndef FFMPEG_NODE_ATOMIC_API_H
+#define FFMPEG_NODE_ATOMIC_API_H
+
+#include <node_api.h>
+
+typedef enum {
+    CTX_TYPE_INPUT_FORMAT,
+    CTX_TYPE_OUTPUT_FORMAT,
+    CTX_TYPE_ENCODER,
+    CTX_TYPE_DECODER,
+    CTX_TYPE_FRAME,
+    CTX_TYPE_PACKET,
+    CTX_TYPE_SWS,
+    CTX_TYPE_SWR
+} ContextType;
+
+// Look up a context pointer by handle ID; returns NULL if the ID is unknown or of another type
+void* get_context_ptr(int id, ContextType expected_type);
+
+// Returns 1 and throws when the handle (codec context, frame or packet) is in use by a pending
+// codecTransfer, whose thread-pool work owns it until the promise settles; check it before
+// dereferencing the handle. With a NULL env it only tests (JS thread)
+int handle_is_busy(napi_env env, int id);
+
+#endif // FFMPEG_NODE_ATOMIC_API_H
@@ -13,6 +13,9 @@
 #include "libavutil/samplefmt.h"
 #include "libavformat/avformat.h"
 
+#include "atomic_api.h"
+#include "audio_fifo.h"
+
 // ============================================================================
 // Context Management for AudioFIFO
 // ============================================================================
@@ -69,13 +72,20 @@ static void free_audio_fifo_id(int id) {
     }
 }
 
-// ============================================================================
-// External context access (for getting frames from atomic_api.c)
-// ============================================================================
-
-// These functions are defined in atomic_api.c
-extern void* get_context_ptr(int id, int expected_type);
-#define CTX_TYPE_FRAME 4  // Must match the enum value in atomic_api.c
+// Get AudioFIFO pointer (exported via audio_fifo.h)
+AVAudioFifo* get_audio_fifo_ptr(int id, enum AVSampleFormat *sample_fmt, int *channels) {
+    AudioFIFOEntry *entry = get_audio_fifo_entry(id);
+    if (!entry) {
+        return NULL;
+    }
+    if (sample_fmt) {
+        *sample_fmt = entry->sample_fmt;
+    }
+    if (channels) {
+        *channels = entry->channels;
+    }
+    return entry->fifo;
+}
 
 // ============================================================================
 // AudioFIFO API Implementation
@@ -186,6 +196,9 @@ napi_value audio_fifo_write(napi_env env, napi_callback_info info) {
         napi_throw_error(env, NULL, "Invalid frame ID");
         return NULL;
     }
+    if (handle_is_busy(env, frame_id)) {
+        return NULL;
+    }
     
     // Reallocate FIFO if needed
     int required_size = av_audio_fifo_size(entry->fifo) + frame->nb_samples;
@@ -241,6 +254,9 @@ napi_value audio_fifo_read(napi_env env, napi_callback_info info) {
         napi_throw_error(env, NULL, "Invalid frame ID");
         return NULL;
     }
+    if (handle_is_busy(env, frame_id)) {
+        return NULL;
+    }
     
     // Check if there are enough samples
     int available = av_audio_fifo_size(entry->fifo);
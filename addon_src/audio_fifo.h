@@ -0,0 +1,15 @@
+/**
+ * @file audio_fifo.h
+ * @brief AudioFIFO handle access for other native modules
+ */
+
+#ifndef FFMPEG_NODE_AUDIO_FIFO_H
+#define FFMPEG_NODE_AUDIO_FIFO_H
+
+#include "libavutil/audio_fifo.h"
+#include "libavutil/samplefmt.h"
+
+// Look up an AudioFIFO by handle ID; sample_fmt/channels are optional outputs
+AVAudioFifo* get_audio_fifo_ptr(int id, enum AVSampleFormat *sample_fmt, int *channels);
+
+#endif // FFMPEG_NODE_AUDIO_FIFO_H
@@ -0,0 +1,663 @@
+/**
+ * @file audio_mixer.c
+ * @brief AudioMixer API - Native N-input audio mixing with per-input gain and sidechain ducking
+ * @description Inputs are fed with frames (aligned by pts) or pulled from AudioFIFO handles;
+ *              output is planar float frames on a continuous sample timeline
+ */
+
+#include <node_api.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/audio_fifo.h"
+#include "libavutil/channel_layout.h"
+#include "libavutil/float_dsp.h"
+#include "libavutil/frame.h"
+#include "libavutil/mem.h"
+#include "libavutil/samplefmt.h"
+
+#include "atomic_api.h"
+#include "audio_fifo.h"
+#include "frame_pool.h"
+
+// ============================================================================
+// Context Management for AudioMixer
+// ============================================================================
+
+#define MAX_AUDIO_MIXERS 64
+#define MAX_MIXER_INPUTS 16
+
+// Longest gap (in seconds) that is filled with silence when a frame pts jumps ahead
+#define MAX_PTS_GAP_SECONDS 60
+
+typedef struct {
+    int active;
+    int ended;
+
+    // Sample source: either a private FIFO fed by sendFrame, or an external AudioFIFO handle
+    AVAudioFifo *fifo;
+    int external_fifo_id;
+
+    float gain;
+
+    // Sidechain ducking
+    int duck_source;        // Input index whose level ducks this input, -1 if none
+    float duck_threshold;   // Linear RMS level that triggers ducking
+    float duck_gain;        // Gain multiplier while ducked
+    float duck_attack_ms;
+    float duck_release_ms;
+    float duck_env;         // Smoothed ducking multiplier (1.0 = not ducked)
+
+    float applied_gain;     // Gain at the end of the previous block, start of the next ramp
+    float level;            // RMS of the current block after user gain
+
+    float **buf;            // Per-channel scratch, FFALIGN(frame_size, 16) floats each
+} MixerInput;
+
+typedef struct {
+    int id;
+    int in_use;
+
+    int sample_rate;
+    int channels;
+    int frame_size;
+    int aligned_size;
+    AVChannelLayout ch_layout;
+
+    MixerInput inputs[MAX_MIXER_INPUTS];
+    int nb_inputs;
+
+    int64_t out_pts;        // Timeline position of the next output sample (time base 1/sample_rate)
+
+    AVFloatDSPContext *fdsp;
+    float **acc;
+    float *silence;
+} AudioMixerEntry;
+
+static AudioMixerEntry audio_mixer_table[MAX_AUDIO_MIXERS] = {0};
+static int next_mixer_id = 1;
+
+static float **alloc_planes(int channels, int size) {
+    float **planes = av_calloc(channels, sizeof(*planes));
+    if (!planes) {
+        return NULL;
+    }
+    for (int c = 0; c < channels; c++) {
+        planes[c] = av_calloc(size, sizeof(float));
+        if (!planes[c]) {
+            for (int i = 0; i < c; i++) {
+                av_free(planes[i]);
+            }
+            av_free(planes);
+            return NULL;
+        }
+    }
+    return planes;
+}
+
+static void free_planes(float ***planes, int channels) {
+    if (!*planes) {
+        return;
+    }
+    for (int c = 0; c < channels; c++) {
+        av_free((*planes)[c]);
+    }
+    av_freep(planes);
+}
+
+static AudioMixerEntry* get_audio_mixer_entry(int id) {
+    for (int i = 0; i < MAX_AUDIO_MIXERS; i++) {
+        if (audio_mixer_table[i].in_use && audio_mixer_table[i].id == id) {
+            return &audio_mixer_table[i];
+        }
+    }
+    return NULL;
+}
+
+static void free_audio_mixer_entry(AudioMixerEntry *m) {
+    for (int i = 0; i < m->nb_inputs; i++) {
+        MixerInput *in = &m->inputs[i];
+        if (!in->external_fifo_id) {
+            av_audio_fifo_free(in->fifo);
+        }
+        free_planes(&in->buf, m->channels);
+    }
+    free_planes(&m->acc, m->channels);
+    av_freep(&m->silence);
+    av_freep(&m->fdsp);
+    av_channel_layout_uninit(&m->ch_layout);
+    memset(m, 0, sizeof(*m));
+}
+
+// Resolve the sample source of an input; external FIFOs are looked up on every use
+// so that freeing the AudioFIFO handle simply ends the input
+static AVAudioFifo* mixer_input_fifo(MixerInput *in) {
+    if (in->external_fifo_id) {
+        return get_audio_fifo_ptr(in->external_fifo_id, NULL, NULL);
+    }
+    return in->fifo;
+}
+
+// ============================================================================
+// Mixing kernels
+// ============================================================================
+
+// dst += src * (g0 + step * i); written so the compiler can vectorize it
+static void mix_gain_ramp(float * restrict dst, const float * restrict src, float g0, float step, int len) {
+    for (int i = 0; i < len; i++) {
+        dst[i] += src[i] * (g0 + step * (float)i);
+    }
+}
+
+static float smoothing_coef(float time_ms, int nb_samples, int sample_rate) {
+    if (time_ms <= 0.0f) {
+        return 0.0f;
+    }
+    return expf(-(float)nb_samples / (time_ms * 0.001f * (float)sample_rate));
+}
+
+// ============================================================================
+// AudioMixer API Implementation
+// ============================================================================
+
+static int get_int_option(napi_env env, napi_value obj, const char *name, int32_t *out) {
+    bool has = false;
+    napi_value val;
+    napi_valuetype type;
+
+    if (napi_has_named_property(env, obj, name, &has) != napi_ok || !has) {
+        return 0;
+    }
+    napi_get_named_property(env, obj, name, &val);
+    napi_typeof(env, val, &type);
+    if (type != napi_number) {
+        return 0;
+    }
+    napi_get_value_int32(env, val, out);
+    return 1;
+}
+
+static int get_float_option(napi_env env, napi_value obj, const char *name, float *out) {
+    bool has = false;
+    napi_value val;
+    napi_valuetype type;
+    double d;
+
+    if (napi_has_named_property(env, obj, name, &has) != napi_ok || !has) {
+        return 0;
+    }
+    napi_get_named_property(env, obj, name, &val);
+    napi_typeof(env, val, &type);
+    if (type != napi_number) {
+        return 0;
+    }
+    napi_get_value_double(env, val, &d);
+    *out = (float)d;
+    return 1;
+}
+
+/**
+ * Create an audio mixer
+ * @param sampleRate - Sample rate of all inputs and the output
+ * @param channels - Channel count of all inputs and the output
+ * @param frameSize - Samples per output frame (e.g. 1024 for AAC)
+ * @returns mixerId - AudioMixer handle ID
+ */
+napi_value audio_mixer_create(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 3;
+    napi_value argv[3];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 3) {
+        napi_throw_error(env, NULL, "Expected sampleRate, channels, and frameSize");
+        return NULL;
+    }
+
+    int32_t sample_rate, channels, frame_size;
+    napi_get_value_int32(env, argv[0], &sample_rate);
+    napi_get_value_int32(env, argv[1], &channels);
+    napi_get_value_int32(env, argv[2], &frame_size);
+
+    if (sample_rate <= 0 || channels <= 0 || channels > AV_NUM_DATA_POINTERS || frame_size <= 0) {
+        napi_throw_error(env, NULL, "Invalid mixer parameters");
+        return NULL;
+    }
+
+    AudioMixerEntry *m = NULL;
+    for (int i = 0; i < MAX_AUDIO_MIXERS; i++) {
+        if (!audio_mixer_table[i].in_use) {
+            m = &audio_mixer_table[i];
+            break;
+        }
+    }
+    if (!m) {
+        napi_throw_error(env, NULL, "Too many AudioMixer contexts");
+        return NULL;
+    }
+
+    memset(m, 0, sizeof(*m));
+    m->sample_rate = sample_rate;
+    m->channels = channels;
+    m->frame_size = frame_size;
+    // AVFloatDSPContext kernels require lengths that are a multiple of 16
+    m->aligned_size = FFALIGN(frame_size, 16);
+    av_channel_layout_default(&m->ch_layout, channels);
+
+    m->fdsp = avpriv_float_dsp_alloc(0);
+    m->acc = alloc_planes(channels, m->aligned_size);
+    m->silence = av_calloc(frame_size, sizeof(float));
+    if (!m->fdsp || !m->acc || !m->silence) {
+        free_audio_mixer_entry(m);
+        napi_throw_error(env, NULL, "Failed to allocate AudioMixer");
+        return NULL;
+    }
+
+    m->id = next_mixer_id++;
+    m->in_use = 1;
+
+    napi_value result;
+    napi_create_int32(env, m->id, &result);
+    return result;
+}
+
+/**
+ * Add an input to the mixer
+ * @param mixerId - AudioMixer ID
+ * @param options - { gain, fifoId, duckBy, duckThreshold, duckGain, duckAttack, duckRelease }
+ * @returns input index
+ */
+napi_value audio_mixer_add_input(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 2;
+    napi_value argv[2];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected mixer ID");
+        return NULL;
+    }
+
+    int mixer_id;
+    napi_get_value_int32(env, argv[0], &mixer_id);
+
+    AudioMixerEntry *m = get_audio_mixer_entry(mixer_id);
+    if (!m) {
+        napi_throw_error(env, NULL, "Invalid AudioMixer ID");
+        return NULL;
+    }
+    if (m->nb_inputs >= MAX_MIXER_INPUTS) {
+        napi_throw_error(env, NULL, "Too many mixer inputs");
+        return NULL;
+    }
+
+    int32_t fifo_id = 0, duck_by = -1;
+    float gain = 1.0f;
+    float duck_threshold = 0.05f, duck_gain = 0.25f, duck_attack = 20.0f, duck_release = 300.0f;
+
+    if (argc >= 2) {
+        napi_valuetype valuetype;
+        napi_typeof(env, argv[1], &valuetype);
+        if (valuetype == napi_object) {
+            get_float_option(env, argv[1], "gain", &gain);
+            get_int_option(env, argv[1], "fifoId", &fifo_id);
+            get_int_option(env, argv[1], "duckBy", &duck_by);
+            get_float_option(env, argv[1], "duckThreshold", &duck_threshold);
+            get_float_option(env, argv[1], "duckGain", &duck_gain);
+            get_float_option(env, argv[1], "duckAttack", &duck_attack);
+            get_float_option(env, argv[1], "duckRelease", &duck_release);
+        }
+    }
+
+    int index = m->nb_inputs;
+    if (duck_by >= index || duck_by < -1) {
+        napi_throw_error(env, NULL, "duckBy must reference a previously added input");
+        return NULL;
+    }
+
+    MixerInput *in = &m->inputs[index];
+    memset(in, 0, sizeof(*in));
+
+    if (fifo_id > 0) {
+        enum AVSampleFormat fmt;
+        int channels;
+        if (!get_audio_fifo_ptr(fifo_id, &fmt, &channels)) {
+            napi_throw_error(env, NULL, "Invalid AudioFIFO ID");
+            return NULL;
+        }
+        if (fmt != AV_SAMPLE_FMT_FLTP || channels != m->channels) {
+            napi_throw_error(env, NULL, "AudioFIFO must be fltp with the mixer channel count");
+            return NULL;
+        }
+        in->external_fifo_id = fifo_id;
+    } else {
+        in->fifo = av_audio_fifo_alloc(AV_SAMPLE_FMT_FLTP, m->channels, m->frame_size * 2);
+        if (!in->fifo) {
+            napi_throw_error(env, NULL, "Failed to allocate mixer input");
+            return NULL;
+        }
+    }
+
+    in->buf = alloc_planes(m->channels, m->aligned_size);
+    if (!in->buf) {
+        if (!in->external_fifo_id) {
+            av_audio_fifo_free(in->fifo);
+        }
+        memset(in, 0, sizeof(*in));
+        napi_throw_error(env, NULL, "Failed to allocate mixer input");
+        return NULL;
+    }
+
+    in->active = 1;
+    in->gain = gain;
+    in->applied_gain = gain;
+    in->duck_source = duck_by;
+    in->duck_threshold = duck_threshold;
+    in->duck_gain = duck_gain;
+    in->duck_attack_ms = duck_attack;
+    in->duck_release_ms = duck_release;
+    in->duck_env = 1.0f;
+    m->nb_inputs++;
+
+    napi_value result;
+    napi_create_int32(env, index, &result);
+    return result;
+}
+
+/**
+ * Set the gain of a mixer input (ramped over the next output frame)
+ * @param mixerId - AudioMixer ID
+ * @param inputIndex - Input index
+ * @param gain - Linear gain
+ */
+napi_value audio_mixer_set_gain(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 3;
+    napi_value argv[3];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 3) {
+        napi_throw_error(env, NULL, "Expected mixer ID, input index, and gain");
+        return NULL;
+    }
+
+    int mixer_id, index;
+    double gain;
+    napi_get_value_int32(env, argv[0], &mixer_id);
+    napi_get_value_int32(env, argv[1], &index);
+    napi_get_value_double(env, argv[2], &gain);
+
+    AudioMixerEntry *m = get_audio_mixer_entry(mixer_id);
+    if (!m || index < 0 || index >= m->nb_inputs) {
+        napi_throw_error(env, NULL, "Invalid AudioMixer ID or input index");
+        return NULL;
+    }
+
+    m->inputs[index].gain = (float)gain;
+    return NULL;
+}
+
+/**
+ * Send a frame to a mixer input
+ * @param mixerId - AudioMixer ID
+ * @param inputIndex - Input index
+ * @param frameId - fltp frame at the mixer rate/channels, pts in 1/sampleRate; null ends the input
+ * @description Gaps in pts are filled with silence and overlapping samples are dropped,
+ *              frames without pts are appended contiguously
+ */
+napi_value audio_mixer_send_frame(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 3;
+    napi_value argv[3];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 3) {
+        napi_throw_error(env, NULL, "Expected mixer ID, input index, and frame ID");
+        return NULL;
+    }
+
+    int mixer_id, index;
+    napi_get_value_int32(env, argv[0], &mixer_id);
+    napi_get_value_int32(env, argv[1], &index);
+
+    AudioMixerEntry *m = get_audio_mixer_entry(mixer_id);
+    if (!m || index < 0 || index >= m->nb_inputs) {
+        napi_throw_error(env, NULL, "Invalid AudioMixer ID or input index");
+        return NULL;
+    }
+    MixerInput *in = &m->inputs[index];
+
+    napi_valuetype valuetype;
+    napi_typeof(env, argv[2], &valuetype);
+    if (valuetype == napi_null || valuetype == napi_undefined) {
+        in->ended = 1;
+        return NULL;
+    }
+
+    if (in->external_fifo_id) {
+        napi_throw_error(env, NULL, "Input reads from an AudioFIFO; write to the FIFO instead");
+        return NULL;
+    }
+    if (in->ended) {
+        napi_throw_error(env, NULL, "Mixer input already ended");
+        return NULL;
+    }
+
+    int frame_id;
+    napi_get_value_int32(env, argv[2], &frame_id);
+    AVFrame *frame = (AVFrame*)get_context_ptr(frame_id, CTX_TYPE_FRAME);
+    if (!frame) {
+        napi_throw_error(env, NULL, "Invalid frame ID");
+        return NULL;
+    }
+    if (handle_is_busy(env, frame_id)) {
+        return NULL;
+    }
+    if (frame->format != AV_SAMPLE_FMT_FLTP ||
+        frame->sample_rate != m->sample_rate ||
+        frame->ch_layout.nb_channels != m->channels) {
+        napi_throw_error(env, NULL, "Frame must be fltp at the mixer sample rate and channel count");
+        return NULL;
+    }
+
+    int skip = 0;
+    if (frame->pts != AV_NOPTS_VALUE) {
+        int64_t write_pos = m->out_pts + av_audio_fifo_size(in->fifo);
+        int64_t gap = frame->pts - write_pos;
+
+        if (gap > (int64_t)m->sample_rate * MAX_PTS_GAP_SECONDS) {
+            napi_throw_error(env, NULL, "Frame pts jumps too far ahead of the mixer timeline");
+            return NULL;
+        }
+        while (gap > 0) {
+            int n = (int)FFMIN(gap, m->frame_size);
+            void *planes[AV_NUM_DATA_POINTERS];
+            for (int c = 0; c < m->channels; c++) {
+                planes[c] = m->silence;
+            }
+            if (av_audio_fifo_write(in->fifo, planes, n) < 0) {
+                napi_throw_error(env, NULL, "Failed to write to mixer input");
+                return NULL;
+            }
+            gap -= n;
+        }
+        if (gap < 0) {
+            skip = (int)FFMIN(-gap, frame->nb_samples);
+        }
+    }
+
+    if (skip < frame->nb_samples) {
+        void *planes[AV_NUM_DATA_POINTERS];
+        for (int c = 0; c < m->channels; c++) {
+            planes[c] = (float*)frame->extended_data[c] + skip;
+        }
+        if (av_audio_fifo_write(in->fifo, planes, frame->nb_samples - skip) < 0) {
+            napi_throw_error(env, NULL, "Failed to write to mixer input");
+            return NULL;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Mix the next output frame
+ * @param mixerId - AudioMixer ID
+ * @param frameId - Destination frame (reallocated as fltp, frameSize samples)
+ * @returns 0 on success, -1 if an input needs more data (EAGAIN), -2 when all inputs ended (EOF)
+ */
+napi_value audio_mixer_receive_frame(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 2;
+    napi_value argv[2];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 2) {
+        napi_throw_error(env, NULL, "Expected mixer ID and frame ID");
+        return NULL;
+    }
+
+    int mixer_id, frame_id;
+    napi_get_value_int32(env, argv[0], &mixer_id);
+    napi_get_value_int32(env, argv[1], &frame_id);
+
+    AudioMixerEntry *m = get_audio_mixer_entry(mixer_id);
+    if (!m) {
+        napi_throw_error(env, NULL, "Invalid AudioMixer ID");
+        return NULL;
+    }
+    AVFrame *dst = (AVFrame*)get_context_ptr(frame_id, CTX_TYPE_FRAME);
+    if (!dst) {
+        napi_throw_error(env, NULL, "Invalid frame ID");
+        return NULL;
+    }
+    if (handle_is_busy(env, frame_id)) {
+        return NULL;
+    }
+
+    napi_value result;
+
+    // Every live input must have a full frame buffered; ended inputs contribute what they have
+    int nb_samples = 0, all_ended = 1;
+    for (int i = 0; i < m->nb_inputs; i++) {
+        MixerInput *in = &m->inputs[i];
+        AVAudioFifo *fifo = mixer_input_fifo(in);
+        int avail = fifo ? av_audio_fifo_size(fifo) : 0;
+
+        if (!fifo) {
+            in->ended = 1;
+        }
+        if (!in->ended) {
+            all_ended = 0;
+            if (avail < m->frame_size) {
+                napi_create_int32(env, -1, &result);
+                return result;
+            }
+        }
+        nb_samples = FFMAX(nb_samples, FFMIN(avail, m->frame_size));
+    }
+    if (!all_ended) {
+        nb_samples = m->frame_size;
+    } else if (nb_samples == 0) {
+        napi_create_int32(env, -2, &result);
+        return result;
+    }
+
+    // Pass 1: pull samples and measure post-gain levels for sidechain ducking
+    for (int i = 0; i < m->nb_inputs; i++) {
+        MixerInput *in = &m->inputs[i];
+        AVAudioFifo *fifo = mixer_input_fifo(in);
+        int got = 0;
+
+        if (fifo) {
+            got = av_audio_fifo_read(fifo, (void**)in->buf, nb_samples);
+            if (got < 0) {
+                got = 0;
+            }
+        }
+
+        float energy = 0.0f;
+        for (int c = 0; c < m->channels; c++) {
+            memset(in->buf[c] + got, 0, (m->aligned_size - got) * sizeof(float));
+            energy += m->fdsp->scalarproduct_float(in->buf[c], in->buf[c], m->aligned_size);
+        }
+        in->level = sqrtf(energy / (float)(nb_samples * m->channels)) * fabsf(in->gain);
+    }
+
+    // Pass 2: smooth ducking envelopes and accumulate
+    for (int c = 0; c < m->channels; c++) {
+        memset(m->acc[c], 0, m->aligned_size * sizeof(float));
+    }
+    for (int i = 0; i < m->nb_inputs; i++) {
+        MixerInput *in = &m->inputs[i];
+
+        if (in->duck_source >= 0) {
+            float target = m->inputs[in->duck_source].level > in->duck_threshold ? in->duck_gain : 1.0f;
+            float time_ms = target < in->duck_env ? in->duck_attack_ms : in->duck_release_ms;
+            float coef = smoothing_coef(time_ms, nb_samples, m->sample_rate);
+            in->duck_env = target + (in->duck_env - target) * coef;
+        }
+
+        float g0 = in->applied_gain;
+        float g1 = in->gain * in->duck_env;
+
+        for (int c = 0; c < m->channels; c++) {
+            if (g0 == g1) {
+                m->fdsp->vector_fmac_scalar(m->acc[c], in->buf[c], g1, m->aligned_size);
+            } else {
+                mix_gain_ramp(m->acc[c], in->buf[c], g0, (g1 - g0) / (float)nb_samples, nb_samples);
+            }
+        }
+        in->applied_gain = g1;
+    }
+
+    av_frame_unref(dst);
+    dst->format = AV_SAMPLE_FMT_FLTP;
+    dst->nb_samples = nb_samples;
+    dst->sample_rate = m->sample_rate;
+    av_channel_layout_copy(&dst->ch_layout, &m->ch_layout);
+    int ret = frame_pool_get_buffer(dst, 0);
+    if (ret < 0) {
+        char errbuf[128];
+        av_strerror(ret, errbuf, sizeof(errbuf));
+        napi_throw_error(env, NULL, errbuf);
+        return NULL;
+    }
+    for (int c = 0; c < m->channels; c++) {
+        memcpy(dst->extended_data[c], m->acc[c], nb_samples * sizeof(float));
+    }
+    dst->pts = m->out_pts;
+    dst->time_base = (AVRational){1, m->sample_rate};
+    m->out_pts += nb_samples;
+
+    napi_create_int32(env, 0, &result);
+    return result;
+}
+
+/**
+ * Free an audio mixer
+ * @param mixerId - AudioMixer ID
+ * @description External AudioFIFO inputs are not freed
+ */
+napi_value audio_mixer_free(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 1;
+    napi_value argv[1];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected mixer ID");
+        return NULL;
+    }
+
+    int mixer_id;
+    napi_get_value_int32(env, argv[0], &mixer_id);
+
+    AudioMixerEntry *m = get_audio_mixer_entry(mixer_id);
+    if (m) {
+        free_audio_mixer_entry(m);
+    }
+
+    return NULL;
+}
@@ -0,0 +1,798 @@
+/**
+ * @file audio_stream.c
+ * @brief Streaming PCM decode - Decodes an audio stream into fixed-size interleaved PCM chunks
+ * @description Demuxing, decoding, resampling and chunking run natively on the libuv thread pool;
+ *              JavaScript receives Float32Array/Int16Array chunks backed by pooled native buffers
+ */
+
+#include <node_api.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavformat/avformat.h"
+#include "libavcodec/avcodec.h"
+#include "libavutil/audio_fifo.h"
+#include "libavutil/channel_layout.h"
+#include "libavutil/samplefmt.h"
+#include "libavutil/thread.h"
+#include "libswresample/swresample.h"
+
+#include "memory_budget.h"
+
+// ============================================================================
+// Chunk Buffer Pool - Chunk memory is handed to JS as external ArrayBuffers
+// and returned to the pool by the GC finalizer. With a memory budget, a chunk
+// is charged only while it is being filled; once JS owns it, the charge is gone
+// ============================================================================
+
+#define MAX_POOLED_CHUNKS 8
+
+typedef struct PcmChunk {
+    struct PcmChunk *next;
+    struct PcmChunkPool *pool;
+    uint8_t *data;
+} PcmChunk;
+
+typedef struct PcmChunkPool {
+    pthread_mutex_t lock;
+    PcmChunk *free_list;
+    int nb_free;
+    int outstanding;   // Chunks currently owned by JS typed arrays
+    int closed;        // Owning stream was closed; free pool once outstanding hits 0
+    size_t chunk_bytes;
+} PcmChunkPool;
+
+static PcmChunkPool *pcm_pool_alloc(size_t chunk_bytes) {
+    PcmChunkPool *pool = av_mallocz(sizeof(*pool));
+    if (!pool) {
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pool->chunk_bytes = chunk_bytes;
+    return pool;
+}
+
+static void pcm_chunk_free(PcmChunk *chunk) {
+    av_free(chunk->data);
+    av_free(chunk);
+}
+
+static void pcm_pool_destroy(PcmChunkPool *pool) {
+    PcmChunk *chunk = pool->free_list;
+    while (chunk) {
+        PcmChunk *next = chunk->next;
+        pcm_chunk_free(chunk);
+        chunk = next;
+    }
+    pthread_mutex_destroy(&pool->lock);
+    av_free(pool);
+}
+
+// Take a chunk from the pool (allocating when empty); may be called from a worker thread
+static PcmChunk *pcm_pool_get(PcmChunkPool *pool) {
+    PcmChunk *chunk = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->free_list) {
+        chunk = pool->free_list;
+        pool->free_list = chunk->next;
+        pool->nb_free--;
+    }
+    if (chunk) {
+        pool->outstanding++;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    if (chunk) {
+        chunk->next = NULL;
+        return chunk;
+    }
+
+    chunk = av_mallocz(sizeof(*chunk));
+    if (chunk) {
+        chunk->data = av_malloc(pool->chunk_bytes);
+    }
+    if (!chunk || !chunk->data) {
+        av_free(chunk);
+        return NULL;
+    }
+    chunk->pool = pool;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->outstanding++;
+    pthread_mutex_unlock(&pool->lock);
+    return chunk;
+}
+
+// Return a chunk to the pool; frees the pool itself when it was closed and this was the last chunk
+static void pcm_pool_put(PcmChunk *chunk) {
+    PcmChunkPool *pool = chunk->pool;
+    int destroy = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->outstanding--;
+    if (!pool->closed && pool->nb_free < MAX_POOLED_CHUNKS) {
+        chunk->next = pool->free_list;
+        pool->free_list = chunk;
+        pool->nb_free++;
+        chunk = NULL;
+    }
+    destroy = pool->closed && pool->outstanding == 0;
+    pthread_mutex_unlock(&pool->lock);
+
+    if (chunk) {
+        pcm_chunk_free(chunk);
+    }
+    if (destroy) {
+        pcm_pool_destroy(pool);
+    }
+}
+
+static void pcm_pool_close(PcmChunkPool *pool) {
+    int destroy;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->closed = 1;
+    destroy = pool->outstanding == 0;
+    pthread_mutex_unlock(&pool->lock);
+
+    if (destroy) {
+        pcm_pool_destroy(pool);
+    }
+}
+
+static void pcm_chunk_finalize(napi_env env, void *data, void *hint) {
+    (void)env;
+    (void)data;
+    pcm_pool_put((PcmChunk *)hint);
+}
+
+// ============================================================================
+// Context Management for audio stream readers
+// ============================================================================
+
+#define MAX_AUDIO_STREAMS 256
+
+typedef struct {
+    int id;
+    int in_use;
+
+    AVFormatContext *fmt_ctx;
+    AVCodecContext *dec_ctx;
+    int stream_idx;
+    AVPacket *pkt;
+    AVFrame *frame;
+
+    // Resampler, rebuilt whenever the decoded frame parameters change
+    struct SwrContext *swr;
+    int swr_in_rate;
+    enum AVSampleFormat swr_in_fmt;
+    AVChannelLayout swr_in_layout;
+    uint8_t *convert_buf;
+    int convert_buf_samples;
+
+    // Output configuration (always interleaved)
+    AVChannelLayout out_layout;
+    enum AVSampleFormat out_fmt;
+    int out_rate;
+    int chunk_samples;
+
+    AVAudioFifo *fifo;
+    PcmChunkPool *pool;
+    MemoryBudget *budget;
+    int64_t fifo_charged;  // FIFO bytes charged to the budget
+    int chunk_charged;     // The pending read's chunk is charged to the budget
+
+    int demux_eof;
+    int drained;
+
+    // Pending read state
+    int busy;
+    int close_pending;
+    int budget_wait;       // Waiting on the JS thread for room in the memory budget
+    napi_deferred deferred;
+    napi_async_work work;
+    PcmChunk *result_chunk;
+    int result_samples;
+    int result_error;
+} AudioStreamEntry;
+
+static AudioStreamEntry audio_stream_table[MAX_AUDIO_STREAMS] = {0};
+static int next_audio_stream_id = 1;
+
+static AudioStreamEntry* alloc_audio_stream_entry(void) {
+    for (int i = 0; i < MAX_AUDIO_STREAMS; i++) {
+        if (!audio_stream_table[i].in_use) {
+            memset(&audio_stream_table[i], 0, sizeof(audio_stream_table[i]));
+            audio_stream_table[i].id = next_audio_stream_id++;
+            audio_stream_table[i].in_use = 1;
+            return &audio_stream_table[i];
+        }
+    }
+    return NULL;
+}
+
+static AudioStreamEntry* get_audio_stream_entry(int id) {
+    for (int i = 0; i < MAX_AUDIO_STREAMS; i++) {
+        if (audio_stream_table[i].in_use && audio_stream_table[i].id == id) {
+            return &audio_stream_table[i];
+        }
+    }
+    return NULL;
+}
+
+static void free_audio_stream_entry(AudioStreamEntry *s) {
+    if (s->pool) {
+        pcm_pool_close(s->pool);
+    }
+    if (s->budget) {
+        memory_budget_release(s->budget, s->fifo_charged);
+        memory_budget_unref(&s->budget);
+    }
+    av_audio_fifo_free(s->fifo);
+    av_freep(&s->convert_buf);
+    swr_free(&s->swr);
+    av_channel_layout_uninit(&s->swr_in_layout);
+    av_channel_layout_uninit(&s->out_layout);
+    av_frame_free(&s->frame);
+    av_packet_free(&s->pkt);
+    avcodec_free_context(&s->dec_ctx);
+    avformat_close_input(&s->fmt_ctx);
+    memset(s, 0, sizeof(*s));
+}
+
+// ============================================================================
+// Decode / Resample / Chunk (runs on the thread pool)
+// ============================================================================
+
+static int audio_stream_setup_swr(AudioStreamEntry *s, const AVFrame *frame) {
+    if (s->swr &&
+        s->swr_in_rate == frame->sample_rate &&
+        s->swr_in_fmt == (enum AVSampleFormat)frame->format &&
+        !av_channel_layout_compare(&s->swr_in_layout, &frame->ch_layout)) {
+        return 0;
+    }
+
+    swr_free(&s->swr);
+    av_channel_layout_uninit(&s->swr_in_layout);
+
+    int ret = swr_alloc_set_opts2(&s->swr,
+        &s->out_layout, s->out_fmt, s->out_rate,
+        &frame->ch_layout, (enum AVSampleFormat)frame->format, frame->sample_rate,
+        0, NULL);
+    if (ret < 0) {
+        return ret;
+    }
+    ret = swr_init(s->swr);
+    if (ret < 0) {
+        swr_free(&s->swr);
+        return ret;
+    }
+
+    s->swr_in_rate = frame->sample_rate;
+    s->swr_in_fmt = (enum AVSampleFormat)frame->format;
+    return av_channel_layout_copy(&s->swr_in_layout, &frame->ch_layout);
+}
+
+// Grow the FIFO ahead of a write and charge the growth to the memory budget; decoded audio cannot
+// be refused at this point, so the next read waits for the budget instead
+static int audio_stream_reserve_fifo(AudioStreamEntry *s, int nb_samples) {
+    int size = av_audio_fifo_size(s->fifo);
+    int capacity = size + av_audio_fifo_space(s->fifo);
+    int needed = FFMAX(capacity, size + nb_samples);
+    int64_t bytes = (int64_t)needed * s->out_layout.nb_channels * av_get_bytes_per_sample(s->out_fmt);
+
+    if (bytes > s->fifo_charged) {
+        memory_budget_charge(s->budget, bytes - s->fifo_charged);
+        s->fifo_charged = bytes;
+    }
+    return needed > capacity ? av_audio_fifo_realloc(s->fifo, needed) : 0;
+}
+
+// Resample (frame may be NULL to flush) and append the output to the FIFO
+static int audio_stream_convert(AudioStreamEntry *s, const AVFrame *frame) {
+    if (!s->swr) {
+        return 0;
+    }
+
+    int in_samples = frame ? frame->nb_samples : 0;
+    int out_samples = swr_get_out_samples(s->swr, in_samples);
+    if (out_samples <= 0) {
+        return 0;
+    }
+
+    if (out_samples > s->convert_buf_samples) {
+        int size = av_samples_get_buffer_size(NULL, s->out_layout.nb_channels, out_samples, s->out_fmt, 1);
+        if (size < 0) {
+            return size;
+        }
+        av_freep(&s->convert_buf);
+        s->convert_buf = av_malloc(size);
+        if (!s->convert_buf) {
+            s->convert_buf_samples = 0;
+            return AVERROR(ENOMEM);
+        }
+        s->convert_buf_samples = out_samples;
+    }
+
+    int ret = swr_convert(s->swr, &s->convert_buf, out_samples,
+                          frame ? (const uint8_t * const *)frame->extended_data : NULL, in_samples);
+    if (ret <= 0) {
+        return ret;
+    }
+
+    if (s->budget) {
+        int err = audio_stream_reserve_fifo(s, ret);
+        if (err < 0) {
+            return err;
+        }
+    }
+    return av_audio_fifo_write(s->fifo, (void **)&s->convert_buf, ret);
+}
+
+static int audio_stream_fill(AudioStreamEntry *s) {
+    while (!s->drained && av_audio_fifo_size(s->fifo) < s->chunk_samples) {
+        int ret = avcodec_receive_frame(s->dec_ctx, s->frame);
+        if (ret == 0) {
+            ret = audio_stream_setup_swr(s, s->frame);
+            if (ret >= 0) {
+                ret = audio_stream_convert(s, s->frame);
+            }
+            av_frame_unref(s->frame);
+            if (ret < 0) {
+                return ret;
+            }
+            continue;
+        }
+        if (ret == AVERROR_EOF) {
+            // Drain the resampler's delay line
+            do {
+                ret = audio_stream_convert(s, NULL);
+            } while (ret > 0);
+            s->drained = 1;
+            return ret < 0 ? ret : 0;
+        }
+        if (ret != AVERROR(EAGAIN)) {
+            return ret;
+        }
+
+        if (s->demux_eof) {
+            avcodec_send_packet(s->dec_ctx, NULL);
+            continue;
+        }
+
+        ret = av_read_frame(s->fmt_ctx, s->pkt);
+        if (ret == AVERROR_EOF) {
+            s->demux_eof = 1;
+            continue;
+        }
+        if (ret < 0) {
+            return ret;
+        }
+
+        if (s->pkt->stream_index == s->stream_idx) {
+            ret = avcodec_send_packet(s->dec_ctx, s->pkt);
+            // Corrupt packets are skipped rather than ending the stream
+            if (ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_INVALIDDATA) {
+                av_packet_unref(s->pkt);
+                return ret;
+            }
+        }
+        av_packet_unref(s->pkt);
+    }
+    return 0;
+}
+
+static void audio_stream_read_execute(napi_env env, void *data) {
+    AudioStreamEntry *s = (AudioStreamEntry *)data;
+    (void)env;
+
+    s->result_chunk = NULL;
+    s->result_samples = 0;
+
+    // Charge the chunk up front; a full budget sends the read back to the JS thread to wait
+    if (s->budget) {
+        s->result_error = memory_budget_try_acquire(s->budget, s->pool->chunk_bytes);
+        if (s->result_error < 0) {
+            return;
+        }
+        s->chunk_charged = 1;
+    }
+
+    s->result_error = audio_stream_fill(s);
+    if (s->result_error < 0) {
+        return;
+    }
+
+    int nb_samples = FFMIN(av_audio_fifo_size(s->fifo), s->chunk_samples);
+    if (nb_samples <= 0) {
+        return; // End of stream
+    }
+
+    PcmChunk *chunk = pcm_pool_get(s->pool);
+    if (!chunk) {
+        s->result_error = AVERROR(ENOMEM);
+        return;
+    }
+
+    int ret = av_audio_fifo_read(s->fifo, (void **)&chunk->data, nb_samples);
+    if (ret < 0) {
+        pcm_pool_put(chunk);
+        s->result_error = ret;
+        return;
+    }
+
+    s->result_chunk = chunk;
+    s->result_samples = ret;
+}
+
+static void audio_stream_read_complete(napi_env env, napi_status status, void *data);
+
+static napi_status audio_stream_queue_read(napi_env env, AudioStreamEntry *s) {
+    napi_value resource_name;
+    napi_create_string_utf8(env, "ffmpeg7:audioStreamRead", NAPI_AUTO_LENGTH, &resource_name);
+    napi_status status = napi_create_async_work(env, NULL, resource_name,
+                                                audio_stream_read_execute, audio_stream_read_complete,
+                                                s, &s->work);
+    if (status == napi_ok) {
+        status = napi_queue_async_work(env, s->work);
+    }
+    if (status != napi_ok && s->work) {
+        napi_delete_async_work(env, s->work);
+        s->work = NULL;
+    }
+    return status;
+}
+
+static void audio_stream_reject(napi_env env, AudioStreamEntry *s, const char *message) {
+    napi_value msg, error;
+    napi_create_string_utf8(env, message, NAPI_AUTO_LENGTH, &msg);
+    napi_create_error(env, NULL, msg, &error);
+    napi_reject_deferred(env, s->deferred, error);
+    s->deferred = NULL;
+}
+
+// Ends the pending read; frees the entry when it was closed meanwhile
+static void audio_stream_read_done(AudioStreamEntry *s) {
+    s->busy = 0;
+    if (s->close_pending) {
+        free_audio_stream_entry(s);
+    }
+}
+
+// The memory budget has room for a chunk again (or the wait failed); retry the read
+static void audio_stream_budget_ready(napi_env env, void *opaque, int status) {
+    AudioStreamEntry *s = opaque;
+    char errbuf[128];
+
+    s->budget_wait = 0;
+    if (status == 0 && !s->close_pending) {
+        if (audio_stream_queue_read(env, s) == napi_ok) {
+            return;
+        }
+        snprintf(errbuf, sizeof(errbuf), "Failed to queue audio stream read");
+    } else if (status == 0 || status == AVERROR_EXIT) {
+        snprintf(errbuf, sizeof(errbuf), "Audio stream read was cancelled");
+    } else {
+        av_strerror(status, errbuf, sizeof(errbuf));
+    }
+    audio_stream_reject(env, s, errbuf);
+    audio_stream_read_done(s);
+}
+
+static void audio_stream_read_complete(napi_env env, napi_status status, void *data) {
+    AudioStreamEntry *s = (AudioStreamEntry *)data;
+    napi_value result = NULL;
+
+    napi_delete_async_work(env, s->work);
+    s->work = NULL;
+
+    // Chunks stop counting against the budget once they leave native hands
+    if (s->chunk_charged) {
+        memory_budget_release(s->budget, s->pool->chunk_bytes);
+        s->chunk_charged = 0;
+    }
+
+    if (status == napi_ok && s->result_error == AVERROR(EAGAIN) && !s->close_pending) {
+        int ret = memory_budget_wait_async(env, s->budget, s->pool->chunk_bytes,
+                                           audio_stream_budget_ready, s);
+        if (ret == 0) {
+            s->budget_wait = 1;
+            return;
+        }
+        if (ret > 0) {
+            audio_stream_budget_ready(env, s, 0);
+            return;
+        }
+        s->result_error = ret;
+    }
+
+    if (status != napi_ok || s->result_error < 0) {
+        char errbuf[128];
+        if (status != napi_ok || s->result_error == AVERROR(EAGAIN)) {
+            snprintf(errbuf, sizeof(errbuf), "Audio stream read was cancelled");
+        } else {
+            av_strerror(s->result_error, errbuf, sizeof(errbuf));
+        }
+        audio_stream_reject(env, s, errbuf);
+        if (s->result_chunk) {
+            pcm_pool_put(s->result_chunk);
+        }
+    } else if (!s->result_chunk) {
+        napi_get_null(env, &result);
+        napi_resolve_deferred(env, s->deferred, result);
+    } else {
+        PcmChunk *chunk = s->result_chunk;
+        int channels = s->out_layout.nb_channels;
+        size_t length = (size_t)s->result_samples * channels;
+        size_t byte_length = length * av_get_bytes_per_sample(s->out_fmt);
+        napi_value arraybuffer;
+
+        napi_status st = napi_create_external_arraybuffer(env, chunk->data, byte_length,
+                                                          pcm_chunk_finalize, chunk, &arraybuffer);
+        if (st != napi_ok) {
+            // Runtimes that forbid external buffers get a copy; the chunk goes straight back to the pool
+            void *copy;
+            napi_create_arraybuffer(env, byte_length, &copy, &arraybuffer);
+            memcpy(copy, chunk->data, byte_length);
+            pcm_pool_put(chunk);
+        }
+
+        napi_typedarray_type type = s->out_fmt == AV_SAMPLE_FMT_S16 ? napi_int16_array : napi_float32_array;
+        napi_create_typedarray(env, type, length, arraybuffer, 0, &result);
+        napi_resolve_deferred(env, s->deferred, result);
+    }
+
+    s->deferred = NULL;
+    s->result_chunk = NULL;
+    audio_stream_read_done(s);
+}
+
+// ============================================================================
+// Streaming Audio Decode API
+// ============================================================================
+
+static int get_int_option(napi_env env, napi_value obj, const char *name, int32_t *out) {
+    bool has = false;
+    napi_value val;
+    napi_valuetype type;
+
+    if (napi_has_named_property(env, obj, name, &has) != napi_ok || !has) {
+        return 0;
+    }
+    napi_get_named_property(env, obj, name, &val);
+    napi_typeof(env, val, &type);
+    if (type != napi_number) {
+        return 0;
+    }
+    napi_get_value_int32(env, val, out);
+    return 1;
+}
+
+/**
+ * Open an audio stream reader that produces fixed-size PCM chunks
+ * @param filePath - Input file path
+ * @param options - { sampleRate, channels, format ("f32" | "s16"), chunkSamples, streamIndex, memoryBudget }
+ * @returns streamId - Audio stream reader ID
+ */
+napi_value audio_stream_open(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 2;
+    napi_value argv[2];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected file path argument");
+        return NULL;
+    }
+
+    char file_path[1024];
+    size_t str_len;
+    status = napi_get_value_string_utf8(env, argv[0], file_path, sizeof(file_path), &str_len);
+    if (status != napi_ok) {
+        napi_throw_error(env, NULL, "Failed to get file path");
+        return NULL;
+    }
+
+    int32_t sample_rate = 16000, channels = 1, chunk_samples = 4096, stream_idx = -1;
+    enum AVSampleFormat out_fmt = AV_SAMPLE_FMT_FLT;
+
+    if (argc >= 2) {
+        napi_valuetype valuetype;
+        napi_typeof(env, argv[1], &valuetype);
+        if (valuetype == napi_object) {
+            get_int_option(env, argv[1], "sampleRate", &sample_rate);
+            get_int_option(env, argv[1], "channels", &channels);
+            get_int_option(env, argv[1], "chunkSamples", &chunk_samples);
+            get_int_option(env, argv[1], "streamIndex", &stream_idx);
+
+            napi_value fmt_val;
+            napi_valuetype fmt_type = napi_undefined;
+            bool has_format = false;
+            napi_has_named_property(env, argv[1], "format", &has_format);
+            if (has_format) {
+                napi_get_named_property(env, argv[1], "format", &fmt_val);
+                napi_typeof(env, fmt_val, &fmt_type);
+            }
+            // An explicit undefined keeps the default, like the other optional options
+            if (fmt_type != napi_undefined) {
+                char fmt_str[16] = {0};
+                napi_get_value_string_utf8(env, fmt_val, fmt_str, sizeof(fmt_str), &str_len);
+                if (strcmp(fmt_str, "s16") == 0) {
+                    out_fmt = AV_SAMPLE_FMT_S16;
+                } else if (strcmp(fmt_str, "f32") == 0 || strcmp(fmt_str, "flt") == 0) {
+                    out_fmt = AV_SAMPLE_FMT_FLT;
+                } else {
+                    napi_throw_error(env, NULL, "Invalid format, expected \"f32\" or \"s16\"");
+                    return NULL;
+                }
+            }
+        }
+    }
+
+    if (sample_rate <= 0 || channels <= 0 || chunk_samples <= 0) {
+        napi_throw_error(env, NULL, "sampleRate, channels and chunkSamples must be positive");
+        return NULL;
+    }
+
+    MemoryBudget *budget = NULL;
+    if (argc >= 2 && memory_budget_from_option(env, argv[1], &budget) < 0) {
+        return NULL;
+    }
+
+    AudioStreamEntry *s = alloc_audio_stream_entry();
+    if (!s) {
+        memory_budget_unref(&budget);
+        napi_throw_error(env, NULL, "Too many audio streams");
+        return NULL;
+    }
+    s->budget = budget;
+
+    char errbuf[128];
+    int ret = avformat_open_input(&s->fmt_ctx, file_path, NULL, NULL);
+    if (ret < 0) {
+        goto fail;
+    }
+    ret = avformat_find_stream_info(s->fmt_ctx, NULL);
+    if (ret < 0) {
+        goto fail;
+    }
+
+    const AVCodec *codec = NULL;
+    ret = av_find_best_stream(s->fmt_ctx, AVMEDIA_TYPE_AUDIO, stream_idx, -1, &codec, 0);
+    if (ret < 0) {
+        goto fail;
+    }
+    s->stream_idx = ret;
+
+    // Only the selected stream is demuxed
+    for (unsigned int i = 0; i < s->fmt_ctx->nb_streams; i++) {
+        if ((int)i != s->stream_idx) {
+            s->fmt_ctx->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    s->dec_ctx = avcodec_alloc_context3(codec);
+    if (!s->dec_ctx) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    ret = avcodec_parameters_to_context(s->dec_ctx, s->fmt_ctx->streams[s->stream_idx]->codecpar);
+    if (ret < 0) {
+        goto fail;
+    }
+    s->dec_ctx->pkt_timebase = s->fmt_ctx->streams[s->stream_idx]->time_base;
+    memory_budget_attach_decoder(s->dec_ctx, s->budget);
+    ret = avcodec_open2(s->dec_ctx, codec, NULL);
+    if (ret < 0) {
+        goto fail;
+    }
+
+    av_channel_layout_default(&s->out_layout, channels);
+    s->out_fmt = out_fmt;
+    s->out_rate = sample_rate;
+    s->chunk_samples = chunk_samples;
+
+    s->pkt = av_packet_alloc();
+    s->frame = av_frame_alloc();
+    s->fifo = av_audio_fifo_alloc(out_fmt, channels, chunk_samples * 2);
+    s->pool = pcm_pool_alloc((size_t)chunk_samples * channels * av_get_bytes_per_sample(out_fmt));
+    if (!s->pkt || !s->frame || !s->fifo || !s->pool) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+
+    napi_value result;
+    napi_create_int32(env, s->id, &result);
+    return result;
+
+fail:
+    av_strerror(ret, errbuf, sizeof(errbuf));
+    free_audio_stream_entry(s);
+    napi_throw_error(env, NULL, errbuf);
+    return NULL;
+}
+
+/**
+ * Read the next PCM chunk asynchronously
+ * @param streamId - Audio stream reader ID
+ * @returns Promise resolving to Float32Array/Int16Array (interleaved, chunkSamples * channels
+ *          values; the last chunk may be shorter) or null at end of stream
+ * @description With a memory budget the read waits on the JS thread, not on the thread pool,
+ *              until a chunk fits; the chunk no longer counts against the budget once resolved
+ */
+napi_value audio_stream_read(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 1;
+    napi_value argv[1];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected audio stream ID");
+        return NULL;
+    }
+
+    int stream_id;
+    napi_get_value_int32(env, argv[0], &stream_id);
+
+    AudioStreamEntry *s = get_audio_stream_entry(stream_id);
+    if (!s || s->close_pending) {
+        napi_throw_error(env, NULL, "Invalid audio stream ID");
+        return NULL;
+    }
+    if (s->busy) {
+        napi_throw_error(env, NULL, "A read is already pending on this audio stream");
+        return NULL;
+    }
+
+    napi_value promise;
+    status = napi_create_promise(env, &s->deferred, &promise);
+    if (status != napi_ok) {
+        napi_throw_error(env, NULL, "Failed to create promise");
+        return NULL;
+    }
+
+    if (audio_stream_queue_read(env, s) != napi_ok) {
+        audio_stream_reject(env, s, "Failed to queue audio stream read");
+        return promise;
+    }
+
+    s->busy = 1;
+    return promise;
+}
+
+/**
+ * Close an audio stream reader
+ * @param streamId - Audio stream reader ID
+ * @description Chunks already handed to JS stay valid; their memory is released when collected
+ */
+napi_value audio_stream_close(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 1;
+    napi_value argv[1];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected audio stream ID");
+        return NULL;
+    }
+
+    int stream_id;
+    napi_get_value_int32(env, argv[0], &stream_id);
+
+    AudioStreamEntry *s = get_audio_stream_entry(stream_id);
+    if (s) {
+        if (s->busy) {
+            // Freed by the completion callback of the in-flight read
+            s->close_pending = 1;
+            if (s->budget_wait) {
+                memory_budget_cancel_wait(env, s->budget, s);
+            }
+        } else {
+            free_audio_stream_entry(s);
+        }
+    }
+
+    return NULL;
+}
@@ -20,6 +20,7 @@ extern napi_value atomic_set_encoder_option(napi_env env, napi_callback_info inf
 extern napi_value atomic_open_encoder(napi_env env, napi_callback_info info);
 extern napi_value atomic_create_decoder(napi_env env, napi_callback_info info);
 extern napi_value atomic_copy_decoder_params(napi_env env, napi_callback_info info);
+extern napi_value atomic_set_decoder_option(napi_env env, napi_callback_info info);
 extern napi_value atomic_open_decoder(napi_env env, napi_callback_info info);
 extern napi_value atomic_get_encoder_list(napi_env env, napi_callback_info info);
 extern napi_value atomic_get_muxer_list(napi_env env, napi_callback_info info);
@@ -38,6 +39,7 @@ extern napi_value atomic_send_packet(napi_env env, napi_callback_info info);
 extern napi_value atomic_receive_frame(napi_env env, napi_callback_info info);
 extern napi_value atomic_send_frame(napi_env env, napi_callback_info info);
 extern napi_value atomic_receive_packet(napi_env env, napi_callback_info info);
+extern napi_value atomic_get_encoder_packet_stats(napi_env env, napi_callback_info info);
 
 // Frame data access and manipulation
 extern napi_value atomic_frame_get_buffer(napi_env env, napi_callback_info info);
@@ -79,6 +81,98 @@ extern napi_value atomic_get_supported_pix_fmts(napi_env env, napi_callback_info
 extern napi_value atomic_get_supported_sample_fmts(napi_env env, napi_callback_info info);
 extern napi_value atomic_get_supported_sample_rates(napi_env env, napi_callback_info info);
 
+// Streaming audio decode from audio_stream.c
+extern napi_value audio_stream_open(napi_env env, napi_callback_info info);
+extern napi_value audio_stream_read(napi_env env, napi_callback_info info);
+extern napi_value audio_stream_close(napi_env env, napi_callback_info info);
+
+// AudioMixer functions from audio_mixer.c
+extern napi_value audio_mixer_create(napi_env env, napi_callback_info info);
+extern napi_value audio_mixer_add_input(napi_env env, napi_callback_info info);
+extern napi_value audio_mixer_set_gain(napi_env env, napi_callback_info info);
+extern napi_value audio_mixer_send_frame(napi_env env, napi_callback_info info);
+extern napi_value audio_mixer_receive_frame(napi_env env, napi_callback_info info);
+extern napi_value audio_mixer_free(napi_env env, napi_callback_info info);
+
+// Raw sample resampling
+extern napi_value atomic_swr_convert(napi_env env, napi_callback_info info);
+
+// Frame-rate conversion from frame_rate.c
+extern napi_value fps_converter_create(napi_env env, napi_callback_info info);
+extern napi_value fps_converter_send_frame(napi_env env, napi_callback_info info);
+extern napi_value fps_converter_receive_frame(napi_env env, napi_callback_info info);
+extern napi_value fps_converter_get_stats(napi_env env, napi_callback_info info);
+extern napi_value fps_converter_free(napi_env env, napi_callback_info info);
+
+// Frame decimation (frame_rate.c)
+extern napi_value decimator_create(napi_env env, napi_callback_info info);
+extern napi_value decimator_filter_frame(napi_env env, napi_callback_info info);
+extern napi_value decimator_get_stats(napi_env env, napi_callback_info info);
+extern napi_value decimator_free(napi_env env, napi_callback_info info);
+
+// Media analysis (analysis.c)
+extern napi_value detect_black_and_silence(napi_env env, napi_callback_info info);
+
+// Crop detection (analysis.c)
+extern napi_value detect_crop(napi_env env, napi_callback_info info);
+
+// Video fingerprints (analysis.c)
+extern napi_value fingerprint(napi_env env, napi_callback_info info);
+extern napi_value fingerprint_compare(napi_env env, napi_callback_info info);
+
+// Frame statistics (analysis.c)
+extern napi_value frame_stats(napi_env env, napi_callback_info info);
+extern napi_value analyze_video_stats(napi_env env, napi_callback_info info);
+
+// Motion vector statistics (analysis.c)
+extern napi_value frame_motion_stats(napi_env env, napi_callback_info info);
+
+// Side data API functions (side_data.c)
+extern napi_value side_data_get_frame(napi_env env, napi_callback_info info);
+extern napi_value side_data_get_packet(napi_env env, napi_callback_info info);
+
+// Packet scan (analysis.c)
+extern napi_value analyze_packets(napi_env env, napi_callback_info info);
+
+// Exact duration probe (utils.c)
+extern napi_value probe_duration(napi_env env, napi_callback_info info);
+
+// Attached pictures (analysis.c)
+extern napi_value get_attached_picture(napi_env env, napi_callback_info info);
+
+// Latency statistics (atomic_api.c)
+extern napi_value atomic_get_latency_stats(napi_env env, napi_callback_info info);
+extern napi_value atomic_set_latency_tracking(napi_env env, napi_callback_info info);
+extern napi_value atomic_get_latency_metrics(napi_env env, napi_callback_info info);
+
+// Encoder reconfiguration (atomic_api.c)
+extern napi_value atomic_reconfigure_encoder(napi_env env, napi_callback_info info);
+
+// Encoder frame preparation (atomic_api.c)
+extern napi_value atomic_prepare_frame_for_encoder(napi_env env, napi_callback_info info);
+
+// Decoder arena (decoder_arena.c)
+extern napi_value decoder_arena_set(napi_env env, napi_callback_info info);
+extern napi_value decoder_arena_stats(napi_env env, napi_callback_info info);
+extern napi_value decoder_arena_frame_layout(napi_env env, napi_callback_info info);
+
+// Frame buffer pools (frame_pool.c)
+extern napi_value frame_pool_stats(napi_env env, napi_callback_info info);
+extern napi_value frame_pool_clear(napi_env env, napi_callback_info info);
+
+// Memory budgets
+extern napi_value memory_budget_create(napi_env env, napi_callback_info info);
+extern napi_value memory_budget_stats(napi_env env, napi_callback_info info);
+extern napi_value memory_budget_free(napi_env env, napi_callback_info info);
+
+// Frame streams
+extern napi_value frame_stream_open(napi_env env, napi_callback_info info);
+extern napi_value frame_stream_read(napi_env env, napi_callback_info info);
+extern napi_value frame_stream_close(napi_env env, napi_callback_info info);
+
+// Async codec transfer
+extern napi_value atomic_codec_transfer(napi_env env, napi_callback_info info);
+
 napi_value Init(napi_env env, napi_value exports)
 {
     napi_status status;
@@ -189,6 +283,11 @@ napi_value Init(napi_env env, napi_value exports)
     status = napi_set_named_property(env, exports, "copyDecoderParams", fn);
     if (status != napi_ok) return NULL;
     
+    status = napi_create_function(env, NULL, 0, atomic_set_decoder_option, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "setDecoderOption", fn);
+    if (status != napi_ok) return NULL;
+    
     status = napi_create_function(env, NULL, 0, atomic_open_decoder, NULL, &fn);
     if (status != napi_ok) return NULL;
     status = napi_set_named_property(env, exports, "openDecoder", fn);
@@ -282,6 +381,11 @@ napi_value Init(napi_env env, napi_value exports)
     status = napi_set_named_property(env, exports, "receivePacket", fn);
     if (status != napi_ok) return NULL;
     
+    status = napi_create_function(env, NULL, 0, atomic_get_encoder_packet_stats, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "getEncoderPacketStats", fn);
+    if (status != napi_ok) return NULL;
+    
     // Frame Data Access
     status = napi_create_function(env, NULL, 0, atomic_frame_get_buffer, NULL, &fn);
     if (status != napi_ok) return NULL;
@@ -428,6 +532,269 @@ napi_value Init(napi_env env, napi_value exports)
     status = napi_set_named_property(env, exports, "audioFifoDrain", fn);
     if (status != napi_ok) return NULL;
     
+    // Streaming Audio Decode API
+    status = napi_create_function(env, NULL, 0, audio_stream_open, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "audioStreamOpen", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, audio_stream_read, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "audioStreamRead", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, audio_stream_close, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "audioStreamClose", fn);
+    if (status != napi_ok) return NULL;
+    
+    // AudioMixer API
+    status = napi_create_function(env, NULL, 0, audio_mixer_create, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "createAudioMixer", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, audio_mixer_add_input, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "audioMixerAddInput", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, audio_mixer_set_gain, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "audioMixerSetGain", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, audio_mixer_send_frame, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "audioMixerSendFrame", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, audio_mixer_receive_frame, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "audioMixerReceiveFrame", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, audio_mixer_free, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "audioMixerFree", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Raw sample resampling API
+    status = napi_create_function(env, NULL, 0, atomic_swr_convert, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "swrConvert", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Frame-Rate Conversion API
+    status = napi_create_function(env, NULL, 0, fps_converter_create, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "createFrameRateConverter", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, fps_converter_send_frame, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "fpsConverterSendFrame", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, fps_converter_receive_frame, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "fpsConverterReceiveFrame", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, fps_converter_get_stats, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "fpsConverterGetStats", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, fps_converter_free, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "fpsConverterFree", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Frame decimation
+    status = napi_create_function(env, NULL, 0, decimator_create, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "createDecimator", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, decimator_filter_frame, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "decimatorFilterFrame", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, decimator_get_stats, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "decimatorGetStats", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, decimator_free, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "decimatorFree", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Media analysis
+    status = napi_create_function(env, NULL, 0, detect_black_and_silence, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "detectBlackAndSilence", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Crop detection
+    status = napi_create_function(env, NULL, 0, detect_crop, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "detectCrop", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Video fingerprints
+    status = napi_create_function(env, NULL, 0, fingerprint, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "fingerprint", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, fingerprint_compare, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "fingerprintCompare", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Frame statistics
+    status = napi_create_function(env, NULL, 0, frame_stats, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "frameStats", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, analyze_video_stats, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "analyzeVideoStats", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Motion vector statistics
+    status = napi_create_function(env, NULL, 0, frame_motion_stats, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "frameMotionStats", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Side data API
+    status = napi_create_function(env, NULL, 0, side_data_get_frame, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "getFrameSideData", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, side_data_get_packet, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "getPacketSideData", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Packet scan
+    status = napi_create_function(env, NULL, 0, analyze_packets, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "analyzePackets", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Exact duration probe
+    status = napi_create_function(env, NULL, 0, probe_duration, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "probeDuration", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Attached pictures
+    status = napi_create_function(env, NULL, 0, get_attached_picture, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "getAttachedPicture", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Latency statistics
+    status = napi_create_function(env, NULL, 0, atomic_get_latency_stats, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "getLatencyStats", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Latency tracking
+    status = napi_create_function(env, NULL, 0, atomic_set_latency_tracking, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "setLatencyTracking", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, atomic_get_latency_metrics, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "getLatencyMetrics", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Encoder reconfiguration
+    status = napi_create_function(env, NULL, 0, atomic_reconfigure_encoder, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "reconfigureEncoder", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Encoder frame preparation
+    status = napi_create_function(env, NULL, 0, atomic_prepare_frame_for_encoder, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "prepareFrameForEncoder", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Decoder arena
+    status = napi_create_function(env, NULL, 0, decoder_arena_set, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "setDecoderArena", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, decoder_arena_stats, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "getDecoderArenaStats", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, decoder_arena_frame_layout, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "getFrameArenaLayout", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Frame buffer pools
+    status = napi_create_function(env, NULL, 0, frame_pool_stats, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "getFramePoolStats", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, frame_pool_clear, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "clearFramePools", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Memory budgets
+    status = napi_create_function(env, NULL, 0, memory_budget_create, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "createMemoryBudget", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, memory_budget_stats, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "getMemoryBudgetStats", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, memory_budget_free, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "freeMemoryBudget", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Frame streams
+    status = napi_create_function(env, NULL, 0, frame_stream_open, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "frameStreamOpen", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, frame_stream_read, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "frameStreamRead", fn);
+    if (status != napi_ok) return NULL;
+    
+    status = napi_create_function(env, NULL, 0, frame_stream_close, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "frameStreamClose", fn);
+    if (status != napi_ok) return NULL;
+    
+    // Async codec transfer
+    status = napi_create_function(env, NULL, 0, atomic_codec_transfer, NULL, &fn);
+    if (status != napi_ok) return NULL;
+    status = napi_set_named_property(env, exports, "codecTransfer", fn);
+    if (status != napi_ok) return NULL;
+    
     return exports;
 }
 
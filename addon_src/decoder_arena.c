@@ -0,0 +1,406 @@
+/**
+ * @file decoder_arena.c
+ * @brief Decoder arena - Decode video frames straight into caller-supplied memory
+ * @description Installs a get_buffer2 callback that carves frame buffers out of a JS-owned
+ *              ArrayBuffer or Uint8Array (including views over a SharedArrayBuffer). The memory is
+ *              split into equal slots handed out as refcounted AVBuffers, so a slot is reused as
+ *              soon as the decoder and every frame referencing it let go. When all slots are busy,
+ *              or a frame cannot live there (audio, hardware or palette formats), decoding falls
+ *              back to FFmpeg's own allocator
+ */
+
+#include <node_api.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "libavcodec/avcodec.h"
+#include "libavutil/buffer.h"
+#include "libavutil/frame.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/thread.h"
+
+#include "atomic_api.h"
+#include "decoder_arena.h"
+
+#define ARENA_ALIGN 64
+#define ARENA_MAX_SLOTS 64
+// Per-plane tail padding for SIMD overreads, as in avcodec_default_get_buffer2
+#define ARENA_PADDING (16 + ARENA_ALIGN - 1)
+
+// ============================================================================
+// Arena State
+// ============================================================================
+
+struct DecoderArena {
+    pthread_mutex_t lock;      // get_buffer2 and buffer release run on decoder threads
+    napi_ref memory_ref;       // Keeps the JS memory alive while frames point into it
+    uint8_t *user_data;        // Start of the caller's view; reported offsets are relative to it
+    uint8_t *base;             // First ARENA_ALIGN-aligned byte
+    size_t size;               // Usable bytes from base
+    size_t slot_size;          // Fixed by the caller or by the first frame
+    int nb_slots;
+    uint64_t used;             // Bitmap of slots held by frames
+    int outstanding;
+    int closed;                // Decoder freed; destroyed once outstanding hits 0
+    int64_t allocations;
+    int64_t fallbacks;
+    struct DecoderArena *next; // Every live arena; only touched on the JS thread
+};
+
+static DecoderArena *arenas = NULL;
+
+static void arena_destroy(napi_env env, DecoderArena *arena) {
+    for (DecoderArena **p = &arenas; *p; p = &(*p)->next) {
+        if (*p == arena) {
+            *p = arena->next;
+            break;
+        }
+    }
+    napi_delete_reference(env, arena->memory_ref);
+    pthread_mutex_destroy(&arena->lock);
+    av_free(arena);
+}
+
+// Free arenas whose decoder is gone and whose last frame has been released
+static void sweep_closed_arenas(napi_env env) {
+    DecoderArena *arena = arenas;
+    while (arena) {
+        DecoderArena *next = arena->next;
+        pthread_mutex_lock(&arena->lock);
+        int done = arena->closed && !arena->outstanding;
+        pthread_mutex_unlock(&arena->lock);
+        if (done) {
+            arena_destroy(env, arena);
+        }
+        arena = next;
+    }
+}
+
+static void arena_release(void *opaque, uint8_t *data) {
+    DecoderArena *arena = opaque;
+    int slot = (int)((data - arena->base) / arena->slot_size);
+
+    pthread_mutex_lock(&arena->lock);
+    arena->used &= ~(UINT64_C(1) << slot);
+    arena->outstanding--;
+    pthread_mutex_unlock(&arena->lock);
+}
+
+// ============================================================================
+// get_buffer2
+// ============================================================================
+
+// Plane strides and offsets of a frame within one buffer, padded the way decoders expect
+static int arena_frame_layout(AVCodecContext *s, const AVFrame *frame, int linesize[4],
+                              size_t offset[4], size_t *total) {
+    int w = frame->width, h = frame->height;
+    int stride_align[AV_NUM_DATA_POINTERS];
+    int unaligned, ret;
+
+    avcodec_align_dimensions2(s, &w, &h, stride_align);
+    // Widen until every stride meets the decoder's alignment
+    do {
+        if ((ret = av_image_fill_linesizes(linesize, frame->format, w)) < 0) {
+            return ret;
+        }
+        w += w & ~(w - 1);
+        unaligned = 0;
+        for (int i = 0; i < 4; i++) {
+            unaligned |= linesize[i] % stride_align[i];
+        }
+    } while (unaligned);
+
+    ptrdiff_t strides[4];
+    size_t sizes[4];
+    for (int i = 0; i < 4; i++) {
+        strides[i] = linesize[i];
+    }
+    if ((ret = av_image_fill_plane_sizes(sizes, frame->format, h, strides)) < 0) {
+        return ret;
+    }
+
+    *total = 0;
+    for (int i = 0; i < 4; i++) {
+        offset[i] = *total;
+        if (sizes[i]) {
+            *total += FFALIGN(sizes[i] + ARENA_PADDING, ARENA_ALIGN);
+        }
+    }
+    return 0;
+}
+
+static int arena_get_buffer2(AVCodecContext *s, AVFrame *frame, int flags) {
+    DecoderArena *arena = s->opaque;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
+    int linesize[4];
+    size_t offset[4], total;
+    int slot = -1;
+
+    if (s->codec_type == AVMEDIA_TYPE_VIDEO && (s->codec->capabilities & AV_CODEC_CAP_DR1) &&
+        desc && !(desc->flags & (AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_HWACCEL)) &&
+        arena_frame_layout(s, frame, linesize, offset, &total) >= 0) {
+        pthread_mutex_lock(&arena->lock);
+        if (!arena->slot_size) {
+            arena->slot_size = FFALIGN(total, ARENA_ALIGN);
+            arena->nb_slots = (int)FFMIN(arena->size / arena->slot_size, ARENA_MAX_SLOTS);
+        }
+        if (total <= arena->slot_size) {
+            for (int i = 0; i < arena->nb_slots; i++) {
+                if (!(arena->used & (UINT64_C(1) << i))) {
+                    slot = i;
+                    break;
+                }
+            }
+        }
+        if (slot >= 0) {
+            arena->used |= UINT64_C(1) << slot;
+            arena->outstanding++;
+            arena->allocations++;
+        }
+        pthread_mutex_unlock(&arena->lock);
+    }
+
+    if (slot < 0) {
+        pthread_mutex_lock(&arena->lock);
+        arena->fallbacks++;
+        pthread_mutex_unlock(&arena->lock);
+        return avcodec_default_get_buffer2(s, frame, flags);
+    }
+
+    uint8_t *data = arena->base + slot * arena->slot_size;
+    frame->buf[0] = av_buffer_create(data, total, arena_release, arena, 0);
+    if (!frame->buf[0]) {
+        arena_release(arena, data);
+        return AVERROR(ENOMEM);
+    }
+    for (int i = 0; i < 4 && linesize[i]; i++) {
+        frame->data[i] = data + offset[i];
+        frame->linesize[i] = linesize[i];
+    }
+    frame->extended_data = frame->data;
+    return 0;
+}
+
+DecoderArena *decoder_arena_from_codec(const AVCodecContext *codec_ctx) {
+    return codec_ctx->get_buffer2 == arena_get_buffer2 ? codec_ctx->opaque : NULL;
+}
+
+void decoder_arena_close(napi_env env, DecoderArena *arena) {
+    if (arena) {
+        pthread_mutex_lock(&arena->lock);
+        arena->closed = 1;
+        pthread_mutex_unlock(&arena->lock);
+    }
+    sweep_closed_arenas(env);
+}
+
+// ============================================================================
+// N-API Functions
+// ============================================================================
+
+/**
+ * Decode into caller-supplied memory (call before openDecoder)
+ * @param decoderContextId - Decoder context ID
+ * @param memory - ArrayBuffer or Uint8Array (e.g. over a SharedArrayBuffer); must not be detached
+ * @param options - (Optional) { slotSize } bytes per frame; default: size of the first frame
+ */
+napi_value decoder_arena_set(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 3;
+    napi_value argv[3];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 2) {
+        napi_throw_error(env, NULL, "Expected decoder context ID and memory");
+        return NULL;
+    }
+
+    int ctx_id;
+    napi_get_value_int32(env, argv[0], &ctx_id);
+    if (handle_is_busy(env, ctx_id)) {
+        return NULL;
+    }
+    AVCodecContext *codec_ctx = get_context_ptr(ctx_id, CTX_TYPE_DECODER);
+    if (!codec_ctx) {
+        napi_throw_error(env, NULL, "Invalid decoder context");
+        return NULL;
+    }
+    if (avcodec_is_open(codec_ctx) || decoder_arena_from_codec(codec_ctx)) {
+        napi_throw_error(env, NULL, "Arena must be set once, before openDecoder");
+        return NULL;
+    }
+
+    void *data = NULL;
+    size_t length = 0;
+    bool is_arraybuffer = false, is_typedarray = false;
+    napi_is_arraybuffer(env, argv[1], &is_arraybuffer);
+    napi_is_typedarray(env, argv[1], &is_typedarray);
+    if (is_arraybuffer) {
+        napi_get_arraybuffer_info(env, argv[1], &data, &length);
+    } else if (is_typedarray) {
+        napi_typedarray_type type;
+        napi_get_typedarray_info(env, argv[1], &type, &length, &data, NULL, NULL);
+        if (type != napi_uint8_array && type != napi_uint8_clamped_array) {
+            is_typedarray = false;
+        }
+    }
+    if ((!is_arraybuffer && !is_typedarray) || !data) {
+        napi_throw_type_error(env, NULL, "Memory must be an ArrayBuffer or Uint8Array");
+        return NULL;
+    }
+
+    int64_t slot_size = 0;
+    if (argc >= 3) {
+        napi_valuetype valuetype;
+        napi_typeof(env, argv[2], &valuetype);
+        bool has = false;
+        if (valuetype == napi_object) {
+            napi_has_named_property(env, argv[2], "slotSize", &has);
+        }
+        if (has) {
+            napi_value val;
+            napi_get_named_property(env, argv[2], "slotSize", &val);
+            napi_get_value_int64(env, val, &slot_size);
+        }
+    }
+
+    uint8_t *base = (uint8_t *)FFALIGN((uintptr_t)data, ARENA_ALIGN);
+    size_t size = (uint8_t *)data + length > base ? (size_t)((uint8_t *)data + length - base) : 0;
+    if (slot_size > 0) {
+        slot_size = FFALIGN(slot_size, ARENA_ALIGN);
+        if ((size_t)slot_size > size) {
+            napi_throw_error(env, NULL, "Memory is smaller than one slot");
+            return NULL;
+        }
+    }
+
+    DecoderArena *arena = av_mallocz(sizeof(*arena));
+    if (!arena || napi_create_reference(env, argv[1], 1, &arena->memory_ref) != napi_ok) {
+        av_free(arena);
+        napi_throw_error(env, NULL, "Failed to allocate arena");
+        return NULL;
+    }
+    pthread_mutex_init(&arena->lock, NULL);
+    arena->user_data = data;
+    arena->base = base;
+    arena->size = size;
+    if (slot_size > 0) {
+        arena->slot_size = slot_size;
+        arena->nb_slots = (int)FFMIN(size / slot_size, ARENA_MAX_SLOTS);
+    }
+    arena->next = arenas;
+    arenas = arena;
+
+    codec_ctx->opaque = arena;
+    codec_ctx->get_buffer2 = arena_get_buffer2;
+
+    sweep_closed_arenas(env);
+    return NULL;
+}
+
+/**
+ * Get arena usage of a decoder
+ * @param decoderContextId - Decoder context ID
+ * @returns { slotSize, slots, inUse, allocations, fallbacks } or null without an arena
+ */
+napi_value decoder_arena_stats(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 1;
+    napi_value argv[1];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected decoder context ID");
+        return NULL;
+    }
+
+    int ctx_id;
+    napi_get_value_int32(env, argv[0], &ctx_id);
+    if (handle_is_busy(env, ctx_id)) {
+        return NULL;
+    }
+    AVCodecContext *codec_ctx = get_context_ptr(ctx_id, CTX_TYPE_DECODER);
+    if (!codec_ctx) {
+        napi_throw_error(env, NULL, "Invalid decoder context");
+        return NULL;
+    }
+
+    napi_value result;
+    DecoderArena *arena = decoder_arena_from_codec(codec_ctx);
+    if (!arena) {
+        napi_get_null(env, &result);
+        return result;
+    }
+
+    pthread_mutex_lock(&arena->lock);
+    double values[] = {
+        (double)arena->slot_size, arena->nb_slots, arena->outstanding,
+        (double)arena->allocations, (double)arena->fallbacks,
+    };
+    pthread_mutex_unlock(&arena->lock);
+
+    static const char *const names[] = { "slotSize", "slots", "inUse", "allocations", "fallbacks" };
+    napi_create_object(env, &result);
+    for (int i = 0; i < 5; i++) {
+        napi_value val;
+        napi_create_double(env, values[i], &val);
+        napi_set_named_property(env, result, names[i], val);
+    }
+    return result;
+}
+
+/**
+ * Locate a frame's planes inside the arena memory
+ * @param frameId - Frame ID
+ * @returns { offsets: number[], linesizes: number[] } relative to the start of the memory passed
+ *          to setDecoderArena, or null if the frame is not stored in an arena
+ */
+napi_value decoder_arena_frame_layout(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 1;
+    napi_value argv[1];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected frame ID");
+        return NULL;
+    }
+
+    int frame_id;
+    napi_get_value_int32(env, argv[0], &frame_id);
+    AVFrame *frame = get_context_ptr(frame_id, CTX_TYPE_FRAME);
+    if (!frame) {
+        napi_throw_error(env, NULL, "Invalid frame");
+        return NULL;
+    }
+    if (handle_is_busy(env, frame_id)) {
+        return NULL;
+    }
+
+    napi_value result;
+    DecoderArena *arena = arenas;
+    while (arena && !(frame->buf[0] && frame->buf[0]->data >= arena->base &&
+                      frame->buf[0]->data < arena->base + arena->size)) {
+        arena = arena->next;
+    }
+    if (!arena) {
+        napi_get_null(env, &result);
+        return result;
+    }
+
+    napi_value offsets, linesizes;
+    napi_create_array(env, &offsets);
+    napi_create_array(env, &linesizes);
+    for (uint32_t i = 0; i < 4 && frame->data[i]; i++) {
+        napi_value val;
+        napi_create_double(env, (double)(frame->data[i] - arena->user_data), &val);
+        napi_set_element(env, offsets, i, val);
+        napi_create_int32(env, frame->linesize[i], &val);
+        napi_set_element(env, linesizes, i, val);
+    }
+    napi_create_object(env, &result);
+    napi_set_named_property(env, result, "offsets", offsets);
+    napi_set_named_property(env, result, "linesizes", linesizes);
+    return result;
+}
@@ -0,0 +1,21 @@
+/**
+ * @file decoder_arena.h
+ * @brief Caller-supplied decoder frame memory, for handle cleanup in atomic_api.c
+ */
+
+#ifndef FFMPEG_NODE_DECODER_ARENA_H
+#define FFMPEG_NODE_DECODER_ARENA_H
+
+#include <node_api.h>
+
+#include "libavcodec/avcodec.h"
+
+typedef struct DecoderArena DecoderArena;
+
+// Arena installed on a decoder by setDecoderArena, or NULL
+DecoderArena *decoder_arena_from_codec(const AVCodecContext *codec_ctx);
+
+// Call after the decoder is freed; the arena memory stays referenced until its last frame is released
+void decoder_arena_close(napi_env env, DecoderArena *arena);
+
+#endif // FFMPEG_NODE_DECODER_ARENA_H
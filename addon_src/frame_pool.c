@@ -0,0 +1,292 @@
+/**
+ * @file frame_pool.c
+ * @brief Frame buffer pools - Reuse frame memory across frameGetBuffer calls
+ * @description Keeps one AVBufferPool per frame geometry (video: format, size, alignment;
+ *              audio: format, channels, samples, alignment). Pipelines that allocate a scaler or
+ *              FIFO output frame per iteration then recycle the same buffers instead of hitting
+ *              the allocator for megabytes per frame. Strides, plane padding and alignment follow
+ *              av_frame_get_buffer: buffers are over-allocated by the alignment and every plane
+ *              pointer is aligned to it, so align values above the malloc alignment are honored
+ */
+
+#include <node_api.h>
+#include <string.h>
+
+#include "libavutil/buffer.h"
+#include "libavutil/channel_layout.h"
+#include "libavutil/frame.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/samplefmt.h"
+
+#include "frame_pool.h"
+
+#define MAX_FRAME_POOLS 32
+#define DEFAULT_ALIGN 64
+
+// ============================================================================
+// Pool Table
+// ============================================================================
+
+typedef struct {
+    int in_use;
+    enum AVMediaType type;
+    int format;
+    int width;             // Video
+    int height;
+    int channels;          // Audio
+    int nb_samples;
+    int align;
+    size_t size;           // Bytes per pooled buffer
+    AVBufferPool *pool;
+    int64_t last_used;
+    int64_t requests;      // Buffers handed out
+    int64_t allocated;     // Buffers the pool had to create
+} FramePool;
+
+static FramePool frame_pools[MAX_FRAME_POOLS];
+static int64_t pool_clock = 0;
+
+static AVBufferRef *pool_alloc(void *opaque, size_t size) {
+    FramePool *fp = opaque;
+    AVBufferRef *buf = av_buffer_alloc(size);
+    if (buf) {
+        fp->allocated++;
+    }
+    return buf;
+}
+
+// Pool for a geometry, created on first use; the least recently used pool is retired when the
+// table is full (its buffers stay valid and are freed once released)
+static FramePool *find_pool(const FramePool *key) {
+    FramePool *slot = NULL;
+
+    pool_clock++;
+    for (int i = 0; i < MAX_FRAME_POOLS; i++) {
+        FramePool *fp = &frame_pools[i];
+        if (fp->in_use && fp->type == key->type && fp->format == key->format &&
+            fp->width == key->width && fp->height == key->height && fp->channels == key->channels &&
+            fp->nb_samples == key->nb_samples && fp->align == key->align && fp->size == key->size) {
+            fp->last_used = pool_clock;
+            return fp;
+        }
+        if (!slot || (slot->in_use && (!fp->in_use || fp->last_used < slot->last_used))) {
+            slot = fp;
+        }
+    }
+
+    av_buffer_pool_uninit(&slot->pool);
+    *slot = *key;
+    slot->in_use = 1;
+    slot->last_used = pool_clock;
+    slot->requests = 0;
+    slot->allocated = 0;
+    slot->pool = av_buffer_pool_init2(key->size, slot, pool_alloc, NULL);
+    if (!slot->pool) {
+        slot->in_use = 0;
+        return NULL;
+    }
+    return slot;
+}
+
+// ============================================================================
+// Allocation
+// ============================================================================
+
+static int get_video_buffer(AVFrame *frame, int align) {
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
+    size_t sizes[4];
+    ptrdiff_t linesizes[4];
+    int ret;
+
+    if (!desc || (desc->flags & AV_PIX_FMT_FLAG_HWACCEL) || frame->linesize[0]) {
+        return av_frame_get_buffer(frame, align);
+    }
+    if ((ret = av_image_check_size(frame->width, frame->height, 0, NULL)) < 0) {
+        return ret;
+    }
+
+    // Same strides, padded height and per-plane padding as av_frame_get_buffer
+    for (int i = 1; i <= align; i += i) {
+        if ((ret = av_image_fill_linesizes(frame->linesize, frame->format, FFALIGN(frame->width, i))) < 0) {
+            return ret;
+        }
+        if (!(frame->linesize[0] & (align - 1))) {
+            break;
+        }
+    }
+    for (int i = 0; i < 4 && frame->linesize[i]; i++) {
+        frame->linesize[i] = FFALIGN(frame->linesize[i], align);
+    }
+    for (int i = 0; i < 4; i++) {
+        linesizes[i] = frame->linesize[i];
+    }
+
+    int padded_height = FFALIGN(frame->height, 32);
+    if ((ret = av_image_fill_plane_sizes(sizes, frame->format, padded_height, linesizes)) < 0) {
+        goto fail;
+    }
+    size_t plane_padding = FFMAX(16 + 16 - 1, align);
+    size_t total = 4 * plane_padding + 4 * (size_t)align;
+    for (int i = 0; i < 4; i++) {
+        total += sizes[i];
+    }
+
+    FramePool key = {
+        .type = AVMEDIA_TYPE_VIDEO, .format = frame->format, .width = frame->width,
+        .height = frame->height, .align = align, .size = total,
+    };
+    FramePool *fp = find_pool(&key);
+    if (!fp || !(frame->buf[0] = av_buffer_pool_get(fp->pool))) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    fp->requests++;
+
+    if ((ret = av_image_fill_pointers(frame->data, frame->format, padded_height,
+                                      frame->buf[0]->data, frame->linesize)) < 0) {
+        goto fail;
+    }
+    for (int i = 0; i < 4; i++) {
+        if (frame->data[i]) {
+            frame->data[i] += i * plane_padding;
+            frame->data[i] = (uint8_t *)FFALIGN((uintptr_t)frame->data[i], align);
+        }
+    }
+    frame->extended_data = frame->data;
+    return 0;
+
+fail:
+    av_frame_unref(frame);
+    return ret;
+}
+
+static int get_audio_buffer(AVFrame *frame, int align) {
+    int channels = frame->ch_layout.nb_channels;
+    int planes = av_sample_fmt_is_planar(frame->format) ? channels : 1;
+    int ret;
+
+    if (channels <= 0 || planes > AV_NUM_DATA_POINTERS || frame->linesize[0]) {
+        return av_frame_get_buffer(frame, align);
+    }
+    if ((ret = av_samples_get_buffer_size(&frame->linesize[0], channels, frame->nb_samples,
+                                          frame->format, align)) < 0) {
+        return ret;
+    }
+
+    // Room to align each plane pointer; the pool's allocator only guarantees malloc alignment
+    FramePool key = {
+        .type = AVMEDIA_TYPE_AUDIO, .format = frame->format, .channels = channels,
+        .nb_samples = frame->nb_samples, .align = align, .size = (size_t)frame->linesize[0] + align,
+    };
+    FramePool *fp = find_pool(&key);
+    if (!fp) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    for (int i = 0; i < planes; i++) {
+        if (!(frame->buf[i] = av_buffer_pool_get(fp->pool))) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+        fp->requests++;
+        frame->data[i] = (uint8_t *)FFALIGN((uintptr_t)frame->buf[i]->data, align);
+    }
+    frame->extended_data = frame->data;
+    return 0;
+
+fail:
+    av_frame_unref(frame);
+    return ret;
+}
+
+int frame_pool_get_buffer(AVFrame *frame, int align) {
+    if (frame->format < 0 || frame->buf[0]) {
+        return av_frame_get_buffer(frame, align);
+    }
+    align = align > 0 ? align : DEFAULT_ALIGN;
+    // Plane pointers are aligned with FFALIGN, which needs a power of two
+    if (align & (align - 1)) {
+        return av_frame_get_buffer(frame, align);
+    }
+    if (frame->width > 0 && frame->height > 0) {
+        return get_video_buffer(frame, align);
+    }
+    if (frame->nb_samples > 0 && av_channel_layout_check(&frame->ch_layout)) {
+        return get_audio_buffer(frame, align);
+    }
+    return av_frame_get_buffer(frame, align);
+}
+
+// ============================================================================
+// N-API Functions
+// ============================================================================
+
+/**
+ * Get frame buffer pool statistics
+ * @returns Array of { type, format, width?, height?, channels?, nbSamples?, bufferSize, requests,
+ *          allocated, reused } - one entry per live pool, most recently used first
+ */
+napi_value frame_pool_stats(napi_env env, napi_callback_info info) {
+    FramePool *order[MAX_FRAME_POOLS];
+    int count = 0;
+
+    for (int i = 0; i < MAX_FRAME_POOLS; i++) {
+        if (frame_pools[i].in_use) {
+            int j = count++;
+            while (j > 0 && order[j - 1]->last_used < frame_pools[i].last_used) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = &frame_pools[i];
+        }
+    }
+
+    napi_value result;
+    napi_create_array_with_length(env, count, &result);
+    for (int i = 0; i < count; i++) {
+        const FramePool *fp = order[i];
+        napi_value obj, val;
+        napi_create_object(env, &obj);
+
+        int video = fp->type == AVMEDIA_TYPE_VIDEO;
+        const char *format = video ? av_get_pix_fmt_name(fp->format) : av_get_sample_fmt_name(fp->format);
+        napi_create_string_utf8(env, video ? "video" : "audio", NAPI_AUTO_LENGTH, &val);
+        napi_set_named_property(env, obj, "type", val);
+        napi_create_string_utf8(env, format ? format : "unknown", NAPI_AUTO_LENGTH, &val);
+        napi_set_named_property(env, obj, "format", val);
+        if (video) {
+            napi_create_int32(env, fp->width, &val);
+            napi_set_named_property(env, obj, "width", val);
+            napi_create_int32(env, fp->height, &val);
+            napi_set_named_property(env, obj, "height", val);
+        } else {
+            napi_create_int32(env, fp->channels, &val);
+            napi_set_named_property(env, obj, "channels", val);
+            napi_create_int32(env, fp->nb_samples, &val);
+            napi_set_named_property(env, obj, "nbSamples", val);
+        }
+        napi_create_double(env, (double)fp->size, &val);
+        napi_set_named_property(env, obj, "bufferSize", val);
+        napi_create_double(env, (double)fp->requests, &val);
+        napi_set_named_property(env, obj, "requests", val);
+        napi_create_double(env, (double)fp->allocated, &val);
+        napi_set_named_property(env, obj, "allocated", val);
+        napi_create_double(env, (double)(fp->requests - fp->allocated), &val);
+        napi_set_named_property(env, obj, "reused", val);
+
+        napi_set_element(env, result, i, obj);
+    }
+    return result;
+}
+
+/**
+ * Release all frame buffer pools; buffers still held by frames are freed when those frames are
+ */
+napi_value frame_pool_clear(napi_env env, napi_callback_info info) {
+    for (int i = 0; i < MAX_FRAME_POOLS; i++) {
+        av_buffer_pool_uninit(&frame_pools[i].pool);
+        frame_pools[i].in_use = 0;
+    }
+    return NULL;
+}
@@ -0,0 +1,17 @@
+/**
+ * @file frame_pool.h
+ * @brief Pooled frame buffer allocation for frameGetBuffer
+ */
+
+#ifndef FFMPEG_NODE_FRAME_POOL_H
+#define FFMPEG_NODE_FRAME_POOL_H
+
+#include "libavutil/frame.h"
+
+// Drop-in for av_frame_get_buffer drawing from per-geometry buffer pools; buffers return to
+// their pool when the frame is unreferenced. Falls back to av_frame_get_buffer for layouts
+// the pools do not cover (preset linesizes, hardware formats, more than 8 audio planes,
+// alignments that are not a power of two)
+int frame_pool_get_buffer(AVFrame *frame, int align);
+
+#endif // FFMPEG_NODE_FRAME_POOL_H
@@ -0,0 +1,992 @@
+/**
+ * @file frame_rate.c
+ * @brief FrameRate API - Native frame-rate conversion and near-duplicate decimation for decoded video frames
+ * @description Converts a decoded frame sequence to a target rate by dropping, duplicating
+ *              (vf_fps semantics) or blending frames, producing pts in the encoder time base;
+ *              static runs can be decimated first (vf_mpdecimate semantics) for VFR output
+ */
+
+#include <node_api.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/frame.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/mathematics.h"
+#include "libavutil/parseutils.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/pixelutils.h"
+#include "libavcodec/avcodec.h"
+
+#include "atomic_api.h"
+#include "frame_pool.h"
+
+// ============================================================================
+// Decimation - Drops frames that barely differ from the last kept frame
+// ============================================================================
+
+typedef struct {
+    int enabled;
+    int hi;              // Any 8x8 block with SAD above hi keeps the frame
+    int lo;              // Blocks with SAD above lo count towards frac
+    float frac;          // Keep the frame if more than frac of the blocks exceed lo
+    int max_drop;        // >0: max consecutive drops, <0: min frames between drops, 0: unlimited
+    av_pixelutils_sad_fn sad;
+    AVFrame *ref;        // Last kept frame
+    int drop_count;      // >0 consecutive drops, <0 consecutive keeps
+    int64_t decimated;
+} Decimator;
+
+static int decimator_init(Decimator *d, int hi, int lo, float frac, int max_drop) {
+    memset(d, 0, sizeof(*d));
+    // 8x8 SAD, unaligned; SIMD-backed in libavutil (same kernel as vf_mpdecimate)
+    d->sad = av_pixelutils_get_sad_fn(3, 3, 0, NULL);
+    if (!d->sad) {
+        return AVERROR(ENOSYS);
+    }
+    d->enabled = 1;
+    d->hi = hi;
+    d->lo = lo;
+    d->frac = frac;
+    d->max_drop = max_drop;
+    return 0;
+}
+
+static void decimator_uninit(Decimator *d) {
+    av_frame_free(&d->ref);
+}
+
+// Compare plane 0 (luma for YUV/gray) block-wise; 1 if cur is close enough to ref to drop
+static int decimator_is_similar(Decimator *d, const AVFrame *cur, const AVFrame *ref) {
+    if (cur->format != ref->format || cur->width != ref->width || cur->height != ref->height) {
+        return 0;
+    }
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(cur->format);
+    if (!desc || desc->comp[0].depth != 8 ||
+        (desc->flags & (AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_BITSTREAM))) {
+        return 0;
+    }
+
+    int w = av_image_get_linesize(cur->format, cur->width, 0);
+    int h = cur->height;
+    int total = 0, over_lo = 0;
+    int t = (int)((float)((w / 16) * (h / 16)) * d->frac);
+
+    // Overlapping 8x8 blocks on a 4-pixel grid, as vf_mpdecimate does
+    for (int y = 0; y < h - 7; y += 4) {
+        const uint8_t *a = cur->data[0] + y * cur->linesize[0];
+        const uint8_t *b = ref->data[0] + y * ref->linesize[0];
+        for (int x = 0; x < w - 7; x += 4) {
+            int sad = d->sad(a + x, cur->linesize[0], b + x, ref->linesize[0]);
+            if (sad > d->hi) {
+                return 0;
+            }
+            if (sad > d->lo && ++over_lo > t) {
+                return 0;
+            }
+            total++;
+        }
+    }
+    return total > 0;
+}
+
+/**
+ * Decide whether a frame is kept
+ * @returns 1 to keep, 0 to drop, negative AVERROR on failure
+ */
+static int decimator_filter(Decimator *d, const AVFrame *frame) {
+    int drop = 0;
+
+    if (d->ref &&
+        !(d->max_drop > 0 && d->drop_count >= d->max_drop) &&
+        !(d->max_drop < 0 && (d->drop_count - 1) > d->max_drop)) {
+        drop = decimator_is_similar(d, frame, d->ref);
+    }
+
+    if (drop) {
+        d->drop_count = FFMAX(1, d->drop_count + 1);
+        d->decimated++;
+        return 0;
+    }
+
+    d->drop_count = FFMIN(-1, d->drop_count - 1);
+    if (!d->ref) {
+        d->ref = av_frame_alloc();
+        if (!d->ref) {
+            return AVERROR(ENOMEM);
+        }
+    } else {
+        av_frame_unref(d->ref);
+    }
+    int ret = av_frame_ref(d->ref, frame);
+    return ret < 0 ? ret : 1;
+}
+
+// Parse { hi, lo, frac, max } with vf_mpdecimate defaults
+static int decimator_init_from_js(napi_env env, napi_value options, Decimator *d) {
+    int32_t hi = 64 * 12, lo = 64 * 5, max_drop = 0;
+    double frac = 0.33;
+    napi_valuetype type;
+
+    napi_typeof(env, options, &type);
+    if (type == napi_object) {
+        bool has = false;
+        napi_value val;
+        napi_has_named_property(env, options, "hi", &has);
+        if (has) {
+            napi_get_named_property(env, options, "hi", &val);
+            napi_get_value_int32(env, val, &hi);
+        }
+        napi_has_named_property(env, options, "lo", &has);
+        if (has) {
+            napi_get_named_property(env, options, "lo", &val);
+            napi_get_value_int32(env, val, &lo);
+        }
+        napi_has_named_property(env, options, "frac", &has);
+        if (has) {
+            napi_get_named_property(env, options, "frac", &val);
+            napi_get_value_double(env, val, &frac);
+        }
+        napi_has_named_property(env, options, "max", &has);
+        if (has) {
+            napi_get_named_property(env, options, "max", &val);
+            napi_get_value_int32(env, val, &max_drop);
+        }
+    }
+    return decimator_init(d, hi, lo, (float)frac, max_drop);
+}
+
+// ============================================================================
+// Context Management for frame-rate converters
+// ============================================================================
+
+#define MAX_FPS_CONVERTERS 256
+
+typedef enum {
+    FPS_MODE_DUP,    // Constant output rate: drop and duplicate to the nearest input frame
+    FPS_MODE_DROP,   // Rate cap: only drop, output pts follow the kept frames
+    FPS_MODE_BLEND   // Constant output rate: blend the two neighbouring input frames
+} FpsMode;
+
+typedef struct {
+    AVFrame *frame;
+    double pos;      // Position in output ticks
+    int emitted;     // Already output at least once
+} QueuedFrame;
+
+typedef struct {
+    int id;
+    int in_use;
+
+    FpsMode mode;
+    AVRational rate;
+    AVRational src_tb;
+    AVRational out_tb;
+
+    QueuedFrame queue[2];
+    int nb_queued;
+
+    int64_t next_tick;       // Next output tick (units of 1/rate)
+    int started;
+    int eof;
+    double end_pos;          // Position where the last input frame ends (set at EOF)
+    double last_pos;
+
+    int64_t frames_in;
+    int64_t frames_out;
+    int64_t dropped;
+    int64_t duplicated;
+    int64_t blended;
+
+    Decimator decimator;
+} FpsConverterEntry;
+
+static FpsConverterEntry fps_table[MAX_FPS_CONVERTERS] = {0};
+static int next_fps_id = 1;
+
+static FpsConverterEntry* get_fps_entry(int id) {
+    for (int i = 0; i < MAX_FPS_CONVERTERS; i++) {
+        if (fps_table[i].in_use && fps_table[i].id == id) {
+            return &fps_table[i];
+        }
+    }
+    return NULL;
+}
+
+static void fps_queue_pop(FpsConverterEntry *c) {
+    if (!c->queue[0].emitted) {
+        c->dropped++;
+    }
+    av_frame_free(&c->queue[0].frame);
+    c->queue[0] = c->queue[1];
+    memset(&c->queue[1], 0, sizeof(c->queue[1]));
+    c->nb_queued--;
+}
+
+static void free_fps_entry(FpsConverterEntry *c) {
+    for (int i = 0; i < c->nb_queued; i++) {
+        av_frame_free(&c->queue[i].frame);
+    }
+    decimator_uninit(&c->decimator);
+    memset(c, 0, sizeof(*c));
+}
+
+// ============================================================================
+// Frame blending
+// ============================================================================
+
+static int fps_can_blend(const AVFrame *frame) {
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
+    if (!desc) {
+        return 0;
+    }
+    if (desc->flags & (AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_BITSTREAM)) {
+        return 0;
+    }
+    for (int i = 0; i < desc->nb_components; i++) {
+        if (desc->comp[i].depth != 8) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// dst = (a * (256 - w) + b * w + 128) >> 8; written so the compiler can vectorize it
+static void blend_row(uint8_t * restrict dst, const uint8_t * restrict a, const uint8_t * restrict b,
+                      int w, int len) {
+    const int wa = 256 - w;
+    for (int i = 0; i < len; i++) {
+        dst[i] = (uint8_t)((a[i] * wa + b[i] * w + 128) >> 8);
+    }
+}
+
+static int fps_blend(AVFrame *dst, const AVFrame *a, const AVFrame *b, int weight) {
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(a->format);
+    int nb_planes = av_pix_fmt_count_planes(a->format);
+
+    dst->format = a->format;
+    dst->width = a->width;
+    dst->height = a->height;
+    int ret = frame_pool_get_buffer(dst, 0);
+    if (ret < 0) {
+        return ret;
+    }
+    ret = av_frame_copy_props(dst, a);
+    if (ret < 0) {
+        return ret;
+    }
+
+    for (int p = 0; p < nb_planes; p++) {
+        int bytes = av_image_get_linesize(a->format, a->width, p);
+        int h = a->height;
+        if (p == 1 || p == 2) {
+            h = AV_CEIL_RSHIFT(a->height, desc->log2_chroma_h);
+        }
+        for (int y = 0; y < h; y++) {
+            blend_row(dst->data[p] + y * dst->linesize[p],
+                      a->data[p] + y * a->linesize[p],
+                      b->data[p] + y * b->linesize[p],
+                      weight, bytes);
+        }
+    }
+    return 0;
+}
+
+// ============================================================================
+// Conversion
+// ============================================================================
+
+// Emit queue[idx] (or a blend) at the current tick into dst
+static int fps_emit(FpsConverterEntry *c, AVFrame *dst, int idx, int blend_weight) {
+    int ret;
+
+    av_frame_unref(dst);
+    if (blend_weight > 0) {
+        ret = fps_blend(dst, c->queue[0].frame, c->queue[1].frame, blend_weight);
+        c->blended++;
+    } else {
+        ret = av_frame_ref(dst, c->queue[idx].frame);
+        if (c->queue[idx].emitted) {
+            c->duplicated++;
+        }
+        c->queue[idx].emitted = 1;
+    }
+    if (ret < 0) {
+        return ret;
+    }
+
+    dst->pts = av_rescale_q(c->next_tick, av_inv_q(c->rate), c->out_tb);
+    dst->duration = av_rescale_q(1, av_inv_q(c->rate), c->out_tb);
+    dst->time_base = c->out_tb;
+    c->next_tick++;
+    c->frames_out++;
+    return 0;
+}
+
+/**
+ * Produce the next output frame
+ * @returns 0 on success, AVERROR(EAGAIN) if more input is needed, AVERROR_EOF when done
+ */
+static int fps_receive(FpsConverterEntry *c, AVFrame *dst) {
+    for (;;) {
+        if (c->nb_queued == 0) {
+            return c->eof ? AVERROR_EOF : AVERROR(EAGAIN);
+        }
+
+        if (c->mode == FPS_MODE_DROP) {
+            // Keep the first frame landing in each output slot
+            int64_t slot = (int64_t)floor(c->queue[0].pos + 1e-6);
+            if (slot >= c->next_tick) {
+                c->next_tick = slot;
+                int ret = fps_emit(c, dst, 0, 0);
+                fps_queue_pop(c);
+                return ret;
+            }
+            fps_queue_pop(c);
+            continue;
+        }
+
+        double t = (double)c->next_tick;
+
+        if (c->nb_queued < 2) {
+            if (!c->eof) {
+                return AVERROR(EAGAIN);
+            }
+            // Repeat the last frame until its duration is covered
+            if (t < c->end_pos - 0.5 || !c->queue[0].emitted) {
+                return fps_emit(c, dst, 0, 0);
+            }
+            fps_queue_pop(c);
+            continue;
+        }
+
+        if (c->mode == FPS_MODE_DUP) {
+            // Nearest-frame selection: frame i covers ticks with round(pos_i) <= t
+            if (floor(c->queue[1].pos + 0.5) <= t) {
+                fps_queue_pop(c);
+                continue;
+            }
+            return fps_emit(c, dst, 0, 0);
+        }
+
+        // FPS_MODE_BLEND
+        if (c->queue[1].pos <= t) {
+            fps_queue_pop(c);
+            continue;
+        }
+        double span = c->queue[1].pos - c->queue[0].pos;
+        int weight = span > 0.0 ? (int)lrint((t - c->queue[0].pos) / span * 256.0) : 0;
+        if (weight <= 0 || !fps_can_blend(c->queue[0].frame) ||
+            c->queue[0].frame->width != c->queue[1].frame->width ||
+            c->queue[0].frame->height != c->queue[1].frame->height ||
+            c->queue[0].frame->format != c->queue[1].frame->format) {
+            return fps_emit(c, dst, 0, 0);
+        }
+        if (weight >= 256) {
+            return fps_emit(c, dst, 1, 0);
+        }
+        c->queue[0].emitted = 1;
+        return fps_emit(c, dst, 0, weight);
+    }
+}
+
+// ============================================================================
+// FrameRate API Implementation
+// ============================================================================
+
+static int parse_rational_value(napi_env env, napi_value value, AVRational *out) {
+    napi_valuetype type;
+    napi_typeof(env, value, &type);
+
+    if (type == napi_string) {
+        char str[64];
+        size_t str_len;
+        napi_get_value_string_utf8(env, value, str, sizeof(str), &str_len);
+        return av_parse_video_rate(out, str);
+    }
+    if (type == napi_number) {
+        double d;
+        napi_get_value_double(env, value, &d);
+        if (d <= 0) {
+            return AVERROR(EINVAL);
+        }
+        *out = av_d2q(d, 1001000);
+        return 0;
+    }
+    if (type == napi_object) {
+        napi_value num_val, den_val;
+        int32_t num = 0, den = 0;
+        napi_get_named_property(env, value, "num", &num_val);
+        napi_get_named_property(env, value, "den", &den_val);
+        napi_get_value_int32(env, num_val, &num);
+        napi_get_value_int32(env, den_val, &den);
+        if (num <= 0 || den <= 0) {
+            return AVERROR(EINVAL);
+        }
+        *out = (AVRational){num, den};
+        return 0;
+    }
+    return AVERROR(EINVAL);
+}
+
+/**
+ * Create a frame-rate converter
+ * @param srcTimeBase - Time base of incoming frame pts ({num, den}, e.g. the input stream time base)
+ * @param frameRate - Target rate ({num, den}, number or string such as "30000/1001" or "ntsc")
+ * @param options - { mode: "dup" | "drop" | "blend", timeBase: {num, den}, encoderId,
+ *                    decimate: true | { hi, lo, frac, max } (implies mode "drop") }
+ * @returns converterId - FrameRate converter handle ID
+ */
+napi_value fps_converter_create(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 3;
+    napi_value argv[3];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 2) {
+        napi_throw_error(env, NULL, "Expected source time base and target frame rate");
+        return NULL;
+    }
+
+    AVRational src_tb, rate;
+    if (parse_rational_value(env, argv[0], &src_tb) < 0) {
+        napi_throw_error(env, NULL, "Invalid source time base");
+        return NULL;
+    }
+    if (parse_rational_value(env, argv[1], &rate) < 0 || rate.num <= 0 || rate.den <= 0) {
+        napi_throw_error(env, NULL, "Invalid target frame rate");
+        return NULL;
+    }
+
+    FpsMode mode = FPS_MODE_DUP;
+    int mode_set = 0;
+    AVRational out_tb = av_inv_q(rate);
+    napi_value decimate_opts = NULL;
+
+    if (argc >= 3) {
+        napi_valuetype valuetype;
+        napi_typeof(env, argv[2], &valuetype);
+        if (valuetype == napi_object) {
+            bool has = false;
+            napi_value val;
+
+            napi_has_named_property(env, argv[2], "mode", &has);
+            if (has) {
+                char mode_str[16] = {0};
+                size_t str_len;
+                napi_get_named_property(env, argv[2], "mode", &val);
+                napi_get_value_string_utf8(env, val, mode_str, sizeof(mode_str), &str_len);
+                if (strcmp(mode_str, "dup") == 0) {
+                    mode = FPS_MODE_DUP;
+                } else if (strcmp(mode_str, "drop") == 0) {
+                    mode = FPS_MODE_DROP;
+                } else if (strcmp(mode_str, "blend") == 0) {
+                    mode = FPS_MODE_BLEND;
+                } else {
+                    napi_throw_error(env, NULL, "Invalid mode, expected \"dup\", \"drop\" or \"blend\"");
+                    return NULL;
+                }
+                mode_set = 1;
+            }
+
+            napi_has_named_property(env, argv[2], "encoderId", &has);
+            if (has) {
+                int32_t encoder_id;
+                napi_get_named_property(env, argv[2], "encoderId", &val);
+                napi_get_value_int32(env, val, &encoder_id);
+                if (handle_is_busy(env, encoder_id)) {
+                    return NULL;
+                }
+                AVCodecContext *enc_ctx = get_context_ptr(encoder_id, CTX_TYPE_ENCODER);
+                if (!enc_ctx || enc_ctx->time_base.num <= 0 || enc_ctx->time_base.den <= 0) {
+                    napi_throw_error(env, NULL, "Invalid encoder context or encoder time base not set");
+                    return NULL;
+                }
+                out_tb = enc_ctx->time_base;
+            }
+
+            napi_has_named_property(env, argv[2], "timeBase", &has);
+            if (has) {
+                napi_get_named_property(env, argv[2], "timeBase", &val);
+                if (parse_rational_value(env, val, &out_tb) < 0) {
+                    napi_throw_error(env, NULL, "Invalid output time base");
+                    return NULL;
+                }
+            }
+
+            napi_has_named_property(env, argv[2], "decimate", &has);
+            if (has) {
+                napi_valuetype dec_type;
+                bool enabled = true;
+                napi_get_named_property(env, argv[2], "decimate", &val);
+                napi_typeof(env, val, &dec_type);
+                if (dec_type == napi_boolean) {
+                    napi_get_value_bool(env, val, &enabled);
+                }
+                if (enabled && (dec_type == napi_boolean || dec_type == napi_object)) {
+                    decimate_opts = val;
+                }
+            }
+        }
+    }
+
+    // A constant-rate mode would duplicate the decimated frames right back in
+    if (decimate_opts) {
+        if (mode_set && mode != FPS_MODE_DROP) {
+            napi_throw_error(env, NULL, "decimate requires mode \"drop\"");
+            return NULL;
+        }
+        mode = FPS_MODE_DROP;
+    }
+
+    FpsConverterEntry *c = NULL;
+    for (int i = 0; i < MAX_FPS_CONVERTERS; i++) {
+        if (!fps_table[i].in_use) {
+            c = &fps_table[i];
+            break;
+        }
+    }
+    if (!c) {
+        napi_throw_error(env, NULL, "Too many frame-rate converters");
+        return NULL;
+    }
+
+    memset(c, 0, sizeof(*c));
+    c->id = next_fps_id++;
+    c->in_use = 1;
+    c->mode = mode;
+    c->rate = rate;
+    c->src_tb = src_tb;
+    c->out_tb = out_tb;
+
+    if (decimate_opts && decimator_init_from_js(env, decimate_opts, &c->decimator) < 0) {
+        free_fps_entry(c);
+        napi_throw_error(env, NULL, "SAD functions unavailable, libavutil built without pixelutils");
+        return NULL;
+    }
+
+    napi_value result;
+    napi_create_int32(env, c->id, &result);
+    return result;
+}
+
+/**
+ * Send a decoded frame to the converter
+ * @param converterId - FrameRate converter ID
+ * @param frameId - Frame ID (referenced, not copied), or null to signal end of stream
+ * @returns 0 on success, -1 if output frames must be received first (EAGAIN)
+ */
+napi_value fps_converter_send_frame(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 2;
+    napi_value argv[2];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 2) {
+        napi_throw_error(env, NULL, "Expected converter ID and frame ID");
+        return NULL;
+    }
+
+    int converter_id;
+    napi_get_value_int32(env, argv[0], &converter_id);
+
+    FpsConverterEntry *c = get_fps_entry(converter_id);
+    if (!c) {
+        napi_throw_error(env, NULL, "Invalid frame-rate converter ID");
+        return NULL;
+    }
+
+    napi_value result;
+    napi_valuetype valuetype;
+    napi_typeof(env, argv[1], &valuetype);
+
+    if (valuetype == napi_null || valuetype == napi_undefined) {
+        if (!c->eof) {
+            c->eof = 1;
+            if (c->nb_queued > 0) {
+                const AVFrame *last = c->queue[c->nb_queued - 1].frame;
+                double duration = last->duration > 0 ?
+                    av_q2d(c->src_tb) * last->duration * av_q2d(c->rate) : 1.0;
+                c->end_pos = c->last_pos + FFMAX(duration, 1.0);
+            }
+        }
+        napi_create_int32(env, 0, &result);
+        return result;
+    }
+
+    if (c->eof) {
+        napi_throw_error(env, NULL, "Frame-rate converter already flushed");
+        return NULL;
+    }
+    if (c->nb_queued >= 2) {
+        napi_create_int32(env, -1, &result);
+        return result;
+    }
+
+    int frame_id;
+    napi_get_value_int32(env, argv[1], &frame_id);
+    AVFrame *frame = get_context_ptr(frame_id, CTX_TYPE_FRAME);
+    if (!frame) {
+        napi_throw_error(env, NULL, "Invalid frame ID");
+        return NULL;
+    }
+    if (handle_is_busy(env, frame_id)) {
+        return NULL;
+    }
+
+    // Near-duplicates of the last kept frame never enter the queue
+    if (c->decimator.enabled) {
+        int keep = decimator_filter(&c->decimator, frame);
+        if (keep < 0) {
+            char errbuf[128];
+            av_strerror(keep, errbuf, sizeof(errbuf));
+            napi_throw_error(env, NULL, errbuf);
+            return NULL;
+        }
+        if (!keep) {
+            c->frames_in++;
+            c->dropped++;
+            napi_create_int32(env, 0, &result);
+            return result;
+        }
+    }
+
+    // Position in output ticks; frames without pts follow the previous one
+    double pos;
+    int64_t pts = frame->pts != AV_NOPTS_VALUE ? frame->pts : frame->best_effort_timestamp;
+    if (pts != AV_NOPTS_VALUE) {
+        pos = (double)pts * av_q2d(c->src_tb) * av_q2d(c->rate);
+    } else {
+        pos = c->frames_in > 0 ? c->last_pos + 1.0 : 0.0;
+    }
+    if (c->frames_in > 0 && pos <= c->last_pos) {
+        // Non-monotonic input: treat as immediately following the previous frame
+        pos = c->last_pos + 1e-3;
+    }
+
+    if (!c->started) {
+        c->started = 1;
+        c->next_tick = c->mode == FPS_MODE_DROP ? (int64_t)floor(pos + 1e-6) : llrint(pos);
+    }
+
+    AVFrame *ref = av_frame_clone(frame);
+    if (!ref) {
+        napi_throw_error(env, NULL, "Failed to reference frame");
+        return NULL;
+    }
+
+    c->queue[c->nb_queued].frame = ref;
+    c->queue[c->nb_queued].pos = pos;
+    c->queue[c->nb_queued].emitted = 0;
+    c->nb_queued++;
+    c->last_pos = pos;
+    c->frames_in++;
+
+    napi_create_int32(env, 0, &result);
+    return result;
+}
+
+/**
+ * Receive the next output frame
+ * @param converterId - FrameRate converter ID
+ * @param frameId - Destination frame ID (references input buffers; blended frames get new buffers)
+ * @returns 0 on success, -1 if more input is needed (EAGAIN), -2 at end of stream (EOF)
+ */
+napi_value fps_converter_receive_frame(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 2;
+    napi_value argv[2];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 2) {
+        napi_throw_error(env, NULL, "Expected converter ID and frame ID");
+        return NULL;
+    }
+
+    int converter_id, frame_id;
+    napi_get_value_int32(env, argv[0], &converter_id);
+    napi_get_value_int32(env, argv[1], &frame_id);
+
+    FpsConverterEntry *c = get_fps_entry(converter_id);
+    if (!c) {
+        napi_throw_error(env, NULL, "Invalid frame-rate converter ID");
+        return NULL;
+    }
+    AVFrame *dst = get_context_ptr(frame_id, CTX_TYPE_FRAME);
+    if (!dst) {
+        napi_throw_error(env, NULL, "Invalid frame ID");
+        return NULL;
+    }
+    if (handle_is_busy(env, frame_id)) {
+        return NULL;
+    }
+
+    int ret = fps_receive(c, dst);
+
+    napi_value result;
+    if (ret == 0) {
+        napi_create_int32(env, 0, &result);
+    } else if (ret == AVERROR(EAGAIN)) {
+        napi_create_int32(env, -1, &result);
+    } else if (ret == AVERROR_EOF) {
+        napi_create_int32(env, -2, &result);
+    } else {
+        char errbuf[128];
+        av_strerror(ret, errbuf, sizeof(errbuf));
+        napi_throw_error(env, NULL, errbuf);
+        return NULL;
+    }
+    return result;
+}
+
+/**
+ * Get converter statistics
+ * @param converterId - FrameRate converter ID
+ * @returns { framesIn, framesOut, dropped, duplicated, blended, decimated }
+ */
+napi_value fps_converter_get_stats(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 1;
+    napi_value argv[1];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected converter ID");
+        return NULL;
+    }
+
+    int converter_id;
+    napi_get_value_int32(env, argv[0], &converter_id);
+
+    FpsConverterEntry *c = get_fps_entry(converter_id);
+    if (!c) {
+        napi_throw_error(env, NULL, "Invalid frame-rate converter ID");
+        return NULL;
+    }
+
+    napi_value result, val;
+    napi_create_object(env, &result);
+    napi_create_int64(env, c->frames_in, &val);
+    napi_set_named_property(env, result, "framesIn", val);
+    napi_create_int64(env, c->frames_out, &val);
+    napi_set_named_property(env, result, "framesOut", val);
+    napi_create_int64(env, c->dropped, &val);
+    napi_set_named_property(env, result, "dropped", val);
+    napi_create_int64(env, c->duplicated, &val);
+    napi_set_named_property(env, result, "duplicated", val);
+    napi_create_int64(env, c->blended, &val);
+    napi_set_named_property(env, result, "blended", val);
+    napi_create_int64(env, c->decimator.decimated, &val);
+    napi_set_named_property(env, result, "decimated", val);
+    return result;
+}
+
+/**
+ * Free a frame-rate converter
+ * @param converterId - FrameRate converter ID
+ */
+napi_value fps_converter_free(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 1;
+    napi_value argv[1];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected converter ID");
+        return NULL;
+    }
+
+    int converter_id;
+    napi_get_value_int32(env, argv[0], &converter_id);
+
+    FpsConverterEntry *c = get_fps_entry(converter_id);
+    if (c) {
+        free_fps_entry(c);
+    }
+    return NULL;
+}
+
+// ============================================================================
+// Decimator API - Standalone near-duplicate frame filter
+// ============================================================================
+
+#define MAX_DECIMATORS 256
+
+typedef struct {
+    int id;
+    int in_use;
+    Decimator decimator;
+    int64_t frames_in;
+} DecimatorEntry;
+
+static DecimatorEntry decimator_table[MAX_DECIMATORS] = {0};
+static int next_decimator_id = 1;
+
+static DecimatorEntry* get_decimator_entry(int id) {
+    for (int i = 0; i < MAX_DECIMATORS; i++) {
+        if (decimator_table[i].in_use && decimator_table[i].id == id) {
+            return &decimator_table[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Create a decimator
+ * @param options - { hi (default 768), lo (default 320), frac (default 0.33), max (default 0) }
+ * @returns decimatorId - Decimator handle ID
+ */
+napi_value decimator_create(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 1;
+    napi_value argv[1];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok) {
+        napi_throw_error(env, NULL, "Failed to parse arguments");
+        return NULL;
+    }
+
+    DecimatorEntry *d = NULL;
+    for (int i = 0; i < MAX_DECIMATORS; i++) {
+        if (!decimator_table[i].in_use) {
+            d = &decimator_table[i];
+            break;
+        }
+    }
+    if (!d) {
+        napi_throw_error(env, NULL, "Too many decimators");
+        return NULL;
+    }
+
+    napi_value options = NULL;
+    if (argc >= 1) {
+        options = argv[0];
+    } else {
+        napi_get_undefined(env, &options);
+    }
+
+    memset(d, 0, sizeof(*d));
+    if (decimator_init_from_js(env, options, &d->decimator) < 0) {
+        napi_throw_error(env, NULL, "SAD functions unavailable, libavutil built without pixelutils");
+        return NULL;
+    }
+    d->id = next_decimator_id++;
+    d->in_use = 1;
+
+    napi_value result;
+    napi_create_int32(env, d->id, &result);
+    return result;
+}
+
+/**
+ * Test a frame against the last kept frame
+ * @param decimatorId - Decimator ID
+ * @param frameId - Frame ID
+ * @returns true to keep the frame (its pts unchanged, giving VFR output), false to drop it
+ */
+napi_value decimator_filter_frame(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 2;
+    napi_value argv[2];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 2) {
+        napi_throw_error(env, NULL, "Expected decimator ID and frame ID");
+        return NULL;
+    }
+
+    int decimator_id, frame_id;
+    napi_get_value_int32(env, argv[0], &decimator_id);
+    napi_get_value_int32(env, argv[1], &frame_id);
+
+    DecimatorEntry *d = get_decimator_entry(decimator_id);
+    if (!d) {
+        napi_throw_error(env, NULL, "Invalid decimator ID");
+        return NULL;
+    }
+    AVFrame *frame = get_context_ptr(frame_id, CTX_TYPE_FRAME);
+    if (!frame) {
+        napi_throw_error(env, NULL, "Invalid frame ID");
+        return NULL;
+    }
+    if (handle_is_busy(env, frame_id)) {
+        return NULL;
+    }
+
+    int ret = decimator_filter(&d->decimator, frame);
+    if (ret < 0) {
+        char errbuf[128];
+        av_strerror(ret, errbuf, sizeof(errbuf));
+        napi_throw_error(env, NULL, errbuf);
+        return NULL;
+    }
+    d->frames_in++;
+
+    napi_value result;
+    napi_get_boolean(env, ret == 1, &result);
+    return result;
+}
+
+/**
+ * Get decimator statistics
+ * @param decimatorId - Decimator ID
+ * @returns { framesIn, kept, decimated }
+ */
+napi_value decimator_get_stats(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 1;
+    napi_value argv[1];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected decimator ID");
+        return NULL;
+    }
+
+    int decimator_id;
+    napi_get_value_int32(env, argv[0], &decimator_id);
+
+    DecimatorEntry *d = get_decimator_entry(decimator_id);
+    if (!d) {
+        napi_throw_error(env, NULL, "Invalid decimator ID");
+        return NULL;
+    }
+
+    napi_value result, val;
+    napi_create_object(env, &result);
+    napi_create_int64(env, d->frames_in, &val);
+    napi_set_named_property(env, result, "framesIn", val);
+    napi_create_int64(env, d->frames_in - d->decimator.decimated, &val);
+    napi_set_named_property(env, result, "kept", val);
+    napi_create_int64(env, d->decimator.decimated, &val);
+    napi_set_named_property(env, result, "decimated", val);
+    return result;
+}
+
+/**
+ * Free a decimator
+ * @param decimatorId - Decimator ID
+ */
+napi_value decimator_free(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 1;
+    napi_value argv[1];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected decimator ID");
+        return NULL;
+    }
+
+    int decimator_id;
+    napi_get_value_int32(env, argv[0], &decimator_id);
+
+    DecimatorEntry *d = get_decimator_entry(decimator_id);
+    if (d) {
+        decimator_uninit(&d->decimator);
+        memset(d, 0, sizeof(*d));
+    }
+    return NULL;
+}
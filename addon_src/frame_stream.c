@@ -0,0 +1,583 @@
+/**
+ * @file frame_stream.c
+ * @brief Prefetching frame decode - A native thread demuxes and decodes ahead of the JS consumer
+ * @description Each reader owns a demuxer, a decoder and a thread that keeps a bounded ring of
+ *              decoded frames filled. Reads move every ready frame into caller-supplied frame
+ *              handles at once, so JavaScript gets a batch per tick and decode latency is hidden
+ *              behind whatever the consumer does with the previous batch
+ */
+
+#include <node_api.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavformat/avformat.h"
+#include "libavcodec/avcodec.h"
+#include "libavutil/avstring.h"
+#include "libavutil/frame.h"
+#include "libavutil/thread.h"
+
+#include "atomic_api.h"
+#include "memory_budget.h"
+
+#define MAX_FRAME_STREAMS 256
+#define MAX_PREFETCH 64
+#define DEFAULT_PREFETCH 8
+
+// ============================================================================
+// Context Management for frame stream readers
+// ============================================================================
+
+typedef struct {
+    int id;
+    int in_use;
+
+    // Opened by the decode thread; stream_idx holds the requested index (-1 for auto) until then
+    char url[1024];
+    int threads;
+    AVFormatContext *fmt_ctx;
+    AVCodecContext *dec_ctx;
+    int stream_idx;
+    AVPacket *pkt;
+    MemoryBudget *budget;
+
+    // Decoded frame ring, filled by the decode thread; slots outside [head, head + count) belong
+    // to the thread, slots inside to the reader
+    pthread_t thread;
+    int thread_started;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;       // Broadcast whenever count, finished or abort changes
+    AVFrame *queue[MAX_PREFETCH];
+    int capacity;
+    int head;
+    int count;
+    int finished;              // Decoder drained or failed; no more frames will be queued
+    int error;                 // Open or decode error, reported once the queued frames are consumed
+    int abort;
+    int read_pending;          // A read is waiting; the next frame or the end wakes it through the notifier
+
+    // Pending read state (JS thread)
+    int busy;
+    napi_deferred deferred;
+    int frame_ids[MAX_PREFETCH];
+    int nb_frame_ids;
+} FrameStreamEntry;
+
+static FrameStreamEntry frame_stream_table[MAX_FRAME_STREAMS] = {0};
+static int next_frame_stream_id = 1;
+
+// Settles pending reads on the JS thread; data carries the stream ID, so a wakeup that arrives
+// after the reader was closed finds nothing and is dropped
+static napi_threadsafe_function frame_stream_notify;
+static int nb_pending_reads;   // The notifier keeps the event loop alive while reads are pending
+
+static FrameStreamEntry* alloc_frame_stream_entry(void) {
+    for (int i = 0; i < MAX_FRAME_STREAMS; i++) {
+        if (!frame_stream_table[i].in_use) {
+            memset(&frame_stream_table[i], 0, sizeof(frame_stream_table[i]));
+            frame_stream_table[i].id = next_frame_stream_id++;
+            frame_stream_table[i].in_use = 1;
+            pthread_mutex_init(&frame_stream_table[i].lock, NULL);
+            pthread_cond_init(&frame_stream_table[i].cond, NULL);
+            return &frame_stream_table[i];
+        }
+    }
+    return NULL;
+}
+
+static FrameStreamEntry* get_frame_stream_entry(int id) {
+    for (int i = 0; i < MAX_FRAME_STREAMS; i++) {
+        if (frame_stream_table[i].in_use && frame_stream_table[i].id == id) {
+            return &frame_stream_table[i];
+        }
+    }
+    return NULL;
+}
+
+static void free_frame_stream_entry(FrameStreamEntry *s) {
+    if (s->thread_started) {
+        pthread_mutex_lock(&s->lock);
+        s->abort = 1;
+        pthread_cond_broadcast(&s->cond);
+        pthread_mutex_unlock(&s->lock);
+        pthread_join(s->thread, NULL);
+    }
+    for (int i = 0; i < MAX_PREFETCH; i++) {
+        av_frame_free(&s->queue[i]);
+    }
+    av_packet_free(&s->pkt);
+    avcodec_free_context(&s->dec_ctx);
+    avformat_close_input(&s->fmt_ctx);
+    memory_budget_unref(&s->budget);
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->lock);
+    memset(s, 0, sizeof(*s));
+}
+
+// ============================================================================
+// Decode Thread
+// ============================================================================
+
+// Lets a close interrupt blocking network reads
+static int frame_stream_interrupt(void *opaque) {
+    FrameStreamEntry *s = opaque;
+    pthread_mutex_lock(&s->lock);
+    int abort = s->abort;
+    pthread_mutex_unlock(&s->lock);
+    return abort;
+}
+
+// Open the input and decoder on the decode thread, so slow network opens and stream probing never
+// run on the JS thread; a close interrupts them through the interrupt callback
+static int frame_stream_init(FrameStreamEntry *s) {
+    int ret;
+
+    s->fmt_ctx = avformat_alloc_context();
+    if (!s->fmt_ctx) {
+        return AVERROR(ENOMEM);
+    }
+    s->fmt_ctx->interrupt_callback.callback = frame_stream_interrupt;
+    s->fmt_ctx->interrupt_callback.opaque = s;
+    ret = avformat_open_input(&s->fmt_ctx, s->url, NULL, NULL);
+    if (ret < 0) {
+        return ret;
+    }
+    ret = avformat_find_stream_info(s->fmt_ctx, NULL);
+    if (ret < 0) {
+        return ret;
+    }
+
+    // Default: best video stream, else best audio stream
+    const AVCodec *codec = NULL;
+    if (s->stream_idx >= 0) {
+        if ((unsigned)s->stream_idx >= s->fmt_ctx->nb_streams) {
+            return AVERROR_STREAM_NOT_FOUND;
+        }
+        codec = avcodec_find_decoder(s->fmt_ctx->streams[s->stream_idx]->codecpar->codec_id);
+        ret = codec ? s->stream_idx : AVERROR_DECODER_NOT_FOUND;
+    } else {
+        ret = av_find_best_stream(s->fmt_ctx, AVMEDIA_TYPE_VIDEO, -1, -1, &codec, 0);
+        if (ret < 0) {
+            ret = av_find_best_stream(s->fmt_ctx, AVMEDIA_TYPE_AUDIO, -1, -1, &codec, 0);
+        }
+    }
+    if (ret < 0) {
+        return ret;
+    }
+    s->stream_idx = ret;
+
+    // Only the selected stream is demuxed
+    for (unsigned int i = 0; i < s->fmt_ctx->nb_streams; i++) {
+        if ((int)i != s->stream_idx) {
+            s->fmt_ctx->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    AVStream *st = s->fmt_ctx->streams[s->stream_idx];
+    s->dec_ctx = avcodec_alloc_context3(codec);
+    if (!s->dec_ctx) {
+        return AVERROR(ENOMEM);
+    }
+    ret = avcodec_parameters_to_context(s->dec_ctx, st->codecpar);
+    if (ret < 0) {
+        return ret;
+    }
+    s->dec_ctx->pkt_timebase = st->time_base;
+    s->dec_ctx->thread_count = s->threads;
+    memory_budget_attach_decoder(s->dec_ctx, s->budget);
+    return avcodec_open2(s->dec_ctx, codec, NULL);
+}
+
+// Called with the lock held whenever a frame is queued or the thread finishes
+static void frame_stream_wake_reader(FrameStreamEntry *s) {
+    pthread_cond_broadcast(&s->cond);
+    if (s->read_pending) {
+        s->read_pending = 0;
+        napi_call_threadsafe_function(frame_stream_notify, (void *)(intptr_t)s->id, napi_tsfn_nonblocking);
+    }
+}
+
+static int frame_stream_decode(FrameStreamEntry *s) {
+    int demux_eof = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&s->lock);
+        while (!s->abort && s->count == s->capacity) {
+            pthread_cond_wait(&s->cond, &s->lock);
+        }
+        AVFrame *slot = s->queue[(s->head + s->count) % s->capacity];
+        int abort = s->abort;
+        pthread_mutex_unlock(&s->lock);
+        if (abort) {
+            return AVERROR_EXIT;
+        }
+
+        int ret = avcodec_receive_frame(s->dec_ctx, slot);
+        if (ret == 0) {
+            slot->time_base = s->dec_ctx->pkt_timebase;
+            pthread_mutex_lock(&s->lock);
+            s->count++;
+            frame_stream_wake_reader(s);
+            pthread_mutex_unlock(&s->lock);
+            continue;
+        }
+        if (ret == AVERROR_EOF) {
+            return 0;
+        }
+        if (ret != AVERROR(EAGAIN)) {
+            return ret;
+        }
+
+        if (demux_eof) {
+            avcodec_send_packet(s->dec_ctx, NULL);
+            continue;
+        }
+
+        // Decoder buffers are charged without waiting, so hold back new input while over budget;
+        // this is the stream's own thread, not a thread-pool one
+        if (s->budget && (ret = memory_budget_wait(s->budget, frame_stream_interrupt, s)) < 0) {
+            return ret;
+        }
+
+        ret = av_read_frame(s->fmt_ctx, s->pkt);
+        if (ret == AVERROR_EOF) {
+            demux_eof = 1;
+            continue;
+        }
+        if (ret < 0) {
+            return ret;
+        }
+        if (s->pkt->stream_index == s->stream_idx) {
+            ret = avcodec_send_packet(s->dec_ctx, s->pkt);
+            // Corrupt packets are skipped rather than ending the stream
+            if (ret < 0 && ret != AVERROR(EAGAIN) && ret != AVERROR_INVALIDDATA) {
+                av_packet_unref(s->pkt);
+                return ret;
+            }
+        }
+        av_packet_unref(s->pkt);
+    }
+}
+
+static void *frame_stream_thread(void *arg) {
+    FrameStreamEntry *s = arg;
+    int ret = frame_stream_init(s);
+    if (ret >= 0) {
+        ret = frame_stream_decode(s);
+    }
+
+    pthread_mutex_lock(&s->lock);
+    s->finished = 1;
+    if (ret < 0 && !s->abort) {
+        s->error = ret;
+    }
+    frame_stream_wake_reader(s);
+    pthread_mutex_unlock(&s->lock);
+    return NULL;
+}
+
+// ============================================================================
+// Reads - Frames are handed over on the JS thread
+// ============================================================================
+
+/**
+ * Move ready frames into the reader's frame handles (JS thread)
+ * @returns number of frames moved, 0 at end of stream, or negative AVERROR; a first handle that
+ *          was freed (EINVAL) or lent to a codecTransfer (EBUSY) while the read was pending fails
+ *          the read instead of looking like the end of the stream
+ */
+static int frame_stream_take(FrameStreamEntry *s) {
+    int n = 0, err = 0;
+
+    pthread_mutex_lock(&s->lock);
+    while (n < s->nb_frame_ids && s->count > 0) {
+        AVFrame *dst = get_context_ptr(s->frame_ids[n], CTX_TYPE_FRAME);
+        if (!dst) {
+            err = AVERROR(EINVAL);
+            break;
+        }
+        if (handle_is_busy(NULL, s->frame_ids[n])) {
+            err = AVERROR(EBUSY);
+            break;
+        }
+        av_frame_unref(dst);
+        av_frame_move_ref(dst, s->queue[s->head]);
+        s->head = (s->head + 1) % s->capacity;
+        s->count--;
+        n++;
+    }
+    if (n) {
+        pthread_cond_broadcast(&s->cond);
+    }
+    int ret = n ? n : err ? err : s->error;
+    pthread_mutex_unlock(&s->lock);
+    return ret;
+}
+
+static void frame_stream_settle(napi_env env, FrameStreamEntry *s, int ret) {
+    if (ret < 0) {
+        char errbuf[128];
+        av_strerror(ret, errbuf, sizeof(errbuf));
+        napi_value msg, error;
+        napi_create_string_utf8(env, errbuf, NAPI_AUTO_LENGTH, &msg);
+        napi_create_error(env, NULL, msg, &error);
+        napi_reject_deferred(env, s->deferred, error);
+    } else {
+        napi_value result;
+        napi_create_int32(env, ret, &result);
+        napi_resolve_deferred(env, s->deferred, result);
+    }
+    s->deferred = NULL;
+}
+
+static void frame_stream_end_read(napi_env env, FrameStreamEntry *s) {
+    s->busy = 0;
+    if (--nb_pending_reads == 0) {
+        napi_unref_threadsafe_function(env, frame_stream_notify);
+    }
+}
+
+// The decode thread queued a frame or finished while a read was pending
+static void frame_stream_notify_read(napi_env env, napi_value js_cb, void *context, void *data) {
+    FrameStreamEntry *s = get_frame_stream_entry((int)(intptr_t)data);
+    (void)js_cb;
+    (void)context;
+
+    if (!env || !s || !s->busy) {
+        return;
+    }
+    frame_stream_end_read(env, s);
+    frame_stream_settle(env, s, frame_stream_take(s));
+}
+
+// ============================================================================
+// Streaming Frame Decode API
+// ============================================================================
+
+/**
+ * Open a frame stream reader; opening and decoding start immediately on a native thread
+ * @param filePath - Input file path or URL
+ * @param options - { streamIndex, prefetch, threads, memoryBudget }
+ * @returns streamId - Frame stream reader ID; frames carry the stream time base (time_base).
+ *          Errors opening the input or decoder reject the first read
+ */
+napi_value frame_stream_open(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 2;
+    napi_value argv[2];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected file path argument");
+        return NULL;
+    }
+
+    char file_path[1024];
+    size_t str_len;
+    status = napi_get_value_string_utf8(env, argv[0], file_path, sizeof(file_path), &str_len);
+    if (status != napi_ok) {
+        napi_throw_error(env, NULL, "Failed to get file path");
+        return NULL;
+    }
+
+    int32_t stream_idx = -1, prefetch = DEFAULT_PREFETCH, threads = 0;
+    napi_value options = NULL;
+    if (argc >= 2) {
+        napi_valuetype valuetype;
+        napi_typeof(env, argv[1], &valuetype);
+        if (valuetype == napi_object) {
+            options = argv[1];
+            const char *names[] = { "streamIndex", "prefetch", "threads" };
+            int32_t *values[] = { &stream_idx, &prefetch, &threads };
+            for (int i = 0; i < 3; i++) {
+                bool has = false;
+                napi_value val;
+                napi_valuetype type;
+                napi_has_named_property(env, options, names[i], &has);
+                if (has) {
+                    napi_get_named_property(env, options, names[i], &val);
+                    napi_typeof(env, val, &type);
+                    if (type == napi_number) {
+                        napi_get_value_int32(env, val, values[i]);
+                    }
+                }
+            }
+        }
+    }
+    if (prefetch < 1 || prefetch > MAX_PREFETCH || threads < 0) {
+        napi_throw_error(env, NULL, "prefetch must be between 1 and 64 and threads must not be negative");
+        return NULL;
+    }
+
+    if (!frame_stream_notify) {
+        napi_value name;
+        napi_create_string_utf8(env, "ffmpeg7:frameStreamRead", NAPI_AUTO_LENGTH, &name);
+        if (napi_create_threadsafe_function(env, NULL, NULL, name, 0, 1, NULL, NULL, NULL,
+                                            frame_stream_notify_read, &frame_stream_notify) != napi_ok) {
+            napi_throw_error(env, NULL, "Failed to create frame stream notifier");
+            return NULL;
+        }
+        napi_unref_threadsafe_function(env, frame_stream_notify);
+    }
+
+    MemoryBudget *budget = NULL;
+    if (memory_budget_from_option(env, options, &budget) < 0) {
+        return NULL;
+    }
+
+    FrameStreamEntry *s = alloc_frame_stream_entry();
+    if (!s) {
+        memory_budget_unref(&budget);
+        napi_throw_error(env, NULL, "Too many frame streams");
+        return NULL;
+    }
+    s->budget = budget;
+
+    char errbuf[128];
+    int ret;
+    av_strlcpy(s->url, file_path, sizeof(s->url));
+    s->stream_idx = stream_idx;
+    s->threads = threads;
+
+    s->pkt = av_packet_alloc();
+    if (!s->pkt) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    s->capacity = prefetch;
+    for (int i = 0; i < prefetch; i++) {
+        if (!(s->queue[i] = av_frame_alloc())) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+    }
+
+    if ((ret = pthread_create(&s->thread, NULL, frame_stream_thread, s)) != 0) {
+        ret = AVERROR(ret);
+        goto fail;
+    }
+    s->thread_started = 1;
+
+    napi_value result;
+    napi_create_int32(env, s->id, &result);
+    return result;
+
+fail:
+    av_strerror(ret, errbuf, sizeof(errbuf));
+    free_frame_stream_entry(s);
+    napi_throw_error(env, NULL, errbuf);
+    return NULL;
+}
+
+/**
+ * Read the next batch of decoded frames
+ * @param streamId - Frame stream reader ID
+ * @param frameIds - Frame handles to fill; each receives a new reference, replacing its previous contents
+ * @returns Promise resolving to the number of handles filled (every ready frame, up to
+ *          frameIds.length), or 0 at end of stream. Resolves at once when frames are already
+ *          queued; otherwise the decode thread settles it, so no thread-pool thread waits
+ */
+napi_value frame_stream_read(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 2;
+    napi_value argv[2];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 2) {
+        napi_throw_error(env, NULL, "Expected frame stream ID and frame IDs");
+        return NULL;
+    }
+
+    int stream_id;
+    napi_get_value_int32(env, argv[0], &stream_id);
+
+    FrameStreamEntry *s = get_frame_stream_entry(stream_id);
+    if (!s) {
+        napi_throw_error(env, NULL, "Invalid frame stream ID");
+        return NULL;
+    }
+    if (s->busy) {
+        napi_throw_error(env, NULL, "A read is already pending on this frame stream");
+        return NULL;
+    }
+
+    bool is_array = false;
+    uint32_t length = 0;
+    napi_is_array(env, argv[1], &is_array);
+    if (!is_array || napi_get_array_length(env, argv[1], &length) != napi_ok || length == 0) {
+        napi_throw_error(env, NULL, "Expected a non-empty array of frame IDs");
+        return NULL;
+    }
+    s->nb_frame_ids = FFMIN(length, MAX_PREFETCH);
+    for (int i = 0; i < s->nb_frame_ids; i++) {
+        napi_value val;
+        napi_get_element(env, argv[1], i, &val);
+        napi_get_value_int32(env, val, &s->frame_ids[i]);
+        if (!get_context_ptr(s->frame_ids[i], CTX_TYPE_FRAME)) {
+            napi_throw_error(env, NULL, "Invalid frame ID");
+            return NULL;
+        }
+        if (handle_is_busy(env, s->frame_ids[i])) {
+            return NULL;
+        }
+    }
+
+    napi_value promise;
+    status = napi_create_promise(env, &s->deferred, &promise);
+    if (status != napi_ok) {
+        napi_throw_error(env, NULL, "Failed to create promise");
+        return NULL;
+    }
+
+    pthread_mutex_lock(&s->lock);
+    int ready = s->count > 0 || s->finished;
+    s->read_pending = !ready;
+    pthread_mutex_unlock(&s->lock);
+    if (ready) {
+        frame_stream_settle(env, s, frame_stream_take(s));
+        return promise;
+    }
+
+    if (nb_pending_reads++ == 0) {
+        napi_ref_threadsafe_function(env, frame_stream_notify);
+    }
+    s->busy = 1;
+    return promise;
+}
+
+/**
+ * Close a frame stream reader and stop its decode thread
+ * @param streamId - Frame stream reader ID
+ * @description Frames already moved into frame handles stay valid
+ */
+napi_value frame_stream_close(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 1;
+    napi_value argv[1];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected frame stream ID");
+        return NULL;
+    }
+
+    int stream_id;
+    napi_get_value_int32(env, argv[0], &stream_id);
+
+    FrameStreamEntry *s = get_frame_stream_entry(stream_id);
+    if (s) {
+        if (s->busy) {
+            // A wakeup already queued for this read finds no reader and is dropped
+            frame_stream_end_read(env, s);
+            napi_value msg, error;
+            napi_create_string_utf8(env, "Frame stream read was cancelled", NAPI_AUTO_LENGTH, &msg);
+            napi_create_error(env, NULL, msg, &error);
+            napi_reject_deferred(env, s->deferred, error);
+            s->deferred = NULL;
+        }
+        free_frame_stream_entry(s);
+    }
+
+    return NULL;
+}
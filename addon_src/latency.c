@@ -0,0 +1,220 @@
+/**
+ * @file latency.c
+ * @brief Latency histograms - Constant-size log-linear histograms for per-call and end-to-end timings
+ * @description Recording is a handful of integer operations and never allocates, so it can sit on
+ *              every encode/decode/scale call; the shared variant does the same with relaxed atomics
+ *              for handles timed on the thread pool. Percentiles are derived from the buckets on read and
+ *              the same buckets are folded into Prometheus histogram series
+ */
+
+#include <node_api.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "libavutil/bprint.h"
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+
+#include "latency.h"
+
+#define SUB_BUCKETS (1 << LATENCY_SUB_BUCKET_BITS)
+
+// Values below SUB_BUCKETS map 1:1; above, the top LATENCY_SUB_BUCKET_BITS + 1 bits select the bucket
+static int bucket_index(int64_t us) {
+    if (us < SUB_BUCKETS) {
+        return (int)us;
+    }
+    int k = (us >> 32) ? 32 + av_log2((unsigned)(us >> 32)) : av_log2((unsigned)us);
+    int index = ((k - LATENCY_SUB_BUCKET_BITS + 1) << LATENCY_SUB_BUCKET_BITS) +
+                (int)((us >> (k - LATENCY_SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+    return FFMIN(index, LATENCY_BUCKETS - 1);
+}
+
+// Largest value (exclusive) that lands in a bucket
+static int64_t bucket_upper_bound(int index) {
+    if (index < SUB_BUCKETS) {
+        return index + 1;
+    }
+    int k = (index >> LATENCY_SUB_BUCKET_BITS) + LATENCY_SUB_BUCKET_BITS - 1;
+    int64_t sub = SUB_BUCKETS + (index & (SUB_BUCKETS - 1));
+    return (sub + 1) << (k - LATENCY_SUB_BUCKET_BITS);
+}
+
+LatencyHistogram *latency_histogram_alloc(void) {
+    LatencyHistogram *hist = av_malloc(sizeof(*hist));
+    if (hist) {
+        latency_histogram_reset(hist);
+    }
+    return hist;
+}
+
+void latency_histogram_free(LatencyHistogram **hist) {
+    av_freep(hist);
+}
+
+void latency_histogram_reset(LatencyHistogram *hist) {
+    memset(hist, 0, sizeof(*hist));
+    hist->min = INT64_MAX;
+}
+
+void latency_histogram_record(LatencyHistogram *hist, int64_t us) {
+    us = FFMAX(us, 0);
+    hist->counts[bucket_index(us)]++;
+    hist->count++;
+    hist->sum += (double)us;
+    hist->min = FFMIN(hist->min, us);
+    hist->max = FFMAX(hist->max, us);
+}
+
+SharedLatencyHistogram *shared_latency_histogram_alloc(void) {
+    SharedLatencyHistogram *hist = av_malloc(sizeof(*hist));
+    if (!hist) {
+        return NULL;
+    }
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        atomic_init(&hist->counts[i], 0);
+    }
+    atomic_init(&hist->min, INT64_MAX);
+    atomic_init(&hist->max, 0);
+    atomic_init(&hist->sum, 0);
+    return hist;
+}
+
+void shared_latency_histogram_free(SharedLatencyHistogram **hist) {
+    av_freep(hist);
+}
+
+void shared_latency_histogram_record(SharedLatencyHistogram *hist, int64_t us) {
+    us = FFMAX(us, 0);
+    atomic_fetch_add_explicit(&hist->counts[bucket_index(us)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&hist->sum, (uint64_t)us, memory_order_relaxed);
+
+    int64_t seen = atomic_load_explicit(&hist->min, memory_order_relaxed);
+    while (us < seen && !atomic_compare_exchange_weak_explicit(&hist->min, &seen, us,
+                                                               memory_order_relaxed,
+                                                               memory_order_relaxed));
+    seen = atomic_load_explicit(&hist->max, memory_order_relaxed);
+    while (us > seen && !atomic_compare_exchange_weak_explicit(&hist->max, &seen, us,
+                                                               memory_order_relaxed,
+                                                               memory_order_relaxed));
+}
+
+void shared_latency_histogram_snapshot(SharedLatencyHistogram *hist, LatencyHistogram *out, int reset) {
+    int first = -1, last = -1;
+    out->count = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        out->counts[i] = reset ? atomic_exchange_explicit(&hist->counts[i], 0, memory_order_relaxed)
+                               : atomic_load_explicit(&hist->counts[i], memory_order_relaxed);
+        if (out->counts[i]) {
+            first = first < 0 ? i : first;
+            last = i;
+        }
+        out->count += out->counts[i];
+    }
+    uint64_t sum;
+    if (reset) {
+        sum = atomic_exchange_explicit(&hist->sum, 0, memory_order_relaxed);
+        out->min = atomic_exchange_explicit(&hist->min, INT64_MAX, memory_order_relaxed);
+        out->max = atomic_exchange_explicit(&hist->max, 0, memory_order_relaxed);
+    } else {
+        sum = atomic_load_explicit(&hist->sum, memory_order_relaxed);
+        out->min = atomic_load_explicit(&hist->min, memory_order_relaxed);
+        out->max = atomic_load_explicit(&hist->max, memory_order_relaxed);
+    }
+    out->sum = (double)sum;
+    // A sample already in its bucket may not have reached min/max yet; widen them to the buckets
+    // so percentiles are not clipped by a half-recorded sample
+    if (out->count && out->min >= bucket_upper_bound(first)) {
+        out->min = first ? bucket_upper_bound(first - 1) : 0;
+    }
+    if (out->count && out->max < (last ? bucket_upper_bound(last - 1) : 0)) {
+        out->max = bucket_upper_bound(last) - 1;
+    }
+}
+
+int64_t latency_histogram_percentile(const LatencyHistogram *hist, double q) {
+    if (!hist->count) {
+        return 0;
+    }
+    uint64_t target = (uint64_t)ceil(av_clipd(q, 0.0, 1.0) * hist->count);
+    uint64_t seen = 0;
+    target = FFMAX(target, 1);
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += hist->counts[i];
+        if (seen >= target) {
+            // Report the bucket's highest value, but never more than was actually observed
+            return av_clip64(bucket_upper_bound(i) - 1, hist->min, hist->max);
+        }
+    }
+    return hist->max;
+}
+
+static void set_ms(napi_env env, napi_value obj, const char *name, double us) {
+    napi_value val;
+    napi_create_double(env, us / 1000.0, &val);
+    napi_set_named_property(env, obj, name, val);
+}
+
+napi_value latency_histogram_to_js(napi_env env, const LatencyHistogram *hist) {
+    napi_value result, val;
+    int nb_buckets = 0;
+
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        nb_buckets += hist->counts[i] != 0;
+    }
+
+    napi_create_object(env, &result);
+    napi_create_double(env, (double)hist->count, &val);
+    napi_set_named_property(env, result, "count", val);
+    set_ms(env, result, "min", hist->count ? (double)hist->min : 0.0);
+    set_ms(env, result, "max", (double)hist->max);
+    set_ms(env, result, "mean", hist->count ? hist->sum / hist->count : 0.0);
+    set_ms(env, result, "p50", (double)latency_histogram_percentile(hist, 0.50));
+    set_ms(env, result, "p90", (double)latency_histogram_percentile(hist, 0.90));
+    set_ms(env, result, "p99", (double)latency_histogram_percentile(hist, 0.99));
+    set_ms(env, result, "p999", (double)latency_histogram_percentile(hist, 0.999));
+
+    napi_value bounds_buffer, counts_buffer;
+    void *bounds_data, *counts_data;
+    napi_create_arraybuffer(env, nb_buckets * sizeof(double), &bounds_data, &bounds_buffer);
+    napi_create_arraybuffer(env, nb_buckets * sizeof(double), &counts_data, &counts_buffer);
+    double *bounds = bounds_data, *counts = counts_data;
+    for (int i = 0, n = 0; i < LATENCY_BUCKETS; i++) {
+        if (hist->counts[i]) {
+            bounds[n] = bucket_upper_bound(i) / 1000.0;
+            counts[n] = (double)hist->counts[i];
+            n++;
+        }
+    }
+    napi_create_typedarray(env, napi_float64_array, nb_buckets, bounds_buffer, 0, &val);
+    napi_set_named_property(env, result, "bucketUpperBounds", val);
+    napi_create_typedarray(env, napi_float64_array, nb_buckets, counts_buffer, 0, &val);
+    napi_set_named_property(env, result, "bucketCounts", val);
+    return result;
+}
+
+// Prometheus bucket boundaries in microseconds (le labels), 50 us to 10 s
+static const int64_t prometheus_bounds[] = {
+    50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+    100000, 250000, 500000, 1000000, 2500000, 10000000,
+};
+
+void latency_histogram_write_prometheus(AVBPrint *bp, const char *name, const char *labels,
+                                        const LatencyHistogram *hist) {
+    uint64_t cumulative = 0;
+    int i = 0;
+
+    // A log-linear bucket counts towards a boundary once all of its values are below it
+    for (size_t b = 0; b < FF_ARRAY_ELEMS(prometheus_bounds); b++) {
+        for (; i < LATENCY_BUCKETS && bucket_upper_bound(i) <= prometheus_bounds[b]; i++) {
+            cumulative += hist->counts[i];
+        }
+        av_bprintf(bp, "%s_bucket{%s,le=\"%g\"} %"PRIu64"\n", name, labels,
+                   prometheus_bounds[b] / 1e6, cumulative);
+    }
+    av_bprintf(bp, "%s_bucket{%s,le=\"+Inf\"} %"PRIu64"\n", name, labels, hist->count);
+    av_bprintf(bp, "%s_sum{%s} %.9g\n", name, labels, hist->sum / 1e6);
+    av_bprintf(bp, "%s_count{%s} %"PRIu64"\n", name, labels, hist->count);
+}
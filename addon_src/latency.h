@@ -0,0 +1,63 @@
+/**
+ * @file latency.h
+ * @brief Latency histograms shared by the native modules
+ */
+
+#ifndef FFMPEG_NODE_LATENCY_H
+#define FFMPEG_NODE_LATENCY_H
+
+#include <node_api.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "libavutil/bprint.h"
+
+// Log-linear buckets (HdrHistogram layout): 16 linear sub-buckets per power of two,
+// ~6% relative precision from 1 us up to 2^35 us
+#define LATENCY_SUB_BUCKET_BITS 4
+#define LATENCY_BUCKETS 512
+
+typedef struct LatencyHistogram {
+    uint64_t counts[LATENCY_BUCKETS];
+    uint64_t count;
+    int64_t min;              // Microseconds
+    int64_t max;
+    double sum;
+} LatencyHistogram;
+
+// Same buckets, recorded from any thread without a lock; read through a snapshot. The sample count
+// is the sum of the buckets, so a snapshot taken mid-record never reports more samples than buckets
+typedef struct SharedLatencyHistogram {
+    _Atomic uint64_t counts[LATENCY_BUCKETS];
+    _Atomic int64_t min;      // Microseconds
+    _Atomic int64_t max;
+    _Atomic uint64_t sum;
+} SharedLatencyHistogram;
+
+LatencyHistogram *latency_histogram_alloc(void);
+void latency_histogram_free(LatencyHistogram **hist);
+void latency_histogram_reset(LatencyHistogram *hist);
+
+// Add one sample in microseconds; negative samples are clamped to 0
+void latency_histogram_record(LatencyHistogram *hist, int64_t us);
+
+SharedLatencyHistogram *shared_latency_histogram_alloc(void);
+void shared_latency_histogram_free(SharedLatencyHistogram **hist);
+void shared_latency_histogram_record(SharedLatencyHistogram *hist, int64_t us);
+// Copy into a plain histogram; with reset, each counter is swapped for zero so a concurrent sample
+// lands either in this snapshot or in the next one
+void shared_latency_histogram_snapshot(SharedLatencyHistogram *hist, LatencyHistogram *out, int reset);
+
+// Value in microseconds at quantile q (0-1); 0 for an empty histogram
+int64_t latency_histogram_percentile(const LatencyHistogram *hist, double q);
+
+// { count, min, max, mean, p50, p90, p99, p999 } in milliseconds, plus the non-empty buckets as
+// { bucketUpperBounds: Float64Array (ms), bucketCounts: Float64Array }
+napi_value latency_histogram_to_js(napi_env env, const LatencyHistogram *hist);
+
+// Append _bucket/_sum/_count series in Prometheus text exposition format (seconds);
+// labels is a comma-separated label list without braces
+void latency_histogram_write_prometheus(AVBPrint *bp, const char *name, const char *labels,
+                                        const LatencyHistogram *hist);
+
+#endif // FFMPEG_NODE_LATENCY_H
@@ -0,0 +1,595 @@
+/**
+ * @file memory_budget.c
+ * @brief Memory budgets - Byte ceilings shared by native jobs, with producer backpressure
+ * @description A budget is charged for the decoded frames, PCM chunks and FIFO space its jobs hold.
+ *              Thread-pool jobs never block on it: a charge that does not fit fails with EAGAIN
+ *              and the job waits on the JS thread until consumers release memory, so a job
+ *              decoding 8K frames slows down instead of taking the process down or starving the
+ *              pool. Decoder buffers are charged unconditionally and hold back the next job
+ *              instead. Waits that outlast the timeout fail with ENOMEM and wait times are kept in
+ *              a latency histogram
+ */
+
+#include <node_api.h>
+#include <errno.h>
+#include <string.h>
+
+#include "libavcodec/avcodec.h"
+#include "libavutil/buffer.h"
+#include "libavutil/frame.h"
+#include "libavutil/mem.h"
+#include "libavutil/thread.h"
+#include "libavutil/time.h"
+
+#include "latency.h"
+#include "memory_budget.h"
+
+#define MAX_MEMORY_BUDGETS 256
+#define DEFAULT_WAIT_TIMEOUT_MS 30000
+#define ABORT_POLL_US 100000
+
+// A job waiting on the JS thread for room; woken in FIFO order by release
+typedef struct BudgetWaiter {
+    MemoryBudget *budget;
+    int64_t bytes;
+    int64_t start;
+    MemoryBudgetWaitCallback cb;
+    void *opaque;
+    napi_ref timer;            // setTimeout handle for the wait timeout
+    struct BudgetWaiter *next;
+} BudgetWaiter;
+
+struct MemoryBudget {
+    int id;
+    pthread_mutex_t lock;      // Charges and releases come from worker and decoder threads
+    pthread_cond_t cond;       // Wakes dedicated threads blocked in memory_budget_wait
+    int refs;                  // Handle table, attached jobs and outstanding charged buffers
+
+    int64_t limit;
+    int64_t used;
+    int64_t peak;
+    int64_t wait_timeout_us;
+
+    BudgetWaiter *waiters;     // JS-thread waiters; the list is only touched on the JS thread,
+    int nb_waiters;            // the count is read under the lock by releasing threads
+    int blocked;               // Dedicated threads in memory_budget_wait
+    napi_threadsafe_function notify;
+    int notify_pending;        // A notify call is queued and holds a reference
+
+    int64_t waits;             // Charges that had to wait
+    int64_t rejections;        // Charges that timed out or exceed the limit on their own
+    int64_t wait_time_us;
+    LatencyHistogram wait_hist;
+};
+
+static MemoryBudget *budget_table[MAX_MEMORY_BUDGETS];
+static int next_budget_id = 1;
+
+static MemoryBudget *get_budget(int id) {
+    for (int i = 0; i < MAX_MEMORY_BUDGETS; i++) {
+        if (budget_table[i] && budget_table[i]->id == id) {
+            return budget_table[i];
+        }
+    }
+    return NULL;
+}
+
+MemoryBudget *memory_budget_ref(MemoryBudget *budget) {
+    pthread_mutex_lock(&budget->lock);
+    budget->refs++;
+    pthread_mutex_unlock(&budget->lock);
+    return budget;
+}
+
+void memory_budget_unref(MemoryBudget **budget) {
+    MemoryBudget *b = *budget;
+    int destroy;
+
+    if (!b) {
+        return;
+    }
+    *budget = NULL;
+
+    pthread_mutex_lock(&b->lock);
+    destroy = --b->refs == 0;
+    pthread_mutex_unlock(&b->lock);
+
+    if (destroy) {
+        if (b->notify) {
+            napi_release_threadsafe_function(b->notify, napi_tsfn_release);
+        }
+        pthread_cond_destroy(&b->cond);
+        pthread_mutex_destroy(&b->lock);
+        av_free(b);
+    }
+}
+
+// Called with the lock held
+static void record_wait(MemoryBudget *budget, int64_t start, int ret) {
+    int64_t waited = av_gettime_relative() - start;
+    budget->wait_time_us += waited;
+    latency_histogram_record(&budget->wait_hist, waited);
+    if (ret < 0) {
+        budget->rejections++;
+    }
+}
+
+// ============================================================================
+// Charging - Nothing here blocks; thread-pool jobs fail fast with EAGAIN and wait
+// on the JS thread (memory_budget_wait_async) before they are queued again
+// ============================================================================
+
+int memory_budget_try_acquire(MemoryBudget *budget, int64_t bytes) {
+    int ret = 0;
+
+    pthread_mutex_lock(&budget->lock);
+    if (bytes > budget->limit) {
+        budget->rejections++;
+        ret = AVERROR(ENOMEM);
+    } else if (budget->used + bytes > budget->limit) {
+        ret = AVERROR(EAGAIN);
+    } else {
+        budget->used += bytes;
+        budget->peak = FFMAX(budget->peak, budget->used);
+    }
+    pthread_mutex_unlock(&budget->lock);
+    return ret;
+}
+
+void memory_budget_charge(MemoryBudget *budget, int64_t bytes) {
+    pthread_mutex_lock(&budget->lock);
+    budget->used += bytes;
+    budget->peak = FFMAX(budget->peak, budget->used);
+    pthread_mutex_unlock(&budget->lock);
+}
+
+void memory_budget_release(MemoryBudget *budget, int64_t bytes) {
+    pthread_mutex_lock(&budget->lock);
+    budget->used -= bytes;
+    if (budget->blocked) {
+        pthread_cond_broadcast(&budget->cond);
+    }
+    // The queued call keeps the budget alive until it has run on the JS thread
+    if (budget->nb_waiters && !budget->notify_pending && budget->used < budget->limit &&
+        napi_call_threadsafe_function(budget->notify, NULL, napi_tsfn_nonblocking) == napi_ok) {
+        budget->notify_pending = 1;
+        budget->refs++;
+    }
+    pthread_mutex_unlock(&budget->lock);
+}
+
+int memory_budget_wait(MemoryBudget *budget, int (*should_abort)(void *opaque), void *opaque) {
+    int ret = 0;
+
+    pthread_mutex_lock(&budget->lock);
+    if (budget->used < budget->limit) {
+        pthread_mutex_unlock(&budget->lock);
+        return 0;
+    }
+
+    int64_t start = av_gettime_relative();
+    int64_t deadline = start + budget->wait_timeout_us;
+    budget->waits++;
+    budget->blocked++;
+    while (budget->used >= budget->limit) {
+        int64_t now = av_gettime_relative();
+        if (now >= deadline) {
+            ret = AVERROR(ENOMEM);
+            break;
+        }
+        // Short slices so a close is noticed without the budget knowing about the caller
+        int64_t wake = av_gettime() + FFMIN(deadline - now, ABORT_POLL_US);
+        struct timespec ts = {
+            .tv_sec = wake / 1000000,
+            .tv_nsec = (wake % 1000000) * 1000,
+        };
+        pthread_cond_timedwait(&budget->cond, &budget->lock, &ts);
+
+        pthread_mutex_unlock(&budget->lock);
+        int abort = should_abort && should_abort(opaque);
+        pthread_mutex_lock(&budget->lock);
+        if (abort) {
+            ret = AVERROR_EXIT;
+            break;
+        }
+    }
+    budget->blocked--;
+    record_wait(budget, start, ret == AVERROR(ENOMEM) ? ret : 0);
+    pthread_mutex_unlock(&budget->lock);
+    return ret;
+}
+
+// ============================================================================
+// JS-Thread Waits - Timeouts run on a JS timer and wakeups arrive through a
+// threadsafe function, so a full budget holds no thread-pool thread
+// ============================================================================
+
+static void call_global(napi_env env, const char *name, size_t argc, napi_value *argv,
+                        napi_value *result) {
+    napi_value global, fn;
+    napi_get_global(env, &global);
+    napi_get_named_property(env, global, name, &fn);
+    napi_call_function(env, global, fn, argc, argv, result);
+}
+
+static void finish_waiter(napi_env env, BudgetWaiter *w, int status) {
+    MemoryBudget *b = w->budget;
+
+    if (w->timer) {
+        napi_value timer;
+        if (status != AVERROR(ENOMEM) && napi_get_reference_value(env, w->timer, &timer) == napi_ok && timer) {
+            call_global(env, "clearTimeout", 1, &timer, NULL);
+        }
+        napi_delete_reference(env, w->timer);
+    }
+
+    pthread_mutex_lock(&b->lock);
+    b->nb_waiters--;
+    record_wait(b, w->start, status == AVERROR(ENOMEM) ? status : 0);
+    pthread_mutex_unlock(&b->lock);
+
+    MemoryBudgetWaitCallback cb = w->cb;
+    void *opaque = w->opaque;
+    av_free(w);
+    cb(env, opaque, status);
+}
+
+static void unlink_waiter(MemoryBudget *b, BudgetWaiter *w) {
+    for (BudgetWaiter **p = &b->waiters; *p; p = &(*p)->next) {
+        if (*p == w) {
+            *p = w->next;
+            return;
+        }
+    }
+}
+
+static napi_value waiter_timeout(napi_env env, napi_callback_info info) {
+    BudgetWaiter *w;
+    napi_get_cb_info(env, info, NULL, NULL, NULL, (void **)&w);
+    unlink_waiter(w->budget, w);
+    finish_waiter(env, w, AVERROR(ENOMEM));
+    return NULL;
+}
+
+// Wake waiters from the head of the queue while the room they were waiting for is free
+static void notify_waiters(napi_env env, napi_value js_cb, void *context, void *data) {
+    MemoryBudget *b = context;
+    BudgetWaiter *woken = NULL, **tail = &woken;
+    (void)js_cb;
+    (void)data;
+
+    pthread_mutex_lock(&b->lock);
+    b->notify_pending = 0;
+    int64_t room = b->limit - b->used;
+    pthread_mutex_unlock(&b->lock);
+
+    while (env && b->waiters && b->waiters->bytes <= room) {
+        BudgetWaiter *w = b->waiters;
+        b->waiters = w->next;
+        room -= w->bytes;
+        w->next = NULL;
+        *tail = w;
+        tail = &w->next;
+    }
+    while (woken) {
+        BudgetWaiter *w = woken;
+        woken = w->next;
+        finish_waiter(env, w, 0);
+    }
+    memory_budget_unref(&b);
+}
+
+int memory_budget_wait_async(napi_env env, MemoryBudget *budget, int64_t bytes,
+                             MemoryBudgetWaitCallback cb, void *opaque) {
+    pthread_mutex_lock(&budget->lock);
+    int fits = !budget->waiters && budget->used + bytes <= budget->limit;
+    int ret = !fits && (bytes > budget->limit || !budget->wait_timeout_us) ? AVERROR(ENOMEM) : 0;
+    if (ret < 0) {
+        budget->rejections++;
+    }
+    pthread_mutex_unlock(&budget->lock);
+    if (fits || ret < 0) {
+        return fits ? 1 : ret;
+    }
+
+    if (!budget->notify) {
+        napi_value name;
+        napi_create_string_utf8(env, "memoryBudgetNotify", NAPI_AUTO_LENGTH, &name);
+        if (napi_create_threadsafe_function(env, NULL, NULL, name, 0, 1, NULL, NULL, budget,
+                                            notify_waiters, &budget->notify) != napi_ok) {
+            return AVERROR(ENOMEM);
+        }
+        // Pending waits keep the loop alive through their timers, not through the notifier
+        napi_unref_threadsafe_function(env, budget->notify);
+    }
+
+    BudgetWaiter *w = av_mallocz(sizeof(*w));
+    if (!w) {
+        return AVERROR(ENOMEM);
+    }
+    w->budget = budget;
+    w->bytes = bytes;
+    w->start = av_gettime_relative();
+    w->cb = cb;
+    w->opaque = opaque;
+
+    napi_value fn, argv[2], timer;
+    napi_create_function(env, "memoryBudgetWaitTimeout", NAPI_AUTO_LENGTH, waiter_timeout, w, &fn);
+    argv[0] = fn;
+    napi_create_double(env, budget->wait_timeout_us / 1000.0, &argv[1]);
+    call_global(env, "setTimeout", 2, argv, &timer);
+    napi_create_reference(env, timer, 1, &w->timer);
+
+    BudgetWaiter **tail = &budget->waiters;
+    while (*tail) {
+        tail = &(*tail)->next;
+    }
+    *tail = w;
+
+    pthread_mutex_lock(&budget->lock);
+    budget->waits++;
+    budget->nb_waiters++;
+    // Memory may have been released before the waiter was visible to release()
+    if (!budget->notify_pending && budget->used + budget->waiters->bytes <= budget->limit &&
+        napi_call_threadsafe_function(budget->notify, NULL, napi_tsfn_nonblocking) == napi_ok) {
+        budget->notify_pending = 1;
+        budget->refs++;
+    }
+    pthread_mutex_unlock(&budget->lock);
+    return 0;
+}
+
+void memory_budget_cancel_wait(napi_env env, MemoryBudget *budget, void *opaque) {
+    for (BudgetWaiter *w = budget->waiters; w; w = w->next) {
+        if (w->opaque == opaque) {
+            unlink_waiter(budget, w);
+            finish_waiter(env, w, AVERROR_EXIT);
+            return;
+        }
+    }
+}
+
+// ============================================================================
+// Decoder Frames - Buffers from the default allocator are wrapped so the charge
+// follows the frame until its last reference is gone
+// ============================================================================
+
+typedef struct {
+    AVBufferRef *buf;
+    MemoryBudget *budget;
+    int64_t bytes;
+} BudgetCharge;
+
+static void charged_buffer_free(void *opaque, uint8_t *data) {
+    BudgetCharge *charge = opaque;
+    (void)data;
+
+    av_buffer_unref(&charge->buf);
+    memory_budget_release(charge->budget, charge->bytes);
+    memory_budget_unref(&charge->budget);
+    av_free(charge);
+}
+
+static int charge_buffer(MemoryBudget *budget, AVBufferRef **buf) {
+    AVBufferRef *orig = *buf;
+    BudgetCharge *charge = av_mallocz(sizeof(*charge));
+    if (!charge) {
+        return AVERROR(ENOMEM);
+    }
+
+    // Shared pool buffers must stay read-only through the wrapper
+    AVBufferRef *wrapped = av_buffer_create(orig->data, orig->size, charged_buffer_free, charge,
+                                            av_buffer_is_writable(orig) ? 0 : AV_BUFFER_FLAG_READONLY);
+    if (!wrapped) {
+        av_free(charge);
+        return AVERROR(ENOMEM);
+    }
+    memory_budget_charge(budget, orig->size);
+    charge->buf = orig;
+    charge->budget = memory_budget_ref(budget);
+    charge->bytes = orig->size;
+    *buf = wrapped;
+    return 0;
+}
+
+// Called from decoder threads, which must not block or fail here: a decoder can need more
+// reference frames than the whole budget, so its buffers may overdraft it
+static int budget_get_buffer2(AVCodecContext *s, AVFrame *frame, int flags) {
+    int ret = avcodec_default_get_buffer2(s, frame, flags);
+    if (ret < 0) {
+        return ret;
+    }
+    for (int i = 0; i < AV_NUM_DATA_POINTERS && frame->buf[i]; i++) {
+        if ((ret = charge_buffer(s->opaque, &frame->buf[i])) < 0) {
+            av_frame_unref(frame);
+            return ret;
+        }
+    }
+    return 0;
+}
+
+void memory_budget_attach_decoder(AVCodecContext *dec_ctx, MemoryBudget *budget) {
+    if (budget) {
+        dec_ctx->opaque = budget;
+        dec_ctx->get_buffer2 = budget_get_buffer2;
+    }
+}
+
+// ============================================================================
+// Option Helper
+// ============================================================================
+
+int memory_budget_from_option(napi_env env, napi_value options, MemoryBudget **budget) {
+    bool has = false;
+    napi_value val;
+    napi_valuetype type;
+    int32_t id;
+
+    *budget = NULL;
+    if (!options || napi_has_named_property(env, options, "memoryBudget", &has) != napi_ok || !has) {
+        return 0;
+    }
+    napi_get_named_property(env, options, "memoryBudget", &val);
+    napi_typeof(env, val, &type);
+    if (type == napi_undefined || type == napi_null) {
+        return 0;
+    }
+
+    MemoryBudget *b = NULL;
+    if (type == napi_number && napi_get_value_int32(env, val, &id) == napi_ok) {
+        b = get_budget(id);
+    }
+    if (!b) {
+        napi_throw_error(env, NULL, "Invalid memory budget ID");
+        return -1;
+    }
+    *budget = memory_budget_ref(b);
+    return 0;
+}
+
+// ============================================================================
+// N-API Functions
+// ============================================================================
+
+/**
+ * Create a memory budget that native jobs can share through their memoryBudget option
+ * @param limitBytes - Maximum bytes the attached jobs may hold at once
+ * @param options - { waitTimeoutMs } - How long a job waits for memory before failing
+ *                  with ENOMEM (default 30000)
+ * @returns budgetId - Memory budget ID
+ */
+napi_value memory_budget_create(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value argv[2];
+
+    napi_status status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected limitBytes argument");
+        return NULL;
+    }
+
+    double limit = 0, timeout_ms = DEFAULT_WAIT_TIMEOUT_MS;
+    napi_get_value_double(env, argv[0], &limit);
+    if (argc >= 2) {
+        napi_valuetype type;
+        napi_typeof(env, argv[1], &type);
+        if (type == napi_object) {
+            bool has = false;
+            napi_has_named_property(env, argv[1], "waitTimeoutMs", &has);
+            if (has) {
+                napi_value val;
+                napi_get_named_property(env, argv[1], "waitTimeoutMs", &val);
+                napi_get_value_double(env, val, &timeout_ms);
+            }
+        }
+    }
+    if (!(limit >= 1) || !(timeout_ms >= 0)) {
+        napi_throw_error(env, NULL, "limitBytes must be positive and waitTimeoutMs must not be negative");
+        return NULL;
+    }
+
+    int slot = -1;
+    for (int i = 0; i < MAX_MEMORY_BUDGETS && slot < 0; i++) {
+        if (!budget_table[i]) {
+            slot = i;
+        }
+    }
+    if (slot < 0) {
+        napi_throw_error(env, NULL, "Too many memory budgets");
+        return NULL;
+    }
+
+    MemoryBudget *b = av_mallocz(sizeof(*b));
+    if (!b) {
+        napi_throw_error(env, NULL, "Failed to allocate memory budget");
+        return NULL;
+    }
+    pthread_mutex_init(&b->lock, NULL);
+    pthread_cond_init(&b->cond, NULL);
+    latency_histogram_reset(&b->wait_hist);
+    b->id = next_budget_id++;
+    b->refs = 1;
+    b->limit = (int64_t)limit;
+    b->wait_timeout_us = (int64_t)(timeout_ms * 1000);
+    budget_table[slot] = b;
+
+    napi_value result;
+    napi_create_int32(env, b->id, &result);
+    return result;
+}
+
+static void set_number(napi_env env, napi_value obj, const char *name, double value) {
+    napi_value val;
+    napi_create_double(env, value, &val);
+    napi_set_named_property(env, obj, name, val);
+}
+
+/**
+ * Get memory budget usage and backpressure statistics
+ * @param budgetId - Memory budget ID
+ * @returns { limit, used, peak, waiting, waits, rejections, waitTimeMs, waitLatency }
+ */
+napi_value memory_budget_stats(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value argv[1];
+    int32_t id;
+
+    napi_status status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected budget ID");
+        return NULL;
+    }
+    napi_get_value_int32(env, argv[0], &id);
+
+    MemoryBudget *b = get_budget(id);
+    if (!b) {
+        napi_throw_error(env, NULL, "Invalid memory budget ID");
+        return NULL;
+    }
+
+    // Snapshot under the lock; building JS values must not hold up producers
+    pthread_mutex_lock(&b->lock);
+    int64_t limit = b->limit, used = b->used, peak = b->peak;
+    int waiting = b->nb_waiters + b->blocked;
+    int64_t waits = b->waits, rejections = b->rejections, wait_time_us = b->wait_time_us;
+    LatencyHistogram wait_hist = b->wait_hist;
+    pthread_mutex_unlock(&b->lock);
+
+    napi_value result;
+    napi_create_object(env, &result);
+    set_number(env, result, "limit", (double)limit);
+    set_number(env, result, "used", (double)used);
+    set_number(env, result, "peak", (double)peak);
+    set_number(env, result, "waiting", waiting);
+    set_number(env, result, "waits", (double)waits);
+    set_number(env, result, "rejections", (double)rejections);
+    set_number(env, result, "waitTimeMs", wait_time_us / 1000.0);
+    napi_set_named_property(env, result, "waitLatency", latency_histogram_to_js(env, &wait_hist));
+    return result;
+}
+
+/**
+ * Free a memory budget handle
+ * @param budgetId - Memory budget ID
+ * @description Jobs already attached keep the budget alive and enforced until they finish
+ */
+napi_value memory_budget_free(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value argv[1];
+    int32_t id;
+
+    napi_status status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected budget ID");
+        return NULL;
+    }
+    napi_get_value_int32(env, argv[0], &id);
+
+    for (int i = 0; i < MAX_MEMORY_BUDGETS; i++) {
+        if (budget_table[i] && budget_table[i]->id == id) {
+            memory_budget_unref(&budget_table[i]);
+            break;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file memory_budget.h
+ * @brief Byte budgets shared by the native jobs that produce frames, packets and PCM
+ */
+
+#ifndef FFMPEG_NODE_MEMORY_BUDGET_H
+#define FFMPEG_NODE_MEMORY_BUDGET_H
+
+#include <node_api.h>
+#include <stdint.h>
+
+#include "libavcodec/avcodec.h"
+
+typedef struct MemoryBudget MemoryBudget;
+
+// Resolve the memoryBudget option (a budget ID) and take a reference; *budget is NULL when the
+// option is absent. Throws and returns -1 for an unknown ID (JS thread)
+int memory_budget_from_option(napi_env env, napi_value options, MemoryBudget **budget);
+
+MemoryBudget *memory_budget_ref(MemoryBudget *budget);
+void memory_budget_unref(MemoryBudget **budget);
+
+// Charge bytes if they fit right now; never blocks (any thread). Returns AVERROR(EAGAIN) while the
+// budget is full and AVERROR(ENOMEM) when bytes exceed the whole limit
+int memory_budget_try_acquire(MemoryBudget *budget, int64_t bytes);
+// Charge memory that is already allocated and cannot be refused, such as decoder buffers; usage may
+// go over the limit, which holds back new work until it drops again
+void memory_budget_charge(MemoryBudget *budget, int64_t bytes);
+void memory_budget_release(MemoryBudget *budget, int64_t bytes);
+
+// Block a dedicated (non thread-pool) thread until usage is below the limit. Returns
+// AVERROR(ENOMEM) after the wait timeout and AVERROR_EXIT once should_abort(opaque) is true
+int memory_budget_wait(MemoryBudget *budget, int (*should_abort)(void *opaque), void *opaque);
+
+// Called on the JS thread when a wait ends: 0 when the bytes fit (they are not reserved),
+// AVERROR(ENOMEM) after the wait timeout, AVERROR_EXIT when cancelled
+typedef void (*MemoryBudgetWaitCallback)(napi_env env, void *opaque, int status);
+
+// Wait on the JS thread for bytes to fit, so no thread-pool thread is held meanwhile. Returns 1
+// when they fit now (cb is not called), 0 when cb will be called later, negative AVERROR on
+// failure (JS thread)
+int memory_budget_wait_async(napi_env env, MemoryBudget *budget, int64_t bytes,
+                             MemoryBudgetWaitCallback cb, void *opaque);
+// End a pending wait_async early; cb is called with AVERROR_EXIT (JS thread)
+void memory_budget_cancel_wait(napi_env env, MemoryBudget *budget, void *opaque);
+
+// Charge a decoder's frame buffers to the budget; the charge is held until the frame is released
+void memory_budget_attach_decoder(AVCodecContext *dec_ctx, MemoryBudget *budget);
+
+#endif // FFMPEG_NODE_MEMORY_BUDGET_H
@@ -0,0 +1,378 @@
+/**
+ * @file side_data.c
+ * @brief SideData API - Batched access to frame and packet side data
+ * @description Returns every side data entry of a frame or packet in one call. Frame entries
+ *              are exposed as external ArrayBuffer views that hold a reference on the side data
+ *              buffer, so captions, HDR metadata and SEI payloads reach JS without a copy;
+ *              well-known structures are also decoded into plain objects
+ */
+
+#include <node_api.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/buffer.h"
+#include "libavutil/display.h"
+#include "libavutil/frame.h"
+#include "libavutil/mastering_display_metadata.h"
+#include "libavcodec/avcodec.h"
+
+#include "atomic_api.h"
+
+#define MAX_SIDE_DATA_FILTER 32
+
+// ============================================================================
+// Type Names - Short JS names for the side data types pipelines care about
+// ============================================================================
+
+typedef struct {
+    int type;
+    const char *name;
+} SideDataName;
+
+static const SideDataName frame_side_data_names[] = {
+    { AV_FRAME_DATA_A53_CC,                      "a53cc" },
+    { AV_FRAME_DATA_MASTERING_DISPLAY_METADATA,  "masteringDisplay" },
+    { AV_FRAME_DATA_CONTENT_LIGHT_LEVEL,         "contentLight" },
+    { AV_FRAME_DATA_SEI_UNREGISTERED,            "seiUnregistered" },
+    { AV_FRAME_DATA_DISPLAYMATRIX,               "displayMatrix" },
+    { AV_FRAME_DATA_S12M_TIMECODE,               "s12mTimecode" },
+    { AV_FRAME_DATA_DYNAMIC_HDR_PLUS,            "hdr10Plus" },
+    { AV_FRAME_DATA_DOVI_RPU_BUFFER,             "doviRpu" },
+    { AV_FRAME_DATA_DOVI_METADATA,               "doviMetadata" },
+    { AV_FRAME_DATA_ICC_PROFILE,                 "iccProfile" },
+    { AV_FRAME_DATA_AMBIENT_VIEWING_ENVIRONMENT, "ambientViewing" },
+    { AV_FRAME_DATA_FILM_GRAIN_PARAMS,           "filmGrain" },
+    { AV_FRAME_DATA_AFD,                         "afd" },
+    { AV_FRAME_DATA_MOTION_VECTORS,              "motionVectors" },
+};
+
+static const SideDataName packet_side_data_names[] = {
+    { AV_PKT_DATA_A53_CC,                     "a53cc" },
+    { AV_PKT_DATA_MASTERING_DISPLAY_METADATA, "masteringDisplay" },
+    { AV_PKT_DATA_CONTENT_LIGHT_LEVEL,        "contentLight" },
+    { AV_PKT_DATA_DISPLAYMATRIX,              "displayMatrix" },
+    { AV_PKT_DATA_S12M_TIMECODE,              "s12mTimecode" },
+    { AV_PKT_DATA_DYNAMIC_HDR10_PLUS,         "hdr10Plus" },
+    { AV_PKT_DATA_DOVI_CONF,                  "doviConfig" },
+    { AV_PKT_DATA_ICC_PROFILE,                "iccProfile" },
+    { AV_PKT_DATA_AFD,                        "afd" },
+    { AV_PKT_DATA_NEW_EXTRADATA,              "newExtradata" },
+    { AV_PKT_DATA_SKIP_SAMPLES,               "skipSamples" },
+    { AV_PKT_DATA_QUALITY_STATS,              "qualityStats" },
+    { AV_PKT_DATA_STRINGS_METADATA,           "stringsMetadata" },
+};
+
+// Short name when known, otherwise FFmpeg's descriptive name
+static const char *side_data_type_name(const SideDataName *names, int nb_names, int type,
+                                       const char *fallback) {
+    for (int i = 0; i < nb_names; i++) {
+        if (names[i].type == type) {
+            return names[i].name;
+        }
+    }
+    return fallback ? fallback : "unknown";
+}
+
+static const char *frame_side_data_type_name(enum AVFrameSideDataType type) {
+    return side_data_type_name(frame_side_data_names, FF_ARRAY_ELEMS(frame_side_data_names),
+                               type, av_frame_side_data_name(type));
+}
+
+static const char *packet_side_data_type_name(enum AVPacketSideDataType type) {
+    return side_data_type_name(packet_side_data_names, FF_ARRAY_ELEMS(packet_side_data_names),
+                               type, av_packet_side_data_name(type));
+}
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+typedef struct {
+    char names[MAX_SIDE_DATA_FILTER][48];
+    int count;
+} SideDataFilter;
+
+// Read an optional array of type names; an absent filter accepts everything
+static int get_side_data_filter(napi_env env, napi_value value, SideDataFilter *filter) {
+    filter->count = 0;
+
+    napi_valuetype type;
+    napi_typeof(env, value, &type);
+    if (type == napi_undefined || type == napi_null) {
+        return 0;
+    }
+
+    bool is_array = false;
+    napi_is_array(env, value, &is_array);
+    if (!is_array) {
+        return -1;
+    }
+
+    uint32_t length;
+    napi_get_array_length(env, value, &length);
+    if (length > MAX_SIDE_DATA_FILTER) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value item;
+        size_t len;
+        napi_get_element(env, value, i, &item);
+        if (napi_get_value_string_utf8(env, item, filter->names[i], sizeof(filter->names[i]), &len) != napi_ok) {
+            return -1;
+        }
+    }
+    filter->count = (int)length;
+    return 0;
+}
+
+static int side_data_filter_match(const SideDataFilter *filter, const char *name) {
+    if (!filter->count) {
+        return 1;
+    }
+    for (int i = 0; i < filter->count; i++) {
+        if (!strcmp(filter->names[i], name)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void side_data_buffer_finalize(napi_env env, void *data, void *hint) {
+    AVBufferRef *ref = hint;
+    av_buffer_unref(&ref);
+}
+
+/**
+ * Wrap side data in an ArrayBuffer. With a backing AVBufferRef the view is external and keeps
+ * its own reference, so the frame can be freed or reused while JS still holds the data.
+ */
+static napi_value create_side_data_buffer(napi_env env, const uint8_t *data, size_t size,
+                                          AVBufferRef *buf) {
+    napi_value arraybuffer;
+
+    if (buf && size) {
+        AVBufferRef *ref = av_buffer_ref(buf);
+        if (ref) {
+            if (napi_create_external_arraybuffer(env, (void *)data, size, side_data_buffer_finalize,
+                                                 ref, &arraybuffer) == napi_ok) {
+                return arraybuffer;
+            }
+            // Runtimes that forbid external buffers get a copy
+            av_buffer_unref(&ref);
+        }
+    }
+
+    void *copy;
+    if (napi_create_arraybuffer(env, size, &copy, &arraybuffer) != napi_ok) {
+        return NULL;
+    }
+    if (size) {
+        memcpy(copy, data, size);
+    }
+    return arraybuffer;
+}
+
+static napi_value create_point(napi_env env, AVRational x, AVRational y) {
+    napi_value pair, val;
+    napi_create_array_with_length(env, 2, &pair);
+    napi_create_double(env, av_q2d(x), &val);
+    napi_set_element(env, pair, 0, val);
+    napi_create_double(env, av_q2d(y), &val);
+    napi_set_element(env, pair, 1, val);
+    return pair;
+}
+
+/**
+ * Decode the structures both frames and packets share into named properties of entry
+ * @param name - Short type name from the tables above
+ * @param arraybuffer - Buffer backing entry.data, used for sub-views such as the SEI payload
+ */
+static void decode_side_data(napi_env env, napi_value entry, const char *name,
+                             const uint8_t *data, size_t size, napi_value arraybuffer) {
+    napi_value val;
+
+    if (!strcmp(name, "masteringDisplay") && size >= sizeof(AVMasteringDisplayMetadata)) {
+        const AVMasteringDisplayMetadata *md = (const AVMasteringDisplayMetadata *)data;
+        napi_value obj;
+        napi_create_object(env, &obj);
+        if (md->has_primaries) {
+            // CIE 1931 xy chromaticities in R, G, B order
+            napi_value primaries;
+            napi_create_array_with_length(env, 3, &primaries);
+            for (int i = 0; i < 3; i++) {
+                napi_set_element(env, primaries, i,
+                                 create_point(env, md->display_primaries[i][0], md->display_primaries[i][1]));
+            }
+            napi_set_named_property(env, obj, "primaries", primaries);
+            napi_set_named_property(env, obj, "whitePoint",
+                                    create_point(env, md->white_point[0], md->white_point[1]));
+        }
+        if (md->has_luminance) {
+            napi_create_double(env, av_q2d(md->min_luminance), &val);
+            napi_set_named_property(env, obj, "minLuminance", val);
+            napi_create_double(env, av_q2d(md->max_luminance), &val);
+            napi_set_named_property(env, obj, "maxLuminance", val);
+        }
+        napi_set_named_property(env, entry, "masteringDisplay", obj);
+    } else if (!strcmp(name, "contentLight") && size >= sizeof(AVContentLightMetadata)) {
+        const AVContentLightMetadata *cl = (const AVContentLightMetadata *)data;
+        napi_value obj;
+        napi_create_object(env, &obj);
+        napi_create_uint32(env, cl->MaxCLL, &val);
+        napi_set_named_property(env, obj, "maxCLL", val);
+        napi_create_uint32(env, cl->MaxFALL, &val);
+        napi_set_named_property(env, obj, "maxFALL", val);
+        napi_set_named_property(env, entry, "contentLight", obj);
+    } else if (!strcmp(name, "displayMatrix") && size >= 9 * sizeof(int32_t)) {
+        napi_create_double(env, av_display_rotation_get((const int32_t *)data), &val);
+        napi_set_named_property(env, entry, "rotation", val);
+    } else if (!strcmp(name, "seiUnregistered") && size >= 16) {
+        // 16-byte UUID followed by the user data payload
+        char uuid[37];
+        snprintf(uuid, sizeof(uuid),
+                 "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+                 data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7],
+                 data[8], data[9], data[10], data[11], data[12], data[13], data[14], data[15]);
+        napi_create_string_utf8(env, uuid, NAPI_AUTO_LENGTH, &val);
+        napi_set_named_property(env, entry, "uuid", val);
+        napi_create_typedarray(env, napi_uint8_array, size - 16, arraybuffer, 16, &val);
+        napi_set_named_property(env, entry, "payload", val);
+    }
+}
+
+static napi_value create_side_data_entry(napi_env env, const char *name, const uint8_t *data,
+                                         size_t size, AVBufferRef *buf) {
+    napi_value entry, val;
+    napi_value arraybuffer = create_side_data_buffer(env, data, size, buf);
+    if (!arraybuffer) {
+        return NULL;
+    }
+
+    napi_create_object(env, &entry);
+    napi_create_string_utf8(env, name, NAPI_AUTO_LENGTH, &val);
+    napi_set_named_property(env, entry, "type", val);
+    napi_create_typedarray(env, napi_uint8_array, size, arraybuffer, 0, &val);
+    napi_set_named_property(env, entry, "data", val);
+    decode_side_data(env, entry, name, data, size, arraybuffer);
+    return entry;
+}
+
+// ============================================================================
+// N-API Functions
+// ============================================================================
+
+/**
+ * Get all side data attached to a frame
+ * @param frameId - Frame ID
+ * @param types - Optional array of type names to return (e.g. ["a53cc", "seiUnregistered"])
+ * @returns Array of { type, data: Uint8Array, ...decoded fields }
+ * @description data views reference the side data buffer instead of copying it and stay valid
+ *              after the frame is unreferenced; they must be treated as read-only
+ */
+napi_value side_data_get_frame(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 2;
+    napi_value argv[2];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected frame ID");
+        return NULL;
+    }
+
+    int frame_id;
+    napi_get_value_int32(env, argv[0], &frame_id);
+    AVFrame *frame = get_context_ptr(frame_id, CTX_TYPE_FRAME);
+    if (!frame) {
+        napi_throw_error(env, NULL, "Invalid frame ID");
+        return NULL;
+    }
+    if (handle_is_busy(env, frame_id)) {
+        return NULL;
+    }
+
+    SideDataFilter filter = { .count = 0 };
+    if (argc >= 2 && get_side_data_filter(env, argv[1], &filter) < 0) {
+        napi_throw_error(env, NULL, "Expected types to be an array of side data type names");
+        return NULL;
+    }
+
+    napi_value result;
+    uint32_t count = 0;
+    napi_create_array(env, &result);
+
+    for (int i = 0; i < frame->nb_side_data; i++) {
+        const AVFrameSideData *sd = frame->side_data[i];
+        const char *name = frame_side_data_type_name(sd->type);
+        if (!side_data_filter_match(&filter, name)) {
+            continue;
+        }
+
+        napi_value entry = create_side_data_entry(env, name, sd->data, sd->size, sd->buf);
+        if (!entry) {
+            napi_throw_error(env, NULL, "Failed to create side data buffer");
+            return NULL;
+        }
+        napi_set_element(env, result, count++, entry);
+    }
+
+    return result;
+}
+
+/**
+ * Get all side data attached to a packet
+ * @param packetId - Packet ID
+ * @param types - Optional array of type names to return
+ * @returns Array of { type, data: Uint8Array, ...decoded fields }
+ * @description Packet side data is not reference counted, so entries are copied
+ */
+napi_value side_data_get_packet(napi_env env, napi_callback_info info) {
+    napi_status status;
+    size_t argc = 2;
+    napi_value argv[2];
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_error(env, NULL, "Expected packet ID");
+        return NULL;
+    }
+
+    int pkt_id;
+    napi_get_value_int32(env, argv[0], &pkt_id);
+    AVPacket *pkt = get_context_ptr(pkt_id, CTX_TYPE_PACKET);
+    if (!pkt) {
+        napi_throw_error(env, NULL, "Invalid packet");
+        return NULL;
+    }
+    if (handle_is_busy(env, pkt_id)) {
+        return NULL;
+    }
+
+    SideDataFilter filter = { .count = 0 };
+    if (argc >= 2 && get_side_data_filter(env, argv[1], &filter) < 0) {
+        napi_throw_error(env, NULL, "Expected types to be an array of side data type names");
+        return NULL;
+    }
+
+    napi_value result;
+    uint32_t count = 0;
+    napi_create_array(env, &result);
+
+    for (int i = 0; i < pkt->side_data_elems; i++) {
+        const AVPacketSideData *sd = &pkt->side_data[i];
+        const char *name = packet_side_data_type_name(sd->type);
+        if (!side_data_filter_match(&filter, name)) {
+            continue;
+        }
+
+        napi_value entry = create_side_data_entry(env, name, sd->data, sd->size, NULL);
+        if (!entry) {
+            napi_throw_error(env, NULL, "Failed to create side data buffer");
+            return NULL;
+        }
+        napi_set_element(env, result, count++, entry);
+    }
+
+    return result;
+}
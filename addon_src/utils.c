@@ -1,6 +1,7 @@
 /*
  * utils.c - Video utility functions
- * Provides functions to get video duration, size and format information
+ * Provides functions to get video duration, size and format information,
+ * including index-based exact durations without avformat_find_stream_info
  */
 
 #include <node_api.h>
@@ -95,6 +96,215 @@ napi_value get_video_duration(napi_env env, napi_callback_info info)
     return result;
 }
 
+// Tail scan window; doubled until timestamps are found, like libavformat's estimate_timings_from_pts
+#define DURATION_TAIL_WINDOW (256 * 1024)
+#define DURATION_TAIL_RETRIES 5
+#define DURATION_HEAD_PACKETS 500
+
+/**
+ * Duration from the container index read by avformat_open_input: mp4 mvhd/tkhd and stts,
+ * mkv Segment Info, mp3 Xing/VBRI, ...
+ * @returns duration in seconds, or a negative value when the header carries none
+ */
+static double duration_from_index(const AVFormatContext *fmt_ctx)
+{
+    if (fmt_ctx->duration != AV_NOPTS_VALUE && fmt_ctx->duration > 0) {
+        return (double)fmt_ctx->duration / AV_TIME_BASE;
+    }
+
+    double duration = -1.0;
+    for (unsigned int i = 0; i < fmt_ctx->nb_streams; i++) {
+        const AVStream *st = fmt_ctx->streams[i];
+        if (st->duration != AV_NOPTS_VALUE && st->duration > 0) {
+            duration = FFMAX(duration, st->duration * av_q2d(st->time_base));
+        }
+    }
+    return duration;
+}
+
+/**
+ * Duration from the first timestamps at the head and the last ones in the tail of the file,
+ * without decoding (TS, PS, raw ADTS, ...)
+ * @returns duration in seconds, or a negative value when no timestamps were found
+ */
+static double duration_from_tail_scan(AVFormatContext *fmt_ctx, double *start_time)
+{
+    unsigned int nb_streams = fmt_ctx->nb_streams;
+    int64_t *first = av_malloc_array(FFMAX(nb_streams, 1), sizeof(*first));
+    int64_t *last = av_malloc_array(FFMAX(nb_streams, 1), sizeof(*last));
+    AVPacket *pkt = av_packet_alloc();
+    double duration = -1.0;
+    int64_t file_size = fmt_ctx->pb ? avio_size(fmt_ctx->pb) : -1;
+
+    if (!first || !last || !pkt || file_size <= 0) {
+        goto end;
+    }
+
+    for (unsigned int i = 0; i < nb_streams; i++) {
+        enum AVMediaType type = fmt_ctx->streams[i]->codecpar->codec_type;
+        first[i] = last[i] = AV_NOPTS_VALUE;
+        if (type != AVMEDIA_TYPE_VIDEO && type != AVMEDIA_TYPE_AUDIO) {
+            fmt_ctx->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    // Head: first timestamp of every stream
+    for (int n = 0, pending = 1; pending && n < DURATION_HEAD_PACKETS; n++) {
+        if (av_read_frame(fmt_ctx, pkt) < 0) {
+            break;
+        }
+        int64_t ts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+        if ((unsigned int)pkt->stream_index < nb_streams && first[pkt->stream_index] == AV_NOPTS_VALUE) {
+            first[pkt->stream_index] = ts;
+        }
+        av_packet_unref(pkt);
+
+        pending = 0;
+        for (unsigned int i = 0; i < nb_streams; i++) {
+            if (fmt_ctx->streams[i]->discard != AVDISCARD_ALL && first[i] == AV_NOPTS_VALUE) {
+                pending = 1;
+            }
+        }
+    }
+
+    // Tail: largest end timestamp among the last packets
+    for (int retry = 0, found = 0; !found && retry < DURATION_TAIL_RETRIES; retry++) {
+        int64_t window = (int64_t)DURATION_TAIL_WINDOW << retry;
+        int64_t pos = FFMAX(0, file_size - window);
+        if (av_seek_frame(fmt_ctx, -1, pos, AVSEEK_FLAG_BYTE) < 0) {
+            break;
+        }
+
+        while (av_read_frame(fmt_ctx, pkt) >= 0) {
+            unsigned int idx = pkt->stream_index;
+            int64_t ts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+            if (idx < nb_streams && ts != AV_NOPTS_VALUE && first[idx] != AV_NOPTS_VALUE) {
+                const AVStream *st = fmt_ctx->streams[idx];
+                int64_t end = ts + pkt->duration;
+                // 33-bit MPEG timestamps wrap roughly every 26.5 hours
+                if (st->pts_wrap_bits > 0 && st->pts_wrap_bits < 63 && end < first[idx]) {
+                    end += 1LL << st->pts_wrap_bits;
+                }
+                if (last[idx] == AV_NOPTS_VALUE || end > last[idx]) {
+                    last[idx] = end;
+                }
+                found = 1;
+            }
+            av_packet_unref(pkt);
+        }
+        if (pos == 0) {
+            break;
+        }
+    }
+
+    double start = 0.0, stop = 0.0;
+    int have = 0;
+    for (unsigned int i = 0; i < nb_streams; i++) {
+        if (first[i] == AV_NOPTS_VALUE || last[i] == AV_NOPTS_VALUE) {
+            continue;
+        }
+        double tb = av_q2d(fmt_ctx->streams[i]->time_base);
+        double s0 = first[i] * tb, s1 = last[i] * tb;
+        start = have ? FFMIN(start, s0) : s0;
+        stop = have ? FFMAX(stop, s1) : s1;
+        have = 1;
+    }
+    if (have && stop > start) {
+        duration = stop - start;
+        *start_time = start;
+    }
+
+end:
+    av_packet_free(&pkt);
+    av_free(first);
+    av_free(last);
+    return duration;
+}
+
+/**
+ * Get the exact duration of a media file and how it was obtained
+ * Args: [file path]
+ * Returns: { duration, startTime, method: 'index' | 'tailScan' | 'estimate' }
+ * Index durations come straight from the container header. Index-less formats are measured
+ * by a tail scan of packet timestamps, and only files with neither (raw streams, unseekable
+ * inputs) fall back to avformat_find_stream_info, which is what getVideoDuration uses.
+ */
+napi_value probe_duration(napi_env env, napi_callback_info info)
+{
+    napi_status status;
+    size_t argc = 1;
+    napi_value argv[1];
+    napi_value result, val;
+    char filepath[1024];
+    size_t filepath_len;
+    AVFormatContext *fmt_ctx = NULL;
+    const char *method = "index";
+    double start_time = 0.0;
+    int ret;
+
+    status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (status != napi_ok || argc < 1) {
+        napi_throw_type_error(env, NULL, "Expected file path as argument");
+        return NULL;
+    }
+
+    status = napi_get_value_string_utf8(env, argv[0], filepath, sizeof(filepath), &filepath_len);
+    if (status != napi_ok) {
+        napi_throw_type_error(env, NULL, "Invalid file path");
+        return NULL;
+    }
+
+    ret = avformat_open_input(&fmt_ctx, filepath, NULL, NULL);
+    if (ret < 0) {
+        char error_msg[1100];
+        snprintf(error_msg, sizeof(error_msg), "Could not open file: %s", filepath);
+        napi_throw_error(env, NULL, error_msg);
+        return NULL;
+    }
+
+    if (fmt_ctx->start_time != AV_NOPTS_VALUE) {
+        start_time = (double)fmt_ctx->start_time / AV_TIME_BASE;
+    }
+
+    double duration = duration_from_index(fmt_ctx);
+    if (duration < 0 && !(fmt_ctx->iformat->flags & (AVFMT_NOTIMESTAMPS | AVFMT_NO_BYTE_SEEK))) {
+        method = "tailScan";
+        duration = duration_from_tail_scan(fmt_ctx, &start_time);
+    }
+    if (duration < 0) {
+        // Reopen: the tail scan may have left the demuxer at the end of the file
+        avformat_close_input(&fmt_ctx);
+        method = "estimate";
+        duration = 0.0;
+        ret = avformat_open_input(&fmt_ctx, filepath, NULL, NULL);
+        if (ret >= 0) {
+            ret = avformat_find_stream_info(fmt_ctx, NULL);
+        }
+        if (ret < 0) {
+            avformat_close_input(&fmt_ctx);
+            napi_throw_error(env, NULL, "Could not find stream information");
+            return NULL;
+        }
+        if (fmt_ctx->duration != AV_NOPTS_VALUE) {
+            duration = (double)fmt_ctx->duration / AV_TIME_BASE;
+        }
+        if (fmt_ctx->start_time != AV_NOPTS_VALUE) {
+            start_time = (double)fmt_ctx->start_time / AV_TIME_BASE;
+        }
+    }
+
+    avformat_close_input(&fmt_ctx);
+
+    napi_create_object(env, &result);
+    napi_create_double(env, duration, &val);
+    napi_set_named_property(env, result, "duration", val);
+    napi_create_double(env, start_time, &val);
+    napi_set_named_property(env, result, "startTime", val);
+    napi_create_string_utf8(env, method, NAPI_AUTO_LENGTH, &val);
+    napi_set_named_property(env, result, "method", val);
+    return result;
+}
+
 /**
  * Get video format information (metadata)
  * Args: [file path]
@@ -11,6 +11,16 @@
         "./addon_src/utils.c",
         "./addon_src/atomic_api.c",
         "./addon_src/audio_fifo.c",
+        "./addon_src/audio_stream.c",
+        "./addon_src/audio_mixer.c",
+        "./addon_src/frame_rate.c",
+        "./addon_src/analysis.c",
+        "./addon_src/side_data.c",
+        "./addon_src/latency.c",
+        "./addon_src/decoder_arena.c",
+        "./addon_src/frame_pool.c",
+        "./addon_src/memory_budget.c",
+        "./addon_src/frame_stream.c",
         "./ffmpeg/fftools/cmdutils.c",
         "./ffmpeg/fftools/ffmpeg_dec.c",
         "./ffmpeg/fftools/ffmpeg_demux.c",
@@ -41,6 +41,12 @@ const {
   createSwsContext,
   swsScale,
 
+  createFrameRateConverter,
+  fpsConverterSendFrame,
+  fpsConverterReceiveFrame,
+  fpsConverterGetStats,
+  fpsConverterFree,
+
   getPacketProperty,
 
   audioFifoAlloc,
@@ -121,43 +127,6 @@ class AudioFrameBuffer {
   }
 }
 
-class FrameRateLimiter {
-  constructor(sourceFps, targetFps) {
-    const safeSource = typeof sourceFps === 'number' && sourceFps > 0 ? sourceFps : targetFps;
-    const safeTarget = typeof targetFps === 'number' && targetFps > 0 ? targetFps : safeSource;
-
-    this.sourceFps = safeSource;
-    this.targetFps = safeTarget;
-    this.sourceFrameDuration = 1 / this.sourceFps;
-    this.targetFrameDuration = 1 / this.targetFps;
-    this.timeline = 0;
-    this.nextEmitTime = 0;
-    this.keptFrames = 0;
-    this.droppedFrames = 0;
-    this.active = this.sourceFps > this.targetFps + 1e-6;
-  }
-
-  shouldEmit() {
-    if (!this.active) {
-      this.keptFrames++;
-      return true;
-    }
-
-    const shouldKeep = this.timeline + Number.EPSILON >= this.nextEmitTime;
-    this.timeline += this.sourceFrameDuration;
-
-    if (shouldKeep) {
-      this.nextEmitTime += this.targetFrameDuration;
-      this.keptFrames++;
-      return true;
-    }
-
-    this.droppedFrames++;
-    return false;
-  }
-}
-
-
 function gcd(a, b) {
   let x = Math.abs(a);
   let y = Math.abs(b);
@@ -309,7 +278,7 @@ async function transcodeToScaled(inputPath, outputPath, options = {}) {
   const targetFrameRate = resolveTargetFrameRate(videoStream, 30);
   const targetFpsValue = targetFrameRate.num / targetFrameRate.den;
   const sourceFpsValue = targetFrameRate.sourceValue ?? targetFpsValue;
-  const frameRateLimiter = new FrameRateLimiter(sourceFpsValue, targetFpsValue);
+  const limitFrameRate = sourceFpsValue > targetFpsValue + 1e-6;
 
   
   const { width: targetWidth, height: targetHeight } = calculateScaledSizeByMinEdge(
@@ -322,8 +291,8 @@ async function transcodeToScaled(inputPath, outputPath, options = {}) {
   console.log(
     `帧率: 输入≈${sourceFpsValue?.toFixed ? sourceFpsValue.toFixed(3) : sourceFpsValue}fps -> 输出<=${targetFpsValue.toFixed(3)}fps`
   );
-  if (frameRateLimiter.active) {
-    const dropRatio = ((frameRateLimiter.sourceFps - frameRateLimiter.targetFps) / frameRateLimiter.sourceFps) * 100;
+  if (limitFrameRate) {
+    const dropRatio = ((sourceFpsValue - targetFpsValue) / sourceFpsValue) * 100;
     console.log(`  ⚖️  检测到高帧率，将按时间采样丢弃多余帧 (预计丢弃比例≈${dropRatio.toFixed(2)}%)`);
   }
 
@@ -362,9 +331,18 @@ async function transcodeToScaled(inputPath, outputPath, options = {}) {
   setEncoderOption(videoEncoder, 'bit_rate', 800000); 
   setEncoderOption(videoEncoder, 'gop_size', 30); 
   setEncoderOption(videoEncoder, 'max_b_frames', 2);
+  // 保留帧率转换器按编码器时间基计算的pts
+  setEncoderOption(videoEncoder, 'preserve_pts', 1);
 
   openEncoder(videoEncoder);
 
+  // 原生帧率转换：只丢帧不补帧，pts直接落在编码器时间基上
+  const fpsConverter = createFrameRateConverter(
+    videoStream.timeBase,
+    { num: targetFrameRate.num, den: targetFrameRate.den },
+    { mode: 'drop', encoderId: videoEncoder }
+  );
+
   
   const outputVideoStreamIdx = addOutputStream(outputCtx, 'libx264');
   copyEncoderToStream(videoEncoder, outputCtx, outputVideoStreamIdx);
@@ -408,6 +386,7 @@ async function transcodeToScaled(inputPath, outputPath, options = {}) {
 
   
   const decodedVideoFrame = allocFrame();
+  const convertedVideoFrame = allocFrame();
   const scaledVideoFrame = allocFrame();
   const encodedVideoPacket = allocPacket();
 
@@ -439,6 +418,22 @@ async function transcodeToScaled(inputPath, outputPath, options = {}) {
 
   console.log('开始转码...');
 
+  const encodeConvertedVideoFrames = () => {
+    while (fpsConverterReceiveFrame(fpsConverter, convertedVideoFrame) === 0) {
+      swsScale(swsCtx, convertedVideoFrame, scaledVideoFrame);
+
+      sendFrame(videoEncoder, scaledVideoFrame);
+
+      while (true) {
+        const encRet = receivePacket(videoEncoder, encodedVideoPacket);
+        if (encRet !== 0) break;
+
+        writePacket(outputCtx, encodedVideoPacket, outputVideoStreamIdx);
+        videoFrameCount++;
+      }
+    }
+  };
+
   while (true) {
     
     const packet = readPacket(inputCtx);
@@ -446,6 +441,9 @@ async function transcodeToScaled(inputPath, outputPath, options = {}) {
       console.log('输入文件读取完毕，刷新编码器...');
 
       
+      fpsConverterSendFrame(fpsConverter, null);
+      encodeConvertedVideoFrames();
+
       sendFrame(videoEncoder, null);
       while (true) {
         const ret = receivePacket(videoEncoder, encodedVideoPacket);
@@ -493,23 +491,8 @@ async function transcodeToScaled(inputPath, outputPath, options = {}) {
         const ret = receiveFrame(videoDecoder, decodedVideoFrame);
         if (ret !== 0) break;
 
-        if (!frameRateLimiter.shouldEmit()) {
-          continue;
-        }
-
-        swsScale(swsCtx, decodedVideoFrame, scaledVideoFrame);
-
-        
-        sendFrame(videoEncoder, scaledVideoFrame);
-
-        
-        while (true) {
-          const encRet = receivePacket(videoEncoder, encodedVideoPacket);
-          if (encRet !== 0) break;
-
-          writePacket(outputCtx, encodedVideoPacket, outputVideoStreamIdx);
-          videoFrameCount++;
-        }
+        fpsConverterSendFrame(fpsConverter, decodedVideoFrame);
+        encodeConvertedVideoFrames();
       }
 
     } else if (audioStream && streamIdx === audioStreamIdx) {
@@ -549,7 +532,7 @@ async function transcodeToScaled(inputPath, outputPath, options = {}) {
 
     
     if (packetCount % 100 === 0) {
-          const dropInfo = frameRateLimiter.active ? `, 丢弃帧: ${frameRateLimiter.droppedFrames}` : '';
+          const dropInfo = limitFrameRate ? `, 丢弃帧: ${fpsConverterGetStats(fpsConverter).dropped}` : '';
           process.stdout.write(`\r处理包: ${packetCount}, 视频帧: ${videoFrameCount}, 音频帧: ${audioFrameCount}${dropInfo}`);
     }
   }
@@ -558,15 +541,17 @@ async function transcodeToScaled(inputPath, outputPath, options = {}) {
   console.log(`  - 处理包数: ${packetCount}`);
   console.log(`  - 视频帧数: ${videoFrameCount}`);
   console.log(`  - 音频帧数: ${audioFrameCount}`);
-  if (frameRateLimiter.active) {
-    console.log(`  - 丢弃冗余帧数: ${frameRateLimiter.droppedFrames}`);
+  if (limitFrameRate) {
+    console.log(`  - 丢弃冗余帧数: ${fpsConverterGetStats(fpsConverter).dropped}`);
   }
 
   
   writeTrailer(outputCtx);
 
   freeFrame(decodedVideoFrame);
+  freeFrame(convertedVideoFrame);
   freeFrame(scaledVideoFrame);
+  fpsConverterFree(fpsConverter);
   freePacket(encodedVideoPacket);
 
   if (audioStream) {
@@ -4,7 +4,10 @@
  * @description provide a simple and easy to use FFmpeg operation interface, suitable for rapid development
  */
 
-import type { VideoFormatInfo, LogCallback } from './types';
+import type { VideoFormatInfo, DurationProbeResult, LogCallback, BlackSilenceOptions, BlackSilenceResult, CropDetectOptions, CropDetectResult,
+    FingerprintOptions, FingerprintCompareOptions, FingerprintMatch,
+    VideoStatsOptions, VideoStatsResult, PacketAnalysisOptions, PacketAnalysisResult,
+    AttachedPictureOptions, AttachedPicture } from './types';
 
 const addon = require('./ffmpeg_node.node');
 
@@ -75,6 +78,36 @@ export function getVideoDuration(filePath: string): number {
     return addon.getVideoDuration(filePath);
 }
 
+/**
+ * Get the exact duration of a media file without probing its streams.
+ * 
+ * The duration is read from the container index when there is one (mp4 mvhd/stts, mkv segment
+ * info, mp3 Xing). Index-less formats such as MPEG-TS are measured from the first and last
+ * packet timestamps. Only when neither works does it fall back to the decoding probe used by
+ * `getVideoDuration`.
+ * 
+ * @param filePath - Path to the media file
+ * @returns Duration in seconds, first timestamp and the method that produced them
+ * 
+ * @example
+ * ```typescript
+ * import { probeDuration } from 'ffmpeg7';
+ * 
+ * const { duration, method } = probeDuration('recording.ts');
+ * console.log(`${duration}s (${method})`); // e.g. "3600.04s (tailScan)"
+ * ```
+ * 
+ * @throws {TypeError} If file path is not a string
+ * @throws {Error} If the file cannot be opened or parsed
+ */
+export function probeDuration(filePath: string): DurationProbeResult {
+    if (typeof filePath !== 'string') {
+        throw new TypeError('Expected file path to be a string');
+    }
+
+    return addon.probeDuration(filePath);
+}
+
 /**
  * Get detailed format information about a video file.
  * 
@@ -104,6 +137,227 @@ export function getVideoFormatInfo(filePath: string): VideoFormatInfo {
     return addon.getVideoFormatInfo(filePath);
 }
 
+/**
+ * Detect black video intervals and audio silence in a single decode pass.
+ * 
+ * Runs natively on the libuv thread pool, so several files can be analysed concurrently
+ * (up to `UV_THREADPOOL_SIZE`, 4 by default). Follows the `blackdetect` and `silencedetect`
+ * filters without going through `run()` and log parsing.
+ * 
+ * @param filePath - Path to the media file
+ * @param options - Detection thresholds
+ * @returns Promise resolving to the black and silence intervals
+ * 
+ * @example
+ * ```typescript
+ * import { detectBlackAndSilence } from 'ffmpeg7';
+ * 
+ * const { black, silence } = await detectBlackAndSilence('upload.mp4', { blackMinDuration: 0.5 });
+ * const leader = black.find((b) => b.start === 0);
+ * if (leader) console.log(`Trim ${leader.end}s of black leader`);
+ * ```
+ * 
+ * @throws {TypeError} If file path is not a string or options is not an object
+ */
+export function detectBlackAndSilence(filePath: string, options: BlackSilenceOptions = {}): Promise<BlackSilenceResult> {
+    if (typeof filePath !== 'string') {
+        throw new TypeError('Expected file path to be a string');
+    }
+    if (typeof options !== 'object' || options === null) {
+        throw new TypeError('Expected options to be an object');
+    }
+
+    return addon.detectBlackAndSilence(filePath, options);
+}
+
+/**
+ * Detect letterbox/pillarbox black bars from evenly spaced keyframes.
+ * 
+ * Only the keyframe nearest each sample position is decoded, on several threads, so this is
+ * far cheaper than a full `cropdetect` run. The result is the union of the content boxes of all
+ * samples (samples that are entirely black are ignored), so no visible picture is cut off.
+ * 
+ * @param filePath - Path to the video file
+ * @param options - Sample count and thresholds
+ * @returns Promise resolving to the crop rectangle
+ * 
+ * @example
+ * ```typescript
+ * import { detectCrop, run } from 'ffmpeg7';
+ * 
+ * const crop = await detectCrop('movie.mp4', { samples: 20 });
+ * if (crop.width < crop.sourceWidth || crop.height < crop.sourceHeight) {
+ *   run(['-i', 'movie.mp4', '-vf', crop.filter, '-y', 'cropped.mp4']);
+ * }
+ * ```
+ * 
+ * @throws {TypeError} If file path is not a string or options is not an object
+ */
+export function detectCrop(filePath: string, options: CropDetectOptions = {}): Promise<CropDetectResult> {
+    if (typeof filePath !== 'string') {
+        throw new TypeError('Expected file path to be a string');
+    }
+    if (typeof options !== 'object' || options === null) {
+        throw new TypeError('Expected options to be an object');
+    }
+
+    return addon.detectCrop(filePath, options);
+}
+
+/**
+ * Compute a perceptual fingerprint of a video.
+ * 
+ * Frames are decoded (keyframes only by default), scaled to 32x32 luma and hashed with a
+ * DCT-based pHash, one hash per 1/fps seconds. Re-encodes at other bitrates or resolutions
+ * produce near-identical signatures; compare them with `compareFingerprints`.
+ * 
+ * @param filePath - Path to the video file
+ * @param options - Hash rate and size
+ * @returns Promise resolving to a compact signature (8-byte header followed by the hashes)
+ * 
+ * @example
+ * ```typescript
+ * import { fingerprint, compareFingerprints } from 'ffmpeg7';
+ * 
+ * const [a, b] = await Promise.all([fingerprint('upload.mp4'), fingerprint('original.mp4')]);
+ * if (compareFingerprints(a, b).similarity > 0.9) console.log('Re-upload detected');
+ * ```
+ * 
+ * @throws {TypeError} If file path is not a string or options is not an object
+ */
+export function fingerprint(filePath: string, options: FingerprintOptions = {}): Promise<Uint8Array> {
+    if (typeof filePath !== 'string') {
+        throw new TypeError('Expected file path to be a string');
+    }
+    if (typeof options !== 'object' || options === null) {
+        throw new TypeError('Expected options to be an object');
+    }
+
+    return addon.fingerprint(filePath, options);
+}
+
+/**
+ * Compare two fingerprints, sliding one against the other to find the best alignment.
+ * 
+ * @param a - Signature from `fingerprint`
+ * @param b - Signature from `fingerprint` with the same `fps` and `hashBits`
+ * @param options - Alignment search range
+ * @returns Similarity and offset of the best alignment
+ * 
+ * @example
+ * ```typescript
+ * import { compareFingerprints } from 'ffmpeg7';
+ * 
+ * const { similarity, offset } = compareFingerprints(a, b, { maxOffset: 30 });
+ * ```
+ * 
+ * @throws {TypeError} If a signature is not a Uint8Array
+ * @throws {Error} If the signatures are malformed or were made with different settings
+ */
+export function compareFingerprints(a: Uint8Array, b: Uint8Array, options: FingerprintCompareOptions = {}): FingerprintMatch {
+    if (!(a instanceof Uint8Array) || !(b instanceof Uint8Array)) {
+        throw new TypeError('Expected fingerprints to be Uint8Arrays');
+    }
+
+    return addon.fingerprintCompare(a, b, options);
+}
+
+/**
+ * Compute per-frame histograms, mean and variance over a whole video stream.
+ * 
+ * All statistics are computed natively on the decoded planes; nothing is copied to JS
+ * except the final typed arrays.
+ * 
+ * @param filePath - Path to the video file
+ * @param options - Components, bin count and sampling
+ * @returns Promise resolving to per-frame statistics as typed arrays
+ * 
+ * @example
+ * ```typescript
+ * import { analyzeVideoStats } from 'ffmpeg7';
+ * 
+ * const stats = await analyzeVideoStats('clip.mp4', { planes: [0] });
+ * const underexposed = stats.mean.filter((m) => m < 40).length / stats.frames;
+ * ```
+ * 
+ * @throws {TypeError} If file path is not a string or options is not an object
+ */
+export function analyzeVideoStats(filePath: string, options: VideoStatsOptions = {}): Promise<VideoStatsResult> {
+    if (typeof filePath !== 'string') {
+        throw new TypeError('Expected file path to be a string');
+    }
+    if (typeof options !== 'object' || options === null) {
+        throw new TypeError('Expected options to be an object');
+    }
+
+    return addon.analyzeVideoStats(filePath, options);
+}
+
+/**
+ * Scan a file's packets without decoding to get frame counts, GOP structure and a bitrate timeline.
+ * 
+ * Only the demuxer runs, and unselected streams are discarded inside it, so the scan is
+ * limited by disk speed.
+ * 
+ * @param filePath - Path to the media file
+ * @param options - Streams to scan and timeline resolution
+ * @returns Promise resolving to per-stream packet statistics
+ * 
+ * @example
+ * ```typescript
+ * import { analyzePackets } from 'ffmpeg7';
+ * 
+ * const { streams } = await analyzePackets('movie.mkv', { interval: 1 });
+ * const video = streams.find((s) => s.type === 'video')!;
+ * console.log(video.frames, Math.max(...video.gopSizes), Math.max(...video.bitrateTimeline));
+ * ```
+ * 
+ * @throws {TypeError} If file path is not a string or options is not an object
+ */
+export function analyzePackets(filePath: string, options: PacketAnalysisOptions = {}): Promise<PacketAnalysisResult> {
+    if (typeof filePath !== 'string') {
+        throw new TypeError('Expected file path to be a string');
+    }
+    if (typeof options !== 'object' || options === null) {
+        throw new TypeError('Expected options to be an object');
+    }
+
+    return addon.analyzePackets(filePath, options);
+}
+
+/**
+ * Get the embedded cover art of an audio or video file.
+ * 
+ * The picture comes straight from the demuxer: no stream probing and no decoder. Without
+ * options the stored bytes (usually JPEG or PNG) are returned without a copy. Passing a size
+ * or format decodes, scales and re-encodes the picture into a thumbnail.
+ * 
+ * @param filePath - Path to the media file
+ * @param options - Optional thumbnail size and format
+ * @returns Promise resolving to the picture, or null if the file has none
+ * 
+ * @example
+ * ```typescript
+ * import { getAttachedPicture } from 'ffmpeg7';
+ * import { writeFileSync } from 'fs';
+ * 
+ * const cover = await getAttachedPicture('song.mp3', { width: 200, format: 'jpeg' });
+ * if (cover) writeFileSync('cover.jpg', cover.data);
+ * ```
+ * 
+ * @throws {TypeError} If file path is not a string or options is not an object
+ */
+export function getAttachedPicture(filePath: string, options: AttachedPictureOptions = {}): Promise<AttachedPicture | null> {
+    if (typeof filePath !== 'string') {
+        throw new TypeError('Expected file path to be a string');
+    }
+    if (typeof options !== 'object' || options === null) {
+        throw new TypeError('Expected options to be an object');
+    }
+
+    return addon.getAttachedPicture(filePath, options);
+}
+
 /**
  * Add a log listener to receive FFmpeg log messages.
  * 
@@ -4,7 +4,37 @@
  * @description provide a fine-grained FFmpeg operation interface, allowing JS to flexibly control the encoding and decoding process
  */
 
-import type { StreamInfo } from './types';
+import { Duplex } from 'stream';
+import type {
+  StreamInfo,
+  DecodeAudioStreamOptions,
+  AudioMixerInputOptions,
+  ChannelLayoutSpec,
+  SwrOptions,
+  SampleBuffer,
+  Rational,
+  FrameRateConverterOptions,
+  FrameRateConverterStats,
+  DecimateOptions,
+  DecimatorStats,
+  FrameStatsOptions,
+  ComponentStats,
+  EncoderPacketStats,
+  MotionStatsOptions,
+  MotionStats,
+  SideDataType,
+  SideDataEntry,
+  LatencyStats,
+  DecoderArenaOptions,
+  DecoderArenaStats,
+  FrameArenaLayout,
+  FramePoolStats,
+  MemoryBudgetOptions,
+  MemoryBudgetStats,
+  DecodeFramesOptions,
+  CodecTransferResult,
+  CodecStreamOptions,
+} from './types';
 
 const addon = require('./ffmpeg_node.node');
 
@@ -260,6 +290,49 @@ export function openEncoder(codecContextId: number): void {
   addon.openEncoder(codecContextId);
 }
 
+/**
+ * change encoder settings mid-stream without tearing down the output
+ * 
+ * Changes the encoder supports at runtime are applied in place and take effect with the next
+ * frame: `bitrate` (opened with a bitrate), `maxrate` / `bufsize` (opened with VBV) and `crf` /
+ * `crf_max` (opened without a bitrate) on libx264, and `bitrate` / `maxrate` / `bufsize` on nvenc.
+ * 
+ * Anything else (resolution, `pix_fmt`, `gop_size`, private options, other encoders) opens a
+ * replacement encoder immediately. The next `sendFrame` accepts the frame and holds it while the
+ * current encoder is drained through `receivePacket`; once it is empty the replacement takes over
+ * with the held frame, starting with a keyframe and continuing the same frame counter and time
+ * base. Send frames of the new size from then on. With global headers the first new packet
+ * carries `AV_PKT_DATA_NEW_EXTRADATA`.
+ * 
+ * @param codecContextId - opened encoder context ID
+ * @param options - setEncoderOption keys plus `maxrate` / `bufsize`
+ * @returns `'inPlace'` or `'switch'`
+ * 
+ * @example
+ * ```typescript
+ * import { reconfigureEncoder } from 'ffmpeg7';
+ * 
+ * reconfigureEncoder(encoder, { bitrate: 1500000 });            // 'inPlace' for libx264 ABR
+ * reconfigureEncoder(encoder, { width: 1280, height: 720 });    // 'switch'
+ * // the usual send-then-drain loop handles the handover
+ * ```
+ * 
+ * @throws {TypeError} if arguments are invalid or an option value is not a number or string
+ * @throws {Error} if the encoder is not open or the replacement fails to open
+ */
+export function reconfigureEncoder(
+  codecContextId: number,
+  options: Record<string, number | string>
+): 'inPlace' | 'switch' {
+  if (typeof codecContextId !== 'number') {
+    throw new TypeError('Expected codec context ID to be a number');
+  }
+  if (typeof options !== 'object' || options === null) {
+    throw new TypeError('Expected options to be an object');
+  }
+  return addon.reconfigureEncoder(codecContextId, options);
+}
+
 // ────────────────────────────────────────────────────────────────────────────
 // 3. transcoding operations
 // ────────────────────────────────────────────────────────────────────────────
@@ -639,6 +712,41 @@ export function copyDecoderParams(inputContextId: number, decoderContextId: numb
   addon.copyDecoderParams(inputContextId, decoderContextId, streamIndex);
 }
 
+/**
+ * set decoder option (call before openDecoder)
+ * 
+ * `threads` sets the decoding thread count; other keys are passed to avcodec_open2 as
+ * codec options, e.g. `flags2: '+export_mvs'` to export motion vectors as frame side data.
+ * 
+ * @param codecContextId - decoder context ID
+ * @param key - option name
+ * @param value - option value
+ * 
+ * @example
+ * ```typescript
+ * import { setDecoderOption, openDecoder } from 'ffmpeg7';
+ * 
+ * setDecoderOption(decoder, 'flags2', '+export_mvs');
+ * setDecoderOption(decoder, 'threads', 4);
+ * openDecoder(decoder);
+ * ```
+ * 
+ * @throws {TypeError} if parameter types are incorrect
+ * @throws {Error} if the context is not a decoder
+ */
+export function setDecoderOption(codecContextId: number, key: string, value: number | string): void {
+  if (typeof codecContextId !== 'number') {
+    throw new TypeError('Expected codec context ID to be a number');
+  }
+  if (typeof key !== 'string') {
+    throw new TypeError('Expected key to be a string');
+  }
+  if (typeof value !== 'number' && typeof value !== 'string') {
+    throw new TypeError('Expected value to be a number or string');
+  }
+  addon.setDecoderOption(codecContextId, key, value);
+}
+
 /**
  * open decoder (call after copying parameters)
  * 
@@ -663,6 +771,79 @@ export function openDecoder(codecContextId: number): void {
   addon.openDecoder(codecContextId);
 }
 
+/**
+ * decode video frames directly into memory you own (call before openDecoder)
+ * 
+ * The memory is split into up to 64 equal slots; each decoded frame is placed in a free slot
+ * (64-byte aligned planes) and the slot is reused once the decoder and every frame referencing
+ * it release it. When all slots are busy, or for audio, hardware or palette frames, FFmpeg's
+ * own allocator is used instead. Keep frames alive only as long as you read their slot, and do
+ * not transfer or detach the memory while the decoder or its frames exist.
+ * 
+ * @param codecContextId - decoder context ID
+ * @param memory - ArrayBuffer or Uint8Array, e.g. a view over a SharedArrayBuffer
+ * @param options - slotSize in bytes (default: size of the first frame)
+ * 
+ * @example
+ * ```typescript
+ * import { setDecoderArena, openDecoder, receiveFrame, getFrameArenaLayout } from 'ffmpeg7';
+ * 
+ * const memory = new Uint8Array(new SharedArrayBuffer(64 * 1024 * 1024));
+ * setDecoderArena(decoder, memory);
+ * openDecoder(decoder);
+ * 
+ * while (receiveFrame(decoder, frame) === 0) {
+ *   const layout = getFrameArenaLayout(frame);
+ *   if (layout) {
+ *     const luma = memory.subarray(layout.offsets[0]); // no copy
+ *   }
+ * }
+ * ```
+ * 
+ * @throws {TypeError} if memory is not an ArrayBuffer or Uint8Array
+ * @throws {Error} if the decoder is already open or the memory is smaller than one slot
+ */
+export function setDecoderArena(
+  codecContextId: number,
+  memory: ArrayBuffer | Uint8Array,
+  options: DecoderArenaOptions = {}
+): void {
+  if (typeof codecContextId !== 'number') {
+    throw new TypeError('Expected codec context ID to be a number');
+  }
+  addon.setDecoderArena(codecContextId, memory, options);
+}
+
+/**
+ * get arena usage of a decoder
+ * 
+ * @param codecContextId - decoder context ID
+ * @returns slot usage and allocation counters, or null if no arena is set
+ * 
+ * @throws {TypeError} if context ID is not a number
+ */
+export function getDecoderArenaStats(codecContextId: number): DecoderArenaStats | null {
+  if (typeof codecContextId !== 'number') {
+    throw new TypeError('Expected codec context ID to be a number');
+  }
+  return addon.getDecoderArenaStats(codecContextId);
+}
+
+/**
+ * locate a frame's planes in the memory passed to setDecoderArena
+ * 
+ * @param frameId - frame ID
+ * @returns plane offsets and line sizes, or null if the frame was not decoded into an arena
+ * 
+ * @throws {TypeError} if frame ID is not a number
+ */
+export function getFrameArenaLayout(frameId: number): FrameArenaLayout | null {
+  if (typeof frameId !== 'number') {
+    throw new TypeError('Expected frame ID to be a number');
+  }
+  return addon.getFrameArenaLayout(frameId);
+}
+
 // ────────────────────────────────────────────────────────────────────────────
 // 5. Frame and Packet Processing
 // ────────────────────────────────────────────────────────────────────────────
@@ -846,6 +1027,119 @@ export function receivePacket(encoderContextId: number, packetId: number): numbe
   return addon.receivePacket(encoderContextId, packetId);
 }
 
+/**
+ * read and clear the per-packet statistics collected by receivePacket
+ * 
+ * Enable collection first with `setEncoderOption(encoder, 'packet_stats', capacity)`. Stats are
+ * recorded natively on every successful receivePacket and returned in bulk as typed arrays.
+ * Set the encoder option `flags` to `'+psnr'` to fill `error`. Throws while a codecTransfer
+ * runs on the encoder.
+ * 
+ * @param encoderContextId - encoder context ID
+ * @returns statistics of all packets received since the previous call
+ * 
+ * @example
+ * ```typescript
+ * import { setEncoderOption, getEncoderPacketStats } from 'ffmpeg7';
+ * 
+ * setEncoderOption(encoder, 'packet_stats', 4096);
+ * setEncoderOption(encoder, 'flags', '+psnr');
+ * // ... encode ...
+ * const stats = getEncoderPacketStats(encoder);
+ * const iFrameBytes = stats.size.filter((_, i) => stats.pictType[i] === 1).reduce((a, b) => a + b, 0);
+ * ```
+ * 
+ * @throws {TypeError} if encoderContextId is not a number
+ * @throws {Error} if the encoder is invalid or packet_stats is not enabled
+ */
+export function getEncoderPacketStats(encoderContextId: number): EncoderPacketStats {
+  if (typeof encoderContextId !== 'number') {
+    throw new TypeError('Expected encoder context ID to be a number');
+  }
+  return addon.getEncoderPacketStats(encoderContextId);
+}
+
+/**
+ * read the latency histograms of a handle
+ * 
+ * Tracking is enabled by the `low_latency` option: `setEncoderOption(encoder, 'low_latency', 1)`
+ * records sendFrame -> receivePacket per frame (`encode`), and
+ * `setOutputOption(output, 'low_latency', '1')` records sendFrame -> writePacket (`endToEnd`).
+ * While `setLatencyTracking(true)` is on, per-call durations are recorded on every encoder,
+ * decoder, output, scaler and resampler (`sendFrame`, `receiveFrame`, `scale`, ...).
+ * 
+ * @param contextId - encoder, decoder, output, sws or swr context ID
+ * @param reset - clear the histograms after reading (default false)
+ * @returns histograms of the tracked metrics, in milliseconds
+ * 
+ * @example
+ * ```typescript
+ * import { getLatencyStats } from 'ffmpeg7';
+ * 
+ * setInterval(() => {
+ *   const { encode } = getLatencyStats(encoder, true);
+ *   const { endToEnd } = getLatencyStats(outputCtx, true);
+ *   console.log(`encode p99 ${encode?.p99.toFixed(2)} ms, end-to-end p99 ${endToEnd?.p99.toFixed(2)} ms`);
+ * }, 10000);
+ * ```
+ * 
+ * @throws {TypeError} if contextId is not a number
+ * @throws {Error} if the context ID is invalid
+ */
+export function getLatencyStats(contextId: number, reset: boolean = false): LatencyStats {
+  if (typeof contextId !== 'number') {
+    throw new TypeError('Expected context ID to be a number');
+  }
+  return addon.getLatencyStats(contextId, reset);
+}
+
+/**
+ * turn per-call latency tracking on or off for all handles
+ * 
+ * Times sendPacket, receiveFrame, sendFrame, receivePacket, swsScale, swrConvertFrame,
+ * swrConvert and writePacket. Histograms are created on the first timed call and kept
+ * until the handle is freed; turning tracking off keeps the recorded samples.
+ * 
+ * @param enabled - whether to time calls
+ * 
+ * @example
+ * ```typescript
+ * import { setLatencyTracking, getLatencyStats } from 'ffmpeg7';
+ * 
+ * setLatencyTracking(true);
+ * // ... transcode ...
+ * const { receiveFrame, sendFrame } = getLatencyStats(decoder);
+ * console.log(receiveFrame?.p99, getLatencyStats(encoder).sendFrame?.p99);
+ * ```
+ */
+export function setLatencyTracking(enabled: boolean): void {
+  addon.setLatencyTracking(!!enabled);
+}
+
+/**
+ * export every latency histogram in Prometheus text exposition format
+ * 
+ * Emits one `ffmpeg7_latency_seconds` histogram series per handle and metric, labelled
+ * `handle`, `kind` (encoder, decoder, output, sws, swr) and `metric` (the getLatencyStats key).
+ * Buckets run from 50 us to 10 s.
+ * 
+ * @returns metrics text, ready to serve from a `/metrics` endpoint
+ * 
+ * @example
+ * ```typescript
+ * import http from 'node:http';
+ * import { getLatencyMetrics } from 'ffmpeg7';
+ * 
+ * http.createServer((req, res) => {
+ *   res.setHeader('Content-Type', 'text/plain; version=0.0.4');
+ *   res.end(getLatencyMetrics());
+ * }).listen(9464);
+ * ```
+ */
+export function getLatencyMetrics(): string {
+  return addon.getLatencyMetrics();
+}
+
 // ────────────────────────────────────────────────────────────────────────────
 // 6. Frame Data Access and Manipulation
 // ────────────────────────────────────────────────────────────────────────────
@@ -853,6 +1147,10 @@ export function receivePacket(encoderContextId: number, packetId: number): numbe
 /**
  * allocate frame buffer
  * 
+ * Buffers come from pools kept per geometry (format, size or channels/samples, alignment) and
+ * return to their pool when the frame is unreferenced, so allocating a frame per iteration
+ * reuses memory instead of hitting the allocator. See getFramePoolStats.
+ * 
  * @param frameId - frame ID
  * @param align - buffer alignment (0 for default)
  * 
@@ -880,12 +1178,44 @@ export function frameGetBuffer(frameId: number, align?: number): void {
   addon.frameGetBuffer(frameId, align);
 }
 
+/**
+ * get statistics of the frame buffer pools used by frameGetBuffer
+ * 
+ * Pools are also used for swsScale destinations, prepareFrameForEncoder conversions,
+ * audio mixer output and blended frame-rate converter frames. Up to 32 geometries are
+ * kept; the least recently used pool is retired when a new one is needed.
+ * 
+ * @returns one entry per pool, most recently used first
+ * 
+ * @example
+ * ```typescript
+ * import { getFramePoolStats } from 'ffmpeg7';
+ * 
+ * for (const p of getFramePoolStats()) {
+ *   console.log(p.format, p.width, p.height, `${p.reused}/${p.requests} reused`, p.allocated * p.bufferSize);
+ * }
+ * ```
+ */
+export function getFramePoolStats(): FramePoolStats[] {
+  return addon.getFramePoolStats();
+}
+
+/**
+ * release all frame buffer pools
+ * 
+ * Idle pooled memory is freed immediately; buffers still held by frames are freed when those
+ * frames are released. Later frameGetBuffer calls start new pools.
+ */
+export function clearFramePools(): void {
+  addon.clearFramePools();
+}
+
 /**
  * set frame property
  * 
  * @param frameId - frame ID
- * @param property - property name (pts, width, height, format, pict_type, key_frame, sample_rate, nb_samples)
- * @param value - property value
+ * @param property - property name (pts, width, height, format, pict_type, key_frame, sample_rate, nb_samples, channels, channel_layout)
+ * @param value - property value (channel_layout also accepts a layout string or BigInt mask)
  * 
  * @example
  * ```typescript
@@ -896,19 +1226,22 @@ export function frameGetBuffer(frameId: number, align?: number): void {
  * setFrameProperty(frame, 'height', 1080);
  * setFrameProperty(frame, 'format', 0); // pixel format
  * setFrameProperty(frame, 'pts', 0);
+ * 
+ * const audio = allocFrame();
+ * setFrameProperty(audio, 'channel_layout', '5.1(side)');
  * ```
  * 
  * @throws {TypeError} if parameter types are incorrect
  * @throws {Error} if property is unknown or unsupported
  */
-export function setFrameProperty(frameId: number, property: string, value: number): void {
+export function setFrameProperty(frameId: number, property: string, value: number | ChannelLayoutSpec): void {
   if (typeof frameId !== 'number') {
     throw new TypeError('Expected frame ID to be a number');
   }
   if (typeof property !== 'string') {
     throw new TypeError('Expected property to be a string');
   }
-  if (typeof value !== 'number') {
+  if (typeof value !== 'number' && !(property === 'channel_layout' && isChannelLayoutSpec(value))) {
     throw new TypeError('Expected value to be a number');
   }
   addon.setFrameProperty(frameId, property, value);
@@ -918,8 +1251,8 @@ export function setFrameProperty(frameId: number, property: string, value: numbe
  * get frame property
  * 
  * @param frameId - frame ID
- * @param property - property name (pts, width, height, format, pict_type, key_frame, sample_rate, nb_samples, linesize)
- * @returns property value (number or array for linesize)
+ * @param property - property name (pts, width, height, format, pict_type, key_frame, sample_rate, nb_samples, channels, channel_layout, linesize, time_base)
+ * @returns property value (number, array for linesize and time_base [num, den], string for channel_layout)
  * 
  * @example
  * ```typescript
@@ -935,7 +1268,7 @@ export function setFrameProperty(frameId: number, property: string, value: numbe
  * @throws {TypeError} if parameter types are incorrect
  * @throws {Error} if property is unknown
  */
-export function getFrameProperty(frameId: number, property: string): number | number[] {
+export function getFrameProperty(frameId: number, property: string): number | number[] | string {
   if (typeof frameId !== 'number') {
     throw new TypeError('Expected frame ID to be a number');
   }
@@ -1196,6 +1529,11 @@ export function createSwsContext(
 /**
  * scale frame using sws context
  * 
+ * The source size and format are taken from each frame: when a stream changes resolution or
+ * pixel format mid-way, the scaler switches to a matching context (up to 4 source geometries
+ * are cached), while the output size and format stay those given to createSwsContext.
+ * A destination frame without a buffer is allocated with the output size and format.
+ * 
  * @param swsContextId - scaler context ID
  * @param srcFrameId - source frame ID
  * @param dstFrameId - destination frame ID
@@ -1227,6 +1565,36 @@ export function swsScale(swsContextId: number, srcFrameId: number, dstFrameId: n
   addon.swsScale(swsContextId, srcFrameId, dstFrameId);
 }
 
+/**
+ * get a frame in the size and pixel format an encoder expects, converting only when needed
+ * 
+ * A frame that already matches the encoder's width, height and pix_fmt is returned as-is
+ * (no copy). Otherwise it is scaled into a conversion frame owned by the encoder handle; that
+ * frame is reused across calls and freed by closeContext(encoder), so do not free it yourself.
+ * 
+ * @param frameId - decoded video frame ID
+ * @param encoderContextId - video encoder context ID
+ * @returns frame ID to pass to sendFrame
+ * 
+ * @example
+ * ```typescript
+ * import { receiveFrame, prepareFrameForEncoder, sendFrame } from 'ffmpeg7';
+ * 
+ * while (receiveFrame(decoder, frame) === 0) {
+ *   sendFrame(encoder, prepareFrameForEncoder(frame, encoder));
+ * }
+ * ```
+ * 
+ * @throws {TypeError} if parameter types are incorrect
+ * @throws {Error} if the conversion fails
+ */
+export function prepareFrameForEncoder(frameId: number, encoderContextId: number): number {
+  if (typeof frameId !== 'number' || typeof encoderContextId !== 'number') {
+    throw new TypeError('Expected frame ID and encoder context ID to be numbers');
+  }
+  return addon.prepareFrameForEncoder(frameId, encoderContextId);
+}
+
 // ────────────────────────────────────────────────────────────────────────────
 // 9. Audio Resampling (SwrContext)
 // ────────────────────────────────────────────────────────────────────────────
@@ -1234,12 +1602,16 @@ export function swsScale(swsContextId: number, srcFrameId: number, dstFrameId: n
 /**
  * create software resample context for audio resampling/format conversion
  * 
+ * Channel layouts may be given as a channel count (default layout for that count),
+ * a layout description such as `'5.1'`, `'stereo'`, `'FL+FR+LFE'` or `'0x3f'`, or a BigInt channel mask.
+ * 
  * @param srcSampleRate - source sample rate
- * @param srcChannels - source channel count
+ * @param srcLayout - source channel count, layout string or channel mask
  * @param srcFormat - source sample format (string name or enum value)
  * @param dstSampleRate - destination sample rate
- * @param dstChannels - destination channel count
+ * @param dstLayout - destination channel count, layout string or channel mask
  * @param dstFormat - destination sample format (string name or enum value)
+ * @param options - resampler options (filter_size, phase_shift, dither_method, async, ...)
  * @returns swrContextId - resample context ID
  * 
  * @example
@@ -1252,34 +1624,49 @@ export function swsScale(swsContextId: number, srcFrameId: number, dstFrameId: n
  *   44100, 2, 'fltp'   // destination
  * );
  * 
+ * // downmix a real 5.1 source with a cheaper filter and triangular dither
+ * const downmix = createSwrContext(48000, '5.1', 'fltp', 16000, 'mono', 's16', {
+ *   filter_size: 16,
+ *   phase_shift: 8,
+ *   dither_method: 'triangular',
+ * });
+ * 
  * swrConvertFrame(swrCtx, srcFrame, dstFrame);
  * closeContext(swrCtx);
  * ```
  * 
  * @throws {TypeError} if parameter types are incorrect
- * @throws {Error} if resample context creation fails
+ * @throws {Error} if a layout or option is invalid, or resample context creation fails
  */
 export function createSwrContext(
   srcSampleRate: number,
-  srcChannels: number,
+  srcLayout: ChannelLayoutSpec,
   srcFormat: string | number,
   dstSampleRate: number,
-  dstChannels: number,
-  dstFormat: string | number
+  dstLayout: ChannelLayoutSpec,
+  dstFormat: string | number,
+  options?: SwrOptions
 ): number {
-  if (typeof srcSampleRate !== 'number' || typeof srcChannels !== 'number') {
-    throw new TypeError('Expected source parameters to be numbers');
+  if (typeof srcSampleRate !== 'number' || typeof dstSampleRate !== 'number') {
+    throw new TypeError('Expected sample rates to be numbers');
+  }
+  if (!isChannelLayoutSpec(srcLayout) || !isChannelLayoutSpec(dstLayout)) {
+    throw new TypeError('Expected channel layouts to be a channel count, layout string or BigInt mask');
   }
   if (typeof srcFormat !== 'string' && typeof srcFormat !== 'number') {
     throw new TypeError('Expected source format to be a string or number');
   }
-  if (typeof dstSampleRate !== 'number' || typeof dstChannels !== 'number') {
-    throw new TypeError('Expected destination parameters to be numbers');
-  }
   if (typeof dstFormat !== 'string' && typeof dstFormat !== 'number') {
     throw new TypeError('Expected destination format to be a string or number');
   }
-  return addon.createSwrContext(srcSampleRate, srcChannels, srcFormat, dstSampleRate, dstChannels, dstFormat);
+  if (options !== undefined && (typeof options !== 'object' || options === null)) {
+    throw new TypeError('Expected options to be an object');
+  }
+  return addon.createSwrContext(srcSampleRate, srcLayout, srcFormat, dstSampleRate, dstLayout, dstFormat, options);
+}
+
+function isChannelLayoutSpec(value: unknown): value is ChannelLayoutSpec {
+  return typeof value === 'number' || typeof value === 'string' || typeof value === 'bigint';
 }
 
 /**
@@ -1317,6 +1704,49 @@ export function swrConvertFrame(swrContextId: number, srcFrameId: number | null,
   return addon.swrConvertFrame(swrContextId, srcFrameId, dstFrameId);
 }
 
+/**
+ * resample raw samples between typed arrays, without frame handles
+ * 
+ * Packed formats use a single TypedArray of interleaved samples; planar formats use an array
+ * with one TypedArray per channel. The number of input samples and the output capacity are
+ * derived from the array lengths, so pass `subarray()` views to convert less.
+ * 
+ * @param swrContextId - resample context ID
+ * @param src - source samples, or null to flush buffered samples
+ * @param dst - destination buffer(s)
+ * @returns number of samples written per channel
+ * 
+ * @example
+ * ```typescript
+ * import { createSwrContext, swrConvert } from 'ffmpeg7';
+ * 
+ * const swrCtx = createSwrContext(48000, 'stereo', 'flt', 16000, 'mono', 'flt');
+ * 
+ * const out = new Float32Array(4096);
+ * const n = swrConvert(swrCtx, interleavedStereo, out);
+ * recognizer.accept(out.subarray(0, n));
+ * 
+ * // flush remaining samples
+ * const tail = swrConvert(swrCtx, null, out);
+ * ```
+ * 
+ * @throws {TypeError} if parameter types are incorrect
+ * @throws {Error} if buffers do not match the context formats or resampling fails
+ */
+export function swrConvert(
+  swrContextId: number,
+  src: SampleBuffer | null,
+  dst: SampleBuffer
+): number {
+  if (typeof swrContextId !== 'number') {
+    throw new TypeError('Expected context ID to be a number');
+  }
+  if (dst === null || typeof dst !== 'object') {
+    throw new TypeError('Expected destination to be a TypedArray or an array of TypedArrays');
+  }
+  return addon.swrConvert(swrContextId, src, dst);
+}
+
 // ────────────────────────────────────────────────────────────────────────────
 // 10. Auxiliary Functions - Seek, Metadata, Format Query
 // ────────────────────────────────────────────────────────────────────────────
@@ -1744,3 +2174,916 @@ export function audioFifoDrain(fifoId: number, nbSamples: number): void {
   addon.audioFifoDrain(fifoId, nbSamples);
 }
 
+
+// ────────────────────────────────────────────────────────────────────────────
+// 12. Streaming Audio Decode - PCM chunks for ASR / analysis pipelines
+// ────────────────────────────────────────────────────────────────────────────
+
+/**
+ * Decode an audio stream into fixed-size interleaved PCM chunks
+ * 
+ * Demuxing, decoding, resampling and chunking all run natively off the JS thread;
+ * each chunk is backed by a pooled native buffer that is recycled once the chunk is garbage collected.
+ * 
+ * @param filePath - input file path
+ * @param options - output sample rate, channels, sample format and chunk size
+ * @returns async generator of Float32Array ("f32") or Int16Array ("s16") chunks
+ * 
+ * @example
+ * ```typescript
+ * import { decodeAudioStream } from 'ffmpeg7';
+ * 
+ * // 16 kHz mono float chunks of 100ms for a speech recognizer
+ * for await (const chunk of decodeAudioStream('speech.mp4', { sampleRate: 16000, chunkSamples: 1600 })) {
+ *   recognizer.accept(chunk);
+ * }
+ * ```
+ * 
+ * @throws {TypeError} if file path is not a string
+ * @throws {Error} if the file has no audio stream or decoding fails
+ */
+export async function* decodeAudioStream(
+  filePath: string,
+  options: DecodeAudioStreamOptions = {}
+): AsyncGenerator<Float32Array | Int16Array, void, undefined> {
+  if (typeof filePath !== 'string') {
+    throw new TypeError('Expected file path to be a string');
+  }
+  const streamId: number = addon.audioStreamOpen(filePath, options);
+  try {
+    while (true) {
+      const chunk: Float32Array | Int16Array | null = await addon.audioStreamRead(streamId);
+      if (chunk === null) {
+        return;
+      }
+      yield chunk;
+    }
+  } finally {
+    addon.audioStreamClose(streamId);
+  }
+}
+
+/**
+ * Create a memory budget - a hard byte ceiling shared by the native jobs attached to it
+ * 
+ * Pass the ID as `memoryBudget` to decodeAudioStream, decodeFrames or any analysis pass. Decoded frames,
+ * PCM chunks (until the read resolves) and FIFO space are charged to the budget; a job that
+ * would go over the limit waits on the event loop until memory is released, and fails with
+ * ENOMEM once it has waited `waitTimeoutMs`. Decoder buffers are charged without waiting and
+ * may take usage past the limit, which holds back new work. One budget can be shared by many jobs.
+ * 
+ * @param limitBytes - maximum bytes the attached jobs may hold at once
+ * @param options - wait timeout
+ * @returns budgetId - memory budget ID
+ * 
+ * @example
+ * ```typescript
+ * import { createMemoryBudget, getMemoryBudgetStats, detectCrop } from 'ffmpeg7';
+ * 
+ * const budget = createMemoryBudget(512 * 1024 * 1024);
+ * await Promise.all(uploads.map((file) => detectCrop(file, { memoryBudget: budget })));
+ * console.log(getMemoryBudgetStats(budget).waitTimeMs);
+ * ```
+ */
+export function createMemoryBudget(limitBytes: number, options: MemoryBudgetOptions = {}): number {
+  if (typeof limitBytes !== 'number') {
+    throw new TypeError('Expected limitBytes to be a number');
+  }
+  return addon.createMemoryBudget(limitBytes, options);
+}
+
+/**
+ * get memory budget usage and backpressure statistics
+ * 
+ * @param budgetId - memory budget ID
+ * @returns current and peak usage, wait counts and the wait time histogram
+ */
+export function getMemoryBudgetStats(budgetId: number): MemoryBudgetStats {
+  return addon.getMemoryBudgetStats(budgetId);
+}
+
+/**
+ * free a memory budget handle
+ * 
+ * Jobs that are already attached keep the budget alive and enforced until they finish.
+ * 
+ * @param budgetId - memory budget ID
+ */
+export function freeMemoryBudget(budgetId: number): void {
+  addon.freeMemoryBudget(budgetId);
+}
+
+// ────────────────────────────────────────────────────────────────────────────
+// 13. AudioMixer API - Native N-input mixing with gain and ducking
+// ────────────────────────────────────────────────────────────────────────────
+
+/**
+ * Create an audio mixer
+ * 
+ * All inputs and the output share the sample rate and channel count; output frames are fltp
+ * with `frameSize` samples and pts counted in samples (time base 1/sampleRate).
+ * 
+ * @param sampleRate - sample rate of inputs and output
+ * @param channels - channel count of inputs and output
+ * @param frameSize - samples per output frame (match the encoder frame size, e.g. 1024 for AAC)
+ * @returns mixerId - AudioMixer handle ID
+ * 
+ * @example
+ * ```typescript
+ * import { createAudioMixer, audioMixerAddInput, audioMixerFree } from 'ffmpeg7';
+ * 
+ * const mixer = createAudioMixer(48000, 2, 1024);
+ * const voice = audioMixerAddInput(mixer);
+ * const music = audioMixerAddInput(mixer, { gain: 0.8, duckBy: voice, duckGain: 0.2 });
+ * // ...
+ * audioMixerFree(mixer);
+ * ```
+ * 
+ * @throws {TypeError} if parameters are not numbers
+ * @throws {Error} if parameters are invalid
+ */
+export function createAudioMixer(sampleRate: number, channels: number, frameSize: number): number {
+  if (typeof sampleRate !== 'number' || typeof channels !== 'number' || typeof frameSize !== 'number') {
+    throw new TypeError('Expected all parameters to be numbers');
+  }
+  return addon.createAudioMixer(sampleRate, channels, frameSize);
+}
+
+/**
+ * Add an input to the mixer
+ * 
+ * @param mixerId - AudioMixer handle ID
+ * @param options - gain, AudioFIFO source and sidechain ducking settings
+ * @returns input index
+ * 
+ * @example
+ * ```typescript
+ * import { audioMixerAddInput, audioFifoAlloc } from 'ffmpeg7';
+ * 
+ * const voice = audioMixerAddInput(mixer);
+ * // Music is buffered in an AudioFIFO and ducked while the voice is above -26 dBFS
+ * const musicFifo = audioFifoAlloc(8, 2, 4096);
+ * audioMixerAddInput(mixer, { fifoId: musicFifo, duckBy: voice, duckThreshold: 0.05 });
+ * ```
+ * 
+ * @throws {TypeError} if mixerId is not a number
+ * @throws {Error} if the mixer ID, AudioFIFO or duckBy index is invalid
+ */
+export function audioMixerAddInput(mixerId: number, options: AudioMixerInputOptions = {}): number {
+  if (typeof mixerId !== 'number') {
+    throw new TypeError('Expected mixer ID to be a number');
+  }
+  return addon.audioMixerAddInput(mixerId, options);
+}
+
+/**
+ * Set the gain of a mixer input; the change is ramped over the next output frame
+ * 
+ * @param mixerId - AudioMixer handle ID
+ * @param inputIndex - input index returned by audioMixerAddInput
+ * @param gain - linear gain
+ * 
+ * @example
+ * ```typescript
+ * import { audioMixerSetGain } from 'ffmpeg7';
+ * 
+ * audioMixerSetGain(mixer, music, 0.5); // -6 dB
+ * ```
+ * 
+ * @throws {TypeError} if parameters are not numbers
+ * @throws {Error} if the mixer ID or input index is invalid
+ */
+export function audioMixerSetGain(mixerId: number, inputIndex: number, gain: number): void {
+  if (typeof mixerId !== 'number' || typeof inputIndex !== 'number' || typeof gain !== 'number') {
+    throw new TypeError('Expected all parameters to be numbers');
+  }
+  addon.audioMixerSetGain(mixerId, inputIndex, gain);
+}
+
+/**
+ * Send a frame to a mixer input
+ * 
+ * The frame must be fltp at the mixer sample rate and channel count, with pts in samples.
+ * Gaps in pts are filled with silence and overlaps are dropped; pass null to end the input.
+ * 
+ * @param mixerId - AudioMixer handle ID
+ * @param inputIndex - input index returned by audioMixerAddInput
+ * @param frameId - frame handle ID, or null to end the input
+ * 
+ * @example
+ * ```typescript
+ * import { swrConvertFrame, audioMixerSendFrame } from 'ffmpeg7';
+ * 
+ * swrConvertFrame(swr, decoded, converted);
+ * audioMixerSendFrame(mixer, voice, converted);
+ * // At end of stream
+ * audioMixerSendFrame(mixer, voice, null);
+ * ```
+ * 
+ * @throws {TypeError} if parameters have the wrong type
+ * @throws {Error} if the frame does not match the mixer format
+ */
+export function audioMixerSendFrame(mixerId: number, inputIndex: number, frameId: number | null): void {
+  if (typeof mixerId !== 'number' || typeof inputIndex !== 'number') {
+    throw new TypeError('Expected mixer ID and input index to be numbers');
+  }
+  if (frameId !== null && typeof frameId !== 'number') {
+    throw new TypeError('Expected frame ID to be a number or null');
+  }
+  addon.audioMixerSendFrame(mixerId, inputIndex, frameId);
+}
+
+/**
+ * Mix the next output frame
+ * 
+ * @param mixerId - AudioMixer handle ID
+ * @param frameId - destination frame handle ID (buffer is (re)allocated)
+ * @returns 0 on success, -1 if an input needs more data (EAGAIN), -2 when all inputs ended (EOF)
+ * 
+ * @example
+ * ```typescript
+ * import { audioMixerReceiveFrame, sendFrame } from 'ffmpeg7';
+ * 
+ * const mixed = allocFrame();
+ * while (audioMixerReceiveFrame(mixer, mixed) === 0) {
+ *   sendFrame(encoder, mixed);
+ *   // ... receive and write packets ...
+ * }
+ * ```
+ * 
+ * @throws {TypeError} if parameters are not numbers
+ * @throws {Error} if the mixer or frame ID is invalid
+ */
+export function audioMixerReceiveFrame(mixerId: number, frameId: number): number {
+  if (typeof mixerId !== 'number' || typeof frameId !== 'number') {
+    throw new TypeError('Expected mixer ID and frame ID to be numbers');
+  }
+  return addon.audioMixerReceiveFrame(mixerId, frameId);
+}
+
+/**
+ * Free an audio mixer (AudioFIFO inputs are left untouched)
+ * 
+ * @param mixerId - AudioMixer handle ID
+ * 
+ * @example
+ * ```typescript
+ * import { audioMixerFree } from 'ffmpeg7';
+ * 
+ * audioMixerFree(mixer);
+ * ```
+ * 
+ * @throws {TypeError} if mixerId is not a number
+ */
+export function audioMixerFree(mixerId: number): void {
+  if (typeof mixerId !== 'number') {
+    throw new TypeError('Expected mixer ID to be a number');
+  }
+  addon.audioMixerFree(mixerId);
+}
+
+// ────────────────────────────────────────────────────────────────────────────
+// 14. Frame-Rate Conversion - CFR/VFR output from decoded frames
+// ────────────────────────────────────────────────────────────────────────────
+
+/**
+ * Create a native frame-rate converter
+ * 
+ * Output frames carry pts in the output time base (the encoder time base when `encoderId` is given).
+ * Set the encoder option `preserve_pts` to 1 so sendFrame keeps these pts instead of renumbering frames.
+ * 
+ * @param srcTimeBase - time base of incoming frame pts (e.g. `stream.timeBase`)
+ * @param frameRate - target rate as `{ num, den }`, a number, or a string such as `'30000/1001'`
+ * @param options - conversion mode and output time base
+ * @returns converterId - frame-rate converter handle ID
+ * 
+ * @example
+ * ```typescript
+ * import { createFrameRateConverter, setEncoderOption } from 'ffmpeg7';
+ * 
+ * setEncoderOption(encoder, 'time_base_num', 1);
+ * setEncoderOption(encoder, 'time_base_den', 30);
+ * setEncoderOption(encoder, 'preserve_pts', 1);
+ * const fps = createFrameRateConverter(videoStream.timeBase, '30', { mode: 'drop', encoderId: encoder });
+ * ```
+ * 
+ * @throws {TypeError} if parameter types are incorrect
+ * @throws {Error} if the time base, rate, mode or encoder is invalid
+ */
+export function createFrameRateConverter(
+  srcTimeBase: Rational,
+  frameRate: Rational | number | string,
+  options: FrameRateConverterOptions = {}
+): number {
+  if (typeof srcTimeBase !== 'object' || srcTimeBase === null) {
+    throw new TypeError('Expected source time base to be a { num, den } object');
+  }
+  if (typeof frameRate !== 'number' && typeof frameRate !== 'string' && (typeof frameRate !== 'object' || frameRate === null)) {
+    throw new TypeError('Expected frame rate to be a number, string or { num, den } object');
+  }
+  return addon.createFrameRateConverter(srcTimeBase, frameRate, options);
+}
+
+/**
+ * Send a decoded frame to the frame-rate converter
+ * 
+ * The frame is referenced, not copied, so the caller may reuse its frame handle immediately.
+ * 
+ * @param converterId - frame-rate converter handle ID
+ * @param frameId - frame handle ID, or null to signal end of stream
+ * @returns 0 on success, -1 if output frames must be received first (EAGAIN)
+ * 
+ * @example
+ * ```typescript
+ * import { fpsConverterSendFrame } from 'ffmpeg7';
+ * 
+ * while (receiveFrame(decoder, decoded) === 0) {
+ *   fpsConverterSendFrame(fps, decoded);
+ *   // ... receive converted frames ...
+ * }
+ * fpsConverterSendFrame(fps, null); // flush
+ * ```
+ * 
+ * @throws {TypeError} if parameter types are incorrect
+ * @throws {Error} if the converter or frame ID is invalid
+ */
+export function fpsConverterSendFrame(converterId: number, frameId: number | null): number {
+  if (typeof converterId !== 'number') {
+    throw new TypeError('Expected converter ID to be a number');
+  }
+  if (frameId !== null && typeof frameId !== 'number') {
+    throw new TypeError('Expected frame ID to be a number or null');
+  }
+  return addon.fpsConverterSendFrame(converterId, frameId);
+}
+
+/**
+ * Receive the next frame at the target rate
+ * 
+ * @param converterId - frame-rate converter handle ID
+ * @param frameId - destination frame handle ID
+ * @returns 0 on success, -1 if more input is needed (EAGAIN), -2 at end of stream (EOF)
+ * 
+ * @example
+ * ```typescript
+ * import { fpsConverterReceiveFrame, swsScale, sendFrame } from 'ffmpeg7';
+ * 
+ * while (fpsConverterReceiveFrame(fps, converted) === 0) {
+ *   swsScale(sws, converted, scaled);
+ *   sendFrame(encoder, scaled);
+ * }
+ * ```
+ * 
+ * @throws {TypeError} if parameters are not numbers
+ * @throws {Error} if the converter or frame ID is invalid
+ */
+export function fpsConverterReceiveFrame(converterId: number, frameId: number): number {
+  if (typeof converterId !== 'number' || typeof frameId !== 'number') {
+    throw new TypeError('Expected converter ID and frame ID to be numbers');
+  }
+  return addon.fpsConverterReceiveFrame(converterId, frameId);
+}
+
+/**
+ * Get frame-rate converter counters
+ * 
+ * @param converterId - frame-rate converter handle ID
+ * @returns frames in/out and dropped/duplicated/blended counts
+ * 
+ * @example
+ * ```typescript
+ * import { fpsConverterGetStats } from 'ffmpeg7';
+ * 
+ * const { dropped, duplicated } = fpsConverterGetStats(fps);
+ * ```
+ * 
+ * @throws {TypeError} if converterId is not a number
+ * @throws {Error} if the converter ID is invalid
+ */
+export function fpsConverterGetStats(converterId: number): FrameRateConverterStats {
+  if (typeof converterId !== 'number') {
+    throw new TypeError('Expected converter ID to be a number');
+  }
+  return addon.fpsConverterGetStats(converterId);
+}
+
+/**
+ * Free a frame-rate converter
+ * 
+ * @param converterId - frame-rate converter handle ID
+ * 
+ * @example
+ * ```typescript
+ * import { fpsConverterFree } from 'ffmpeg7';
+ * 
+ * fpsConverterFree(fps);
+ * ```
+ * 
+ * @throws {TypeError} if converterId is not a number
+ */
+export function fpsConverterFree(converterId: number): void {
+  if (typeof converterId !== 'number') {
+    throw new TypeError('Expected converter ID to be a number');
+  }
+  addon.fpsConverterFree(converterId);
+}
+
+// ────────────────────────────────────────────────────────────────────────────
+// 15. Frame Decimation - drop near-duplicate frames (mpdecimate)
+// ────────────────────────────────────────────────────────────────────────────
+
+/**
+ * Create a near-duplicate frame decimator
+ * 
+ * Each frame is compared against the last kept frame on 8x8 luma blocks (8-bit formats).
+ * Kept frames keep their original pts, so the output is VFR; set the encoder option
+ * `preserve_pts` to 1 and rescale the pts to the encoder time base when encoding them.
+ * For a frame-rate converter, pass the same options as `decimate` instead (drop mode).
+ * 
+ * @param options - SAD thresholds and drop limit
+ * @returns decimatorId - decimator handle ID
+ * 
+ * @example
+ * ```typescript
+ * import { createDecimator, decimatorFilterFrame } from 'ffmpeg7';
+ * 
+ * const dec = createDecimator({ max: 10 });
+ * while (receiveFrame(decoder, frame) === 0) {
+ *   if (decimatorFilterFrame(dec, frame)) sendFrame(encoder, frame);
+ * }
+ * ```
+ * 
+ * @throws {TypeError} if options is not an object
+ * @throws {Error} if too many decimators are open
+ */
+export function createDecimator(options: DecimateOptions = {}): number {
+  if (typeof options !== 'object' || options === null) {
+    throw new TypeError('Expected options to be an object');
+  }
+  return addon.createDecimator(options);
+}
+
+/**
+ * Test a frame against the last kept frame
+ * 
+ * @param decimatorId - decimator handle ID
+ * @param frameId - frame handle ID
+ * @returns true to keep the frame, false if it is a near-duplicate to drop
+ * 
+ * @example
+ * ```typescript
+ * import { decimatorFilterFrame } from 'ffmpeg7';
+ * 
+ * if (!decimatorFilterFrame(dec, frame)) continue;
+ * ```
+ * 
+ * @throws {TypeError} if parameters are not numbers
+ * @throws {Error} if the decimator or frame ID is invalid
+ */
+export function decimatorFilterFrame(decimatorId: number, frameId: number): boolean {
+  if (typeof decimatorId !== 'number' || typeof frameId !== 'number') {
+    throw new TypeError('Expected decimator ID and frame ID to be numbers');
+  }
+  return addon.decimatorFilterFrame(decimatorId, frameId);
+}
+
+/**
+ * Get decimator counters
+ * 
+ * @param decimatorId - decimator handle ID
+ * @returns frames tested, kept and decimated
+ * 
+ * @example
+ * ```typescript
+ * import { decimatorGetStats } from 'ffmpeg7';
+ * 
+ * const { decimated } = decimatorGetStats(dec);
+ * ```
+ * 
+ * @throws {TypeError} if decimatorId is not a number
+ * @throws {Error} if the decimator ID is invalid
+ */
+export function decimatorGetStats(decimatorId: number): DecimatorStats {
+  if (typeof decimatorId !== 'number') {
+    throw new TypeError('Expected decimator ID to be a number');
+  }
+  return addon.decimatorGetStats(decimatorId);
+}
+
+/**
+ * Free a decimator
+ * 
+ * @param decimatorId - decimator handle ID
+ * 
+ * @example
+ * ```typescript
+ * import { decimatorFree } from 'ffmpeg7';
+ * 
+ * decimatorFree(dec);
+ * ```
+ * 
+ * @throws {TypeError} if decimatorId is not a number
+ */
+export function decimatorFree(decimatorId: number): void {
+  if (typeof decimatorId !== 'number') {
+    throw new TypeError('Expected decimator ID to be a number');
+  }
+  addon.decimatorFree(decimatorId);
+}
+
+// ────────────────────────────────────────────────────────────────────────────
+// 16. Frame Statistics - histograms and moments on frame planes
+// ────────────────────────────────────────────────────────────────────────────
+
+/**
+ * Compute histograms, mean and variance of a frame's components
+ * 
+ * Runs directly on the frame planes, so nothing is copied to JS except the histograms.
+ * 
+ * @param frameId - frame handle ID (software pixel format)
+ * @param options - components and bin count
+ * @returns one entry per selected component
+ * 
+ * @example
+ * ```typescript
+ * import { frameStats } from 'ffmpeg7';
+ * 
+ * const [luma] = frameStats(frame, { planes: [0], bins: 64 });
+ * if (luma.mean < 30) console.log('Underexposed frame');
+ * ```
+ * 
+ * @throws {TypeError} if frameId is not a number or options is not an object
+ * @throws {Error} if the frame ID, pixel format or component index is invalid
+ */
+export function frameStats(frameId: number, options: FrameStatsOptions = {}): ComponentStats[] {
+  if (typeof frameId !== 'number') {
+    throw new TypeError('Expected frame ID to be a number');
+  }
+  if (typeof options !== 'object' || options === null) {
+    throw new TypeError('Expected options to be an object');
+  }
+  return addon.frameStats(frameId, options);
+}
+
+// ────────────────────────────────────────────────────────────────────────────
+// 17. Motion Analysis - motion vectors exported by the decoder
+// ────────────────────────────────────────────────────────────────────────────
+
+/**
+ * Summarise the motion vectors of a decoded frame
+ * 
+ * The decoder must be opened with `flags2: '+export_mvs'`; this reuses the motion search
+ * the encoder already did, so no optical flow is computed. Intra frames report no vectors.
+ * 
+ * @param frameId - frame handle ID
+ * @param options - histogram layout
+ * @returns vector count, mean magnitude, coverage and area-weighted histograms
+ * 
+ * @example
+ * ```typescript
+ * import { setDecoderOption, openDecoder, frameMotionStats } from 'ffmpeg7';
+ * 
+ * setDecoderOption(decoder, 'flags2', '+export_mvs');
+ * openDecoder(decoder);
+ * // ... receiveFrame(decoder, frame)
+ * const motion = frameMotionStats(frame);
+ * if (motion.coverage > 0.5 && motion.meanMagnitude > 8) console.log('Camera pan');
+ * ```
+ * 
+ * @throws {TypeError} if frameId is not a number or options is not an object
+ * @throws {Error} if the frame ID or histogram options are invalid
+ */
+export function frameMotionStats(frameId: number, options: MotionStatsOptions = {}): MotionStats {
+  if (typeof frameId !== 'number') {
+    throw new TypeError('Expected frame ID to be a number');
+  }
+  if (typeof options !== 'object' || options === null) {
+    throw new TypeError('Expected options to be an object');
+  }
+  return addon.frameMotionStats(frameId, options);
+}
+
+// ────────────────────────────────────────────────────────────────────────────
+// 18. Side Data - captions, HDR metadata and SEI attached to frames and packets
+// ────────────────────────────────────────────────────────────────────────────
+
+/**
+ * Get the side data attached to a frame
+ * 
+ * All entries are returned in one call. `data` views FFmpeg's reference-counted buffer
+ * directly instead of copying it, and stays valid after the frame is unreferenced or freed.
+ * Treat it as read-only: it may be shared with other frames.
+ * 
+ * @param frameId - frame handle ID
+ * @param types - only return these types (default all)
+ * @returns side data entries in attachment order
+ * 
+ * @example
+ * ```typescript
+ * import { getFrameSideData } from 'ffmpeg7';
+ * 
+ * for (const sd of getFrameSideData(frame, ['masteringDisplay', 'contentLight', 'a53cc'])) {
+ *   if (sd.contentLight) console.log('MaxCLL', sd.contentLight.maxCLL);
+ *   if (sd.type === 'a53cc') captions.push(sd.data);
+ * }
+ * ```
+ * 
+ * @throws {TypeError} if frameId is not a number or types is not an array
+ * @throws {Error} if the frame ID is invalid
+ */
+export function getFrameSideData(frameId: number, types?: SideDataType[]): SideDataEntry[] {
+  if (typeof frameId !== 'number') {
+    throw new TypeError('Expected frame ID to be a number');
+  }
+  if (types !== undefined && !Array.isArray(types)) {
+    throw new TypeError('Expected types to be an array');
+  }
+  return addon.getFrameSideData(frameId, types);
+}
+
+/**
+ * Get the side data attached to a packet
+ * 
+ * Packet side data is not reference counted in FFmpeg, so `data` is a copy.
+ * 
+ * @param packetId - packet handle ID
+ * @param types - only return these types (default all)
+ * @returns side data entries in attachment order
+ * 
+ * @example
+ * ```typescript
+ * import { getPacketSideData } from 'ffmpeg7';
+ * 
+ * const [extradata] = getPacketSideData(packet, ['newExtradata']);
+ * ```
+ * 
+ * @throws {TypeError} if packetId is not a number or types is not an array
+ * @throws {Error} if the packet ID is invalid
+ */
+export function getPacketSideData(packetId: number, types?: SideDataType[]): SideDataEntry[] {
+  if (typeof packetId !== 'number') {
+    throw new TypeError('Expected packet ID to be a number');
+  }
+  if (types !== undefined && !Array.isArray(types)) {
+    throw new TypeError('Expected types to be an array');
+  }
+  return addon.getPacketSideData(packetId, types);
+}
+
+
+// ────────────────────────────────────────────────────────────────────────────
+// 19. Streaming Frame Decode - prefetching async iterator over decoded frames
+// ────────────────────────────────────────────────────────────────────────────
+
+/**
+ * Decode a stream into frames with native prefetch
+ * 
+ * A native thread opens the input, then demuxes and decodes up to `prefetch` frames ahead of the loop. Every frame
+ * that is ready is handed over in one batch, so decode latency overlaps with the loop body and
+ * the event loop is never blocked on the demuxer or decoder; open errors surface from the first
+ * `next()`. Replaces hand-written
+ * readPacket/sendPacket/receiveFrame loops.
+ * 
+ * Yielded IDs are a pool of `prefetch` frame handles owned by the iterator: a frame is valid
+ * until the iterator fetches the next batch, and all of them are freed when the loop ends.
+ * Copy what you need to keep (getFrameData, swsScale into your own frame).
+ * pts is in the stream time base, available as `getFrameProperty(frame, 'time_base')`.
+ * 
+ * @param input - input file path or URL
+ * @param options - stream selection, prefetch depth, decoder threads and memory budget
+ * @returns async generator of frame handle IDs
+ * 
+ * @example
+ * ```typescript
+ * import { decodeFrames, getFrameProperty, getFrameData } from 'ffmpeg7';
+ * 
+ * for await (const frame of decodeFrames('input.mp4', { prefetch: 16 })) {
+ *   const pts = getFrameProperty(frame, 'pts');
+ *   thumbnails.push(getFrameData(frame, 0));
+ * }
+ * ```
+ * 
+ * @throws {TypeError} if input is not a string
+ * @throws {Error} if the stream cannot be opened or decoding fails
+ */
+export async function* decodeFrames(
+  input: string,
+  options: DecodeFramesOptions = {}
+): AsyncGenerator<number, void, undefined> {
+  if (typeof input !== 'string') {
+    throw new TypeError('Expected input to be a string');
+  }
+  const streamId: number = addon.frameStreamOpen(input, options);
+  const frames: number[] = [];
+  try {
+    for (let i = 0; i < (options.prefetch ?? 8); i++) {
+      frames.push(addon.allocFrame());
+    }
+    while (true) {
+      const count: number = await addon.frameStreamRead(streamId, frames);
+      if (count === 0) {
+        return;
+      }
+      for (let i = 0; i < count; i++) {
+        yield frames[i];
+      }
+    }
+  } finally {
+    addon.frameStreamClose(streamId);
+    for (const frame of frames) {
+      addon.freeFrame(frame);
+    }
+  }
+}
+
+
+// ────────────────────────────────────────────────────────────────────────────
+// 20. Codec Streams - stream.Duplex wrappers running codecs on the thread pool
+// ────────────────────────────────────────────────────────────────────────────
+
+/**
+ * Send one input to an encoder or decoder and drain its outputs on the thread pool
+ * 
+ * The context and all handles passed belong to the thread pool until the promise settles;
+ * synchronous calls on the context (sendFrame, receivePacket, closeContext, ...) and on the
+ * frame and packet handles (freeFrame, setFrameData, getPacketData, ...) throw meanwhile.
+ * 
+ * @param contextId - encoder or decoder context ID
+ * @param inputId - frame ID (encoder) or packet ID (decoder), null to flush, undefined to only drain
+ * @param outputIds - packet IDs (encoder) or frame IDs (decoder) to receive into, 1-64
+ * @returns outputs filled, whether the input was accepted, and whether the codec is drained
+ * 
+ * @example
+ * ```typescript
+ * import { codecTransfer, allocPacket } from 'ffmpeg7';
+ * 
+ * const packets = [allocPacket(), allocPacket()];
+ * let r = await codecTransfer(encoder, frame, packets);
+ * while (!r.consumed) {
+ *   writeOut(packets.slice(0, r.received));
+ *   r = await codecTransfer(encoder, frame, packets);
+ * }
+ * ```
+ */
+export function codecTransfer(
+  contextId: number,
+  inputId: number | null | undefined,
+  outputIds: number[]
+): Promise<CodecTransferResult> {
+  if (typeof contextId !== 'number' || !Array.isArray(outputIds)) {
+    throw new TypeError('Expected context ID and an array of output IDs');
+  }
+  return addon.codecTransfer(contextId, inputId, outputIds);
+}
+
+/**
+ * Object-mode Duplex around an opened codec handle
+ * 
+ * Handle IDs written to the stream are sent to the codec on the thread pool; the write callback
+ * fires once the codec has accepted the input, so the handle can be reused after that. Every
+ * output is a new handle owned by the reader, who frees it. A full readable side pauses the
+ * codec, which in turn holds back write callbacks, so highWaterMark backpressure reaches the
+ * writer. Ending the writable side flushes the codec. The codec handle itself is not closed.
+ */
+export abstract class CodecStream extends Duplex {
+  private readonly contextId: number;
+  private readonly batchSize: number;
+  private readonly spare: number[] = [];
+  private pending: Promise<CodecTransferResult> | null = null;
+  private resumeRead: (() => void) | null = null;
+
+  protected constructor(contextId: number, options: CodecStreamOptions = {}) {
+    const highWaterMark = options.highWaterMark ?? 8;
+    super({ objectMode: true, readableHighWaterMark: highWaterMark, writableHighWaterMark: highWaterMark });
+    this.contextId = contextId;
+    this.batchSize = Math.min(Math.max(options.batchSize ?? 8, 1), 64);
+  }
+
+  protected abstract allocOutput(): number;
+  protected abstract freeOutput(id: number): void;
+
+  // Send one input (null flushes) and push everything the codec produces for it
+  private async process(input: number | null): Promise<void> {
+    const flushing = input === null;
+    let send: number | null | undefined = input;
+    while (true) {
+      while (this.spare.length < this.batchSize) {
+        this.spare.push(this.allocOutput());
+      }
+      this.pending = codecTransfer(this.contextId, send, this.spare);
+      const result = await this.pending;
+      this.pending = null;
+
+      const outputs = this.spare.splice(0, result.received);
+      if (this.destroyed) {
+        outputs.forEach((id) => this.freeOutput(id));
+        return;
+      }
+      let room = true;
+      for (const id of outputs) {
+        room = this.push(id) && room;
+      }
+      if (result.eof) {
+        return;
+      }
+      // Hold the codec (and the write callback) until the reader catches up
+      if (!room) {
+        await new Promise<void>((resolve) => {
+          this.resumeRead = resolve;
+        });
+        if (this.destroyed) {
+          return;
+        }
+      }
+      const progress = result.received > 0 || result.consumed;
+      if (result.consumed) {
+        send = undefined;
+      }
+      if (!progress) {
+        if (flushing) {
+          return;
+        }
+        throw new Error('Codec neither accepted the input nor produced output');
+      }
+      if (!flushing && send === undefined && result.received < this.batchSize) {
+        return;
+      }
+    }
+  }
+
+  _write(chunk: unknown, _encoding: BufferEncoding, callback: (error?: Error | null) => void): void {
+    if (typeof chunk !== 'number') {
+      callback(new TypeError('Expected a frame or packet handle ID'));
+      return;
+    }
+    this.process(chunk).then(() => callback(), callback);
+  }
+
+  _final(callback: (error?: Error | null) => void): void {
+    this.process(null).then(() => {
+      this.push(null);
+      callback();
+    }, callback);
+  }
+
+  _read(): void {
+    const resume = this.resumeRead;
+    this.resumeRead = null;
+    resume?.();
+  }
+
+  _destroy(error: Error | null, callback: (error?: Error | null) => void): void {
+    this._read();
+    const settled = this.pending ? this.pending.then(() => undefined, () => undefined) : Promise.resolve();
+    settled.then(() => {
+      this.spare.splice(0).forEach((id) => this.freeOutput(id));
+      callback(error);
+    });
+  }
+}
+
+/**
+ * Duplex decoder: write packet IDs, read frame IDs
+ * 
+ * @example
+ * ```typescript
+ * import { pipeline } from 'stream/promises';
+ * import { DecoderStream, EncoderStream } from 'ffmpeg7';
+ * 
+ * // packetSource yields packet IDs, packetSink frees the packet IDs it receives
+ * await pipeline(packetSource, new DecoderStream(decoder), frameFilter, new EncoderStream(encoder), packetSink);
+ * ```
+ */
+export class DecoderStream extends CodecStream {
+  constructor(decoderContextId: number, options: CodecStreamOptions = {}) {
+    super(decoderContextId, options);
+  }
+
+  protected allocOutput(): number {
+    return addon.allocFrame();
+  }
+
+  protected freeOutput(id: number): void {
+    addon.freeFrame(id);
+  }
+}
+
+/**
+ * Duplex encoder: write frame IDs, read packet IDs
+ * 
+ * Frames are read by the encoder on the thread pool; do not modify or free a frame until its
+ * write callback has fired.
+ */
+export class EncoderStream extends CodecStream {
+  constructor(encoderContextId: number, options: CodecStreamOptions = {}) {
+    super(encoderContextId, options);
+  }
+
+  protected allocOutput(): number {
+    return addon.allocPacket();
+  }
+
+  protected freeOutput(id: number): void {
+    addon.freePacket(id);
+  }
+}
@@ -78,6 +78,8 @@ export interface StreamInfo {
   index: number;
   /** Media type: "video", "audio", "subtitle", etc. */
   type: string;
+  /** Stream time base (unit of packet and decoded frame timestamps) */
+  timeBase?: Rational;
   /** Codec name (e.g., "h264", "aac") */
   codec?: string;
   /** Video width (video streams only) */
@@ -98,10 +100,706 @@ export interface StreamInfo {
   sampleRate?: number;
   /** Number of channels (audio streams only) */
   channels?: number;
+  /** Channel layout description, e.g. "5.1(side)" (audio streams only) */
+  channelLayout?: string;
   /** Bitrate */
   bitrate?: number;
 }
 
+/**
+ * Memory budget attachment shared by native jobs (decodeAudioStream, decodeFrames and the analysis passes)
+ */
+export interface JobMemoryOptions {
+  /**
+   * Memory budget ID from createMemoryBudget. Decoded frames, PCM chunks and FIFO space are
+   * charged to it; the job waits on the event loop for memory instead of allocating past the limit.
+   */
+  memoryBudget?: number;
+}
+
+/**
+ * Options for streaming PCM decode (decodeAudioStream)
+ */
+export interface DecodeAudioStreamOptions extends JobMemoryOptions {
+  /** Output sample rate in Hz (default 16000) */
+  sampleRate?: number;
+  /** Output channel count; multi-channel output is interleaved (default 1) */
+  channels?: number;
+  /** Output sample format: "f32" yields Float32Array, "s16" yields Int16Array (default "f32") */
+  format?: 'f32' | 's16';
+  /** Samples per channel in each chunk; the final chunk may be shorter (default 4096) */
+  chunkSamples?: number;
+  /** Audio stream index to decode (default: best audio stream) */
+  streamIndex?: number;
+}
+
+/**
+ * Options for the prefetching frame iterator (decodeFrames)
+ */
+export interface DecodeFramesOptions extends JobMemoryOptions {
+  /** Stream index to decode (default: best video stream, else best audio stream) */
+  streamIndex?: number;
+  /** Frames decoded ahead of the consumer, 1-64; also the largest batch per read (default 8) */
+  prefetch?: number;
+  /** Decoder threads, 0 for automatic (default 0) */
+  threads?: number;
+}
+
+/**
+ * Result of codecTransfer
+ */
+export interface CodecTransferResult {
+  /** Output handles filled, in the order they were passed */
+  received: number;
+  /** The input was accepted; otherwise drain the outputs and send it again */
+  consumed: boolean;
+  /** The codec is fully drained after a flush */
+  eof: boolean;
+}
+
+/**
+ * Options for DecoderStream and EncoderStream
+ */
+export interface CodecStreamOptions {
+  /** Handles buffered on each side before backpressure applies (default 8) */
+  highWaterMark?: number;
+  /** Output handles filled per thread-pool step, 1-64 (default 8) */
+  batchSize?: number;
+}
+
+/**
+ * Options for an AudioMixer input (audioMixerAddInput)
+ */
+export interface AudioMixerInputOptions {
+  /** Linear gain applied to this input (default 1.0) */
+  gain?: number;
+  /** Pull samples from this AudioFIFO handle (fltp, mixer channel count) instead of audioMixerSendFrame */
+  fifoId?: number;
+  /** Index of a previously added input whose level ducks this input (sidechain) */
+  duckBy?: number;
+  /** Linear RMS level of the sidechain input that triggers ducking (default 0.05) */
+  duckThreshold?: number;
+  /** Gain multiplier applied while ducked (default 0.25) */
+  duckGain?: number;
+  /** Time in ms to reach the ducked gain (default 20) */
+  duckAttack?: number;
+  /** Time in ms to recover from ducking (default 300) */
+  duckRelease?: number;
+}
+
+/**
+ * Channel layout: channel count (default layout), layout description
+ * (e.g. "5.1", "stereo", "FL+FR+LFE", "0x3f") or BigInt channel mask
+ */
+export type ChannelLayoutSpec = number | string | bigint;
+
+/**
+ * Raw PCM buffer for swrConvert: one TypedArray of interleaved samples for packed
+ * formats, or one TypedArray per channel for planar formats
+ */
+export type SampleBuffer =
+  | Uint8Array
+  | Int16Array
+  | Int32Array
+  | Float32Array
+  | Float64Array
+  | ArrayLike<Uint8Array | Int16Array | Int32Array | Float32Array | Float64Array>;
+
+/**
+ * Resampler options (libswresample AVOptions) for createSwrContext
+ */
+export interface SwrOptions {
+  /** Length of each FIR filter in the resampling filterbank (default 32; lower is faster) */
+  filter_size?: number;
+  /** log2 of the number of filterbank entries (default 10; lower is faster) */
+  phase_shift?: number;
+  /** Interpolate between filterbank entries */
+  linear_interp?: boolean;
+  /** Cutoff frequency ratio (0-1) */
+  cutoff?: number;
+  /** Dither method, e.g. "rectangular", "triangular", "triangular_hp", "shibata" */
+  dither_method?: string | number;
+  /** Simple async compensation: max samples per second to stretch/squeeze (1 enables fills/trims only) */
+  async?: number;
+  /** Any other swr option, passed through av_opt_set */
+  [name: string]: string | number | boolean | undefined;
+}
+
+/**
+ * Options for a frame-rate converter (createFrameRateConverter)
+ */
+export interface FrameRateConverterOptions {
+  /**
+   * Conversion mode:
+   * - "dup": constant output rate, frames are dropped or duplicated (vf_fps behaviour, default)
+   * - "drop": rate cap, frames are only dropped; output pts follow the kept frames (VFR)
+   * - "blend": constant output rate, frames are blended from their two neighbours (8-bit formats)
+   */
+  mode?: 'dup' | 'drop' | 'blend';
+  /** Time base of output pts (default 1/frameRate) */
+  timeBase?: Rational;
+  /** Take the output time base from this encoder handle */
+  encoderId?: number;
+  /**
+   * Drop near-duplicate input frames before conversion (true for defaults).
+   * Implies mode "drop"; combining it with "dup" or "blend" throws
+   */
+  decimate?: boolean | DecimateOptions;
+}
+
+/**
+ * Frame-rate converter counters (fpsConverterGetStats)
+ */
+export interface FrameRateConverterStats {
+  /** Frames sent to the converter */
+  framesIn: number;
+  /** Frames produced */
+  framesOut: number;
+  /** Input frames never output */
+  dropped: number;
+  /** Output frames that repeat an already output input frame */
+  duplicated: number;
+  /** Output frames blended from two input frames */
+  blended: number;
+  /** Input frames dropped by the decimator (included in dropped) */
+  decimated: number;
+}
+
+/**
+ * Near-duplicate frame decimation thresholds (mpdecimate semantics).
+ * Each 8x8 luma block is compared against the last kept frame by SAD.
+ */
+export interface DecimateOptions {
+  /** A block whose SAD exceeds this makes the frame distinct (default 768) */
+  hi?: number;
+  /** SAD threshold counted against frac (default 320) */
+  lo?: number;
+  /** Fraction of blocks that may exceed lo before the frame is distinct (default 0.33) */
+  frac?: number;
+  /**
+   * max > 0: most consecutive frames dropped; max < 0: least frames kept
+   * between drops; 0: unlimited (default 0)
+   */
+  max?: number;
+}
+
+/**
+ * Decimator counters (decimatorGetStats)
+ */
+export interface DecimatorStats {
+  /** Frames tested */
+  framesIn: number;
+  /** Frames kept */
+  kept: number;
+  /** Frames dropped as near-duplicates */
+  decimated: number;
+}
+
+/**
+ * Time interval reported by analysis passes, in seconds
+ */
+export interface TimeInterval {
+  /** Interval start */
+  start: number;
+  /** Interval end */
+  end: number;
+  /** end - start */
+  duration: number;
+}
+
+/**
+ * Result of probeDuration
+ */
+export interface DurationProbeResult {
+  /** Duration in seconds */
+  duration: number;
+  /** First timestamp in seconds (0 when the index does not say) */
+  startTime: number;
+  /**
+   * - `index`: read from the container header, exact
+   * - `tailScan`: last minus first packet timestamp, exact to one packet
+   * - `estimate`: avformat_find_stream_info, may be derived from the bitrate
+   */
+  method: 'index' | 'tailScan' | 'estimate';
+}
+
+/**
+ * Thresholds for detectBlackAndSilence (blackdetect / silencedetect semantics)
+ */
+export interface BlackSilenceOptions extends JobMemoryOptions {
+  /** Minimum black interval length in seconds (default 2) */
+  blackMinDuration?: number;
+  /** Fraction of pixels that must be black for a black picture (default 0.98) */
+  pictureBlackRatio?: number;
+  /** Luma threshold of a black pixel, as a fraction of the luma range (default 0.10) */
+  pixelBlackThreshold?: number;
+  /** Silence noise floor in dB (default -60) */
+  noise?: number;
+  /** Minimum silence length in seconds (default 2) */
+  silenceMinDuration?: number;
+  /** Decode only keyframes; much faster, black intervals are then keyframe-accurate (default false) */
+  keyframesOnly?: boolean;
+  /** Width that non 8-bit video is scaled to before scanning (default 256) */
+  analysisWidth?: number;
+}
+
+/**
+ * Result of detectBlackAndSilence
+ */
+export interface BlackSilenceResult {
+  /** Black video intervals */
+  black: TimeInterval[];
+  /** Silent audio intervals */
+  silence: TimeInterval[];
+  /** End of the last decoded frame in seconds */
+  duration: number;
+}
+
+/**
+ * Options for detectCrop
+ */
+export interface CropDetectOptions extends JobMemoryOptions {
+  /** Number of evenly spaced keyframes to sample (default 12) */
+  samples?: number;
+  /** Rows/columns with a mean luma above this are picture, 0-255 (default 24) */
+  limit?: number;
+  /** Width and height are rounded down to a multiple of this (default 2) */
+  round?: number;
+  /** Sample positions decoded in parallel (default 4) */
+  threads?: number;
+}
+
+/**
+ * Crop rectangle in source pixels
+ */
+export interface CropRect {
+  x: number;
+  y: number;
+  width: number;
+  height: number;
+}
+
+/**
+ * Result of detectCrop
+ */
+export interface CropDetectResult extends CropRect {
+  /** Source picture width */
+  sourceWidth: number;
+  /** Source picture height */
+  sourceHeight: number;
+  /** The rectangle as a filter string, e.g. "crop=1920:800:0:140" */
+  filter: string;
+  /** Content box of every usable (not entirely black) sample */
+  samples: Array<CropRect & { time: number }>;
+}
+
+/**
+ * Options for fingerprint
+ */
+export interface FingerprintOptions extends JobMemoryOptions {
+  /** Hashes per second of video (default 1) */
+  fps?: number;
+  /** Bits per hash, 64 or 256 (default 64) */
+  hashBits?: 64 | 256;
+  /** Hash keyframes only; each tick repeats the last keyframe (default true) */
+  keyframesOnly?: boolean;
+}
+
+/**
+ * Options for compareFingerprints
+ */
+export interface FingerprintCompareOptions {
+  /** Largest time shift tried between the two signatures, in seconds (default 10) */
+  maxOffset?: number;
+  /** Smallest overlap accepted, in seconds (default 5, capped at the shorter signature) */
+  minOverlap?: number;
+}
+
+/**
+ * Best alignment found by compareFingerprints
+ */
+export interface FingerprintMatch {
+  /** 1 - mean Hamming distance / hashBits; around 0.5 for unrelated content */
+  similarity: number;
+  /** Seconds by which b lags a at the best alignment */
+  offset: number;
+  /** Mean Hamming distance in bits */
+  distance: number;
+  /** Overlapping duration compared, in seconds */
+  overlap: number;
+}
+
+/**
+ * Options for frameStats and analyzeVideoStats
+ */
+export interface FrameStatsOptions {
+  /**
+   * Component indices in pixel-format order (0 = Y/R, 1 = U/G, 2 = V/B, 3 = A); default all.
+   * Semi-planar formats such as nv12 report U and V separately.
+   */
+  planes?: number[];
+  /** Histogram bins, a power of two; capped at 2^bitDepth (default 256) */
+  bins?: number;
+}
+
+/**
+ * Statistics of one frame component
+ */
+export interface ComponentStats {
+  /** Component index */
+  component: number;
+  /** Mean sample value */
+  mean: number;
+  /** Population variance */
+  variance: number;
+  /** Smallest sample value */
+  min: number;
+  /** Largest sample value */
+  max: number;
+  /** Sample counts per bin */
+  histogram: Uint32Array;
+}
+
+/**
+ * Options for analyzeVideoStats
+ */
+export interface VideoStatsOptions extends FrameStatsOptions, JobMemoryOptions {
+  /** Only analyse keyframes (default false) */
+  keyframesOnly?: boolean;
+  /** Keep one histogram per frame instead of a single summed histogram (default false) */
+  perFrameHistograms?: boolean;
+}
+
+/**
+ * Result of analyzeVideoStats. Per-frame arrays are frame-major:
+ * the value of component `components[c]` in frame `f` is at `f * components.length + c`.
+ */
+export interface VideoStatsResult {
+  /** Frames analysed */
+  frames: number;
+  /** Bins per histogram */
+  bins: number;
+  /** Component indices analysed */
+  components: number[];
+  /** Frame timestamps in seconds */
+  time: Float64Array;
+  mean: Float64Array;
+  variance: Float64Array;
+  min: Uint16Array;
+  max: Uint16Array;
+  /**
+   * Summed histograms (`components.length * bins`), or one set per frame
+   * (`frames * components.length * bins`) with `perFrameHistograms`
+   */
+  histogram: Uint32Array;
+}
+
+/**
+ * Options for analyzePackets
+ */
+export interface PacketAnalysisOptions extends JobMemoryOptions {
+  /** Stream indices to scan (default all); other streams are discarded by the demuxer */
+  streams?: number[];
+  /** Bitrate timeline bucket length in seconds (default 1) */
+  interval?: number;
+}
+
+/**
+ * Packet statistics of one stream
+ */
+export interface StreamPacketStats {
+  /** Stream index */
+  index: number;
+  /** 'video', 'audio', 'subtitle', ... */
+  type: string;
+  /** Codec name */
+  codec: string;
+  /** Packet count; one frame per packet for video */
+  frames: number;
+  /** Total payload bytes */
+  bytes: number;
+  /** Seconds from the first timestamp to the end of the last packet */
+  duration: number;
+  /** Average bitrate in bits per second */
+  bitrate: number;
+  /** Keyframe timestamps in seconds (NaN when a keyframe has no timestamp) */
+  keyframeTimes: Float64Array;
+  /** Packet number of each keyframe */
+  keyframeIndices: Uint32Array;
+  /** Packets per GOP, keyframe to keyframe; the last GOP runs to the end of the stream */
+  gopSizes: Uint32Array;
+  /** Bits per second in each `interval`, starting at the container start time */
+  bitrateTimeline: Float64Array;
+}
+
+/**
+ * Result of analyzePackets
+ */
+export interface PacketAnalysisResult {
+  /** Container duration in seconds */
+  duration: number;
+  /** Bitrate timeline bucket length in seconds */
+  interval: number;
+  streams: StreamPacketStats[];
+}
+
+/**
+ * Options for getAttachedPicture. Setting any of them turns the stored picture into a thumbnail.
+ */
+export interface AttachedPictureOptions extends JobMemoryOptions {
+  /** Thumbnail width; derived from height and the aspect ratio when omitted */
+  width?: number;
+  /** Thumbnail height; derived from width and the aspect ratio when omitted */
+  height?: number;
+  /** Output image format (default 'jpeg') */
+  format?: 'jpeg' | 'png';
+  /** JPEG quantizer, 2 (best) to 31 (default 3) */
+  quality?: number;
+}
+
+/**
+ * Embedded cover art returned by getAttachedPicture
+ */
+export interface AttachedPicture {
+  /** Encoded image; references the demuxed packet when no thumbnail options were given */
+  data: Buffer;
+  /** Image codec, e.g. 'mjpeg' or 'png' */
+  codec: string;
+  /** Width in pixels (0 if the container does not store it) */
+  width: number;
+  /** Height in pixels (0 if the container does not store it) */
+  height: number;
+  /** Index of the attached-picture stream */
+  streamIndex: number;
+}
+
+/**
+ * Per-packet encoder statistics (getEncoderPacketStats), oldest packet first
+ */
+export interface EncoderPacketStats {
+  /** Packets in this batch */
+  count: number;
+  /** Packets overwritten because the ring filled up before it was read */
+  dropped: number;
+  /** Packet pts in the encoder time base (NaN if unset) */
+  pts: Float64Array;
+  /** Packet dts in the encoder time base (NaN if unset) */
+  dts: Float64Array;
+  /** Encoded size in bytes */
+  size: Int32Array;
+  /** AV_PKT_FLAG_* bits (1 = key) */
+  flags: Uint8Array;
+  /** Picture type: 1 = I, 2 = P, 3 = B, 0 = unknown */
+  pictType: Uint8Array;
+  /** Average QP from the encoder's quality stats (NaN if the encoder does not export them) */
+  qp: Float32Array;
+  /** Sum of squared errors per plane, 4 values per packet (requires the encoder flag +psnr) */
+  error: Float64Array;
+}
+
+/**
+ * Latency histogram snapshot; all times in milliseconds.
+ * Buckets are log-linear with ~6% relative precision.
+ */
+export interface LatencyHistogram {
+  count: number;
+  min: number;
+  max: number;
+  mean: number;
+  p50: number;
+  p90: number;
+  p99: number;
+  p999: number;
+  /** Upper bound of each non-empty bucket */
+  bucketUpperBounds: Float64Array;
+  /** Samples in each non-empty bucket */
+  bucketCounts: Float64Array;
+}
+
+/**
+ * Latency histograms of a handle (getLatencyStats); only tracked metrics are present
+ */
+export interface LatencyStats {
+  /** Encoder: sendFrame -> receivePacket of the same frame */
+  encode?: LatencyHistogram;
+  /** Output: sendFrame -> writePacket of the same frame */
+  endToEnd?: LatencyHistogram;
+  /** Decoder: duration of sendPacket calls (setLatencyTracking) */
+  sendPacket?: LatencyHistogram;
+  /** Decoder: duration of receiveFrame calls that returned a frame */
+  receiveFrame?: LatencyHistogram;
+  /** Encoder: duration of sendFrame calls */
+  sendFrame?: LatencyHistogram;
+  /** Encoder: duration of receivePacket calls that returned a packet */
+  receivePacket?: LatencyHistogram;
+  /** Scaler: duration of swsScale calls */
+  scale?: LatencyHistogram;
+  /** Resampler: duration of swrConvertFrame / swrConvert calls */
+  convert?: LatencyHistogram;
+  /** Output: duration of writePacket calls */
+  write?: LatencyHistogram;
+}
+
+/**
+ * Frame buffer pool statistics (getFramePoolStats)
+ */
+export interface FramePoolStats {
+  type: 'video' | 'audio';
+  /** Pixel or sample format name */
+  format: string;
+  width?: number;
+  height?: number;
+  channels?: number;
+  nbSamples?: number;
+  /** Bytes per pooled buffer */
+  bufferSize: number;
+  /** Buffers handed out */
+  requests: number;
+  /** Buffers allocated; each stays in the pool once released */
+  allocated: number;
+  /** Requests served by a recycled buffer */
+  reused: number;
+}
+
+/**
+ * Options for createMemoryBudget
+ */
+export interface MemoryBudgetOptions {
+  /** How long a job waits for memory before it fails with ENOMEM (default 30000) */
+  waitTimeoutMs?: number;
+}
+
+/**
+ * Memory budget usage and backpressure statistics (getMemoryBudgetStats)
+ */
+export interface MemoryBudgetStats {
+  /** Byte limit */
+  limit: number;
+  /** Bytes currently charged */
+  used: number;
+  /** Highest charge seen */
+  peak: number;
+  /** Jobs waiting for memory right now */
+  waiting: number;
+  /** Charges that had to wait for memory */
+  waits: number;
+  /** Charges that timed out or were larger than the whole budget */
+  rejections: number;
+  /** Total time jobs spent waiting */
+  waitTimeMs: number;
+  /** Distribution of individual waits */
+  waitLatency: LatencyHistogram;
+}
+
+/**
+ * Options for setDecoderArena
+ */
+export interface DecoderArenaOptions {
+  /** Bytes reserved per frame (default: size of the first decoded frame) */
+  slotSize?: number;
+}
+
+/**
+ * Decoder arena usage (getDecoderArenaStats)
+ */
+export interface DecoderArenaStats {
+  /** Bytes per slot; 0 until the first frame when not given */
+  slotSize: number;
+  /** Frames the memory can hold at once (max 64) */
+  slots: number;
+  /** Slots referenced by the decoder or by frames */
+  inUse: number;
+  /** Frames decoded into the arena */
+  allocations: number;
+  /** Frames allocated by FFmpeg instead (arena full or unsupported format) */
+  fallbacks: number;
+}
+
+/**
+ * Position of a frame's planes in the memory passed to setDecoderArena
+ */
+export interface FrameArenaLayout {
+  /** Byte offset of each plane */
+  offsets: number[];
+  /** Bytes per row of each plane */
+  linesizes: number[];
+}
+
+/**
+ * Options for frameMotionStats
+ */
+export interface MotionStatsOptions {
+  /** Magnitude histogram bins (default 16) */
+  magnitudeBins?: number;
+  /** Magnitude in pixels mapped to the last bin; larger vectors are clamped (default 64) */
+  maxMagnitude?: number;
+  /** Direction histogram bins over 360°, starting rightwards and turning counter-clockwise (default 8) */
+  directionBins?: number;
+}
+
+/**
+ * Motion summary of one frame decoded with `flags2: '+export_mvs'`.
+ * Histograms are weighted by block area in pixels.
+ */
+export interface MotionStats {
+  /** Motion vectors exported by the decoder (0 for intra frames or without export_mvs) */
+  vectors: number;
+  /** Area-weighted mean vector length in pixels */
+  meanMagnitude: number;
+  /** Fraction of the frame covered by non-zero vectors, 0-1 */
+  coverage: number;
+  /** Area per magnitude bin */
+  magnitude: Float64Array;
+  /** Area per direction bin (moving blocks only) */
+  direction: Float64Array;
+}
+
+/**
+ * Side data type names accepted by getFrameSideData / getPacketSideData. Types without a short
+ * name are reported under FFmpeg's descriptive name (av_frame_side_data_name).
+ */
+export type SideDataType =
+  | 'a53cc' | 'masteringDisplay' | 'contentLight' | 'seiUnregistered' | 'displayMatrix'
+  | 's12mTimecode' | 'hdr10Plus' | 'doviRpu' | 'doviMetadata' | 'doviConfig' | 'iccProfile'
+  | 'ambientViewing' | 'filmGrain' | 'afd' | 'motionVectors' | 'newExtradata' | 'skipSamples'
+  | 'qualityStats' | 'stringsMetadata';
+
+/**
+ * SMPTE ST 2086 mastering display colour volume
+ */
+export interface MasteringDisplayMetadata {
+  /** CIE 1931 xy chromaticities of the R, G and B primaries */
+  primaries?: [[number, number], [number, number], [number, number]];
+  /** CIE 1931 xy white point */
+  whitePoint?: [number, number];
+  /** Minimum luminance in cd/m² */
+  minLuminance?: number;
+  /** Maximum luminance in cd/m² */
+  maxLuminance?: number;
+}
+
+/**
+ * One side data entry of a frame or packet
+ */
+export interface SideDataEntry {
+  type: SideDataType | string;
+  /**
+   * Raw side data. For frames this is a read-only view of FFmpeg's buffer (no copy) that stays
+   * valid after the frame is freed; packet side data is copied.
+   */
+  data: Uint8Array;
+  /** Decoded 'masteringDisplay' entry */
+  masteringDisplay?: MasteringDisplayMetadata;
+  /** Decoded 'contentLight' entry, in cd/m² */
+  contentLight?: { maxCLL: number; maxFALL: number };
+  /** 'displayMatrix': counter-clockwise rotation in degrees */
+  rotation?: number;
+  /** 'seiUnregistered': UUID of the user data */
+  uuid?: string;
+  /** 'seiUnregistered': user data after the UUID (view into `data`) */
+  payload?: Uint8Array;
+}
+
 /**
  * Log callback function type
  * @param level - FFmpeg log level (AV_LOG_*)
@@ -0,0 +1,93 @@
+// Checks that timestamps stay continuous when reconfigureEncoder switches between
+// encoders with and without B-frames.
+// Run after `npm run build && npm run build:ts`: node --test test/
+const test = require('node:test');
+const assert = require('node:assert');
+const { MidLevel } = require('../dist/index.js');
+
+const {
+  createEncoder,
+  setEncoderOption,
+  openEncoder,
+  reconfigureEncoder,
+  closeContext,
+  allocFrame,
+  allocPacket,
+  freeFrame,
+  freePacket,
+  frameGetBuffer,
+  setFrameProperty,
+  sendFrame,
+  receivePacket,
+  getPacketProperty,
+} = MidLevel;
+
+const WIDTH = 176;
+const HEIGHT = 144;
+const SEGMENT = 10; // frames between switches
+
+function makeFrame() {
+  const frame = allocFrame();
+  setFrameProperty(frame, 'width', WIDTH);
+  setFrameProperty(frame, 'height', HEIGHT);
+  setFrameProperty(frame, 'format', 0); // AV_PIX_FMT_YUV420P
+  frameGetBuffer(frame, 0);
+  return frame;
+}
+
+function encodeWithSwitches(bFrames) {
+  const encoder = createEncoder('mpeg4');
+  setEncoderOption(encoder, 'width', WIDTH);
+  setEncoderOption(encoder, 'height', HEIGHT);
+  setEncoderOption(encoder, 'pix_fmt', 'yuv420p');
+  setEncoderOption(encoder, 'time_base_num', 1);
+  setEncoderOption(encoder, 'time_base_den', 25);
+  setEncoderOption(encoder, 'max_b_frames', bFrames[0]);
+  openEncoder(encoder);
+
+  const packet = allocPacket();
+  const packets = [];
+  const drain = () => {
+    while (receivePacket(encoder, packet) === 0) {
+      packets.push({ pts: getPacketProperty(packet, 'pts'), dts: getPacketProperty(packet, 'dts') });
+    }
+  };
+
+  bFrames.forEach((maxBFrames, segment) => {
+    if (segment > 0) {
+      assert.strictEqual(reconfigureEncoder(encoder, { max_b_frames: maxBFrames }), 'switch');
+    }
+    for (let i = 0; i < SEGMENT; i++) {
+      const frame = makeFrame();
+      sendFrame(encoder, frame);
+      freeFrame(frame);
+      drain();
+    }
+  });
+  sendFrame(encoder, null);
+  drain();
+
+  freePacket(packet);
+  closeContext(encoder);
+  return packets;
+}
+
+test('switching into and out of B-frames keeps dts monotonic and pts from drifting', () => {
+  const segments = [0, 2, 0, 2, 0, 2];
+  const packets = encodeWithSwitches(segments);
+  assert.strictEqual(packets.length, segments.length * SEGMENT);
+
+  for (let i = 1; i < packets.length; i++) {
+    assert.ok(packets[i].dts > packets[i - 1].dts, `dts ${packets[i].dts} after ${packets[i - 1].dts}`);
+  }
+  for (const { pts, dts } of packets) {
+    assert.ok(dts <= pts, `dts ${dts} > pts ${pts}`);
+  }
+
+  // Frames are numbered 0..n-1; the only allowed offset is the one-off reorder room the first
+  // B-frame encoder needed, not one per switch
+  const pts = packets.map((p) => p.pts).sort((a, b) => a - b);
+  const shift = pts[0];
+  pts.forEach((value, i) => assert.strictEqual(value, i + shift));
+  assert.ok(shift <= 2, `pts shifted by ${shift}`);
+});
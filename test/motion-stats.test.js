@@ -0,0 +1,122 @@
+// Checks the sign convention of frameMotionStats on a synthetic pan.
+// Run after `npm run build && npm run build:ts`: node --test test/
+const test = require('node:test');
+const assert = require('node:assert');
+const { MidLevel } = require('../dist/index.js');
+
+const {
+  createEncoder,
+  createDecoder,
+  setEncoderOption,
+  setDecoderOption,
+  openEncoder,
+  openDecoder,
+  closeContext,
+  allocFrame,
+  allocPacket,
+  freeFrame,
+  freePacket,
+  frameGetBuffer,
+  getFrameProperty,
+  setFrameProperty,
+  setFrameData,
+  sendFrame,
+  receivePacket,
+  sendPacket,
+  receiveFrame,
+  frameMotionStats,
+} = MidLevel;
+
+const WIDTH = 176;
+const HEIGHT = 144;
+const PAN = 4; // pixels per frame, content moves rightwards
+const FRAMES = 12;
+const DIRECTION_BINS = 8; // 45° each: bins 0 and 7 straddle rightwards, 3 and 4 leftwards
+
+// Deterministic texture made of 4x4 blocks so the motion search locks onto it
+function texture(x, y) {
+  let h = Math.imul((x >> 2) * 73856093 ^ (y >> 2) * 19349663, 0x9e3779b1);
+  h ^= h >>> 15;
+  return 32 + (h & 0xbf);
+}
+
+function makeFrame(index) {
+  const frame = allocFrame();
+  setFrameProperty(frame, 'width', WIDTH);
+  setFrameProperty(frame, 'height', HEIGHT);
+  setFrameProperty(frame, 'format', 0); // AV_PIX_FMT_YUV420P
+  frameGetBuffer(frame, 0);
+
+  const linesize = getFrameProperty(frame, 'linesize');
+  const luma = Buffer.alloc(linesize[0] * HEIGHT);
+  for (let y = 0; y < HEIGHT; y++) {
+    for (let x = 0; x < WIDTH; x++) {
+      luma[y * linesize[0] + x] = texture(x - index * PAN + 1024, y);
+    }
+  }
+  setFrameData(frame, 0, luma);
+  setFrameData(frame, 1, Buffer.alloc(linesize[1] * (HEIGHT >> 1), 128));
+  setFrameData(frame, 2, Buffer.alloc(linesize[2] * (HEIGHT >> 1), 128));
+  return frame;
+}
+
+function panDirection(maxBFrames) {
+  const encoder = createEncoder('mpeg4');
+  setEncoderOption(encoder, 'width', WIDTH);
+  setEncoderOption(encoder, 'height', HEIGHT);
+  setEncoderOption(encoder, 'pix_fmt', 'yuv420p');
+  setEncoderOption(encoder, 'time_base_num', 1);
+  setEncoderOption(encoder, 'time_base_den', 25);
+  setEncoderOption(encoder, 'gop_size', FRAMES);
+  setEncoderOption(encoder, 'max_b_frames', maxBFrames);
+  setEncoderOption(encoder, 'bitrate', 2000000);
+  openEncoder(encoder);
+
+  const decoder = createDecoder('mpeg4');
+  setDecoderOption(decoder, 'flags2', '+export_mvs');
+  openDecoder(decoder);
+
+  const packet = allocPacket();
+  const decoded = allocFrame();
+  const direction = new Float64Array(DIRECTION_BINS);
+
+  const drainDecoder = () => {
+    while (receiveFrame(decoder, decoded) === 0) {
+      const stats = frameMotionStats(decoded, { directionBins: DIRECTION_BINS });
+      stats.direction.forEach((area, i) => { direction[i] += area; });
+    }
+  };
+  const drainEncoder = () => {
+    while (receivePacket(encoder, packet) === 0) {
+      sendPacket(decoder, packet);
+      drainDecoder();
+    }
+  };
+
+  for (let i = 0; i < FRAMES; i++) {
+    const frame = makeFrame(i);
+    sendFrame(encoder, frame);
+    freeFrame(frame);
+    drainEncoder();
+  }
+  sendFrame(encoder, null);
+  drainEncoder();
+  sendPacket(decoder, null);
+  drainDecoder();
+
+  freePacket(packet);
+  freeFrame(decoded);
+  closeContext(decoder);
+  closeContext(encoder);
+  return direction;
+}
+
+for (const [name, maxBFrames] of [['P-frames (past references)', 0], ['B-frames (both directions)', 2]]) {
+  test(`rightward pan is reported rightwards for ${name}`, () => {
+    const direction = panDirection(maxBFrames);
+    const rightwards = direction[0] + direction[DIRECTION_BINS - 1];
+    const leftwards = direction[DIRECTION_BINS / 2 - 1] + direction[DIRECTION_BINS / 2];
+    assert.ok(rightwards > 0, 'expected moving blocks');
+    assert.ok(rightwards > 4 * leftwards, `rightwards ${rightwards} vs leftwards ${leftwards}`);
+  });
+}